@@ -0,0 +1,327 @@
+/*
+ * Description: implementations to keep improving a gift cover until a deadline
+ * Author: Laura Galbraith
+*/
+
+#include "anytime.hpp" // self-include header
+
+#include <string> // string
+#include <vector> // vector
+#include <functional> // function
+#include <chrono> // steady_clock, microseconds, duration_cast
+#include <random> // minstd_rand, uniform_int_distribution
+#include <algorithm> // sort, max, min
+
+#include "incidence.hpp" // IncidenceStore
+#include "localsearch.hpp" // ImproveCover, LocalSearchResult
+#include "lowerbound.hpp" // BoundCover
+
+// the clock is read once every this many branch and bound nodes
+const unsigned int DEADLINE_CHECK_INTERVAL = 16;
+// the lower bound may use up to this share of the budget
+const long LOWER_BOUND_BUDGET_PERCENT = 10;
+// randomized greedy restarts may use up to this share of the budget, and stop early after this many in a row find nothing better
+const long RESTART_BUDGET_PERCENT = 25;
+// each local search, the first and each restart's, may use up to this share of the restarts' time, so the first one cannot leave none for the restarts
+const long LOCAL_SEARCH_RESTART_PERCENT = 20;
+const unsigned int RESTARTS_WITHOUT_IMPROVEMENT = 32;
+// a restart picks at random among the gifts loved by at least this share of the most uncovered villagers any gift is loved by
+const unsigned int RESTART_CANDIDATE_PERCENT = 75;
+
+std::string AnytimeMethodName(AnytimeMethod method) {
+  switch (method) {
+    case AnytimeMethod::GREEDY:
+      return "greedy";
+    case AnytimeMethod::LOCAL_SEARCH:
+      return "local search";
+    case AnytimeMethod::RANDOMIZED_GREEDY:
+      return "randomized greedy";
+    case AnytimeMethod::EXACT_SEARCH:
+      return "exact search";
+  }
+  return "";
+}
+
+AnytimeIncumbent::AnytimeIncumbent()
+  : lower_bound(0), elapsed_us(0), method(AnytimeMethod::GREEDY), optimal(false)
+{}
+
+AnytimeResult::AnytimeResult()
+  : restarts(0), exact_nodes(0), elapsed_us(0)
+{}
+
+// The state shared by every phase: the villagers to cover, the best cover so far, and a partial cover with each gift's gain kept up to date
+class AnytimeSearch {
+  public:
+    AnytimeSearch(const IncidenceStore& store, const std::vector<unsigned int>& greedy_gift_ids, long time_budget_us, const std::function<void(const AnytimeIncumbent&)>& listener)
+      : incidences(store),
+        on_incumbent(listener),
+        start(std::chrono::steady_clock::now()),
+        deadline(start + std::chrono::microseconds(time_budget_us)),
+        restart_deadline(start + std::chrono::microseconds(time_budget_us * RESTART_BUDGET_PERCENT / 100)),
+        local_search_us(time_budget_us * RESTART_BUDGET_PERCENT / 100 * LOCAL_SEARCH_RESTART_PERCENT / 100),
+        bound_us(time_budget_us * LOWER_BOUND_BUDGET_PERCENT / 100),
+        deadline_checks(0),
+        expired(false),
+        have_incumbent(false),
+        needed(store.VillagerCount(), false),
+        needed_count(0),
+        lower_bound(0),
+        rng(1),
+        gains(store.GiftCount(), 0),
+        cover_counts(store.VillagerCount(), 0),
+        uncovered(0)
+    {
+      // the villagers to cover are those the greedy picks cover; no cover can reach the rest
+      for (auto g:greedy_gift_ids) {
+        for (const unsigned int* v_it = store.GiftVillagersBegin(g); v_it != store.GiftVillagersEnd(g); ++v_it) {
+          if (!this->needed[*v_it]) {
+            this->needed[*v_it] = true;
+            ++this->needed_count;
+          }
+        }
+      }
+
+      // until BoundCover has run, the only bound is everyone over the most villagers one gift is loved by, which is quick enough not to hold up the greedy picks
+      unsigned int largest_gift = 0;
+      for (unsigned int gift_id = 0; gift_id < store.GiftCount(); ++gift_id) {
+        largest_gift = std::max(largest_gift, static_cast<unsigned int>(store.GiftVillagersEnd(gift_id) - store.GiftVillagersBegin(gift_id)));
+      }
+      this->lower_bound = largest_gift > 0 ? (this->needed_count + largest_gift - 1) / largest_gift : 0;
+    }
+
+    AnytimeResult Run(const std::vector<unsigned int>& greedy_gift_ids) {
+      // the greedy picks are the first incumbent, before anything else takes any of the budget
+      this->Offer(greedy_gift_ids, AnytimeMethod::GREEDY);
+
+      // a better bound, which later incumbents carry; if it proves the greedy picks optimal, there is nothing left to search for
+      if (!this->result.best.optimal) {
+        this->lower_bound = std::max(this->lower_bound, BoundCover(this->incidences, greedy_gift_ids, this->bound_us).bound);
+        this->result.best.lower_bound = this->lower_bound;
+        this->result.best.optimal = this->result.best.gift_ids.size() <= this->lower_bound;
+      }
+
+      if (!this->result.best.optimal) {
+        this->Offer(ImproveCover(this->incidences, this->result.best.gift_ids, this->LocalSearchUs()).gift_ids, AnytimeMethod::LOCAL_SEARCH);
+      }
+
+      unsigned int restarts_without_improvement = 0;
+      while (!this->result.best.optimal && restarts_without_improvement < RESTARTS_WITHOUT_IMPROVEMENT && this->RemainingUs(this->restart_deadline) > 0) {
+        std::vector<unsigned int> picks;
+        if (!this->RandomizedGreedy(&picks)) {
+          break;
+        }
+        ++this->result.restarts;
+
+        const LocalSearchResult improved = ImproveCover(this->incidences, picks, this->LocalSearchUs());
+        restarts_without_improvement = this->Offer(improved.gift_ids, AnytimeMethod::RANDOMIZED_GREEDY) ? 0 : restarts_without_improvement + 1;
+      }
+
+      if (!this->result.best.optimal && this->RemainingUs(this->deadline) > 0) {
+        // each pick covers someone new, so the search goes no deeper than there are villagers
+        this->branch_gifts.resize(this->needed_count + 1);
+        this->ResetCover();
+        this->Branch(0);
+
+        // the search only gives up early when out of time, so otherwise nothing smaller exists
+        if (!this->expired) {
+          this->result.best.optimal = true;
+          this->result.best.lower_bound = static_cast<unsigned int>(this->result.best.gift_ids.size());
+        }
+      }
+
+      this->result.elapsed_us = this->ElapsedUs();
+      return this->result;
+    }
+
+  private:
+    // records the cover if it is the first or strictly smaller than the best so far; returns true if it was
+    bool Offer(const std::vector<unsigned int>& gift_ids, AnytimeMethod method) {
+      if (this->have_incumbent && gift_ids.size() >= this->result.best.gift_ids.size()) {
+        return false;
+      }
+
+      this->have_incumbent = true;
+      this->result.best.gift_ids = gift_ids;
+      this->result.best.lower_bound = this->lower_bound;
+      this->result.best.elapsed_us = this->ElapsedUs();
+      this->result.best.method = method;
+      this->result.best.optimal = gift_ids.size() <= this->lower_bound;
+      if (this->on_incumbent) {
+        this->on_incumbent(this->result.best);
+      }
+      return true;
+    }
+
+    // a greedy cover that picks at random among the gifts nearly as good as the best, rather than always the best; false if out of time
+    bool RandomizedGreedy(std::vector<unsigned int>* picks) {
+      this->ResetCover();
+      while (this->uncovered > 0) {
+        if (this->Expired()) {
+          return false;
+        }
+
+        unsigned int max_gain = 0;
+        for (auto gain:this->gains) {
+          max_gain = std::max(max_gain, gain);
+        }
+        const unsigned int threshold = std::max(1u, (max_gain * RESTART_CANDIDATE_PERCENT + 99) / 100);
+
+        unsigned int candidates = 0;
+        for (auto gain:this->gains) {
+          candidates += gain >= threshold ? 1 : 0;
+        }
+        std::uniform_int_distribution<unsigned int> choose(0, candidates - 1);
+        unsigned int chosen = choose(this->rng);
+
+        for (unsigned int gift_id = 0; gift_id < this->gains.size(); ++gift_id) {
+          if (this->gains[gift_id] >= threshold && chosen-- == 0) {
+            this->Pick(gift_id);
+            break;
+          }
+        }
+      }
+
+      *picks = this->picked;
+      return true;
+    }
+
+    // branches on the uncovered villager who loves the fewest gifts, trying the gifts that cover the most first;
+    // a branch is cut once even the best gift left could not cover everyone in fewer gift types than the best cover so far
+    void Branch(size_t depth) {
+      if (this->Expired() || this->result.best.optimal) {
+        return;
+      }
+      ++this->result.exact_nodes;
+
+      if (this->uncovered == 0) {
+        this->Offer(this->picked, AnytimeMethod::EXACT_SEARCH);
+        return;
+      }
+
+      unsigned int max_gain = 0;
+      for (auto gain:this->gains) {
+        max_gain = std::max(max_gain, gain);
+      }
+      if (this->picked.size() + (this->uncovered + max_gain - 1) / max_gain >= this->result.best.gift_ids.size()) {
+        return;
+      }
+
+      unsigned int pickiest = 0;
+      size_t pickiest_degree = this->incidences.GiftCount() + 1;
+      for (unsigned int villager_id = 0; villager_id < this->needed.size(); ++villager_id) {
+        if (this->needed[villager_id] && this->cover_counts[villager_id] == 0 && this->Degree(villager_id) < pickiest_degree) {
+          pickiest = villager_id;
+          pickiest_degree = this->Degree(villager_id);
+        }
+      }
+
+      std::vector<unsigned int>& gifts_to_try = this->branch_gifts[depth];
+      gifts_to_try.assign(this->incidences.VillagerGiftsBegin(pickiest), this->incidences.VillagerGiftsEnd(pickiest));
+      std::sort(gifts_to_try.begin(), gifts_to_try.end(), [this](unsigned int a, unsigned int b) {
+        return this->gains[a] > this->gains[b] || (this->gains[a] == this->gains[b] && a < b);
+      });
+
+      for (size_t gift_i = 0; gift_i < gifts_to_try.size(); ++gift_i) {
+        this->Pick(gifts_to_try[gift_i]);
+        this->Branch(depth+1);
+        this->Unpick();
+        if (this->expired || this->result.best.optimal) {
+          return;
+        }
+      }
+    }
+
+    // nothing picked: every needed villager uncovered, and each gift's gain the number of needed villagers who love it
+    void ResetCover() {
+      this->picked.resize(0);
+      std::fill(this->cover_counts.begin(), this->cover_counts.end(), 0);
+      this->uncovered = this->needed_count;
+      for (unsigned int gift_id = 0; gift_id < this->gains.size(); ++gift_id) {
+        this->gains[gift_id] = 0;
+        for (const unsigned int* v_it = this->incidences.GiftVillagersBegin(gift_id); v_it != this->incidences.GiftVillagersEnd(gift_id); ++v_it) {
+          this->gains[gift_id] += this->needed[*v_it] ? 1 : 0;
+        }
+      }
+    }
+
+    void Pick(unsigned int gift_id) {
+      this->picked.push_back(gift_id);
+      for (const unsigned int* v_it = this->incidences.GiftVillagersBegin(gift_id); v_it != this->incidences.GiftVillagersEnd(gift_id); ++v_it) {
+        if (this->needed[*v_it] && this->cover_counts[*v_it]++ == 0) {
+          --this->uncovered;
+          for (const unsigned int* g_it = this->incidences.VillagerGiftsBegin(*v_it); g_it != this->incidences.VillagerGiftsEnd(*v_it); ++g_it) {
+            --this->gains[*g_it];
+          }
+        }
+      }
+    }
+
+    // undoes the latest pick
+    void Unpick() {
+      const unsigned int gift_id = this->picked.back();
+      this->picked.pop_back();
+      for (const unsigned int* v_it = this->incidences.GiftVillagersBegin(gift_id); v_it != this->incidences.GiftVillagersEnd(gift_id); ++v_it) {
+        if (this->needed[*v_it] && --this->cover_counts[*v_it] == 0) {
+          ++this->uncovered;
+          for (const unsigned int* g_it = this->incidences.VillagerGiftsBegin(*v_it); g_it != this->incidences.VillagerGiftsEnd(*v_it); ++g_it) {
+            ++this->gains[*g_it];
+          }
+        }
+      }
+    }
+
+    size_t Degree(unsigned int villager_id) const {
+      return static_cast<size_t>(this->incidences.VillagerGiftsEnd(villager_id) - this->incidences.VillagerGiftsBegin(villager_id));
+    }
+
+    // reads the clock only every few calls; once out of time, stays out of time
+    bool Expired() {
+      if (!this->expired && ++this->deadline_checks % DEADLINE_CHECK_INTERVAL == 0) {
+        this->expired = std::chrono::steady_clock::now() >= this->deadline;
+      }
+      return this->expired;
+    }
+
+    long RemainingUs(std::chrono::steady_clock::time_point until) const {
+      return std::max(0L, static_cast<long>(std::chrono::duration_cast<std::chrono::microseconds>(until - std::chrono::steady_clock::now()).count()));
+    }
+
+    // a local search's share of the restarts' time, or what is left of it
+    long LocalSearchUs() const {
+      return std::min(this->local_search_us, this->RemainingUs(this->restart_deadline));
+    }
+
+    long ElapsedUs() const {
+      return static_cast<long>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - this->start).count());
+    }
+
+    const IncidenceStore& incidences;
+    const std::function<void(const AnytimeIncumbent&)>& on_incumbent;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point deadline;
+    std::chrono::steady_clock::time_point restart_deadline;
+    long local_search_us;
+    long bound_us;
+    unsigned int deadline_checks;
+    bool expired;
+    bool have_incumbent;
+    AnytimeResult result;
+
+    std::vector<bool> needed; // per villager: covered by the greedy picks, so any cover must cover them
+    unsigned int needed_count;
+    unsigned int lower_bound;
+    std::minstd_rand rng; // fixed seed, so a run with enough time always streams the same covers
+
+    // the partial cover the restarts and the exact search build up
+    std::vector<unsigned int> picked;
+    std::vector<unsigned int> gains; // needed villagers each gift is loved by that nothing picked covers
+    std::vector<unsigned int> cover_counts; // picked gifts covering each villager
+    unsigned int uncovered; // needed villagers nothing picked covers
+    std::vector<std::vector<unsigned int>> branch_gifts; // scratch: gifts to try at each depth of the exact search, kept between nodes
+};
+
+AnytimeResult SolveAnytime(const IncidenceStore& incidences, const std::vector<unsigned int>& greedy_gift_ids, long time_budget_us, const std::function<void(const AnytimeIncumbent&)>& on_incumbent) {
+  AnytimeSearch search = AnytimeSearch(incidences, greedy_gift_ids, time_budget_us, on_incumbent);
+  return search.Run(greedy_gift_ids);
+}
@@ -0,0 +1,61 @@
+/*
+ * Description: interfaces to keep improving a gift cover until a deadline
+ * Documentation: of the technique: https://en.m.wikipedia.org/wiki/Anytime_algorithm
+ * Author: Laura Galbraith
+*/
+
+#ifndef SVGSC_ANYTIME_H
+#define SVGSC_ANYTIME_H
+
+#include <string> // string
+#include <vector> // vector
+#include <functional> // function
+
+#include "incidence.hpp" // IncidenceStore
+
+// how an incumbent cover was found
+enum class AnytimeMethod {
+  GREEDY, // the greedy picks the solve started from
+  LOCAL_SEARCH, // dropping and swapping gifts around the best cover so far
+  RANDOMIZED_GREEDY, // a greedy restart picking at random among the nearly-best gifts, then local search
+  EXACT_SEARCH // branch and bound over the villagers with the fewest loved gifts
+};
+
+// ex. "exact search"
+std::string AnytimeMethodName(AnytimeMethod method);
+
+// One cover, better than every one found before it
+class AnytimeIncumbent {
+  public:
+    // Constructor
+    AnytimeIncumbent();
+
+    // Member variables
+    std::vector<unsigned int> gift_ids;
+    unsigned int lower_bound; // no cover of the same villagers has fewer gift types
+    long elapsed_us; // since the solve started
+    AnytimeMethod method;
+    bool optimal; // the exact search finished, or the cover meets the lower bound
+};
+
+class AnytimeResult {
+  public:
+    // Constructor
+    AnytimeResult();
+
+    // Member variables
+    AnytimeIncumbent best;
+    unsigned int restarts; // randomized greedy restarts tried
+    unsigned long exact_nodes; // branch and bound nodes visited
+    long elapsed_us;
+};
+
+// Starts from the greedy picks and improves on them until the cover is proven optimal or the time budget runs out:
+// local search first, then randomized greedy restarts for up to a quarter of the budget, then an exact branch and bound for the rest,
+// which prunes against the best cover found so far; each local search gets at most a fifth of the restarts' time
+// each strictly better cover, the greedy picks first, is passed to on_incumbent as it is found, the greedy picks before any of the budget is spent
+// the lower bound comes from BoundCover, given up to a tenth of the budget after the greedy picks are passed on; they carry a quicker, weaker bound
+// the deadline is read every few branch and bound nodes and every restart pick, so the solve overruns it by at most a few microseconds of work
+AnytimeResult SolveAnytime(const IncidenceStore& incidences, const std::vector<unsigned int>& greedy_gift_ids, long time_budget_us, const std::function<void(const AnytimeIncumbent&)>& on_incumbent);
+
+#endif // SVGSC_ANYTIME_H
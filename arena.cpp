@@ -0,0 +1,112 @@
+/*
+ * Description: implementation to a monotonic memory arena with recycled small blocks
+ * Author: Laura Galbraith
+*/
+
+#include "arena.hpp" // self-include header
+
+ArenaStats::ArenaStats()
+  : block_allocations(0),
+    allocations(0),
+    reused_allocations(0),
+    reserved_bytes(0)
+{
+}
+
+Arena::Block::Block(char* block_data, size_t block_size)
+  : data(block_data),
+    size(block_size)
+{
+}
+
+Arena::Arena(size_t first_block_size)
+  : current_block(0),
+    pos(NULL),
+    end(NULL)
+{
+  for (size_t class_i = 0; class_i < Arena::SIZE_CLASSES; ++class_i) {
+    this->free_lists[class_i] = NULL;
+  }
+
+  this->NextBlock(first_block_size);
+}
+
+void* Arena::Allocate(size_t size) {
+  ++this->stats.allocations;
+
+  // round up so every allocation stays aligned, and so a freed allocation fits any later request of its size class
+  size = size == 0 ? Arena::ALIGNMENT : (size + Arena::ALIGNMENT - 1) / Arena::ALIGNMENT * Arena::ALIGNMENT;
+
+  const size_t class_i = size / Arena::ALIGNMENT - 1;
+  if (class_i < Arena::SIZE_CLASSES && this->free_lists[class_i] != NULL) {
+    void* p = this->free_lists[class_i];
+    this->free_lists[class_i] = *static_cast<void**>(p);
+    ++this->stats.reused_allocations;
+    return p;
+  }
+
+  if (static_cast<size_t>(this->end - this->pos) < size) {
+    this->NextBlock(size);
+  }
+
+  void* p = this->pos;
+  this->pos += size;
+  return p;
+}
+
+void Arena::Deallocate(void* p, size_t size) {
+  size = size == 0 ? Arena::ALIGNMENT : (size + Arena::ALIGNMENT - 1) / Arena::ALIGNMENT * Arena::ALIGNMENT;
+
+  const size_t class_i = size / Arena::ALIGNMENT - 1;
+  if (class_i < Arena::SIZE_CLASSES) {
+    *static_cast<void**>(p) = this->free_lists[class_i];
+    this->free_lists[class_i] = p;
+  }
+}
+
+void Arena::Reset() {
+  for (size_t class_i = 0; class_i < Arena::SIZE_CLASSES; ++class_i) {
+    this->free_lists[class_i] = NULL;
+  }
+
+  this->current_block = 0;
+  this->pos = this->blocks[0].data;
+  this->end = this->blocks[0].data + this->blocks[0].size;
+}
+
+const ArenaStats Arena::GetStats() const {
+  return this->stats;
+}
+
+Arena::~Arena() {
+  for (auto block:this->blocks) {
+    ::operator delete(block.data);
+  }
+}
+
+// moves on to the next block that fits the size, after a Reset, or else gets a new one from the heap, each double the size of the last
+void Arena::NextBlock(size_t size) {
+  while (this->pos != NULL && this->current_block+1 < this->blocks.size()) {
+    ++this->current_block;
+    const Block& block = this->blocks[this->current_block];
+    if (block.size >= size) {
+      this->pos = block.data;
+      this->end = block.data + block.size;
+      return;
+    }
+  }
+
+  size_t block_size = this->blocks.empty() ? size : this->blocks.back().size * 2;
+  if (block_size < size) {
+    block_size = size;
+  }
+
+  char* data = static_cast<char*>(::operator new(block_size));
+  this->blocks.push_back(Block(data, block_size));
+  this->current_block = this->blocks.size()-1;
+  this->pos = data;
+  this->end = data + block_size;
+
+  ++this->stats.block_allocations;
+  this->stats.reserved_bytes += block_size;
+}
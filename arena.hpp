@@ -0,0 +1,121 @@
+/*
+ * Description: interfaces to a monotonic memory arena with recycled small blocks, and an allocator drawing from it for standard containers
+ * Documentation: allocator requirements: https://en.cppreference.com/w/cpp/named_req/Allocator
+ * Author: Laura Galbraith
+*/
+
+#ifndef SVGSC_ARENA_H
+#define SVGSC_ARENA_H
+
+#include <vector> // vector
+#include <cstddef> // size_t
+#include <new> // operator new, operator delete
+
+// Running totals of what an Arena has handed out
+class ArenaStats {
+  public:
+    // Constructor
+    ArenaStats();
+
+    // Member variables
+    unsigned long block_allocations; // calls to the heap, for the arena's own blocks
+    unsigned long allocations; // requests served
+    unsigned long reused_allocations; // requests served from memory given back earlier
+    size_t reserved_bytes; // total size of the arena's blocks
+};
+
+// Hands out memory from a few large blocks, so a container's many small nodes cost no heap calls of their own
+// freed small allocations are kept on per-size free lists and handed out again; everything is released in one shot by Reset,
+// which keeps the blocks so the next use of the arena needs no heap calls at all
+// not thread-safe
+class Arena {
+  public:
+    // Constructor
+    Arena(size_t first_block_size = Arena::DEFAULT_BLOCK_SIZE);
+
+    // O(1), amortized
+    void* Allocate(size_t size);
+    void Deallocate(void* p, size_t size);
+
+    // every object using the arena must be destroyed first
+    // O(number of blocks)
+    void Reset();
+
+    // Data-reading methods
+    const ArenaStats GetStats() const;
+
+    // Destructor
+    ~Arena();
+
+  private:
+    // not copyable, since allocators hold pointers to it
+    Arena(const Arena& other);
+    Arena& operator=(const Arena& other);
+
+    void NextBlock(size_t size);
+
+    static const size_t DEFAULT_BLOCK_SIZE = 1 << 16;
+    static const size_t ALIGNMENT = alignof(std::max_align_t);
+    static const size_t SIZE_CLASSES = 16; // free lists for sizes up to SIZE_CLASSES*ALIGNMENT; larger allocations are only released by Reset
+
+    class Block {
+      public:
+        // Constructor
+        Block(char* block_data, size_t block_size);
+
+        // Member variables
+        char* data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    size_t current_block;
+    char* pos;
+    char* end;
+    void* free_lists[SIZE_CLASSES]; // each free allocation starts with a pointer to the next
+    ArenaStats stats;
+};
+
+// Standard allocator that draws from an Arena, or from the heap when it has none, so default-constructed containers still work
+// copies of a container keep its arena, while assigning to a container keeps the arena it already had
+template <class T>
+class ArenaAllocator {
+  public:
+    typedef T value_type;
+
+    // Constructors
+    ArenaAllocator() : arena(NULL) {}
+    explicit ArenaAllocator(Arena* allocator_arena) : arena(allocator_arena) {}
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t n) {
+      if (this->arena == NULL) {
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+      }
+      return static_cast<T*>(this->arena->Allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) {
+      if (this->arena == NULL) {
+        ::operator delete(p);
+        return;
+      }
+      this->arena->Deallocate(p, n * sizeof(T));
+    }
+
+    // Member variables
+    Arena* arena;
+};
+
+template <class T, class U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+  return a.arena == b.arena;
+}
+
+template <class T, class U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+  return a.arena != b.arena;
+}
+
+#endif // SVGSC_ARENA_H
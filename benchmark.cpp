@@ -0,0 +1,1064 @@
+/*
+ * Description: program to measure the throughput of the StardewValleyGiftSetCovering building blocks on the local machine
+ * Author: Laura Galbraith
+*/
+
+#include <iostream> // cout, cerr, endl
+#include <fstream> // ifstream
+#include <sstream> // stringstream
+#include <string> // string
+#include <vector> // vector
+#include <chrono> // steady_clock, duration
+#include <cstdlib> // strtoul, malloc, free
+#include <new> // bad_alloc
+#include <algorithm> // sort, unique, max, find
+#include <thread> // thread, hardware_concurrency, sleep_for
+#include <functional> // function
+#include <atomic> // atomic
+#include <memory> // shared_ptr, unique_ptr
+
+#include "xmlparse.hpp" // GetPrecededAndNestedData, XMLParseResult, XMLParseBackend
+#include "extractcache.hpp" // ExtractionCache
+#include "valleyfacts.hpp" // GiftForVillagers, Gift, Villager
+#include "bucketqueue.hpp" // BucketQueue
+#include "arena.hpp" // Arena, ArenaStats
+#include "incidence.hpp" // IncidenceStore
+#include "sweep.hpp" // RunSweep, SweepResult, SweepVariant
+#include "localsearch.hpp" // ImproveCover, LocalSearchResult
+#include "anytime.hpp" // SolveAnytime, AnytimeResult, AnytimeIncumbent, AnytimeMethodName
+#include "instance.hpp" // SetCoverInstance, SetCoverInstanceFormat, ReadSetCoverInstance
+#include "greedy.hpp" // GreedyCover
+#include "parallelgreedy.hpp" // ParallelGreedyCover, ParallelGreedyStats
+#include "output.hpp" // GiftSolution
+#include "lowerbound.hpp" // BoundCover, CoverLowerBound
+#include "maxcoverage.hpp" // SolveMaxCoverage, MaxCoverageResult
+#include "snapshot.hpp" // SnapshotStore, DatasetSnapshot, BackgroundRefresher
+#include "solver.hpp" // SolverContext, SolverQuery, IDSpan
+#include "setstore.hpp" // BuildSetStore, SetStoreBuildStats, SetStore, StreamingGreedyCover, StreamingGreedyResult
+#include "perfcounters.hpp" // WritePerfReport, PERF_COUNTERS_COMPILED_IN
+#include "smallcover.hpp" // SolveSmallCover, SmallCoverResult, SMALL_COVER_MAX_STATES
+#include "engine.hpp" // EngineCalibration, WriteEngineCalibration, ProfileInstance, ChooseEngine, EngineChoice, EngineOptions
+
+#include <sys/resource.h> // getrusage
+
+// Constants for input format
+const std::string PARSE_COMMAND = "parse";
+const std::string SOLVE_COMMAND = "solve";
+const std::string SWEEP_COMMAND = "sweep";
+const std::string IMPROVE_COMMAND = "improve";
+const std::string ANYTIME_COMMAND = "anytime";
+const std::string INSTANCE_COMMAND = "instance";
+const std::string BOUND_COMMAND = "bound";
+const std::string COVERAGE_COMMAND = "coverage";
+const std::string PARALLEL_GREEDY_COMMAND = "parallel-greedy";
+const std::string SNAPSHOT_COMMAND = "snapshot";
+const std::string QUERY_COMMAND = "query";
+const std::string STORE_COMMAND = "store";
+const std::string CALIBRATE_COMMAND = "calibrate";
+const char INPUT_LIST_SEPARATOR = ',';
+const unsigned long DEFAULT_ITERATIONS = 20;
+
+// every heap allocation the program makes is counted, to see what a solve costs; atomic, since some benchmarks allocate on several threads
+static std::atomic<unsigned long> heap_allocations(0);
+
+void* operator new(size_t size) {
+  ++heap_allocations;
+  void* p = std::malloc(size > 0 ? size : 1);
+  if (p == NULL) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  std::free(p);
+}
+
+void PrintUsage() {
+  std::cout << std::endl;
+  std::cout << "Usage: <program> " << PARSE_COMMAND << " <saved page.html> <preceding element> <preceding substring> <element1" << INPUT_LIST_SEPARATOR << "element2...> [iterations]" << std::endl;
+  std::cout << "    ex. " << PARSE_COMMAND << " Abigail.html td \"Best Gifts\" td" << INPUT_LIST_SEPARATOR << "span" << INPUT_LIST_SEPARATOR << "a" << std::endl;
+  std::cout << "   or: <program> " << SOLVE_COMMAND << " <gifts> <villagers> <villagers per gift> [iterations]" << std::endl;
+  std::cout << "    ex. " << SOLVE_COMMAND << " 1000 200 8" << std::endl;
+  std::cout << "   or: <program> " << SWEEP_COMMAND << " <gifts> <villagers> <villagers per gift> [threads]" << std::endl;
+  std::cout << "    ex. " << SWEEP_COMMAND << " 300 60 6 4" << std::endl;
+  std::cout << "   or: <program> " << IMPROVE_COMMAND << " <gifts> <villagers> <villagers per gift> [iterations]" << std::endl;
+  std::cout << "    ex. " << IMPROVE_COMMAND << " 300 60 6" << std::endl;
+  std::cout << "   or: <program> " << ANYTIME_COMMAND << " <gifts> <villagers> <villagers per gift> <time budget ms>" << std::endl;
+  std::cout << "    ex. " << ANYTIME_COMMAND << " 1000 200 8 500" << std::endl;
+  std::cout << "   or: <program> " << INSTANCE_COMMAND << " <set-cover instance file>" << std::endl;
+  std::cout << "    ex. " << INSTANCE_COMMAND << " scp41.txt" << std::endl;
+  std::cout << "   or: <program> " << BOUND_COMMAND << " <gifts> <villagers> <villagers per gift> <time budget ms>" << std::endl;
+  std::cout << "    ex. " << BOUND_COMMAND << " 300 60 6 1000" << std::endl;
+  std::cout << "   or: <program> " << COVERAGE_COMMAND << " <gifts> <villagers> <villagers per gift> <time budget ms>" << std::endl;
+  std::cout << "    ex. " << COVERAGE_COMMAND << " 300 60 6 1000" << std::endl;
+  std::cout << "   or: <program> " << PARALLEL_GREEDY_COMMAND << " <set-cover instance file> [threads]" << std::endl;
+  std::cout << "    ex. " << PARALLEL_GREEDY_COMMAND << " scp41.txt 8" << std::endl;
+  std::cout << "   or: <program> " << SNAPSHOT_COMMAND << " <gifts> <villagers> <villagers per gift> <time budget ms> [readers]" << std::endl;
+  std::cout << "    ex. " << SNAPSHOT_COMMAND << " 1000 200 8 1000 4" << std::endl;
+  std::cout << "   or: <program> " << QUERY_COMMAND << " <gifts> <villagers> <villagers per gift> [iterations]" << std::endl;
+  std::cout << "    ex. " << QUERY_COMMAND << " 300 60 6 10000" << std::endl;
+  std::cout << "   or: <program> " << STORE_COMMAND << " <set-cover instance file> <store file to write> [memory MB]" << std::endl;
+  std::cout << "    ex. " << STORE_COMMAND << " scp41.txt scp41.store 16" << std::endl;
+  std::cout << "   or: <program> " << CALIBRATE_COMMAND << " [calibration file to write] [threads]" << std::endl;
+  std::cout << "    ex. " << CALIBRATE_COMMAND << " engine.calibration 4" << std::endl;
+  std::cout << std::endl;
+}
+
+std::vector<std::string> SplitList(const std::string& s) {
+  std::vector<std::string> ret;
+  std::stringstream stream(s);
+  std::string part;
+  while (std::getline(stream, part, INPUT_LIST_SEPARATOR)) {
+    ret.push_back(part);
+  }
+  return ret;
+}
+
+// times repeated extraction with one backend; returns MB/s
+double MeasureParse(const std::string& page, const std::string& preceding_name, const std::string& preceding_substring, const std::vector<std::string>& containing_names, XMLParseBackend backend, unsigned long iterations, XMLParseResult* last_result) {
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (unsigned long i = 0; i < iterations; ++i) {
+    *last_result = GetPrecededAndNestedData(page, preceding_name, preceding_substring, containing_names, backend);
+  }
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  return static_cast<double>(page.size()) * static_cast<double>(iterations) / elapsed.count() / 1e6;
+}
+
+// times repeated extraction through an extraction cache that already holds the page, so each one only hashes it; returns MB/s
+double MeasureCachedParse(const std::string& page, const std::string& preceding_name, const std::string& preceding_substring, const std::vector<std::string>& containing_names, unsigned long iterations, XMLParseResult* last_result) {
+  ExtractionCache cache;
+  *last_result = cache.Extract(page, preceding_name, preceding_substring, containing_names, XMLParseBackend::LIBXML2);
+
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (unsigned long i = 0; i < iterations; ++i) {
+    *last_result = cache.Extract(page, preceding_name, preceding_substring, containing_names, XMLParseBackend::LIBXML2);
+  }
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  return static_cast<double>(page.size()) * static_cast<double>(iterations) / elapsed.count() / 1e6;
+}
+
+// compares libxml2 with the HTML scanner on a saved page, and with an extraction cache hit
+int ParseBenchmark(int argc, char* argv[]) {
+  if (argc < 6) {
+    PrintUsage();
+    return -1;
+  }
+
+  std::ifstream page_file(argv[2], std::ios::binary);
+  if (!page_file) {
+    std::cerr << "could not read " << argv[2] << std::endl;
+    return -1;
+  }
+  std::stringstream page_stream;
+  page_stream << page_file.rdbuf();
+  const std::string page = page_stream.str();
+
+  const std::string preceding_name = argv[3];
+  const std::string preceding_substring = argv[4];
+  const std::vector<std::string> containing_names = SplitList(argv[5]);
+  const unsigned long iterations = argc > 6 ? std::strtoul(argv[6], NULL, 10) : DEFAULT_ITERATIONS;
+
+  XMLParseResult libxml2_result = XMLParseResult(std::vector<std::string>(), "");
+  XMLParseResult scanner_result = XMLParseResult(std::vector<std::string>(), "");
+  const double libxml2_rate = MeasureParse(page, preceding_name, preceding_substring, containing_names, XMLParseBackend::LIBXML2, iterations, &libxml2_result);
+  const double scanner_rate = MeasureParse(page, preceding_name, preceding_substring, containing_names, XMLParseBackend::SCANNER, iterations, &scanner_result);
+  XMLParseResult cached_result = XMLParseResult(std::vector<std::string>(), "");
+  const double cached_rate = MeasureCachedParse(page, preceding_name, preceding_substring, containing_names, iterations, &cached_result);
+
+  std::cout << "page: " << page.size() << " bytes, " << iterations << " iterations" << std::endl;
+  std::cout << "    libxml2: " << libxml2_rate << " MB/s, " << libxml2_result.data.size() << " items" << std::endl;
+  std::cout << "    scanner: " << scanner_rate << " MB/s, " << scanner_result.data.size() << " items" << std::endl;
+  std::cout << "    speedup: " << scanner_rate / libxml2_rate << "x" << std::endl;
+  std::cout << "    extraction cache hit: " << cached_rate << " MB/s, " << cached_result.data.size() << " items, " << cached_rate / libxml2_rate << "x libxml2" << std::endl;
+
+  if (scanner_result.data != libxml2_result.data || cached_result.data != libxml2_result.data) {
+    std::cout << "    results DIFFER between backends" << std::endl;
+    return 1;
+  }
+
+  std::cout << "    results identical" << std::endl;
+  return 0;
+}
+
+// a reproducible random instance: each gift is loved by the given number of villagers, picked with a linear congruential generator
+std::vector<GiftForVillagers> GenerateGiftSets(unsigned long gift_count, unsigned long villager_count, unsigned long villagers_per_gift) {
+  std::vector<GiftForVillagers> gift_sets;
+  unsigned long state = 1;
+  for (unsigned long gift_i = 0; gift_i < gift_count; ++gift_i) {
+    std::vector<Villager> villagers;
+    for (unsigned long villager_i = 0; villager_i < villagers_per_gift; ++villager_i) {
+      state = (state * 6364136223846793005UL + 1442695040888963407UL) & 0xFFFFFFFFFFFFUL;
+      villagers.push_back("V" + std::to_string((state >> 16) % villager_count));
+    }
+    gift_sets.push_back(GiftForVillagers("G" + std::to_string(gift_i), villagers));
+  }
+  return gift_sets;
+}
+
+// the same layout the program loads: names get IDs in sorted order, so ties break the same way as the bucket queue
+IncidenceStore BuildIncidenceStore(const std::vector<GiftForVillagers>& gift_sets) {
+  std::vector<Gift> gifts;
+  std::vector<Villager> villagers;
+  for (const auto& g:gift_sets) {
+    gifts.push_back(g.GetGift());
+    for (auto v:g.GetVillagers()) {
+      villagers.push_back(v);
+    }
+  }
+  std::sort(gifts.begin(), gifts.end());
+  std::sort(villagers.begin(), villagers.end());
+  villagers.erase(std::unique(villagers.begin(), villagers.end()), villagers.end());
+
+  IncidenceStore incidences;
+  for (const auto& g:gifts) {
+    incidences.AddGift(g);
+  }
+  for (const auto& v:villagers) {
+    incidences.AddVillager(v);
+  }
+  for (const auto& g:gift_sets) {
+    const unsigned int gift_id = incidences.GetGiftNames().Find(g.GetGift());
+    for (auto v:g.GetVillagers()) {
+      incidences.AddIncidence(gift_id, incidences.GetVillagerNames().Find(v));
+    }
+  }
+  incidences.Build();
+
+  return incidences;
+}
+
+// the greedy picks, as the program makes them, by gift ID
+std::vector<unsigned int> GreedyPicks(const std::vector<GiftForVillagers>& gift_sets, const IncidenceStore& incidences) {
+  std::vector<unsigned int> greedy_picks;
+  BucketQueue<GiftForVillagers> bucket_queue = BucketQueue<GiftForVillagers>(gift_sets);
+  while (true) {
+    GiftForVillagers next_gift = bucket_queue.GetHighestPrioritySet();
+    bucket_queue.DeleteHighestPrioritySet();
+    if (next_gift.Size() == 0) {
+      break;
+    }
+    greedy_picks.push_back(incidences.GetGiftNames().Find(next_gift.GetGift()));
+  }
+  return greedy_picks;
+}
+
+// how many villagers love at least one of the gifts
+size_t CoveredVillagers(const IncidenceStore& incidences, const std::vector<unsigned int>& gift_ids) {
+  std::vector<bool> covered(incidences.VillagerCount(), false);
+  size_t covered_count = 0;
+  for (auto g:gift_ids) {
+    for (const unsigned int* v_it = incidences.GiftVillagersBegin(g); v_it != incidences.GiftVillagersEnd(g); ++v_it) {
+      covered_count += covered[*v_it] ? 0 : 1;
+      covered[*v_it] = true;
+    }
+  }
+  return covered_count;
+}
+
+// The size of a generated instance, as the solver benchmarks take it: <gifts> <villagers> <villagers per gift>
+class GeneratedInstanceSize {
+  public:
+    // Constructors
+    GeneratedInstanceSize();
+    GeneratedInstanceSize(unsigned long gifts, unsigned long villagers, unsigned long per_gift);
+
+    // ex. "instance: 300 gifts, 60 villagers, 6 villagers per gift"
+    std::string Description() const;
+
+    unsigned long gift_count;
+    unsigned long villager_count;
+    unsigned long villagers_per_gift;
+};
+
+GeneratedInstanceSize::GeneratedInstanceSize()
+  : gift_count(0), villager_count(0), villagers_per_gift(0)
+{}
+
+GeneratedInstanceSize::GeneratedInstanceSize(unsigned long gifts, unsigned long villagers, unsigned long per_gift)
+  : gift_count(gifts), villager_count(villagers), villagers_per_gift(per_gift)
+{}
+
+std::string GeneratedInstanceSize::Description() const {
+  return "instance: " + std::to_string(this->gift_count) + " gifts, " + std::to_string(this->villager_count) + " villagers, " + std::to_string(this->villagers_per_gift) + " villagers per gift";
+}
+
+// reads the size from the three arguments after the command; returns false if there are fewer than min_argc arguments, or the instance would be empty
+bool ReadInstanceSize(int argc, char* argv[], int min_argc, GeneratedInstanceSize* size) {
+  if (argc < std::max(min_argc, 5)) {
+    return false;
+  }
+
+  size->gift_count = std::strtoul(argv[2], NULL, 10);
+  size->villager_count = std::strtoul(argv[3], NULL, 10);
+  size->villagers_per_gift = std::strtoul(argv[4], NULL, 10);
+  return size->gift_count > 0 && size->villager_count > 0;
+}
+
+// A generated instance, laid out the way the program loads it, with the greedy picks over it as the program makes them
+class GeneratedInstance {
+  public:
+    // Constructor; the greedy picks take the bucket queue a while on large instances, so they are only made if asked for
+    GeneratedInstance(const GeneratedInstanceSize& instance_size, bool pick_greedily);
+
+    // prints whether the gifts, chosen by what is named, still cover every villager the greedy picks do; returns false if they do not
+    bool CheckStillCovered(const std::vector<unsigned int>& gift_ids, const std::string& chosen_by) const;
+
+    GeneratedInstanceSize size;
+    std::vector<GiftForVillagers> gift_sets;
+    IncidenceStore incidences;
+    std::vector<unsigned int> greedy_picks; // by gift ID; empty unless asked for
+};
+
+GeneratedInstance::GeneratedInstance(const GeneratedInstanceSize& instance_size, bool pick_greedily)
+  : size(instance_size),
+    gift_sets(GenerateGiftSets(instance_size.gift_count, instance_size.villager_count, instance_size.villagers_per_gift)),
+    incidences(BuildIncidenceStore(this->gift_sets))
+{
+  if (pick_greedily) {
+    this->greedy_picks = GreedyPicks(this->gift_sets, this->incidences);
+  }
+}
+
+bool GeneratedInstance::CheckStillCovered(const std::vector<unsigned int>& gift_ids, const std::string& chosen_by) const {
+  const size_t greedy_covered = CoveredVillagers(this->incidences, this->greedy_picks);
+  const size_t still_covered = CoveredVillagers(this->incidences, gift_ids);
+  if (still_covered != greedy_covered) {
+    std::cout << "    " << chosen_by << " UNCOVERED villagers: " << still_covered << " covered vs " << greedy_covered << std::endl;
+    return false;
+  }
+
+  std::cout << "    every villager still covered" << std::endl;
+  return true;
+}
+
+// greedy set-cover, as the program does it; returns the number of gifts picked
+size_t SolveGreedy(const std::vector<GiftForVillagers>& gift_sets, Arena* arena) {
+  BucketQueue<GiftForVillagers> bucket_queue = BucketQueue<GiftForVillagers>(gift_sets, arena);
+
+  size_t picked = 0;
+  while (true) {
+    GiftForVillagers next_gift = bucket_queue.GetHighestPrioritySet();
+    bucket_queue.DeleteHighestPrioritySet();
+    if (next_gift.Size() == 0) {
+      return picked;
+    }
+    ++picked;
+  }
+}
+
+// compares heap allocations of a solve with and without an arena
+int SolveBenchmark(int argc, char* argv[]) {
+  GeneratedInstanceSize size;
+  const unsigned long iterations = argc > 5 ? std::strtoul(argv[5], NULL, 10) : DEFAULT_ITERATIONS;
+  if (!ReadInstanceSize(argc, argv, 5, &size) || iterations == 0) {
+    PrintUsage();
+    return -1;
+  }
+
+  const std::vector<GiftForVillagers> gift_sets = GenerateGiftSets(size.gift_count, size.villager_count, size.villagers_per_gift);
+
+  // without an arena
+  unsigned long allocations_before = heap_allocations;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  size_t heap_picked = 0;
+  for (unsigned long i = 0; i < iterations; ++i) {
+    heap_picked = SolveGreedy(gift_sets, NULL);
+  }
+  const std::chrono::duration<double> heap_elapsed = std::chrono::steady_clock::now() - start;
+  const unsigned long heap_allocations_per_solve = (heap_allocations - allocations_before) / iterations;
+
+  // with one arena, reset between solves
+  allocations_before = heap_allocations;
+  Arena arena;
+  size_t arena_picked = SolveGreedy(gift_sets, &arena);
+  arena.Reset();
+  const unsigned long first_arena_allocations = heap_allocations - allocations_before;
+
+  allocations_before = heap_allocations;
+  start = std::chrono::steady_clock::now();
+  for (unsigned long i = 0; i < iterations; ++i) {
+    arena_picked = SolveGreedy(gift_sets, &arena);
+    arena.Reset();
+  }
+  const std::chrono::duration<double> arena_elapsed = std::chrono::steady_clock::now() - start;
+  const unsigned long steady_arena_allocations = (heap_allocations - allocations_before) / iterations;
+  const ArenaStats stats = arena.GetStats();
+
+  std::cout << size.Description() << ", " << iterations << " iterations" << std::endl;
+  std::cout << "    heap:  " << heap_allocations_per_solve << " allocations per solve, " << heap_elapsed.count() * 1000 / static_cast<double>(iterations) << " ms per solve" << std::endl;
+  std::cout << "    arena: " << first_arena_allocations << " allocations in the first solve, " << steady_arena_allocations << " per solve after, ";
+  std::cout << arena_elapsed.count() * 1000 / static_cast<double>(iterations) << " ms per solve" << std::endl;
+  std::cout << "    arena: " << stats.reserved_bytes << " bytes reserved in " << stats.block_allocations << " blocks, ";
+  std::cout << stats.reused_allocations << " of " << stats.allocations << " allocations served from freed memory" << std::endl;
+
+  if (heap_picked != arena_picked) {
+    std::cout << "    gifts picked DIFFER: " << heap_picked << " vs " << arena_picked << std::endl;
+    return 1;
+  }
+
+  std::cout << "    both picked " << heap_picked << " gifts" << std::endl;
+  return 0;
+}
+
+// times a sweep of every single-gift and single-villager removal on one thread and on many, checking a sample against the bucket queue
+int SweepBenchmark(int argc, char* argv[]) {
+  GeneratedInstanceSize size;
+  if (!ReadInstanceSize(argc, argv, 5, &size)) {
+    PrintUsage();
+    return -1;
+  }
+  unsigned int thread_count = argc > 5 ? static_cast<unsigned int>(std::strtoul(argv[5], NULL, 10)) : std::thread::hardware_concurrency();
+  if (thread_count <= 0) {
+    thread_count = 1;
+  }
+
+  const GeneratedInstance generated(size, false);
+  const std::vector<GiftForVillagers>& gift_sets = generated.gift_sets;
+  const IncidenceStore& incidences = generated.incidences;
+
+  // without local search, so the counts can be checked against the plain greedy below
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  const SweepResult serial = RunSweep(incidences, false, 1, -1);
+  const std::chrono::duration<double> serial_elapsed = std::chrono::steady_clock::now() - start;
+
+  start = std::chrono::steady_clock::now();
+  const SweepResult parallel = RunSweep(incidences, false, thread_count, -1);
+  const std::chrono::duration<double> parallel_elapsed = std::chrono::steady_clock::now() - start;
+
+  std::cout << size.Description() << ", " << serial.variants.size() << " variants" << std::endl;
+  std::cout << "    1 thread:  " << serial_elapsed.count() * 1000 << " ms" << std::endl;
+  std::cout << "    " << thread_count << " threads: " << parallel_elapsed.count() * 1000 << " ms, speedup " << serial_elapsed.count() / parallel_elapsed.count() << "x" << std::endl;
+
+  // the sweep's solver must pick as many gifts as the bucket queue, with and without each of the first few gifts
+  const size_t checked_gifts = gift_sets.size() < 10 ? gift_sets.size() : 10;
+  bool matches = serial.base.gift_types == SolveGreedy(gift_sets, NULL);
+  for (size_t gift_i = 0; gift_i < checked_gifts && matches; ++gift_i) {
+    std::vector<GiftForVillagers> remaining_sets;
+    for (const auto& g:gift_sets) {
+      if (g.GetGift() != incidences.GetGiftNames().Name(static_cast<unsigned int>(gift_i))) {
+        remaining_sets.push_back(g);
+      }
+    }
+
+    for (const auto& variant:serial.variants) {
+      if (variant.removed_gifts.size() == 1 && variant.removed_gifts[0] == gift_i) {
+        matches = variant.gift_types == SolveGreedy(remaining_sets, NULL);
+      }
+    }
+  }
+
+  bool same_ranking = serial.variants.size() == parallel.variants.size();
+  for (size_t variant_i = 0; variant_i < serial.variants.size() && same_ranking; ++variant_i) {
+    same_ranking = serial.variants[variant_i].removed_gifts == parallel.variants[variant_i].removed_gifts &&
+                   serial.variants[variant_i].skipped_villagers == parallel.variants[variant_i].skipped_villagers &&
+                   serial.variants[variant_i].gift_types == parallel.variants[variant_i].gift_types;
+  }
+
+  if (!matches || !same_ranking) {
+    std::cout << "    results DIFFER" << (matches ? " between thread counts" : " from the bucket queue") << std::endl;
+    return 1;
+  }
+
+  std::cout << "    results identical, and match the bucket queue" << std::endl;
+  return 0;
+}
+
+// times the local search after the greedy picks, checking it uncovers no one
+int ImproveBenchmark(int argc, char* argv[]) {
+  GeneratedInstanceSize size;
+  const unsigned long iterations = argc > 5 ? std::strtoul(argv[5], NULL, 10) : DEFAULT_ITERATIONS;
+  if (!ReadInstanceSize(argc, argv, 5, &size) || iterations == 0) {
+    PrintUsage();
+    return -1;
+  }
+
+  const GeneratedInstance generated(size, true);
+
+  LocalSearchResult improved;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (unsigned long i = 0; i < iterations; ++i) {
+    improved = ImproveCover(generated.incidences, generated.greedy_picks, 1000000);
+  }
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  std::cout << size.Description() << ", " << iterations << " iterations" << std::endl;
+  std::cout << "    greedy picked " << generated.greedy_picks.size() << " gifts; local search kept " << improved.gift_ids.size() << " (" << improved.redundant_removed << " redundant, ";
+  std::cout << improved.one_for_two_swaps << " one-for-two swaps, " << improved.two_for_three_swaps << " two-for-three swaps" << (improved.local_optimum ? "" : ", stopped by the time budget") << ")" << std::endl;
+  std::cout << "    " << elapsed.count() * 1000000 / static_cast<double>(iterations) << " us per local search" << std::endl;
+
+  return generated.CheckStillCovered(improved.gift_ids, "local search") ? 0 : 1;
+}
+
+int AnytimeBenchmark(int argc, char* argv[]) {
+  GeneratedInstanceSize size;
+  if (!ReadInstanceSize(argc, argv, 6, &size)) {
+    PrintUsage();
+    return -1;
+  }
+  const long time_budget_ms = static_cast<long>(std::strtoul(argv[5], NULL, 10));
+
+  const GeneratedInstance generated(size, true);
+
+  std::cout << size.Description() << ", " << time_budget_ms << " ms budget" << std::endl;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  const AnytimeResult anytime = SolveAnytime(generated.incidences, generated.greedy_picks, time_budget_ms * 1000, [](const AnytimeIncumbent& incumbent) {
+    std::cout << "    " << static_cast<double>(incumbent.elapsed_us) / 1000 << " ms: " << incumbent.gift_ids.size() << " gift types (" << AnytimeMethodName(incumbent.method) << "), ";
+    std::cout << (incumbent.optimal ? "proven optimal" : "at least " + std::to_string(incumbent.lower_bound) + " needed") << std::endl;
+  });
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  std::cout << "    best: " << anytime.best.gift_ids.size() << " gift types, " << (anytime.best.optimal ? "proven optimal" : "at least " + std::to_string(anytime.best.lower_bound) + " needed");
+  std::cout << "; " << anytime.restarts << " randomized greedy restarts, " << anytime.exact_nodes << " exact search nodes" << std::endl;
+  std::cout << "    finished after " << elapsed.count() * 1000 << " ms";
+  if (!anytime.best.optimal) {
+    std::cout << ", " << elapsed.count() * 1000 - static_cast<double>(time_budget_ms) << " ms past the budget";
+  }
+  std::cout << std::endl;
+
+  return generated.CheckStillCovered(anytime.best.gift_ids, "the best cover") ? 0 : 1;
+}
+
+int InstanceBenchmark(int argc, char* argv[]) {
+  if (argc < 3) {
+    PrintUsage();
+    return -1;
+  }
+
+  std::ifstream sized_file(argv[2], std::ios::binary | std::ios::ate);
+  const double file_mb = static_cast<double>(sized_file.tellg()) / (1024 * 1024);
+  sized_file.close();
+
+  SetCoverInstance instance;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  const std::string read_error = ReadSetCoverInstance(argv[2], SetCoverInstanceFormat::DETECT, &instance);
+  const std::chrono::duration<double> read_elapsed = std::chrono::steady_clock::now() - start;
+  if (read_error != "") {
+    std::cerr << "could not read instance: " << read_error << std::endl;
+    return -1;
+  }
+
+  GiftSolution solution;
+  start = std::chrono::steady_clock::now();
+  GreedyCover(instance.incidences, NULL, &solution);
+  const std::chrono::duration<double> solve_elapsed = std::chrono::steady_clock::now() - start;
+
+  std::cout << "instance: " << instance.incidences.GiftCount() << " sets, " << instance.incidences.VillagerCount() << " elements, " << instance.incidences.IncidenceCount() << " incidences, " << file_mb << " MB" << std::endl;
+  std::cout << "    read and laid out in " << read_elapsed.count() * 1000 << " ms: " << file_mb / read_elapsed.count() << " MB/s" << std::endl;
+  std::cout << "    greedy cover of " << solution.GiftCount() << " sets (" << solution.uncovered_villager_ids.size() << " elements uncovered) in " << solve_elapsed.count() * 1000 << " ms" << std::endl;
+  return 0;
+}
+
+// times the lower bound on the greedy picks, checking it against the best cover the anytime solve finds in the time budget
+int BoundBenchmark(int argc, char* argv[]) {
+  GeneratedInstanceSize size;
+  if (!ReadInstanceSize(argc, argv, 6, &size)) {
+    PrintUsage();
+    return -1;
+  }
+  const long time_budget_ms = static_cast<long>(std::strtoul(argv[5], NULL, 10));
+
+  const GeneratedInstance generated(size, true);
+
+  const CoverLowerBound bound = BoundCover(generated.incidences, generated.greedy_picks, time_budget_ms * 1000);
+  std::cout << size.Description() << ", " << time_budget_ms << " ms budget" << std::endl;
+  std::cout << "    greedy picked " << generated.greedy_picks.size() << " gifts; at least " << bound.bound << " needed (" << bound.disjoint_villagers << " disjoint villagers, ";
+  std::cout << bound.by_size << " by size, " << bound.relaxation << " by the relaxation after " << bound.iterations << " subgradient steps)" << std::endl;
+  std::cout << "    " << static_cast<double>(bound.elapsed_us) / 1000 << " ms for the bound" << std::endl;
+
+  // no cover can beat the bound, so an optimal one shows whether it is valid
+  const AnytimeResult anytime = SolveAnytime(generated.incidences, generated.greedy_picks, time_budget_ms * 1000, std::function<void(const AnytimeIncumbent&)>());
+  std::cout << "    best cover found: " << anytime.best.gift_ids.size() << " gifts" << (anytime.best.optimal ? ", proven optimal" : "") << std::endl;
+  if (bound.bound > anytime.best.gift_ids.size()) {
+    std::cout << "    the bound EXCEEDS a cover of " << anytime.best.gift_ids.size() << std::endl;
+    return 1;
+  }
+
+  std::cout << "    bound no more than the best cover" << std::endl;
+  return 0;
+}
+
+// times reading every k off the greedy picks against the exact search for each k, checking greedy keeps its 1 - 1/e guarantee
+int CoverageBenchmark(int argc, char* argv[]) {
+  GeneratedInstanceSize size;
+  if (!ReadInstanceSize(argc, argv, 6, &size)) {
+    PrintUsage();
+    return -1;
+  }
+  const long time_budget_ms = static_cast<long>(std::strtoul(argv[5], NULL, 10));
+
+  const GeneratedInstance generated(size, true);
+
+  const MaxCoverageResult greedy = SolveMaxCoverage(generated.incidences, generated.greedy_picks, 1, false, 0);
+  const MaxCoverageResult exact = SolveMaxCoverage(generated.incidences, generated.greedy_picks, 1, true, time_budget_ms * 1000);
+
+  std::cout << size.Description() << ", " << time_budget_ms << " ms budget" << std::endl;
+  std::cout << "    every k from the greedy picks in " << static_cast<double>(greedy.elapsed_us) / 1000 << " ms; exact search " << static_cast<double>(exact.elapsed_us) / 1000 << " ms, " << exact.exact_nodes << " nodes" << std::endl;
+
+  bool guarantee_kept = true;
+  for (size_t k = 1; k <= greedy.covered.size(); ++k) {
+    std::cout << "    k = " << k << ": greedy covers " << greedy.covered[k-1] << ", exact " << exact.covered[k-1] << (exact.optimal[k-1] ? " (optimal)" : "") << std::endl;
+    if (exact.optimal[k-1] && static_cast<double>(greedy.covered[k-1]) < (1 - 1 / 2.718281828459045) * static_cast<double>(exact.covered[k-1])) {
+      guarantee_kept = false;
+    }
+  }
+
+  if (!guarantee_kept) {
+    std::cout << "    greedy covered LESS than 1 - 1/e of the optimum" << std::endl;
+    return 1;
+  }
+
+  std::cout << "    greedy within 1 - 1/e of every optimum found" << std::endl;
+  return 0;
+}
+
+// times the greedy cover of an instance on one thread and on more, doubling up to the threads asked for, then in bulk rounds,
+// checking the parallel picks match the sequential ones
+int ParallelGreedyBenchmark(int argc, char* argv[]) {
+  if (argc < 3) {
+    PrintUsage();
+    return -1;
+  }
+
+  unsigned long max_threads = argc > 3 ? std::strtoul(argv[3], NULL, 10) : std::thread::hardware_concurrency();
+  if (max_threads == 0) {
+    max_threads = 1;
+  }
+
+  SetCoverInstance instance;
+  const std::string read_error = ReadSetCoverInstance(argv[2], SetCoverInstanceFormat::DETECT, &instance);
+  if (read_error != "") {
+    std::cerr << "could not read instance: " << read_error << std::endl;
+    return -1;
+  }
+  std::cout << "instance: " << instance.incidences.GiftCount() << " sets, " << instance.incidences.VillagerCount() << " elements, " << instance.incidences.IncidenceCount() << " incidences" << std::endl;
+
+  GiftSolution sequential;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  GreedyCover(instance.incidences, NULL, &sequential);
+  const std::chrono::duration<double> sequential_elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << "    sequential: " << sequential.GiftCount() << " sets in " << sequential_elapsed.count() * 1000 << " ms" << std::endl;
+
+  bool all_match = true;
+  for (unsigned long thread_count = 1; thread_count <= max_threads; thread_count *= 2) {
+    GiftSolution parallel;
+    start = std::chrono::steady_clock::now();
+    const ParallelGreedyStats stats = ParallelGreedyCover(instance.incidences, static_cast<unsigned int>(thread_count), false, &parallel);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    const bool match = parallel.gift_ids == sequential.gift_ids && parallel.villager_ids == sequential.villager_ids && parallel.uncovered_villager_ids == sequential.uncovered_villager_ids;
+    all_match = all_match && match;
+    std::cout << "    " << stats.thread_count << " threads: " << parallel.GiftCount() << " sets in " << elapsed.count() * 1000 << " ms, " << stats.rounds << " rounds, ";
+    std::cout << sequential_elapsed.count() / elapsed.count() << "x the sequential speed" << (match ? "" : ", picks DIFFER") << std::endl;
+  }
+
+  GiftSolution bulk;
+  start = std::chrono::steady_clock::now();
+  const ParallelGreedyStats bulk_stats = ParallelGreedyCover(instance.incidences, static_cast<unsigned int>(max_threads), true, &bulk);
+  const std::chrono::duration<double> bulk_elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << "    " << bulk_stats.thread_count << " threads in bulk rounds: " << bulk.GiftCount() << " sets (" << bulk.uncovered_villager_ids.size() << " elements uncovered) in " << bulk_elapsed.count() * 1000 << " ms, ";
+  std::cout << bulk_stats.rounds << " rounds, " << sequential_elapsed.count() / bulk_elapsed.count() << "x the sequential speed" << std::endl;
+
+  if (!all_match || bulk.uncovered_villager_ids != sequential.uncovered_villager_ids) {
+    std::cout << "    the parallel greedy did NOT match the sequential cover" << std::endl;
+    return 1;
+  }
+
+  std::cout << "    every parallel cover matches the sequential picks, and bulk rounds cover the same elements" << std::endl;
+  return 0;
+}
+
+// the snapshots cycle through this many sizes, so a reader can tell from its version how many gifts a snapshot must have
+const unsigned long SNAPSHOT_SIZES = 8;
+
+// generated gift data standing in for a load from the wiki
+std::unique_ptr<GiftsByVillager> GenerateSnapshotData(unsigned long gift_count, unsigned long villager_count, unsigned long villagers_per_gift) {
+  SetCoverInstance instance;
+  instance.incidences = BuildIncidenceStore(GenerateGiftSets(gift_count, villager_count, villagers_per_gift));
+  return std::unique_ptr<GiftsByVillager>(new GiftsByVillager(&instance));
+}
+
+// what one reader thread saw
+class SnapshotReaderStats {
+  public:
+    SnapshotReaderStats()
+      : solves(0), acquire_ns(0), max_acquire_ns(0), versions_seen(0), consistent(true)
+    {}
+
+    unsigned long solves;
+    double acquire_ns;
+    double max_acquire_ns;
+    unsigned long versions_seen;
+    bool consistent; // false if a version went backwards or a snapshot's data did not match its version
+};
+
+// solves back to back on several threads for the time budget, each solve on the latest snapshot, while a background refresher publishes new ones as fast as it builds them,
+// checking every reader only ever sees versions count up, each with its own data whole
+int SnapshotBenchmark(int argc, char* argv[]) {
+  GeneratedInstanceSize size;
+  if (!ReadInstanceSize(argc, argv, 6, &size)) {
+    PrintUsage();
+    return -1;
+  }
+  const long time_budget_ms = static_cast<long>(std::strtoul(argv[5], NULL, 10));
+  unsigned long reader_count = argc > 6 ? std::strtoul(argv[6], NULL, 10) : std::thread::hardware_concurrency();
+  if (reader_count == 0) {
+    reader_count = 1;
+  }
+
+  SnapshotStore store(GenerateSnapshotData(size.gift_count, size.villager_count, size.villagers_per_gift).get());
+  BackgroundRefresher refresher(&store, [=](const GiftsByVillager& current) {
+    const unsigned long next_gift_count = size.gift_count + (current.GetIncidences().GiftCount() + 1 - size.gift_count) % SNAPSHOT_SIZES;
+    return GenerateSnapshotData(next_gift_count, size.villager_count, size.villagers_per_gift);
+  }, 1);
+
+  std::atomic<bool> stopping(false);
+  std::vector<SnapshotReaderStats> reader_stats(reader_count);
+  std::vector<std::thread> readers;
+  for (unsigned long reader_i = 0; reader_i < reader_count; ++reader_i) {
+    readers.push_back(std::thread([&store, &stopping, &reader_stats, reader_i, size]() {
+      SnapshotReaderStats& stats = reader_stats[reader_i];
+      unsigned long last_version = 0;
+      while (!stopping.load()) {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        const std::shared_ptr<const DatasetSnapshot> snapshot = store.Acquire();
+        const std::chrono::duration<double, std::nano> acquire_elapsed = std::chrono::steady_clock::now() - start;
+        stats.acquire_ns += acquire_elapsed.count();
+        stats.max_acquire_ns = std::max(stats.max_acquire_ns, acquire_elapsed.count());
+
+        GiftSolution solution;
+        GreedyCover(snapshot->data.GetIncidences(), NULL, &solution);
+        ++stats.solves;
+
+        const unsigned long expected_gifts = size.gift_count + (snapshot->version - 1) % SNAPSHOT_SIZES;
+        stats.consistent = stats.consistent && snapshot->version >= last_version && snapshot->data.GetIncidences().GiftCount() == expected_gifts;
+        stats.versions_seen += snapshot->version != last_version ? 1 : 0;
+        last_version = snapshot->version;
+      }
+    }));
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(time_budget_ms));
+  stopping = true;
+  for (auto& t:readers) {
+    t.join();
+  }
+
+  SnapshotReaderStats total;
+  for (const auto& stats:reader_stats) {
+    total.solves += stats.solves;
+    total.acquire_ns += stats.acquire_ns;
+    total.max_acquire_ns = std::max(total.max_acquire_ns, stats.max_acquire_ns);
+    total.versions_seen += stats.versions_seen;
+    total.consistent = total.consistent && stats.consistent;
+  }
+
+  std::cout << "snapshot: " << reader_count << " readers for " << time_budget_ms << " ms, on " << size.gift_count << " to " << size.gift_count + SNAPSHOT_SIZES - 1 << " gifts, " << size.villager_count << " villagers, " << size.villagers_per_gift << " villagers per gift" << std::endl;
+  std::cout << "    " << refresher.Publishes() << " snapshots published in the background; the readers saw " << total.versions_seen << " versions between them" << std::endl;
+  std::cout << "    " << total.solves << " solves, " << static_cast<double>(total.solves) * 1000.0 / static_cast<double>(time_budget_ms) << " per second" << std::endl;
+  std::cout << "    acquire: " << (total.solves > 0 ? total.acquire_ns / static_cast<double>(total.solves) : 0) << " ns mean, " << total.max_acquire_ns << " ns max" << std::endl;
+
+  if (!total.consistent) {
+    std::cout << "    a reader saw versions go backwards, or a snapshot's data not its own" << std::endl;
+    return 1;
+  }
+
+  std::cout << "    every reader saw versions only count up, each with its own data" << std::endl;
+  return 0;
+}
+
+// true if the solution skips the villagers and gifts it was asked to, and accounts for every other villager once; seen is kept between calls so checking allocates nothing
+bool QueryAnswered(const GiftSolution& solution, size_t villager_count, unsigned int skipped_villager_id, unsigned int missing_gift_id, std::vector<unsigned int>* seen) {
+  seen->assign(villager_count, 0);
+  for (auto v:solution.villager_ids) {
+    ++(*seen)[v];
+  }
+  for (auto v:solution.uncovered_villager_ids) {
+    ++(*seen)[v];
+  }
+  for (unsigned int villager_id = 0; villager_id < villager_count; ++villager_id) {
+    if ((*seen)[villager_id] != (villager_id == skipped_villager_id ? 0u : 1u)) {
+      return false;
+    }
+  }
+  return std::find(solution.gift_ids.begin(), solution.gift_ids.end(), missing_gift_id) == solution.gift_ids.end();
+}
+
+// times queries against data loaded once, each skipping a different villager and missing a different gift: through one reused solver context, then a new context per query,
+// checking the context picks as many gifts as the bucket queue and that every answer skips what it was asked to
+int QueryBenchmark(int argc, char* argv[]) {
+  GeneratedInstanceSize size;
+  const unsigned long iterations = argc > 5 ? std::strtoul(argv[5], NULL, 10) : DEFAULT_ITERATIONS;
+  if (!ReadInstanceSize(argc, argv, 5, &size) || iterations == 0) {
+    PrintUsage();
+    return -1;
+  }
+
+  const std::unique_ptr<GiftsByVillager> data = GenerateSnapshotData(size.gift_count, size.villager_count, size.villagers_per_gift);
+  const size_t villagers = data->GetIncidences().VillagerCount();
+  const size_t gifts = data->GetIncidences().GiftCount();
+
+  SolverContext context;
+  SolverQuery query;
+  context.Solve(*data, query);
+  const size_t bucket_queue_picked = SolveGreedy(GenerateGiftSets(size.gift_count, size.villager_count, size.villagers_per_gift), NULL);
+  const size_t context_picked = context.LovedSolution().GiftCount();
+
+  bool all_answered = true;
+  std::vector<unsigned int> seen(villagers, 0);
+  unsigned int skipped_villager_id = 0;
+  unsigned int missing_gift_id = 0;
+  query.skip_villager_ids = IDSpan(&skipped_villager_id, 1);
+  query.missing_gift_ids = IDSpan(&missing_gift_id, 1);
+
+  unsigned long allocations_before = heap_allocations;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (unsigned long i = 0; i < iterations; ++i) {
+    skipped_villager_id = static_cast<unsigned int>(i % villagers);
+    missing_gift_id = static_cast<unsigned int>(i % gifts);
+    context.Solve(*data, query);
+    all_answered = all_answered && QueryAnswered(context.LovedSolution(), villagers, skipped_villager_id, missing_gift_id, &seen);
+  }
+  const std::chrono::duration<double> reused_elapsed = std::chrono::steady_clock::now() - start;
+  const unsigned long reused_allocations = heap_allocations - allocations_before;
+
+  allocations_before = heap_allocations;
+  start = std::chrono::steady_clock::now();
+  for (unsigned long i = 0; i < iterations; ++i) {
+    skipped_villager_id = static_cast<unsigned int>(i % villagers);
+    missing_gift_id = static_cast<unsigned int>(i % gifts);
+    SolverContext fresh_context;
+    fresh_context.Solve(*data, query);
+  }
+  const std::chrono::duration<double> fresh_elapsed = std::chrono::steady_clock::now() - start;
+  const unsigned long fresh_allocations = (heap_allocations - allocations_before) / iterations;
+
+  std::cout << "query: " << gifts << " gifts, " << villagers << " villagers, " << size.villagers_per_gift << " villagers per gift, " << iterations << " queries, each skipping a villager and missing a gift" << std::endl;
+  std::cout << "    reused context: " << reused_elapsed.count() * 1000000 / static_cast<double>(iterations) << " us per query, " << reused_allocations << " allocations in all" << std::endl;
+  std::cout << "    new context:    " << fresh_elapsed.count() * 1000000 / static_cast<double>(iterations) << " us per query, " << fresh_allocations << " allocations per query" << std::endl;
+
+  if (context_picked != bucket_queue_picked || !all_answered) {
+    std::cout << "    the context picked " << context_picked << " gifts to the bucket queue's " << bucket_queue_picked << (all_answered ? "" : ", and an answer did NOT skip what it was asked to") << std::endl;
+    return 1;
+  }
+
+  std::cout << "    the context and the bucket queue both picked " << context_picked << " gifts, and every answer skipped what it was asked to" << std::endl;
+  return 0;
+}
+
+// the most memory the process has held at once so far, in MB
+double PeakResidentMB() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return static_cast<double>(usage.ru_maxrss) / 1024;
+}
+
+// times building a store of the instance file within the memory budget and covering it in passes over the store, with the peak memory of doing so,
+// then reads the instance into memory and covers it with GreedyCover, checking both leave the same elements uncovered
+int StoreBenchmark(int argc, char* argv[]) {
+  if (argc < 4) {
+    PrintUsage();
+    return -1;
+  }
+  const unsigned long memory_mb = argc > 4 ? std::strtoul(argv[4], NULL, 10) : 16;
+  if (memory_mb == 0) {
+    PrintUsage();
+    return -1;
+  }
+
+  std::ifstream sized_file(argv[2], std::ios::binary | std::ios::ate);
+  const double file_mb = static_cast<double>(sized_file.tellg()) / (1024 * 1024);
+  sized_file.close();
+
+  SetStoreBuildStats built;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  const std::string build_error = BuildSetStore(argv[2], SetCoverInstanceFormat::DETECT, argv[3], memory_mb << 20, &built);
+  const std::chrono::duration<double> build_elapsed = std::chrono::steady_clock::now() - start;
+  if (build_error != "") {
+    std::cerr << "could not build set store: " << build_error << std::endl;
+    return -1;
+  }
+
+  SetStore store;
+  const std::string open_error = store.Open(argv[3]);
+  if (open_error != "") {
+    std::cerr << "could not read set store: " << open_error << std::endl;
+    return -1;
+  }
+  GiftSolution streamed_solution;
+  start = std::chrono::steady_clock::now();
+  const StreamingGreedyResult streamed = StreamingGreedyCover(store, &streamed_solution);
+  const std::chrono::duration<double> stream_elapsed = std::chrono::steady_clock::now() - start;
+  if (streamed.error != "") {
+    std::cerr << "could not solve set store: " << streamed.error << std::endl;
+    return -1;
+  }
+  const double streamed_peak_mb = PeakResidentMB();
+
+  SetCoverInstance instance;
+  start = std::chrono::steady_clock::now();
+  const std::string read_error = ReadSetCoverInstance(argv[2], SetCoverInstanceFormat::DETECT, &instance);
+  GiftSolution solution;
+  GreedyCover(instance.incidences, NULL, &solution);
+  const std::chrono::duration<double> memory_elapsed = std::chrono::steady_clock::now() - start;
+  if (read_error != "") {
+    std::cerr << "could not read instance: " << read_error << std::endl;
+    return -1;
+  }
+
+  const double store_mb = static_cast<double>(built.store_bytes) / (1024 * 1024);
+  std::cout << "store: " << store.GiftCount() << " sets, " << store.VillagerCount() << " elements, " << store.IncidenceCount() << " incidences; " << file_mb << " MB of instance in " << store_mb << " MB of store" << std::endl;
+  std::cout << "    built in " << build_elapsed.count() * 1000 << " ms, " << built.passes << " passes over the instance with a " << memory_mb << " MB budget" << std::endl;
+  std::cout << "    streamed greedy cover of " << streamed_solution.GiftCount() << " sets in " << stream_elapsed.count() * 1000 << " ms: " << streamed.passes << " passes, ";
+  std::cout << static_cast<double>(streamed.bytes_scanned) / (1024 * 1024) << " MB scanned, " << static_cast<double>(streamed.resident_bytes) / 1024 << " KB of gains and covered flags" << std::endl;
+  std::cout << "    peak memory building and streaming: " << streamed_peak_mb << " MB" << std::endl;
+  std::cout << "    in-memory greedy cover of " << solution.GiftCount() << " sets in " << memory_elapsed.count() * 1000 << " ms, reading included; peak memory then " << PeakResidentMB() << " MB" << std::endl;
+
+  if (streamed_solution.uncovered_villager_ids != solution.uncovered_villager_ids) {
+    std::cout << "    the covers leave DIFFERENT elements uncovered" << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+// the generated data each engine is timed on: enough incidences for the greedy to take a while, and few enough villagers for the exact search
+const unsigned long CALIBRATION_GIFTS = 20000;
+const unsigned long CALIBRATION_VILLAGERS = 2000;
+const unsigned long CALIBRATION_VILLAGERS_PER_GIFT = 20;
+const unsigned long CALIBRATION_EXACT_GIFTS = 80;
+const unsigned long CALIBRATION_EXACT_VILLAGERS = 26;
+const unsigned long CALIBRATION_EXACT_VILLAGERS_PER_GIFT = 3;
+const unsigned long CALIBRATION_RUNS = 3;
+
+// measures how fast each engine runs here, for ChooseEngine: the sequential greedy's incidences per microsecond, what each round of the parallel greedy's
+// threads meeting adds beyond their share of that, and the exact search's covered-sets per microsecond; the fastest of a few runs is kept, and written to the file if one is given
+int CalibrateBenchmark(int argc, char* argv[]) {
+  const std::string calibration_path = argc > 2 ? argv[2] : "";
+  const unsigned long available_threads = std::max(argc > 3 ? std::strtoul(argv[3], NULL, 10) : std::thread::hardware_concurrency(), 1ul);
+  // the rounds cost the threads meeting, so there must be more than one, even on one core
+  const unsigned long thread_count = std::max(available_threads, 2ul);
+
+  const GeneratedInstance generated(GeneratedInstanceSize(CALIBRATION_GIFTS, CALIBRATION_VILLAGERS, CALIBRATION_VILLAGERS_PER_GIFT), false);
+  const IncidenceStore& incidences = generated.incidences;
+  std::cout << "instance: " << incidences.GiftCount() << " gifts, " << incidences.VillagerCount() << " villagers, " << incidences.IncidenceCount() << " incidences" << std::endl;
+
+  double sequential_us = 0;
+  double parallel_us = 0;
+  ParallelGreedyStats parallel_stats;
+  for (unsigned long run = 0; run < CALIBRATION_RUNS; ++run) {
+    GiftSolution solution;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    GreedyCover(incidences, NULL, &solution);
+    const double run_sequential_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    sequential_us = run == 0 ? run_sequential_us : std::min(sequential_us, run_sequential_us);
+
+    start = std::chrono::steady_clock::now();
+    parallel_stats = ParallelGreedyCover(incidences, static_cast<unsigned int>(thread_count), false, &solution);
+    const double run_parallel_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    parallel_us = run == 0 ? run_parallel_us : std::min(parallel_us, run_parallel_us);
+  }
+
+  EngineCalibration calibration;
+  calibration.greedy_incidences_per_us = static_cast<double>(incidences.IncidenceCount()) / std::max(sequential_us, 1.0);
+  // at least a little, since a round is never free
+  calibration.parallel_round_us = std::max((parallel_us - sequential_us / static_cast<double>(parallel_stats.thread_count)) / std::max(parallel_stats.rounds, 1u), 0.1);
+  std::cout << "    sequential greedy: " << sequential_us / 1000 << " ms, " << calibration.greedy_incidences_per_us << " incidences per us" << std::endl;
+  std::cout << "    parallel greedy on " << parallel_stats.thread_count << " threads: " << parallel_us / 1000 << " ms in " << parallel_stats.rounds << " rounds, ";
+  std::cout << calibration.parallel_round_us << " us per round beyond its share of the work" << std::endl;
+
+  const GeneratedInstance small_generated(GeneratedInstanceSize(CALIBRATION_EXACT_GIFTS, CALIBRATION_EXACT_VILLAGERS, CALIBRATION_EXACT_VILLAGERS_PER_GIFT), false);
+  const IncidenceStore& small_incidences = small_generated.incidences;
+  GiftSolution small_solution;
+  GreedyCover(small_incidences, NULL, &small_solution);
+  double exact_states_per_us = 0;
+  SmallCoverResult exact;
+  for (unsigned long run = 0; run < CALIBRATION_RUNS; ++run) {
+    exact = SolveSmallCover(small_incidences, small_solution.gift_ids, SMALL_COVER_MAX_STATES);
+    exact_states_per_us = std::max(exact_states_per_us, static_cast<double>(exact.states) / static_cast<double>(std::max(exact.elapsed_us, 1l)));
+  }
+  calibration.exact_states_per_us = exact_states_per_us;
+  std::cout << "    exact search over " << exact.villagers << " villagers: " << exact.states << " covered-sets in " << static_cast<double>(exact.elapsed_us) / 1000 << " ms, ";
+  std::cout << calibration.exact_states_per_us << " per us" << std::endl;
+
+  EngineOptions options;
+  options.available_threads = static_cast<unsigned int>(available_threads);
+  options.exact_allowed = true;
+  std::cout << "    this instance would be solved by the " << ChooseEngine(ProfileInstance(incidences), calibration, options).reason << std::endl;
+
+  if (calibration_path != "") {
+    const std::string write_error = WriteEngineCalibration(calibration_path, calibration);
+    if (write_error != "") {
+      std::cerr << "could not write calibration: " << write_error << std::endl;
+      return -1;
+    }
+    std::cout << "    written to " << calibration_path << ", for determine_gifts.out --engine-calibration" << std::endl;
+  }
+  return 0;
+}
+
+int RunCommand(int argc, char* argv[]) {
+  if (argc < 2) {
+    PrintUsage();
+    return -1;
+  }
+
+  const std::string command = argv[1];
+  if (command == PARSE_COMMAND) {
+    return ParseBenchmark(argc, argv);
+  }
+  else if (command == SOLVE_COMMAND) {
+    return SolveBenchmark(argc, argv);
+  }
+  else if (command == SWEEP_COMMAND) {
+    return SweepBenchmark(argc, argv);
+  }
+  else if (command == IMPROVE_COMMAND) {
+    return ImproveBenchmark(argc, argv);
+  }
+  else if (command == ANYTIME_COMMAND) {
+    return AnytimeBenchmark(argc, argv);
+  }
+  else if (command == INSTANCE_COMMAND) {
+    return InstanceBenchmark(argc, argv);
+  }
+  else if (command == BOUND_COMMAND) {
+    return BoundBenchmark(argc, argv);
+  }
+  else if (command == COVERAGE_COMMAND) {
+    return CoverageBenchmark(argc, argv);
+  }
+  else if (command == PARALLEL_GREEDY_COMMAND) {
+    return ParallelGreedyBenchmark(argc, argv);
+  }
+  else if (command == SNAPSHOT_COMMAND) {
+    return SnapshotBenchmark(argc, argv);
+  }
+  else if (command == QUERY_COMMAND) {
+    return QueryBenchmark(argc, argv);
+  }
+  else if (command == STORE_COMMAND) {
+    return StoreBenchmark(argc, argv);
+  }
+  else if (command == CALIBRATE_COMMAND) {
+    return CalibrateBenchmark(argc, argv);
+  }
+
+  PrintUsage();
+  return -1;
+}
+
+int main(int argc, char* argv[]) {
+  const int result = RunCommand(argc, argv);
+
+  // a 'make profiled' build ends with the hardware counters' totals for every region the command entered, as one line of JSON
+  if (PERF_COUNTERS_COMPILED_IN && result == 0) {
+    WritePerfReport(std::cout);
+  }
+  return result;
+}
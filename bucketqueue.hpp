@@ -12,36 +12,50 @@
 #include <map> // map
 #include <tuple> // pair
 #include <stdexcept> // invalid_argument, range_error, logic_error
+#include <functional> // less
 
-template <class T> // class T requirements: default constructor, copy constructor, operator=, operator<, std::ostream& operator<<(std::ostream& os, const T& t), unsigned int Size() const, void AddElements(const T& other), size_t RemoveElements(const T& other)
+#include "arena.hpp" // Arena, ArenaAllocator
+#include "perfcounters.hpp" // SVGSC_PERF_REGION
+
+// when given an arena, every bucket, and every set the queue stores or hands back, lives in it, so a solve makes (nearly) no heap calls;
+// the arena must outlive the queue and the sets taken from it
+template <class T> // class T requirements: default constructor, constructor T(Arena* arena) giving an empty set stored in the arena (or the heap if NULL), copy constructor keeping the other set's storage, operator= keeping this set's storage, operator<, std::ostream& operator<<(std::ostream& os, const T& t), unsigned int Size() const, void AddElements(const T& other), size_t RemoveElements(const T& other)
 class BucketQueue {
   public:
     // Constructors
     BucketQueue();
-    BucketQueue(const std::vector<T>& initial_sets);
+    BucketQueue(const std::vector<T>& initial_sets, Arena* arena = NULL);
 
     // Abstract type methods
-    void InsertSet(T set);
+    void InsertSet(const T& set);
     T GetHighestPrioritySet(); // if there is no highest-priority (no buckets left), the default value of T (T()) is returned
     void DeleteHighestPrioritySet();
-    void DecreasePriorityOfSet(T set, unsigned int old_priority, unsigned int new_priority);
+    void DecreasePriorityOfSet(const T& set, unsigned int old_priority, unsigned int new_priority);
 
     // Additional helpful methods
+    void CoverElements(const T& set); // counts the set's elements as covered without deleting a set, lowering the priority of every set sharing them
     const T GetCoveredElements() const;
 
   private:
+    typedef std::map<T, bool, std::less<T>, ArenaAllocator<std::pair<const T, bool>>> Bucket;
+
+    void InsertStoredSet(const T& set);
     std::pair<int, T> GetHighestPriorityPosition() const;
-    void DeleteSet(T set, unsigned int priority);
+    void DeleteSet(const T& set, unsigned int priority);
     void ResizeBuckets();
 
+    Arena* arena;
+
     // "indexed by priorities, whose cells contain collections of items with the same priority as each other" (wikipedia)
-    std::vector<std::map<T, bool>> buckets;
+    std::vector<Bucket, ArenaAllocator<Bucket>> buckets;
     T covered_set;
 };
 
 // default constructor takes in no elements
 template <class T>
-BucketQueue<T>::BucketQueue() {
+BucketQueue<T>::BucketQueue()
+  : arena(NULL)
+{
   this->buckets.resize(0);
   this->covered_set = T();
 }
@@ -49,22 +63,35 @@ BucketQueue<T>::BucketQueue() {
 // this constructor initializes the set by inserting elements for the user
 // O(number of initial sets), as long as T Size() method is O(1)
 template <class T>
-BucketQueue<T>::BucketQueue(const std::vector<T>& initial_sets) {
+BucketQueue<T>::BucketQueue(const std::vector<T>& initial_sets, Arena* queue_arena)
+  : arena(queue_arena),
+    buckets(ArenaAllocator<Bucket>(queue_arena)),
+    covered_set(queue_arena)
+{
+  SVGSC_PERF_REGION("bucket queue build");
   // fill in buckets with initial_sets
-  for (auto set:initial_sets) {
+  for (const auto& set:initial_sets) {
     this->InsertSet(set);
   }
+}
 
-  this->covered_set = T();
+// O(1), as long as T Size() method is O(1)
+template <class T>
+void BucketQueue<T>::InsertSet(const T& set) {
+  // copy the set into the queue's storage
+  T stored_set = T(this->arena);
+  stored_set = set;
+
+  this->InsertStoredSet(stored_set);
 }
 
 // O(1), as long as T Size() method is O(1)
 template <class T>
-void BucketQueue<T>::InsertSet(T set) {
+void BucketQueue<T>::InsertStoredSet(const T& set) {
   const unsigned int set_priority = set.Size();
   // resize buckets as needed
   if (set_priority >= this->buckets.size()) {
-    this->buckets.resize(set_priority+1);
+    this->buckets.resize(set_priority+1, Bucket(ArenaAllocator<std::pair<const T, bool>>(this->arena)));
   }
 
   // store set in bucket
@@ -91,12 +118,36 @@ void BucketQueue<T>::DeleteHighestPrioritySet() {
   // delete the highest-priority set
   this->DeleteSet(max_pos.second, max_pos.first);
 
-  // add the deleted set's elements to the so-far-covered-set
-  this->covered_set.AddElements(max_pos.second);
+  // add the deleted set's elements to the so-far-covered-set, and adjust priorities of remaining sets
+  this->CoverElements(max_pos.second);
+}
+
+// O(1)
+template <class T>
+void BucketQueue<T>::DecreasePriorityOfSet(const T& set, unsigned int old_priority, unsigned int new_priority) {
+  if (new_priority == old_priority) {
+    return;
+  }
+  else if (new_priority > old_priority) {
+    throw std::invalid_argument("bucket queue priority can only be decreased");
+  }
+
+  // remove from the buckets at its old priority (and resize buckets as necessary)
+  this->DeleteSet(set, old_priority);
+
+  // re-add it to buckets at its new priority
+  this->InsertStoredSet(set);
+}
+
+// amortized O(number of elements)
+template <class T>
+void BucketQueue<T>::CoverElements(const T& set) {
+  SVGSC_PERF_REGION("bucket queue update");
+  this->covered_set.AddElements(set);
 
-  // adjust priorities of remaining sets, based on what the now-deleted set covered
-  for (typename std::vector<std::map<T, bool>>::size_type bucket_i = 0; bucket_i < this->buckets.size(); ++bucket_i) {
-    typename std::map<T, bool>::iterator set_it = this->buckets[bucket_i].begin();
+  // adjust priorities of remaining sets, based on what is now covered
+  for (typename std::vector<Bucket>::size_type bucket_i = 0; bucket_i < this->buckets.size(); ++bucket_i) {
+    typename Bucket::iterator set_it = this->buckets[bucket_i].begin();
     while (set_it != this->buckets[bucket_i].end()) {
       T set_in_map = set_it->first;
       T updated_set = set_in_map;
@@ -107,7 +158,7 @@ void BucketQueue<T>::DeleteHighestPrioritySet() {
       // check how to handle bucket iteration/the set
       if (elems_removed > 0) {
         // update the key stored in the map, so that DecreasePriorityOfSet will find the updated element
-        typename std::map<T, bool>::size_type elems_deleted = this->buckets[bucket_i].erase(set_in_map);
+        typename Bucket::size_type elems_deleted = this->buckets[bucket_i].erase(set_in_map);
         if (elems_deleted != 1) {
           throw std::logic_error("original set with covered elements not found in bucket");
         }
@@ -128,23 +179,6 @@ void BucketQueue<T>::DeleteHighestPrioritySet() {
   }
 }
 
-// O(1)
-template <class T>
-void BucketQueue<T>::DecreasePriorityOfSet(T set, unsigned int old_priority, unsigned int new_priority) {
-  if (new_priority == old_priority) {
-    return;
-  }
-  else if (new_priority > old_priority) {
-    throw std::invalid_argument("bucket queue priority can only be decreased");
-  }
-
-  // remove from the buckets at its old priority (and resize buckets as necessary)
-  this->DeleteSet(set, old_priority);
-
-  // re-add it to buckets at its new priority
-  this->InsertSet(set);
-}
-
 // O(1)
 template <class T>
 const T BucketQueue<T>::GetCoveredElements() const {
@@ -156,7 +190,7 @@ const T BucketQueue<T>::GetCoveredElements() const {
 template <class T>
 std::pair<int, T> BucketQueue<T>::GetHighestPriorityPosition() const {
   int max_i = static_cast<int>(this->buckets.size())-1;
-  T set = T();
+  T set = T(this->arena);
 
   if (max_i >= 0) {
     set = this->buckets[max_i].begin()->first;
@@ -167,13 +201,13 @@ std::pair<int, T> BucketQueue<T>::GetHighestPriorityPosition() const {
 
 // O(number of priorities)
 template <class T>
-void BucketQueue<T>::DeleteSet(T set, unsigned int priority) {
+void BucketQueue<T>::DeleteSet(const T& set, unsigned int priority) {
   if (priority >= this->buckets.size()) {
     throw std::range_error("priority set-to-delete is too large");
   }
 
   // delete set
-  typename std::map<T, bool>::size_type elems_deleted = this->buckets[priority].erase(set);
+  typename Bucket::size_type elems_deleted = this->buckets[priority].erase(set);
   if (elems_deleted != 1) {
     throw std::invalid_argument("set-to-delete not found at priority");
   }
@@ -186,13 +220,14 @@ void BucketQueue<T>::DeleteSet(T set, unsigned int priority) {
 // O(number of priorities)
 template <class T>
 void BucketQueue<T>::ResizeBuckets() {
-  // resize buckets vector to exactly fit remaining highest priority
-  for (typename std::vector<std::map<T, bool>>::size_type bucket_i = this->buckets.size()-1; bucket_i >= 0; --bucket_i) {
-    if (this->buckets[bucket_i].size() > 0) {
-      this->buckets.resize(bucket_i+1);
+  // resize buckets vector to exactly fit remaining highest priority, or to nothing once every set is deleted
+  for (typename std::vector<Bucket>::size_type bucket_count = this->buckets.size(); bucket_count > 0; --bucket_count) {
+    if (this->buckets[bucket_count-1].size() > 0) {
+      this->buckets.resize(bucket_count);
       return;
     }
   }
+  this->buckets.resize(0);
 }
 
 #endif // SVGSC_BUCKET_QUEUE_H
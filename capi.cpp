@@ -0,0 +1,217 @@
+/*
+ * Description: implementation to the C interface, over the in-process solver; no exception gets past it
+ * Author: Laura Galbraith
+*/
+
+#include "svgsc.h" // self-include header
+
+#include <string> // string
+#include <vector> // vector
+#include <memory> // unique_ptr
+#include <cstring> // strncpy
+#include <new> // nothrow
+#include <utility> // move
+#include <functional> // function
+#include <exception> // exception
+
+#include "valleyfacts.hpp" // GiftsByVillager, WikiLoadOptions, WikiSource, Gift, Villager
+#include "dataset.hpp" // ReadWikiDataset, WikiDatasetResult
+#include "embedded.hpp" // GetEmbeddedDataset
+#include "instance.hpp" // SetCoverInstance, SetCoverInstanceFormat, ReadSetCoverInstance
+#include "nametable.hpp" // NameTable
+#include "solver.hpp" // SolverContext, SolverQuery, IDSpan
+#include "output.hpp" // GiftSolution
+
+struct svgsc_dataset {
+  explicit svgsc_dataset(GiftsByVillager* loaded)
+    : data(std::move(*loaded))
+  {}
+
+  const GiftsByVillager data;
+};
+
+struct svgsc_context {
+  SolverContext solver;
+  std::string error;
+};
+
+// copies as much of the message as fits, always ending it
+static void WriteError(const std::string& message, char* error, size_t error_size) {
+  if (error == NULL || error_size <= 0) {
+    return;
+  }
+  std::strncpy(error, message.c_str(), error_size - 1);
+  error[error_size - 1] = '\0';
+}
+
+// runs the load, returning NULL with the reason if it gives one or throws
+static svgsc_dataset* LoadDataset(const std::function<std::string(std::unique_ptr<GiftsByVillager>* loaded)>& load, char* error, size_t error_size) {
+  try {
+    std::unique_ptr<GiftsByVillager> loaded;
+    const std::string load_error = load(&loaded);
+    if (load_error != "") {
+      WriteError(load_error, error, error_size);
+      return NULL;
+    }
+    return new svgsc_dataset(loaded.get());
+  }
+  catch (const std::exception& e) {
+    WriteError(e.what(), error, error_size);
+    return NULL;
+  }
+}
+
+static const GiftSolution& TierSolution(const svgsc_context* context, int tier) {
+  return tier == SVGSC_LIKED ? context->solver.LikedSolution() : context->solver.LovedSolution();
+}
+
+static svgsc_span Span(const std::vector<unsigned int>& ids, size_t begin, size_t end) {
+  svgsc_span span;
+  span.ids = ids.data() + begin;
+  span.count = end - begin;
+  return span;
+}
+
+static IDSpan QuerySpan(const svgsc_span& span) {
+  return IDSpan(span.ids, span.ids != NULL ? span.count : 0);
+}
+
+extern "C" {
+
+void svgsc_query_init(svgsc_query* query) {
+  const SolverQuery defaults;
+  query->skip_villager_ids.ids = NULL;
+  query->skip_villager_ids.count = 0;
+  query->missing_gift_ids.ids = NULL;
+  query->missing_gift_ids.count = 0;
+  query->liked_tier = defaults.liked_tier ? 1 : 0;
+  query->local_search_budget_us = defaults.local_search_budget_us;
+}
+
+svgsc_dataset* svgsc_dataset_load_stored(const char* dataset_path, int liked_gifts, char* error, size_t error_size) {
+  return LoadDataset([dataset_path, liked_gifts](std::unique_ptr<GiftsByVillager>* loaded) {
+    const WikiDatasetResult stored = ReadWikiDataset(dataset_path);
+    if (stored.error != "") {
+      return "could not read dataset: " + stored.error;
+    }
+
+    WikiLoadOptions options;
+    options.source = WikiSource::STORED_DATASET;
+    options.liked_gifts = liked_gifts != 0;
+    loaded->reset(new GiftsByVillager(std::vector<Villager>(), std::vector<Gift>(), options, stored.data));
+    return std::string();
+  }, error, error_size);
+}
+
+svgsc_dataset* svgsc_dataset_load_wiki(const char* api_url, int liked_gifts, char* error, size_t error_size) {
+  return LoadDataset([api_url, liked_gifts](std::unique_ptr<GiftsByVillager>* loaded) {
+    WikiLoadOptions options;
+    options.source = WikiSource::WIKITEXT;
+    options.liked_gifts = liked_gifts != 0;
+    if (api_url != NULL) {
+      options.api_url = api_url;
+    }
+    loaded->reset(new GiftsByVillager(std::vector<Villager>(), std::vector<Gift>(), options));
+    return std::string();
+  }, error, error_size);
+}
+
+svgsc_dataset* svgsc_dataset_load_embedded(char* error, size_t error_size) {
+  return LoadDataset([](std::unique_ptr<GiftsByVillager>* loaded) {
+    const EmbeddedDataset* embedded = GetEmbeddedDataset();
+    if (embedded == NULL) {
+      return std::string("no dataset is embedded in this build; see 'make embedded'");
+    }
+    loaded->reset(new GiftsByVillager(std::vector<Villager>(), std::vector<Gift>(), *embedded));
+    return std::string();
+  }, error, error_size);
+}
+
+svgsc_dataset* svgsc_dataset_load_instance(const char* instance_path, char* error, size_t error_size) {
+  return LoadDataset([instance_path](std::unique_ptr<GiftsByVillager>* loaded) {
+    SetCoverInstance instance;
+    const std::string read_error = ReadSetCoverInstance(instance_path, SetCoverInstanceFormat::DETECT, &instance);
+    if (read_error != "") {
+      return "could not read instance: " + read_error;
+    }
+    loaded->reset(new GiftsByVillager(&instance));
+    return std::string();
+  }, error, error_size);
+}
+
+void svgsc_dataset_free(svgsc_dataset* dataset) {
+  delete dataset;
+}
+
+unsigned int svgsc_gift_count(const svgsc_dataset* dataset) {
+  return static_cast<unsigned int>(dataset->data.GetIncidences().GiftCount());
+}
+
+unsigned int svgsc_villager_count(const svgsc_dataset* dataset) {
+  return static_cast<unsigned int>(dataset->data.GetIncidences().VillagerCount());
+}
+
+unsigned int svgsc_gift_id(const svgsc_dataset* dataset, const char* gift_name) {
+  return dataset->data.GetIncidences().GetGiftNames().Find(gift_name);
+}
+
+unsigned int svgsc_villager_id(const svgsc_dataset* dataset, const char* villager_name) {
+  return dataset->data.GetIncidences().GetVillagerNames().Find(villager_name);
+}
+
+const char* svgsc_gift_name(const svgsc_dataset* dataset, unsigned int gift_id) {
+  const NameTable& names = dataset->data.GetIncidences().GetGiftNames();
+  return gift_id < names.Size() ? names.Name(gift_id).c_str() : NULL;
+}
+
+const char* svgsc_villager_name(const svgsc_dataset* dataset, unsigned int villager_id) {
+  const NameTable& names = dataset->data.GetIncidences().GetVillagerNames();
+  return villager_id < names.Size() ? names.Name(villager_id).c_str() : NULL;
+}
+
+svgsc_context* svgsc_context_create(void) {
+  return new (std::nothrow) svgsc_context();
+}
+
+void svgsc_context_free(svgsc_context* context) {
+  delete context;
+}
+
+int svgsc_solve(svgsc_context* context, const svgsc_dataset* dataset, const svgsc_query* query) {
+  try {
+    SolverQuery solver_query;
+    solver_query.skip_villager_ids = QuerySpan(query->skip_villager_ids);
+    solver_query.missing_gift_ids = QuerySpan(query->missing_gift_ids);
+    solver_query.liked_tier = query->liked_tier != 0;
+    solver_query.local_search_budget_us = query->local_search_budget_us;
+    context->error = context->solver.Solve(dataset->data, solver_query);
+  }
+  catch (const std::exception& e) {
+    context->error = e.what();
+  }
+  return context->error == "" ? 0 : -1;
+}
+
+const char* svgsc_context_error(const svgsc_context* context) {
+  return context->error.c_str();
+}
+
+svgsc_span svgsc_result_gifts(const svgsc_context* context, int tier) {
+  const GiftSolution& solution = TierSolution(context, tier);
+  return Span(solution.gift_ids, 0, solution.gift_ids.size());
+}
+
+svgsc_span svgsc_result_villagers(const svgsc_context* context, int tier, size_t gift_i) {
+  const GiftSolution& solution = TierSolution(context, tier);
+  if (gift_i >= solution.GiftCount()) {
+    return Span(solution.villager_ids, 0, 0);
+  }
+  return Span(solution.villager_ids, solution.VillagersBegin(gift_i), solution.VillagersEnd(gift_i));
+}
+
+svgsc_span svgsc_result_uncovered(const svgsc_context* context, int tier) {
+  const GiftSolution& solution = TierSolution(context, tier);
+  return Span(solution.uncovered_villager_ids, 0, solution.uncovered_villager_ids.size());
+}
+
+}
@@ -0,0 +1,185 @@
+/*
+ * Description: program to check the wiki loaders against wiki responses saved in the fixtures directory, without reaching the wiki
+ * Author: Laura Galbraith
+*/
+
+#include <iostream> // cout, endl
+#include <fstream> // ifstream
+#include <string> // string, getline
+#include <vector> // vector
+#include <utility> // pair
+#include <functional> // function
+#include <stdexcept> // runtime_error
+#include <cstdlib> // realpath, free
+
+#include "valleyfacts.hpp" // GiftsByVillager, GiftForVillagers, WikiLoadOptions, WikiSource
+#include "xmlparse.hpp" // XMLParseBackend
+
+// Constants for input format
+const std::string DEFAULT_FIXTURES_DIRECTORY = "fixtures";
+
+// Constants for the fixtures, relative to their directory
+// one saved API response holds every page the loader asks for, so it answers each of the loader's queries, which find their pages in it by title
+const std::string WIKI_API_PAGES_FIXTURE = "wiki_api/pages.json";
+// the same response with one villager's page missing, as the API reports a page that does not exist
+const std::string WIKI_API_MISSING_PAGE_FIXTURE = "wiki_api/missing_page.json";
+// the same pages as rendered, each file named by its title, as the loader appends it to the page URL
+const std::string WIKI_HTML_DIRECTORY = "wiki_html/";
+// what the saved pages load as, whether as wikitext or rendered, one gift set per line; lines starting with '#' are comments
+const std::string EXPECTED_GIFTS_FIXTURE = "expected_gifts.txt";
+
+void PrintUsage() {
+  std::cout << std::endl;
+  std::cout << "Usage: <program> [fixtures directory]" << std::endl;
+  std::cout << "    ex. " << DEFAULT_FIXTURES_DIRECTORY << std::endl;
+  std::cout << std::endl;
+}
+
+// every loved gift set, then every liked one, one line each; both tiers share one list of gifts, so a gift nobody in the tier loves (or likes) is left out
+// ex. "loved Amethyst: Abigail"
+std::vector<std::string> DescribeGiftSets(const GiftsByVillager& gifts_and_villagers) {
+  std::vector<std::string> lines;
+  const std::vector<std::pair<std::string, std::vector<GiftForVillagers>>> tiers = {
+    std::make_pair("loved", gifts_and_villagers.GetGiftSets()),
+    std::make_pair("liked", gifts_and_villagers.GetLikedGiftSets())
+  };
+  for (const auto& tier:tiers) {
+    for (const auto& gift_set:tier.second) {
+      if (gift_set.Size() == 0) {
+        continue;
+      }
+
+      std::string line = tier.first + " " + gift_set.GetGift() + ":";
+      std::string separator = " ";
+      for (const auto& villager:gift_set.GetVillagers()) {
+        line += separator + villager;
+        separator = ", ";
+      }
+      lines.push_back(line);
+    }
+  }
+  return lines;
+}
+
+// returns an error, or empty if successful
+std::string ReadExpectedLines(const std::string& path, std::vector<std::string>* lines) {
+  std::ifstream file(path);
+  if (!file) {
+    return "could not open " + path;
+  }
+
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line != "" && line[0] != '#') {
+      lines->push_back(line);
+    }
+  }
+  return "";
+}
+
+// returns the first line that differs, or empty if none do
+std::string CompareLines(const std::vector<std::string>& expected, const std::vector<std::string>& actual) {
+  for (size_t line_i = 0; line_i < expected.size() || line_i < actual.size(); ++line_i) {
+    const std::string expected_line = line_i < expected.size() ? expected[line_i] : "(nothing)";
+    const std::string actual_line = line_i < actual.size() ? actual[line_i] : "(nothing)";
+    if (expected_line != actual_line) {
+      return "line " + std::to_string(line_i + 1) + " is \"" + actual_line + "\", expected \"" + expected_line + "\"";
+    }
+  }
+  return "";
+}
+
+WikiLoadOptions WikitextLoadOptions(const std::string& response_url) {
+  WikiLoadOptions options;
+  options.source = WikiSource::WIKITEXT;
+  options.api_url = response_url;
+  options.liked_gifts = true;
+  return options;
+}
+
+WikiLoadOptions RenderedHTMLLoadOptions(const std::string& page_url, XMLParseBackend parser) {
+  WikiLoadOptions options;
+  options.source = WikiSource::RENDERED_HTML;
+  options.page_url = page_url;
+  options.html_parser = parser;
+  options.liked_gifts = true;
+  return options;
+}
+
+// each check returns an error, or empty if it passed
+
+std::string CheckWikitextLoad(const std::string& fixtures_url, const std::vector<std::string>& expected) {
+  const GiftsByVillager gifts_and_villagers = GiftsByVillager(std::vector<Villager>(), std::vector<Gift>(), WikitextLoadOptions(fixtures_url + WIKI_API_PAGES_FIXTURE));
+  return CompareLines(expected, DescribeGiftSets(gifts_and_villagers));
+}
+
+std::string CheckWikitextMissingPage(const std::string& fixtures_url) {
+  try {
+    GiftsByVillager(std::vector<Villager>(), std::vector<Gift>(), WikitextLoadOptions(fixtures_url + WIKI_API_MISSING_PAGE_FIXTURE));
+  }
+  catch (const std::runtime_error& e) {
+    const std::string error = e.what();
+    return error.find("page Krobus is missing") != std::string::npos ? "" : "failed for another reason: " + error;
+  }
+  return "loaded although a page is missing";
+}
+
+// with XMLParseBackend::VERIFY, any page where libxml2 and the scanner extract different names fails the load
+std::string CheckRenderedHTMLLoad(const std::string& fixtures_url, XMLParseBackend parser, const std::vector<std::string>& expected) {
+  const GiftsByVillager gifts_and_villagers = GiftsByVillager(std::vector<Villager>(), std::vector<Gift>(), RenderedHTMLLoadOptions(fixtures_url + WIKI_HTML_DIRECTORY, parser));
+  return CompareLines(expected, DescribeGiftSets(gifts_and_villagers));
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 2) {
+    PrintUsage();
+    return -1;
+  }
+
+  // the loader fetches the saved responses through libcurl, which needs an absolute file URL
+  char* fixtures_path = realpath(argc > 1 ? argv[1] : DEFAULT_FIXTURES_DIRECTORY.c_str(), NULL);
+  if (fixtures_path == NULL) {
+    std::cerr << "could not find the fixtures directory" << std::endl;
+    return -1;
+  }
+  const std::string fixtures_directory = std::string(fixtures_path) + "/";
+  const std::string fixtures_url = "file://" + fixtures_directory;
+  free(fixtures_path);
+
+  std::vector<std::string> expected_gifts;
+  const std::string read_error = ReadExpectedLines(fixtures_directory + EXPECTED_GIFTS_FIXTURE, &expected_gifts);
+  if (read_error != "") {
+    std::cerr << read_error << std::endl;
+    return -1;
+  }
+
+  const std::vector<std::pair<std::string, std::function<std::string()>>> checks = {
+    std::make_pair("wikitext load", [&fixtures_url, &expected_gifts]() { return CheckWikitextLoad(fixtures_url, expected_gifts); }),
+    std::make_pair("wikitext load with a missing page", [&fixtures_url]() { return CheckWikitextMissingPage(fixtures_url); }),
+    std::make_pair("rendered page load with libxml2", [&fixtures_url, &expected_gifts]() { return CheckRenderedHTMLLoad(fixtures_url, XMLParseBackend::LIBXML2, expected_gifts); }),
+    std::make_pair("rendered page load with the scanner", [&fixtures_url, &expected_gifts]() { return CheckRenderedHTMLLoad(fixtures_url, XMLParseBackend::SCANNER, expected_gifts); }),
+    std::make_pair("rendered page load with both parsers compared page by page", [&fixtures_url, &expected_gifts]() { return CheckRenderedHTMLLoad(fixtures_url, XMLParseBackend::VERIFY, expected_gifts); })
+  };
+
+  unsigned int failures = 0;
+  for (const auto& check:checks) {
+    std::string error;
+    try {
+      error = check.second();
+    }
+    catch (const std::exception& e) {
+      error = e.what();
+    }
+
+    if (error == "") {
+      std::cout << "ok      " << check.first << std::endl;
+    }
+    else {
+      std::cout << "FAILED  " << check.first << ": " << error << std::endl;
+      ++failures;
+    }
+  }
+
+  std::cout << checks.size() - failures << " of " << checks.size() << " checks passed" << std::endl;
+  return failures > 0 ? -1 : 0;
+}
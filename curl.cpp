@@ -13,18 +13,115 @@
 #include <iostream> // cout, endl
 #include <sstream> // stringstream
 #include <stdexcept> // runtime_error
+#include <mutex> // mutex, lock_guard, unique_lock
+#include <vector> // vector
+#include <map> // map
+#include <set> // set
+#include <deque> // deque
+#include <utility> // move, make_pair
+#include <algorithm> // nth_element, min, max
+#include <chrono> // steady_clock, milliseconds
+#include <thread> // thread, this_thread::sleep_for
+#include <condition_variable> // condition_variable
+#include <memory> // unique_ptr
+#include <random> // random_device, uniform_int_distribution
 #include <stdio.h> // used with CURLOPT_WRITEDATA
-#include <curl/curl.h> // CURL, CURLcode, CURL* constants, related methods
+#include <curl/curl.h> // CURL, CURLSH, CURLcode, CURL* constants, related methods
 
-CurlResult::CurlResult(const std::string& result_data, const std::string& result_error)
-  : data(result_data), error(result_error)
+CurlResult::CurlResult(const std::string& result_data, const std::string& result_error, size_t result_wire_bytes)
+  : data(result_data), error(result_error), wire_bytes(result_wire_bytes)
 {}
 
-Curl::Curl() {
+CurlTransferStats::CurlTransferStats()
+  : transfers(0), wire_bytes(0), decoded_bytes(0)
+{}
+
+void CurlTransferStats::Add(const CurlTransferStats& other) {
+  this->transfers += other.transfers;
+  this->wire_bytes += other.wire_bytes;
+  this->decoded_bytes += other.decoded_bytes;
+}
+
+CurlRequestPolicy::CurlRequestPolicy()
+  : connect_timeout_ms(10000), total_timeout_ms(60000), max_attempts(3), backoff_base_ms(250), backoff_max_ms(4000), hedge_percentile(0)
+{}
+
+CurlURLOutcome::CurlURLOutcome(const std::string& outcome_url)
+  : url(outcome_url), attempts(0), hedged(false), hedge_won(false), elapsed_ms(0)
+{}
+
+// hedging waits for this many fetches before trusting their percentile
+const size_t HEDGE_MIN_SAMPLES = 4;
+
+// the hedging percentile is taken over at most this many of the latest fetches
+const size_t LATENCY_HISTORY_MAX = 256;
+
+// longest wait between checks on a transfer in progress, so a hedge goes out close to its due time
+const long TRANSFER_POLL_MS = 50;
+
+long MillisecondsSince(const std::chrono::steady_clock::time_point& start) {
+  return static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+// failures that another try may not hit: https://curl.se/libcurl/c/libcurl-errors.html
+bool RetryableCurlCode(CURLcode code) {
+  return code == CURLE_OPERATION_TIMEDOUT || code == CURLE_COULDNT_CONNECT || code == CURLE_COULDNT_RESOLVE_HOST ||
+         code == CURLE_SEND_ERROR || code == CURLE_RECV_ERROR || code == CURLE_GOT_NOTHING || code == CURLE_PARTIAL_FILE ||
+         code == CURLE_HTTP2 || code == CURLE_HTTP2_STREAM || code == CURLE_SSL_CONNECT_ERROR;
+}
+
+bool RetryableHTTPStatus(long status) {
+  return status >= 500 || status == 429;
+}
+
+// latencies of successful attempts by every Curl object in this process, as the connection cache is shared, since most Curl objects make only a few calls
+// (the wikitext load makes two) and could never gather enough on their own to hedge
+class LatencyHistory {
+  public:
+    void Add(long latency_ms) {
+      std::lock_guard<std::mutex> guard(this->lock);
+      this->latencies_ms.push_back(latency_ms);
+      if (this->latencies_ms.size() > LATENCY_HISTORY_MAX) {
+        this->latencies_ms.pop_front();
+      }
+    }
+
+    // negative until there are HEDGE_MIN_SAMPLES latencies
+    // O(LATENCY_HISTORY_MAX)
+    long PercentileMs(unsigned int percentile) const {
+      std::vector<long> sorted_ms;
+      {
+        std::lock_guard<std::mutex> guard(this->lock);
+        if (this->latencies_ms.size() < HEDGE_MIN_SAMPLES) {
+          return -1;
+        }
+        sorted_ms.assign(this->latencies_ms.begin(), this->latencies_ms.end());
+      }
+
+      std::vector<long>::iterator percentile_it = sorted_ms.begin() + static_cast<long>((sorted_ms.size()-1) * percentile / 100);
+      std::nth_element(sorted_ms.begin(), percentile_it, sorted_ms.end());
+      return *percentile_it;
+    }
+
+  private:
+    std::deque<long> latencies_ms; // oldest first
+    mutable std::mutex lock;
+};
+
+LatencyHistory& SharedLatencies() {
+  static LatencyHistory history;
+  return history;
+}
+
+Curl::Curl()
+  : backoff_jitter(std::random_device()())
+{
   this->curl_impl = curl_easy_init();
   if (this->curl_impl == NULL) {
     throw std::runtime_error("curl handle failed to initialize");
   }
+
+  this->SetPersistentOptions();
 }
 
 Curl::Curl(const Curl& other) {
@@ -39,9 +136,51 @@ Curl& Curl::operator=(const Curl& other) {
   return *this;
 }
 
+void Curl::SetRequestPolicy(const CurlRequestPolicy& policy) {
+  this->request_policy = policy;
+  curl_easy_setopt(this->curl_impl, CURLOPT_CONNECTTIMEOUT_MS, this->request_policy.connect_timeout_ms);
+  curl_easy_setopt(this->curl_impl, CURLOPT_TIMEOUT_MS, this->request_policy.total_timeout_ms);
+}
+
 // it's possible to make multiple calls with the same curl object; it keeps the connection open in the meantime
-// TODO consider using CURLOPT_ERRORBUFFER if I get errors that I need explained; see https://curl.se/libcurl/c/htmltitle.html
+// a transient failure is retried after a jittered, exponentially-growing wait, so a briefly-struggling wiki is not hit by every retry at once
 CurlResult Curl::CallURL(const char* url) {
+  CurlURLOutcome outcome = CurlURLOutcome(url);
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  CurlResult result = CurlResult("", "");
+  const unsigned int max_attempts = std::max(this->request_policy.max_attempts, 1u);
+  for (unsigned int attempt = 1; attempt <= max_attempts; ++attempt) {
+    if (attempt > 1) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(this->BackoffDelayMs(attempt-1)));
+    }
+
+    bool retryable = false;
+    result = this->PerformAttempt(url, &retryable, &outcome);
+    outcome.attempts = attempt;
+    if (result.error == "" || !retryable) {
+      break;
+    }
+  }
+
+  if (result.error != "" && outcome.attempts > 1) {
+    std::stringstream attempts_error;
+    attempts_error << result.error << " (after " << outcome.attempts << " attempts)";
+    result.error = attempts_error.str();
+  }
+
+  outcome.elapsed_ms = MillisecondsSince(start);
+  outcome.error = result.error;
+  this->url_outcomes.push_back(outcome);
+
+  return result;
+}
+
+// One try at the URL; when hedging, a duplicate request is raced against it once it runs past the latency percentile, and the first good response wins
+// TODO consider using CURLOPT_ERRORBUFFER if I get errors that I need explained; see https://curl.se/libcurl/c/htmltitle.html
+CurlResult Curl::PerformAttempt(const char* url, bool* retryable, CurlURLOutcome* outcome) {
+  *retryable = false;
+
   CURLcode code = curl_easy_setopt(this->curl_impl, CURLOPT_URL, url);
   if (code != CURLE_OK) {
     std::stringstream error_code;
@@ -64,14 +203,167 @@ CurlResult Curl::CallURL(const char* url) {
     return CurlResult("", error_code.str());
   }
 
-  code = curl_easy_perform(this->curl_impl);
-  if (code != CURLE_OK) {
+  // the transfers run on a multi handle, so a hedge can run alongside: https://curl.se/libcurl/c/libcurl-multi.html
+  CURLM* multi = curl_multi_init();
+  if (multi == NULL) {
+    return CurlResult("", "curl multi handle failed to initialize");
+  }
+  curl_multi_add_handle(multi, this->curl_impl);
+
+  const long hedge_delay_ms = this->HedgeDelayMs();
+  CURL* hedge = NULL;
+  std::string hedge_data;
+
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  CURL* winner = NULL;
+  unsigned int transfers_left = 1;
+  CURLcode failed_code = CURLE_OK;
+  long failed_status = 0;
+  CURLMcode multi_code = CURLM_OK;
+  while (winner == NULL && transfers_left > 0) {
+    int running = 0;
+    multi_code = curl_multi_perform(multi, &running);
+    if (multi_code != CURLM_OK) {
+      break;
+    }
+
+    int queued = 0;
+    CURLMsg* message = NULL;
+    while ((message = curl_multi_info_read(multi, &queued)) != NULL) {
+      if (message->msg != CURLMSG_DONE) {
+        continue;
+      }
+      --transfers_left;
+
+      long status = 0;
+      curl_easy_getinfo(message->easy_handle, CURLINFO_RESPONSE_CODE, &status);
+      if (message->data.result == CURLE_OK && status < 400) {
+        if (winner == NULL) {
+          winner = message->easy_handle;
+        }
+      }
+      else {
+        failed_code = message->data.result;
+        failed_status = status;
+      }
+    }
+
+    if (winner != NULL || transfers_left <= 0) {
+      break;
+    }
+
+    // send the hedge once this attempt is slower than most
+    long poll_ms = TRANSFER_POLL_MS;
+    if (hedge == NULL && hedge_delay_ms >= 0) {
+      const long elapsed_ms = MillisecondsSince(start);
+      if (elapsed_ms >= hedge_delay_ms) {
+        hedge = curl_easy_duphandle(this->curl_impl);
+        if (hedge != NULL) {
+          // a duplicate stuck behind the slow transfer's connection would not help, so it does not wait to multiplex
+          curl_easy_setopt(hedge, CURLOPT_WRITEDATA, &hedge_data);
+          curl_easy_setopt(hedge, CURLOPT_PIPEWAIT, 0L);
+          curl_multi_add_handle(multi, hedge);
+          ++transfers_left;
+          outcome->hedged = true;
+        }
+      }
+      else {
+        poll_ms = std::min(poll_ms, hedge_delay_ms - elapsed_ms);
+      }
+    }
+
+    multi_code = curl_multi_poll(multi, NULL, 0, static_cast<int>(poll_ms), NULL);
+    if (multi_code != CURLM_OK) {
+      break;
+    }
+  }
+
+  // every transfer counts towards the bytes on the wire, including an abandoned one
+  this->stats.wire_bytes += this->WireBytes(this->curl_impl);
+  curl_multi_remove_handle(multi, this->curl_impl);
+  if (hedge != NULL) {
+    this->stats.wire_bytes += this->WireBytes(hedge);
+    curl_multi_remove_handle(multi, hedge);
+  }
+  curl_multi_cleanup(multi);
+
+  if (winner == NULL) {
+    if (hedge != NULL) {
+      curl_easy_cleanup(hedge);
+    }
+
     std::stringstream error_code;
-    error_code << "got error code while calling URL (see https://curl.se/libcurl/c/libcurl-errors.html): " << code;
+    if (multi_code != CURLM_OK) {
+      error_code << "got error code while running transfers (see https://curl.se/libcurl/c/libcurl-errors.html): " << multi_code;
+    }
+    else if (failed_code != CURLE_OK) {
+      *retryable = RetryableCurlCode(failed_code);
+      error_code << "got error code while calling URL (see https://curl.se/libcurl/c/libcurl-errors.html): " << failed_code;
+    }
+    else {
+      *retryable = RetryableHTTPStatus(failed_status);
+      error_code << "got HTTP status " << failed_status << " while calling URL";
+    }
     return CurlResult("", error_code.str());
   }
 
-  return CurlResult(data, "");
+  SharedLatencies().Add(MillisecondsSince(start));
+
+  const size_t wire_bytes = this->WireBytes(winner);
+  if (winner == hedge) {
+    outcome->hedge_won = true;
+    data.swap(hedge_data);
+  }
+  if (hedge != NULL) {
+    curl_easy_cleanup(hedge);
+  }
+
+  ++this->stats.transfers;
+  this->stats.decoded_bytes += data.size();
+
+  return CurlResult(data, "", wire_bytes);
+}
+
+// how long an attempt may run before it is hedged; negative if it should not be
+// O(LATENCY_HISTORY_MAX)
+long Curl::HedgeDelayMs() const {
+  const unsigned int percentile = this->request_policy.hedge_percentile;
+  if (percentile <= 0 || percentile >= 100) {
+    return -1;
+  }
+  return SharedLatencies().PercentileMs(percentile);
+}
+
+// "full jitter": https://aws.amazon.com/blogs/architecture/exponential-backoff-and-jitter/
+long Curl::BackoffDelayMs(unsigned int retry) {
+  long ceiling_ms = this->request_policy.backoff_base_ms;
+  for (unsigned int retry_i = 1; retry_i < retry && ceiling_ms < this->request_policy.backoff_max_ms; ++retry_i) {
+    ceiling_ms *= 2;
+  }
+  ceiling_ms = std::min(ceiling_ms, this->request_policy.backoff_max_ms);
+  if (ceiling_ms <= 0) {
+    return 0;
+  }
+
+  std::uniform_int_distribution<long> delay_ms(0, ceiling_ms);
+  return delay_ms(this->backoff_jitter);
+}
+
+// https://curl.se/libcurl/c/CURLINFO_SIZE_DOWNLOAD_T.html counts the body as received, i.e. before content decoding
+size_t Curl::WireBytes(CURL* handle) const {
+  curl_off_t body_bytes = 0;
+  long header_bytes = 0;
+  curl_easy_getinfo(handle, CURLINFO_SIZE_DOWNLOAD_T, &body_bytes);
+  curl_easy_getinfo(handle, CURLINFO_HEADER_SIZE, &header_bytes);
+  return static_cast<size_t>(body_bytes) + static_cast<size_t>(header_bytes);
+}
+
+const CurlTransferStats Curl::GetTransferStats() const {
+  return this->stats;
+}
+
+const std::vector<CurlURLOutcome> Curl::GetURLOutcomes() const {
+  return this->url_outcomes;
 }
 
 Curl::~Curl() {
@@ -83,6 +375,10 @@ void Curl::copy(const Curl& other) {
   // calling copy constructor is impossible; since we are not supposed to free the memory associated with it either (https://curl.se/libcurl/c/curl_easy_getinfo.html), we cannot copy internal info...
   // have to copy the same handle
   this->curl_impl = other.curl_impl;
+  this->stats = other.stats;
+  this->request_policy = other.request_policy;
+  this->url_outcomes = other.url_outcomes;
+  this->backoff_jitter = other.backoff_jitter;
 }
 
 void Curl::clear() {
@@ -90,6 +386,81 @@ void Curl::clear() {
   this->curl_impl = NULL;
 }
 
+// Options that stay the same for every call made with this handle
+// failures here are not fatal: an older libcurl without e.g. HTTP/2 support still fetches pages, just less efficiently
+void Curl::SetPersistentOptions() {
+  // an empty string advertises every encoding this libcurl was built with (gzip, deflate, and br/zstd when available) and decodes responses for us
+  curl_easy_setopt(this->curl_impl, CURLOPT_ACCEPT_ENCODING, "");
+
+  // negotiate HTTP/2 over TLS via ALPN, falling back to HTTP/1.1
+  // CURLOPT_PIPEWAIT is left off: each call runs on a multi handle of its own, and a transfer waiting to multiplex is only woken by its own multi handle,
+  // so with handles on several threads sharing connections (see CurlPipeline), it could wait forever on a connection another thread is using
+  curl_easy_setopt(this->curl_impl, CURLOPT_HTTP_VERSION, static_cast<long>(CURL_HTTP_VERSION_2TLS));
+
+  // handles may run on several threads at once (see CurlPipeline), where timeouts must not be signalled: https://curl.se/libcurl/c/CURLOPT_NOSIGNAL.html
+  curl_easy_setopt(this->curl_impl, CURLOPT_NOSIGNAL, 1L);
+
+  // keep idle connections alive between the page calls of a run
+  curl_easy_setopt(this->curl_impl, CURLOPT_TCP_KEEPALIVE, 1L);
+
+  // a stalled server fails the attempt instead of the whole run waiting on it
+  curl_easy_setopt(this->curl_impl, CURLOPT_CONNECTTIMEOUT_MS, this->request_policy.connect_timeout_ms);
+  curl_easy_setopt(this->curl_impl, CURLOPT_TIMEOUT_MS, this->request_policy.total_timeout_ms);
+
+  // share DNS, TLS sessions and connections with every other Curl object in this process
+  CURLSH* share = Curl::SharedCache();
+  if (share != NULL) {
+    curl_easy_setopt(this->curl_impl, CURLOPT_SHARE, share);
+  }
+}
+
+// process-wide cache of DNS results, TLS sessions and open connections: https://curl.se/libcurl/c/curl_share_setopt.html
+// libcurl requires lock callbacks when the share is used by handles on more than one thread
+static std::mutex shared_cache_locks[CURL_LOCK_DATA_LAST];
+
+static void LockSharedCache(CURL* handle, curl_lock_data data, curl_lock_access access, void* user_ptr) {
+  (void) handle;
+  (void) access;
+  (void) user_ptr;
+  shared_cache_locks[data].lock();
+}
+
+static void UnlockSharedCache(CURL* handle, curl_lock_data data, void* user_ptr) {
+  (void) handle;
+  (void) user_ptr;
+  shared_cache_locks[data].unlock();
+}
+
+class CurlShareHolder {
+  public:
+    CurlShareHolder() {
+      this->share = curl_share_init();
+      if (this->share == NULL) {
+        return;
+      }
+
+      curl_share_setopt(this->share, CURLSHOPT_LOCKFUNC, LockSharedCache);
+      curl_share_setopt(this->share, CURLSHOPT_UNLOCKFUNC, UnlockSharedCache);
+      curl_share_setopt(this->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+      curl_share_setopt(this->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+      curl_share_setopt(this->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+    }
+
+    ~CurlShareHolder() {
+      if (this->share != NULL) {
+        curl_share_cleanup(this->share);
+      }
+    }
+
+    CURLSH* share;
+};
+
+// may return NULL if the share could not be created, in which case each handle keeps its own caches
+CURLSH* Curl::SharedCache() {
+  static CurlShareHolder holder;
+  return holder.share;
+}
+
 // based on 'writer' example from https://curl.se/libcurl/c/htmltitle.html
 size_t Curl::DataWriter(char* curl_data_ptr, size_t always_one, size_t data_size, std::string* caller_ptr) {
   if (caller_ptr == NULL) {
@@ -100,3 +471,101 @@ size_t Curl::DataWriter(char* curl_data_ptr, size_t always_one, size_t data_size
   caller_ptr->append(curl_data_ptr, size_to_write);
   return size_to_write;
 }
+
+// the Curl objects are made here, on the calling thread, since libcurl's global setup on the first one is not thread-safe
+CurlPipeline::CurlPipeline(unsigned int window, const CurlRequestPolicy& policy)
+  : stopping(false)
+{
+  const unsigned int thread_count = std::max(window, 1u);
+  for (unsigned int thread_i = 0; thread_i < thread_count; ++thread_i) {
+    this->curls.push_back(std::unique_ptr<Curl>(new Curl()));
+    this->curls.back()->SetRequestPolicy(policy);
+  }
+  this->thread_stats.resize(thread_count);
+
+  for (unsigned int thread_i = 0; thread_i < thread_count; ++thread_i) {
+    this->threads.push_back(std::thread(&CurlPipeline::Fetch, this, thread_i));
+  }
+}
+
+void CurlPipeline::Request(const std::string& url) {
+  {
+    std::lock_guard<std::mutex> guard(this->lock);
+    if (!this->requested.insert(url).second) {
+      return;
+    }
+    this->queued.push_back(url);
+  }
+  this->changed.notify_all();
+}
+
+CurlResult CurlPipeline::Take(const std::string& url) {
+  this->Request(url);
+
+  std::unique_lock<std::mutex> guard(this->lock);
+  auto found = this->finished.find(url);
+  while (found == this->finished.end()) {
+    this->changed.wait(guard);
+    found = this->finished.find(url);
+  }
+
+  CurlResult result = std::move(found->second);
+  this->finished.erase(found);
+  this->requested.erase(url);
+  return result;
+}
+
+const CurlTransferStats CurlPipeline::GetTransferStats() const {
+  std::lock_guard<std::mutex> guard(this->lock);
+  CurlTransferStats total;
+  for (const auto& stats:this->thread_stats) {
+    total.Add(stats);
+  }
+  return total;
+}
+
+const std::vector<CurlURLOutcome> CurlPipeline::GetURLOutcomes() const {
+  std::lock_guard<std::mutex> guard(this->lock);
+  return this->url_outcomes;
+}
+
+CurlPipeline::~CurlPipeline() {
+  {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->stopping = true;
+    this->queued.clear();
+  }
+  this->changed.notify_all();
+
+  for (auto& thread:this->threads) {
+    thread.join();
+  }
+}
+
+// each thread takes the oldest queued URL, fetches it without the lock held, then files the result and its Curl's totals
+void CurlPipeline::Fetch(unsigned int thread_i) {
+  Curl* curl = this->curls[thread_i].get();
+  std::unique_lock<std::mutex> guard(this->lock);
+  while (true) {
+    while (!this->stopping && this->queued.empty()) {
+      this->changed.wait(guard);
+    }
+    if (this->stopping) {
+      return;
+    }
+
+    const std::string url = this->queued.front();
+    this->queued.pop_front();
+
+    guard.unlock();
+    CurlResult result = curl->CallURL(url.c_str());
+    const CurlTransferStats stats = curl->GetTransferStats();
+    const CurlURLOutcome outcome = curl->GetURLOutcomes().back();
+    guard.lock();
+
+    this->thread_stats[thread_i] = stats;
+    this->url_outcomes.push_back(outcome);
+    this->finished.insert(std::make_pair(url, std::move(result)));
+    this->changed.notify_all();
+  }
+}
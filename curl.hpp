@@ -7,16 +7,71 @@
 #define SVGSC_CURL_H
 
 #include <string>
-#include <curl/curl.h> // CURL
+#include <vector> // vector
+#include <random> // minstd_rand
+#include <map> // map
+#include <set> // set
+#include <deque> // deque
+#include <memory> // unique_ptr
+#include <thread> // thread
+#include <mutex> // mutex
+#include <condition_variable> // condition_variable
+#include <curl/curl.h> // CURL, CURLSH
 
 class CurlResult {
   public:
     // Constructor
-    CurlResult(const std::string& result_data, const std::string& result_error);
+    CurlResult(const std::string& result_data, const std::string& result_error, size_t result_wire_bytes = 0);
 
     // Member variables
     std::string data;
     std::string error; // will be empty if result is successful
+    size_t wire_bytes; // bytes received over the network (headers plus possibly-compressed body); data.size() is the decoded size
+};
+
+// Running totals of what a Curl object has transferred
+class CurlTransferStats {
+  public:
+    // Constructor
+    CurlTransferStats();
+
+    // adds another object's totals to these
+    void Add(const CurlTransferStats& other);
+
+    // Member variables
+    unsigned int transfers;
+    size_t wire_bytes;
+    size_t decoded_bytes;
+};
+
+// How hard a Curl object tries to fetch each URL
+class CurlRequestPolicy {
+  public:
+    // Constructor; defaults to modest timeouts, 3 attempts and no hedging
+    CurlRequestPolicy();
+
+    // Member variables
+    long connect_timeout_ms; // 0 means libcurl's default
+    long total_timeout_ms; // per attempt; 0 means no limit
+    unsigned int max_attempts; // including the first; only transient failures (timeouts, dropped connections, HTTP 5xx/429) are retried
+    long backoff_base_ms; // the n-th retry waits a random time up to min(backoff_max_ms, backoff_base_ms * 2^(n-1)): "full jitter"
+    long backoff_max_ms;
+    unsigned int hedge_percentile; // 1-99: once an attempt has taken longer than this percentile of earlier fetches by any Curl in the process, a duplicate request races it; 0 disables hedging
+};
+
+// What happened while fetching one URL
+class CurlURLOutcome {
+  public:
+    // Constructor
+    explicit CurlURLOutcome(const std::string& outcome_url);
+
+    // Member variables
+    std::string url;
+    unsigned int attempts;
+    bool hedged; // a duplicate request was sent during some attempt
+    bool hedge_won; // the duplicate request finished first
+    long elapsed_ms; // including any waits between attempts
+    std::string error; // will be empty if the URL was fetched
 };
 
 class Curl {
@@ -30,18 +85,74 @@ class Curl {
     // Assignment operator
     Curl& operator=(const Curl& other);
 
-    // Method to call URL
+    // applies to every later call; timeouts also apply to connections already open
+    void SetRequestPolicy(const CurlRequestPolicy& policy);
+
+    // Method to call URL, retrying and hedging as the request policy allows
     CurlResult CallURL(const char* url);
 
+    // Data-reading methods
+    const CurlTransferStats GetTransferStats() const;
+    const std::vector<CurlURLOutcome> GetURLOutcomes() const; // one per call, in call order
+
     // Destructor
     ~Curl();
 
   private:
     void copy(const Curl& other);
     void clear();
+    void SetPersistentOptions();
+    CurlResult PerformAttempt(const char* url, bool* retryable, CurlURLOutcome* outcome);
+    long HedgeDelayMs() const;
+    long BackoffDelayMs(unsigned int retry);
+    size_t WireBytes(CURL* handle) const;
+    static CURLSH* SharedCache();
     static size_t DataWriter(char* curl_data_ptr, size_t always_one, size_t data_size, std::string* caller_ptr);
 
     CURL* curl_impl;
+    CurlTransferStats stats;
+    CurlRequestPolicy request_policy;
+    std::vector<CurlURLOutcome> url_outcomes;
+    std::minstd_rand backoff_jitter;
+};
+
+// Fetches URLs ahead of the caller, on threads of its own, so pages download while the caller parses others
+// each thread has its own Curl, so at most window fetches are in flight at once; queued URLs start in the order they were requested
+class CurlPipeline {
+  public:
+    // Constructor; starts window threads (at least one), each fetching with the policy
+    CurlPipeline(unsigned int window, const CurlRequestPolicy& policy);
+
+    // queues the URL, unless it has already been requested and not yet taken
+    void Request(const std::string& url);
+
+    // waits for the URL's result and hands it over; a URL not requested yet is requested first
+    CurlResult Take(const std::string& url);
+
+    // the totals of every thread's Curl, and what happened to each URL, in the order their fetches finished
+    const CurlTransferStats GetTransferStats() const;
+    const std::vector<CurlURLOutcome> GetURLOutcomes() const;
+
+    // Destructor; cancels every fetch not yet started and waits for those in flight, whose results are dropped
+    ~CurlPipeline();
+
+  private:
+    // not copyable, since the threads hold on to the pipeline
+    CurlPipeline(const CurlPipeline& other);
+    CurlPipeline& operator=(const CurlPipeline& other);
+
+    void Fetch(unsigned int thread_i);
+
+    std::vector<std::unique_ptr<Curl>> curls; // by thread
+    std::vector<CurlTransferStats> thread_stats; // of each thread's Curl, as of its last fetch
+    std::vector<CurlURLOutcome> url_outcomes;
+    std::deque<std::string> queued; // URLs not started yet, in request order
+    std::map<std::string, CurlResult> finished; // results not taken yet, by URL
+    std::set<std::string> requested; // URLs requested and not taken, whether or not their fetch has finished
+    bool stopping;
+    mutable std::mutex lock;
+    std::condition_variable changed; // signalled when a URL is queued or finished, and when stopping
+    std::vector<std::thread> threads;
 };
 
 #endif // SVGSC_CURL_H
@@ -0,0 +1,217 @@
+/*
+ * Description: implementation to store what was read from the wiki, along with the page revisions it was read from
+ * Author: Laura Galbraith
+*/
+
+#include "dataset.hpp" // self-include header
+
+#include <fstream> // ifstream, ofstream
+#include <sstream> // stringstream
+#include <cstdio> // rename, remove
+#include <cstdlib> // strtoul
+
+// The file is one record per line, with tab-separated fields (wiki titles cannot contain tabs or line breaks):
+//   svgsc-wiki-dataset <version>
+//   villagers <revision> <villager>...
+//   friendship <revision>
+//   universal-loves <gift>...
+//   universal-love-exceptions <villager> <gift> <villager> <gift>...
+//   universal-likes <gift>...
+//   universal-like-exceptions <villager> <gift> <villager> <gift>...
+//   villager <villager> <revision> <gift>...
+//   villager-likes <villager> <gift>...
+// version 1 had no liked gifts, so has none of the like records
+const std::string DATASET_HEADER = "svgsc-wiki-dataset";
+const std::string DATASET_VERSION = "2";
+const std::string DATASET_VERSION_WITHOUT_LIKES = "1";
+const std::string VILLAGERS_RECORD = "villagers";
+const std::string FRIENDSHIP_RECORD = "friendship";
+const std::string UNIVERSAL_LOVES_RECORD = "universal-loves";
+const std::string UNIVERSAL_LOVE_EXCEPTIONS_RECORD = "universal-love-exceptions";
+const std::string UNIVERSAL_LIKES_RECORD = "universal-likes";
+const std::string UNIVERSAL_LIKE_EXCEPTIONS_RECORD = "universal-like-exceptions";
+const std::string VILLAGER_RECORD = "villager";
+const std::string VILLAGER_LIKES_RECORD = "villager-likes";
+const char FIELD_SEPARATOR = '\t';
+
+VillagerPageData::VillagerPageData()
+  : revision_id(0)
+{}
+
+VillagerPageData::VillagerPageData(unsigned long page_revision_id, const std::vector<std::string>& page_loved_gifts, const std::vector<std::string>& page_liked_gifts)
+  : revision_id(page_revision_id), loved_gifts(page_loved_gifts), liked_gifts(page_liked_gifts)
+{}
+
+WikiDataset::WikiDataset()
+  : villagers_revision_id(0), friendship_revision_id(0), likes_read(false)
+{}
+
+bool WikiDataset::Empty() const {
+  return this->villagers_revision_id == 0 && this->friendship_revision_id == 0 && this->villager_pages.empty();
+}
+
+WikiDatasetResult::WikiDatasetResult(const WikiDataset& result_data, const std::string& result_error)
+  : data(result_data), error(result_error)
+{}
+
+std::vector<std::string> SplitFields(const std::string& line) {
+  std::vector<std::string> fields;
+  std::stringstream stream(line);
+  std::string field;
+  while (std::getline(stream, field, FIELD_SEPARATOR)) {
+    fields.push_back(field);
+  }
+  return fields;
+}
+
+// returns 0 for a revision that is not a positive number
+unsigned long ParseRevision(const std::string& field) {
+  char* end = NULL;
+  const unsigned long revision_id = std::strtoul(field.c_str(), &end, 10);
+  if (field.empty() || end == NULL || *end != '\0') {
+    return 0;
+  }
+  return revision_id;
+}
+
+WikiDatasetResult ReadWikiDataset(const std::string& path) {
+  WikiDataset dataset;
+
+  std::ifstream file(path.c_str());
+  if (!file) {
+    return WikiDatasetResult(dataset, "");
+  }
+
+  std::string line;
+  if (!std::getline(file, line) || (line != DATASET_HEADER + FIELD_SEPARATOR + DATASET_VERSION && line != DATASET_HEADER + FIELD_SEPARATOR + DATASET_VERSION_WITHOUT_LIKES)) {
+    return WikiDatasetResult(WikiDataset(), path + " is not a version " + DATASET_VERSION_WITHOUT_LIKES + " or " + DATASET_VERSION + " wiki dataset");
+  }
+  dataset.likes_read = line == DATASET_HEADER + FIELD_SEPARATOR + DATASET_VERSION;
+
+  unsigned long line_number = 1;
+  while (std::getline(file, line)) {
+    ++line_number;
+    const std::vector<std::string> fields = SplitFields(line);
+    if (fields.size() <= 0) {
+      continue;
+    }
+
+    const std::string& record = fields[0];
+    bool valid = true;
+    if (record == VILLAGERS_RECORD && fields.size() >= 2) {
+      dataset.villagers_revision_id = ParseRevision(fields[1]);
+      dataset.villagers.assign(fields.begin() + 2, fields.end());
+      valid = dataset.villagers_revision_id > 0;
+    }
+    else if (record == FRIENDSHIP_RECORD && fields.size() == 2) {
+      dataset.friendship_revision_id = ParseRevision(fields[1]);
+      valid = dataset.friendship_revision_id > 0;
+    }
+    else if (record == UNIVERSAL_LOVES_RECORD) {
+      dataset.universal_loves.assign(fields.begin() + 1, fields.end());
+    }
+    else if (record == UNIVERSAL_LOVE_EXCEPTIONS_RECORD && fields.size() % 2 == 1) {
+      dataset.universal_love_exceptions.assign(fields.begin() + 1, fields.end());
+    }
+    else if (record == UNIVERSAL_LIKES_RECORD && dataset.likes_read) {
+      dataset.universal_likes.assign(fields.begin() + 1, fields.end());
+    }
+    else if (record == UNIVERSAL_LIKE_EXCEPTIONS_RECORD && dataset.likes_read && fields.size() % 2 == 1) {
+      dataset.universal_like_exceptions.assign(fields.begin() + 1, fields.end());
+    }
+    else if (record == VILLAGER_RECORD && fields.size() >= 3) {
+      const unsigned long revision_id = ParseRevision(fields[2]);
+      dataset.villager_pages[fields[1]] = VillagerPageData(revision_id, std::vector<std::string>(fields.begin() + 3, fields.end()), std::vector<std::string>());
+      valid = revision_id > 0;
+    }
+    else if (record == VILLAGER_LIKES_RECORD && dataset.likes_read && fields.size() >= 2) {
+      // follows the villager's own record, whose revision it was read from
+      auto found = dataset.villager_pages.find(fields[1]);
+      if (found != dataset.villager_pages.end()) {
+        found->second.liked_gifts.assign(fields.begin() + 2, fields.end());
+      }
+      valid = found != dataset.villager_pages.end();
+    }
+    else {
+      valid = false;
+    }
+
+    if (!valid) {
+      std::stringstream error;
+      error << path << " line " << line_number << " is not a valid " << record << " record";
+      return WikiDatasetResult(WikiDataset(), error.str());
+    }
+  }
+
+  return WikiDatasetResult(dataset, "");
+}
+
+// returns false if a field cannot be stored
+bool WriteFields(std::ostream& os, const std::vector<std::string>& fields) {
+  for (auto f:fields) {
+    if (f.find_first_of("\t\r\n") != std::string::npos) {
+      return false;
+    }
+    os << FIELD_SEPARATOR << f;
+  }
+  return true;
+}
+
+std::string WriteWikiDataset(const std::string& path, const WikiDataset& dataset) {
+  const std::string temporary_path = path + ".tmp";
+  std::ofstream file(temporary_path.c_str(), std::ios::trunc);
+  if (!file) {
+    return "could not write " + temporary_path;
+  }
+
+  bool valid = true;
+  file << DATASET_HEADER << FIELD_SEPARATOR << DATASET_VERSION << '\n';
+
+  file << VILLAGERS_RECORD << FIELD_SEPARATOR << dataset.villagers_revision_id;
+  valid = WriteFields(file, dataset.villagers) && valid;
+  file << '\n';
+
+  file << FRIENDSHIP_RECORD << FIELD_SEPARATOR << dataset.friendship_revision_id << '\n';
+
+  file << UNIVERSAL_LOVES_RECORD;
+  valid = WriteFields(file, dataset.universal_loves) && valid;
+  file << '\n';
+
+  file << UNIVERSAL_LOVE_EXCEPTIONS_RECORD;
+  valid = WriteFields(file, dataset.universal_love_exceptions) && valid;
+  file << '\n';
+
+  file << UNIVERSAL_LIKES_RECORD;
+  valid = WriteFields(file, dataset.universal_likes) && valid;
+  file << '\n';
+
+  file << UNIVERSAL_LIKE_EXCEPTIONS_RECORD;
+  valid = WriteFields(file, dataset.universal_like_exceptions) && valid;
+  file << '\n';
+
+  for (auto v_page:dataset.villager_pages) {
+    file << VILLAGER_RECORD;
+    valid = WriteFields(file, {v_page.first}) && valid;
+    file << FIELD_SEPARATOR << v_page.second.revision_id;
+    valid = WriteFields(file, v_page.second.loved_gifts) && valid;
+    file << '\n';
+
+    file << VILLAGER_LIKES_RECORD;
+    valid = WriteFields(file, {v_page.first}) && valid;
+    valid = WriteFields(file, v_page.second.liked_gifts) && valid;
+    file << '\n';
+  }
+
+  file.close();
+  if (!valid || !file) {
+    std::remove(temporary_path.c_str());
+    return valid ? "could not write " + temporary_path : "a name in the dataset contains a tab or line break";
+  }
+
+  if (std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+    std::remove(temporary_path.c_str());
+    return "could not replace " + path;
+  }
+
+  return "";
+}
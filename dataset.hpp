@@ -0,0 +1,67 @@
+/*
+ * Description: interfaces to store what was read from the wiki, along with the page revisions it was read from
+ * Author: Laura Galbraith
+*/
+
+#ifndef SVGSC_DATASET_H
+#define SVGSC_DATASET_H
+
+#include <string> // string
+#include <vector> // vector
+#include <map> // map
+
+// What was read from one villager's page
+class VillagerPageData {
+  public:
+    // Constructors
+    VillagerPageData();
+    VillagerPageData(unsigned long page_revision_id, const std::vector<std::string>& page_loved_gifts, const std::vector<std::string>& page_liked_gifts);
+
+    // Member variables
+    unsigned long revision_id;
+    std::vector<std::string> loved_gifts;
+    std::vector<std::string> liked_gifts;
+};
+
+// Everything the wiki says about loved and liked gifts, before any villagers or gifts are skipped, so one dataset serves any skip lists
+// each part records the revision of the page it came from, so it only needs to be read again once that page changes
+class WikiDataset {
+  public:
+    // Constructor; an empty dataset, which has not been read from any page
+    WikiDataset();
+
+    bool Empty() const;
+
+    // Member variables
+    unsigned long villagers_revision_id; // 0 if not yet read
+    std::vector<std::string> villagers; // every giftable villager, in the order the Villagers page lists them
+
+    unsigned long friendship_revision_id; // 0 if not yet read
+    std::vector<std::string> universal_loves;
+    std::vector<std::string> universal_love_exceptions; // in a list form of Villager/Gift/Villager/Gift, with the Villager specified before the Gift they don't love
+    std::vector<std::string> universal_likes;
+    std::vector<std::string> universal_like_exceptions; // in the same form as universal_love_exceptions
+    bool likes_read; // false for a dataset stored before liked gifts were kept, whose pages must all be read again for them
+
+    std::map<std::string, VillagerPageData> villager_pages; // by villager name, which is also the page title
+};
+
+class WikiDatasetResult {
+  public:
+    // Constructor
+    WikiDatasetResult(const WikiDataset& result_data, const std::string& result_error);
+
+    // Member variables
+    WikiDataset data;
+    std::string error; // will be empty if result is successful
+};
+
+// reads a dataset written by WriteWikiDataset; a file that does not exist yet reads as an empty dataset
+// a version 1 file, from before liked gifts were kept, reads with likes_read false
+WikiDatasetResult ReadWikiDataset(const std::string& path);
+
+// replaces the file with the dataset, so an interrupted write never leaves a partial file behind
+// returns an error, or empty if successful
+std::string WriteWikiDataset(const std::string& path, const WikiDataset& dataset);
+
+#endif // SVGSC_DATASET_H
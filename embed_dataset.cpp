@@ -0,0 +1,155 @@
+/*
+ * Description: program to turn a stored wiki dataset into a header of constant tables, to compile into the program
+ * Author: Laura Galbraith
+*/
+
+#include <iostream> // cout, cerr, endl
+#include <fstream> // ifstream, ofstream
+#include <sstream> // stringstream
+#include <string> // string
+#include <vector> // vector
+#include <iomanip> // hex, setw, setfill
+
+#include "dataset.hpp" // WikiDataset, ReadWikiDataset
+#include "valleyfacts.hpp" // GiftsByVillager, WikiLoadOptions, WikiSource, Villager
+#include "incidence.hpp" // IncidenceStore
+#include "nametable.hpp" // NameTable
+#include "embedded.hpp" // EmbeddedDataset
+
+void PrintUsage() {
+  std::cout << std::endl;
+  std::cout << "Usage: <program> <stored dataset> <header to write>" << std::endl;
+  std::cout << "    ex. embedded_dataset.tsv embedded_dataset.hpp" << std::endl;
+  std::cout << std::endl;
+}
+
+// FNV-1a: https://en.m.wikipedia.org/wiki/Fowler%E2%80%93Noll%E2%80%93Vo_hash_function
+unsigned long long HashBytes(const std::string& bytes) {
+  unsigned long long hash = 14695981039346656037ULL;
+  for (auto c:bytes) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+// a C++ string literal of the name; bytes outside printable ASCII are escaped, so the header's encoding never matters
+std::string StringLiteral(const std::string& s) {
+  std::stringstream literal;
+  literal << '"';
+  for (auto c:s) {
+    const unsigned char byte = static_cast<unsigned char>(c);
+    if (c == '"' || c == '\\') {
+      literal << '\\' << c;
+    }
+    else if (byte < 0x20 || byte >= 0x7F) {
+      literal << '\\' << std::oct << std::setw(3) << std::setfill('0') << static_cast<unsigned int>(byte) << std::dec;
+    }
+    else {
+      literal << c;
+    }
+  }
+  literal << '"';
+  return literal.str();
+}
+
+void WriteNameTable(std::ostream& os, const std::string& array_name, const NameTable& names) {
+  os << "constexpr const char* " << array_name << "[] = {" << std::endl;
+  for (unsigned int id = 0; id < names.Size(); ++id) {
+    os << "  " << StringLiteral(names.Name(id)) << "," << std::endl;
+  }
+  if (names.Size() <= 0) {
+    os << "  \"\"," << std::endl; // arrays cannot be empty; the count says there are no names
+  }
+  os << "};" << std::endl << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc != 3) {
+    PrintUsage();
+    return -1;
+  }
+
+  const std::string dataset_path = argv[1];
+  const std::string header_path = argv[2];
+
+  WikiDatasetResult read_dataset = ReadWikiDataset(dataset_path);
+  if (read_dataset.error != "" || read_dataset.data.Empty()) {
+    std::cerr << "could not read dataset: " << (read_dataset.error != "" ? read_dataset.error : dataset_path + " does not exist or is empty") << std::endl;
+    return -1;
+  }
+  const WikiDataset& dataset = read_dataset.data;
+
+  // combine the loves exactly as a run would, with nothing skipped
+  WikiLoadOptions load_options;
+  load_options.source = WikiSource::STORED_DATASET;
+  const GiftsByVillager gifts_and_villagers = GiftsByVillager(std::vector<Villager>(), std::vector<Gift>(), load_options, dataset);
+  const IncidenceStore& incidences = gifts_and_villagers.GetIncidences();
+
+  // the version names the page revisions the data was read from, and a hash of the dataset itself
+  std::ifstream dataset_file(dataset_path.c_str(), std::ios::binary);
+  std::stringstream dataset_bytes;
+  dataset_bytes << dataset_file.rdbuf();
+  unsigned long latest_villager_revision = 0;
+  for (auto v_page:dataset.villager_pages) {
+    if (v_page.second.revision_id > latest_villager_revision) {
+      latest_villager_revision = v_page.second.revision_id;
+    }
+  }
+  std::stringstream version;
+  version << "villagers r" << dataset.villagers_revision_id << ", friendship r" << dataset.friendship_revision_id << ", villager pages up to r" << latest_villager_revision;
+  version << ", hash " << std::hex << std::setw(16) << std::setfill('0') << HashBytes(dataset_bytes.str());
+
+  std::ofstream header(header_path.c_str(), std::ios::trunc);
+  if (!header) {
+    std::cerr << "could not write " << header_path << std::endl;
+    return -1;
+  }
+
+  header << "// Generated by embed_dataset.out from a stored dataset; rebuild with 'make embedded' rather than editing" << std::endl << std::endl;
+  header << "#ifndef SVGSC_EMBEDDED_DATASET_H" << std::endl;
+  header << "#define SVGSC_EMBEDDED_DATASET_H" << std::endl << std::endl;
+  header << "#include \"embedded.hpp\" // EmbeddedDataset" << std::endl << std::endl;
+
+  WriteNameTable(header, "EMBEDDED_GIFT_NAMES", incidences.GetGiftNames());
+  WriteNameTable(header, "EMBEDDED_VILLAGER_NAMES", incidences.GetVillagerNames());
+
+  header << "constexpr unsigned int EMBEDDED_VILLAGER_ORDER[] = {";
+  for (auto v:gifts_and_villagers.GetVillagers()) {
+    header << incidences.GetVillagerNames().Find(v) << ",";
+  }
+  header << (incidences.VillagerCount() <= 0 ? "0" : "") << "};" << std::endl << std::endl;
+
+  const unsigned int gift_count = static_cast<unsigned int>(incidences.GiftCount());
+  const unsigned int villager_count = static_cast<unsigned int>(incidences.VillagerCount());
+  const unsigned int words_per_gift = (villager_count + EmbeddedDataset::BITS_PER_WORD - 1) / EmbeddedDataset::BITS_PER_WORD;
+  header << "constexpr unsigned long long EMBEDDED_INCIDENCES[] = {" << std::endl;
+  for (unsigned int gift_id = 0; gift_id < gift_count; ++gift_id) {
+    std::vector<unsigned long long> words(words_per_gift, 0);
+    for (const unsigned int* v_it = incidences.GiftVillagersBegin(gift_id); v_it != incidences.GiftVillagersEnd(gift_id); ++v_it) {
+      words[*v_it / EmbeddedDataset::BITS_PER_WORD] |= 1ULL << (*v_it % EmbeddedDataset::BITS_PER_WORD);
+    }
+
+    header << " ";
+    for (auto word:words) {
+      header << " 0x" << std::hex << word << std::dec << "ULL,";
+    }
+    header << " // " << StringLiteral(incidences.GetGiftNames().Name(gift_id)) << std::endl;
+  }
+  if (gift_count * words_per_gift <= 0) {
+    header << "  0" << std::endl;
+  }
+  header << "};" << std::endl << std::endl;
+
+  header << "constexpr EmbeddedDataset EMBEDDED_DATASET(" << StringLiteral(version.str()) << ", EMBEDDED_GIFT_NAMES, " << gift_count << ", EMBEDDED_VILLAGER_NAMES, " << villager_count << ", EMBEDDED_VILLAGER_ORDER, EMBEDDED_INCIDENCES);" << std::endl << std::endl;
+  header << "#endif // SVGSC_EMBEDDED_DATASET_H" << std::endl;
+
+  header.close();
+  if (!header) {
+    std::cerr << "could not write " << header_path << std::endl;
+    return -1;
+  }
+
+  std::cout << "Embedded " << villager_count << " villagers and " << gift_count << " gifts (" << version.str() << ") in " << header_path << std::endl;
+  return 0;
+}
@@ -0,0 +1,23 @@
+/*
+ * Description: implementation to a gift/villager dataset compiled into the program
+ * Author: Laura Galbraith
+*/
+
+#include "embedded.hpp" // self-include header
+
+#include <cstddef> // NULL
+
+// 'make embedded' generates this header from a stored dataset and defines SVGSC_EMBEDDED_DATASET
+#ifdef SVGSC_EMBEDDED_DATASET
+#include "embedded_dataset.hpp" // EMBEDDED_DATASET
+#endif
+
+constexpr unsigned int EmbeddedDataset::BITS_PER_WORD;
+
+const EmbeddedDataset* GetEmbeddedDataset() {
+#ifdef SVGSC_EMBEDDED_DATASET
+  return &EMBEDDED_DATASET;
+#else
+  return NULL;
+#endif
+}
@@ -0,0 +1,49 @@
+/*
+ * Description: interface to a gift/villager dataset compiled into the program
+ * Author: Laura Galbraith
+*/
+
+#ifndef SVGSC_EMBEDDED_H
+#define SVGSC_EMBEDDED_H
+
+// Everything needed to solve without reading the wiki, as constant tables: built by 'make embedded' from a stored dataset
+// names are interned in sorted order, the same IDs GiftsByVillager would give them
+class EmbeddedDataset {
+  public:
+    // Constructor; constexpr so the generated tables need no code at startup
+    constexpr EmbeddedDataset(const char* dataset_version, const char* const* gift_name_table, unsigned int gifts, const char* const* villager_name_table, unsigned int villagers, const unsigned int* villager_list_order, const unsigned long long* incidence_bitsets)
+      : version(dataset_version),
+        gift_names(gift_name_table),
+        gift_count(gifts),
+        villager_names(villager_name_table),
+        villager_count(villagers),
+        villager_order(villager_list_order),
+        incidences(incidence_bitsets)
+    {}
+
+    // O(1)
+    constexpr unsigned int WordsPerGift() const {
+      return (this->villager_count + BITS_PER_WORD - 1) / BITS_PER_WORD;
+    }
+
+    // O(1)
+    constexpr bool Loves(unsigned int villager_id, unsigned int gift_id) const {
+      return (this->incidences[gift_id * this->WordsPerGift() + villager_id / BITS_PER_WORD] >> (villager_id % BITS_PER_WORD)) & 1ULL;
+    }
+
+    // Member variables
+    const char* version; // the page revisions the data was read from, and a hash of it
+    const char* const* gift_names; // sorted
+    unsigned int gift_count;
+    const char* const* villager_names; // sorted
+    unsigned int villager_count;
+    const unsigned int* villager_order; // every villager ID, in the order the Villagers page lists them
+    const unsigned long long* incidences; // one bitset over villager IDs per gift: bit v of gift g's row is set if villager v loves gift g
+
+    static constexpr unsigned int BITS_PER_WORD = 64;
+};
+
+// the dataset compiled into this build, or NULL if it was built without one
+const EmbeddedDataset* GetEmbeddedDataset();
+
+#endif // SVGSC_EMBEDDED_H
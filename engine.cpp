@@ -0,0 +1,237 @@
+/*
+ * Description: implementations to choose which engine covers the gifts, from the shape of the data, the time budget and how fast each engine runs on this machine
+ * Author: Laura Galbraith
+*/
+
+#include "engine.hpp" // self-include header
+
+#include <string> // string
+#include <vector> // vector
+#include <map> // map
+#include <fstream> // ifstream, ofstream
+#include <sstream> // stringstream
+#include <algorithm> // min, max
+#include <cstdlib> // strtod
+
+#include "incidence.hpp" // IncidenceStore
+#include "smallcover.hpp" // SMALL_COVER_MAX_VILLAGERS, SMALL_COVER_MAX_STATES
+
+// The file is one record per line, with tab-separated fields:
+//   svgsc-engine-calibration <version>
+//   <measurement name> <value>
+const std::string ENGINE_CALIBRATION_HEADER = "svgsc-engine-calibration";
+const std::string ENGINE_CALIBRATION_VERSION = "1";
+const char ENGINE_CALIBRATION_FIELD_SEPARATOR = '\t';
+const std::string GREEDY_INCIDENCES_PER_US_NAME = "greedy_incidences_per_us";
+const std::string PARALLEL_ROUND_US_NAME = "parallel_round_us";
+const std::string EXACT_STATES_PER_US_NAME = "exact_states_per_us";
+
+// the parallel greedy must be predicted to take at most this much of the sequential greedy's time, since the prediction is rough and the threads take cores from other work
+const double PARALLEL_MIN_SPEEDUP = 1.25;
+// an exact search too short to reach this many covered-sets is not worth starting
+const unsigned long EXACT_MIN_STATES = 4096;
+
+std::string GreedyEngineName(GreedyEngine engine) {
+  switch (engine) {
+    case GreedyEngine::SEQUENTIAL:
+      return "sequential greedy";
+    case GreedyEngine::PARALLEL:
+      return "parallel greedy";
+    case GreedyEngine::BULK_PARALLEL:
+      return "parallel greedy in bulk rounds";
+  }
+  return "";
+}
+
+InstanceProfile::InstanceProfile()
+  : gifts(0), villagers(0), incidences(0), density(0), largest_gift(0), coverable_villagers(0), forced_gifts(0), villagers_left_unforced(0)
+{}
+
+InstanceProfile ProfileInstance(const IncidenceStore& incidences) {
+  InstanceProfile profile;
+  profile.gifts = incidences.GiftCount();
+  profile.villagers = incidences.VillagerCount();
+  profile.incidences = incidences.IncidenceCount();
+  if (profile.gifts > 0 && profile.villagers > 0) {
+    profile.density = static_cast<double>(profile.incidences) / (static_cast<double>(profile.gifts) * static_cast<double>(profile.villagers));
+  }
+
+  std::vector<bool> forced(profile.gifts, false);
+  for (unsigned int gift_id = 0; gift_id < profile.gifts; ++gift_id) {
+    profile.largest_gift = std::max(profile.largest_gift, static_cast<unsigned int>(incidences.GiftVillagersEnd(gift_id) - incidences.GiftVillagersBegin(gift_id)));
+  }
+  for (unsigned int villager_id = 0; villager_id < profile.villagers; ++villager_id) {
+    const size_t loving_gifts = static_cast<size_t>(incidences.VillagerGiftsEnd(villager_id) - incidences.VillagerGiftsBegin(villager_id));
+    if (loving_gifts > 0) {
+      ++profile.coverable_villagers;
+    }
+    if (loving_gifts == 1 && !forced[*incidences.VillagerGiftsBegin(villager_id)]) {
+      forced[*incidences.VillagerGiftsBegin(villager_id)] = true;
+      ++profile.forced_gifts;
+    }
+  }
+
+  // the villagers the forced gifts cover are taken care of whatever else is picked
+  std::vector<bool> covered(profile.villagers, false);
+  unsigned int forced_covered = 0;
+  for (unsigned int gift_id = 0; gift_id < profile.gifts; ++gift_id) {
+    if (!forced[gift_id]) {
+      continue;
+    }
+    for (const unsigned int* v_it = incidences.GiftVillagersBegin(gift_id); v_it != incidences.GiftVillagersEnd(gift_id); ++v_it) {
+      if (!covered[*v_it]) {
+        covered[*v_it] = true;
+        ++forced_covered;
+      }
+    }
+  }
+  profile.villagers_left_unforced = profile.coverable_villagers - forced_covered;
+
+  return profile;
+}
+
+EngineCalibration::EngineCalibration()
+  : greedy_incidences_per_us(4), parallel_round_us(50), exact_states_per_us(1.5)
+{}
+
+std::string ReadEngineCalibration(const std::string& path, EngineCalibration* calibration) {
+  std::ifstream file(path.c_str());
+  if (!file) {
+    return "could not read " + path;
+  }
+
+  std::string line;
+  if (!std::getline(file, line) || line != ENGINE_CALIBRATION_HEADER + ENGINE_CALIBRATION_FIELD_SEPARATOR + ENGINE_CALIBRATION_VERSION) {
+    return path + " is not a version " + ENGINE_CALIBRATION_VERSION + " engine calibration";
+  }
+
+  // every measurement must be there, and positive, so a choice is never made from a partly-read file
+  std::map<std::string, double> measurements;
+  unsigned long line_number = 1;
+  while (std::getline(file, line)) {
+    ++line_number;
+    const size_t separator = line.find(ENGINE_CALIBRATION_FIELD_SEPARATOR);
+    char* end = NULL;
+    const double value = separator == std::string::npos ? 0 : std::strtod(line.c_str() + separator + 1, &end);
+    if (separator == std::string::npos || end == NULL || *end != '\0' || !(value > 0)) {
+      std::stringstream error;
+      error << path << " line " << line_number << " is not a positive measurement";
+      return error.str();
+    }
+    measurements[line.substr(0, separator)] = value;
+  }
+
+  for (const auto& name:{GREEDY_INCIDENCES_PER_US_NAME, PARALLEL_ROUND_US_NAME, EXACT_STATES_PER_US_NAME}) {
+    if (measurements.find(name) == measurements.end()) {
+      return path + " has no " + name;
+    }
+  }
+  calibration->greedy_incidences_per_us = measurements[GREEDY_INCIDENCES_PER_US_NAME];
+  calibration->parallel_round_us = measurements[PARALLEL_ROUND_US_NAME];
+  calibration->exact_states_per_us = measurements[EXACT_STATES_PER_US_NAME];
+  return "";
+}
+
+std::string WriteEngineCalibration(const std::string& path, const EngineCalibration& calibration) {
+  std::ofstream file(path.c_str(), std::ios::trunc);
+  if (!file) {
+    return "could not write " + path;
+  }
+
+  file << ENGINE_CALIBRATION_HEADER << ENGINE_CALIBRATION_FIELD_SEPARATOR << ENGINE_CALIBRATION_VERSION << '\n';
+  file << GREEDY_INCIDENCES_PER_US_NAME << ENGINE_CALIBRATION_FIELD_SEPARATOR << calibration.greedy_incidences_per_us << '\n';
+  file << PARALLEL_ROUND_US_NAME << ENGINE_CALIBRATION_FIELD_SEPARATOR << calibration.parallel_round_us << '\n';
+  file << EXACT_STATES_PER_US_NAME << ENGINE_CALIBRATION_FIELD_SEPARATOR << calibration.exact_states_per_us << '\n';
+  file.close();
+
+  if (!file) {
+    return "could not write " + path;
+  }
+  return "";
+}
+
+EngineChoice::EngineChoice()
+  : greedy(GreedyEngine::SEQUENTIAL), thread_count(1), predicted_greedy_us(0), exact(false), exact_max_states(0)
+{}
+
+std::string Milliseconds(double us) {
+  std::stringstream ms;
+  ms << us / 1000 << " ms";
+  return ms.str();
+}
+
+EngineOptions::EngineOptions()
+  : time_budget_us(-1), available_threads(1), sequential_only(false), exact_allowed(false), asked_threads(0), asked_bulk(false), greedy_order(false)
+{}
+
+EngineChoice ChooseEngine(const InstanceProfile& profile, const EngineCalibration& calibration, const EngineOptions& options) {
+  EngineChoice choice;
+  std::stringstream reason;
+
+  const double sequential_us = static_cast<double>(profile.incidences) / calibration.greedy_incidences_per_us;
+  choice.predicted_greedy_us = static_cast<long>(sequential_us);
+
+  // a pick per forced gift, and about one for each average gift's worth of villagers left after them
+  const double average_gift = profile.gifts > 0 ? static_cast<double>(profile.incidences) / static_cast<double>(profile.gifts) : 1;
+  const double predicted_rounds = profile.forced_gifts + static_cast<double>(profile.villagers_left_unforced) / std::max(average_gift, 1.0);
+
+  // the fewest threads predicted to be fastest, trying each power of two
+  unsigned int best_threads = 1;
+  double best_parallel_us = sequential_us;
+  for (unsigned int thread_count = 2; thread_count <= options.available_threads && thread_count > 1; thread_count *= 2) {
+    const double parallel_us = sequential_us / thread_count + predicted_rounds * calibration.parallel_round_us;
+    if (parallel_us < best_parallel_us) {
+      best_threads = thread_count;
+      best_parallel_us = parallel_us;
+    }
+  }
+
+  reason << profile.incidences << " incidences over " << profile.gifts << " gifts and " << profile.villagers << " villagers (density " << profile.density << ", ";
+  reason << profile.forced_gifts << " gifts forced) are predicted to take " << Milliseconds(sequential_us) << " on one thread";
+  if (options.asked_threads > 0 || options.asked_bulk) {
+    choice.thread_count = options.asked_threads > 0 ? options.asked_threads : options.available_threads;
+    choice.greedy = options.asked_bulk ? GreedyEngine::BULK_PARALLEL : choice.thread_count > 1 ? GreedyEngine::PARALLEL : GreedyEngine::SEQUENTIAL;
+    reason << (choice.greedy == GreedyEngine::SEQUENTIAL ? ", and one thread was asked for" : ", but the threads were asked for");
+  }
+  else if (options.sequential_only) {
+    reason << ", and this solve must stay on one thread";
+  }
+  else if (options.available_threads <= 1) {
+    reason << ", and only one core is available";
+  }
+  else if (best_threads <= 1 || best_parallel_us * PARALLEL_MIN_SPEEDUP > sequential_us) {
+    reason << ", too little to share among threads meeting about " << static_cast<unsigned long>(predicted_rounds) << " times";
+  }
+  else {
+    choice.greedy = GreedyEngine::PARALLEL;
+    choice.thread_count = best_threads;
+    choice.predicted_greedy_us = static_cast<long>(best_parallel_us);
+    reason << " and " << Milliseconds(best_parallel_us) << " on " << best_threads;
+
+    if (options.time_budget_us >= 0 && best_parallel_us > static_cast<double>(options.time_budget_us) / 2) {
+      reason << ", over half the time budget of " << Milliseconds(static_cast<double>(options.time_budget_us));
+      if (options.greedy_order) {
+        reason << ", but the picks must stay in greedy order";
+      }
+      else {
+        choice.greedy = GreedyEngine::BULK_PARALLEL;
+        choice.thread_count = options.available_threads;
+      }
+    }
+  }
+
+  if (options.exact_allowed && profile.coverable_villagers <= SMALL_COVER_MAX_VILLAGERS) {
+    const unsigned long budget_states = options.time_budget_us >= 0 ? static_cast<unsigned long>(static_cast<double>(options.time_budget_us) * calibration.exact_states_per_us) : SMALL_COVER_MAX_STATES;
+    choice.exact_max_states = std::min(SMALL_COVER_MAX_STATES, budget_states);
+    if (choice.exact_max_states >= EXACT_MIN_STATES) {
+      choice.exact = true;
+      reason << "; then an exact search, since only " << profile.coverable_villagers << " villagers can be covered";
+      if (choice.exact_max_states < SMALL_COVER_MAX_STATES) {
+        reason << ", reaching at most " << choice.exact_max_states << " covered-sets in the time budget";
+      }
+    }
+  }
+
+  choice.reason = GreedyEngineName(choice.greedy) + (choice.thread_count > 1 ? " on " + std::to_string(choice.thread_count) + " threads" : "") + ": " + reason.str();
+  return choice;
+}
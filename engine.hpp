@@ -0,0 +1,101 @@
+/*
+ * Description: interfaces to choose which engine covers the gifts, from the shape of the data, the time budget and how fast each engine runs on this machine
+ * Author: Laura Galbraith
+*/
+
+#ifndef SVGSC_ENGINE_H
+#define SVGSC_ENGINE_H
+
+#include <string> // string
+#include <cstddef> // size_t
+
+#include "incidence.hpp" // IncidenceStore
+
+// how the greedy picks are made
+enum class GreedyEngine {
+  SEQUENTIAL, // GreedyCover on one thread, through SolverContext, which also solves a liked tier; its picks match the bucket queue's
+  PARALLEL, // ParallelGreedyCover, with exactly the same picks, for data large enough to be worth sharing among threads
+  BULK_PARALLEL // ParallelGreedyCover in bulk rounds, whose picks can differ, for when even the parallel greedy would take most of the time budget
+};
+
+// ex. "sequential greedy"
+std::string GreedyEngineName(GreedyEngine engine);
+
+// What the engine is chosen from, read off the incidence store
+class InstanceProfile {
+  public:
+    // Constructor
+    InstanceProfile();
+
+    // Member variables
+    size_t gifts;
+    size_t villagers;
+    size_t incidences;
+    double density; // incidences out of gifts * villagers
+    unsigned int largest_gift; // villagers the most-loved gift is loved by
+    unsigned int coverable_villagers; // villagers some gift is loved by; the rest stay uncovered whatever is picked
+    unsigned int forced_gifts; // gifts that are the only one some villager loves, which every cover picks
+    unsigned int villagers_left_unforced; // coverable villagers the forced gifts do not cover, which the greedy has to choose gifts for
+};
+
+// O(number of incidences)
+InstanceProfile ProfileInstance(const IncidenceStore& incidences);
+
+// How fast each engine runs on this machine, as measured by 'benchmark.out calibrate'
+class EngineCalibration {
+  public:
+    // Constructor; about what an unoptimized build measures on a small cloud machine, so a choice is still sensible without calibrating
+    EngineCalibration();
+
+    // Member variables
+    double greedy_incidences_per_us; // the sequential greedy's throughput
+    double parallel_round_us; // what each round of the parallel greedy's threads meeting adds, beyond its share of the sequential work
+    double exact_states_per_us; // covered-sets the exact search reaches
+};
+
+// reads a file written by WriteEngineCalibration; returns an error, or empty if successful
+std::string ReadEngineCalibration(const std::string& path, EngineCalibration* calibration);
+
+// returns an error, or empty if successful
+std::string WriteEngineCalibration(const std::string& path, const EngineCalibration& calibration);
+
+// Which engines to run, how, and why
+class EngineChoice {
+  public:
+    // Constructor; the sequential greedy alone
+    EngineChoice();
+
+    // Member variables
+    GreedyEngine greedy;
+    unsigned int thread_count; // for the parallel engines
+    long predicted_greedy_us;
+    bool exact; // follow the greedy picks with SolveSmallCover
+    unsigned long exact_max_states;
+    std::string reason; // one line for the report, ex. "parallel greedy on 4 threads: ..."
+};
+
+// What the caller needs of the engines, besides the data
+class EngineOptions {
+  public:
+    // Constructor; no time budget, one thread, no exact search, nothing asked for
+    EngineOptions();
+
+    // Member variables
+    long time_budget_us; // negative for none
+    unsigned int available_threads;
+    bool sequential_only; // a liked tier, or any solve that must stay on one thread
+    bool exact_allowed; // the picks may be followed by an exact search for a smaller cover
+    unsigned int asked_threads; // if not 0, the greedy runs on this many threads whatever is predicted
+    bool asked_bulk; // the greedy runs in bulk rounds, on asked_threads or else every available thread
+    bool greedy_order; // the picks must come in the order the greedy makes them, as when the first k are read off them, so bulk rounds are never chosen
+};
+
+// Chooses the greedy engine predicted to finish first, from the calibration, unless the threads or bulk rounds were asked for:
+// the parallel greedy costs its share of the sequential work plus a round of the threads meeting per pick, and the picks are guessed from the forced gifts
+// and the villagers left after them over the average gift; bulk rounds are only chosen when the parallel greedy would still take over half the time budget,
+// and the picks need not be in greedy order
+// if the exact search is allowed and few enough villagers can be covered, it follows, limited to the covered-sets the calibration says it can reach in the time budget
+// O(log(available threads))
+EngineChoice ChooseEngine(const InstanceProfile& profile, const EngineCalibration& calibration, const EngineOptions& options);
+
+#endif // SVGSC_ENGINE_H
@@ -0,0 +1,210 @@
+/*
+ * Description: implementation to keep what was extracted from wiki pages, keyed by the page body and what was extracted from it, so an unchanged page is never parsed twice
+ * Author: Laura Galbraith
+*/
+
+#include "extractcache.hpp" // self-include header
+
+#include <string> // string
+#include <vector> // vector
+#include <map> // map
+#include <fstream> // ifstream, ofstream
+#include <sstream> // stringstream
+#include <chrono> // steady_clock, microseconds, duration_cast
+#include <iomanip> // setw, setfill
+#include <cstdio> // rename, remove
+#include <cstdlib> // strtoul
+
+#include "xmlparse.hpp" // GetPrecededAndNestedData, XMLParseResult, XMLParseBackend, XMLItemCallback
+
+// The file is one record per line, with tab-separated fields (names read from the wiki cannot contain tabs or line breaks):
+//   svgsc-extraction-cache <version> <writes so far>
+//   entry <key> <write last used before> <parse microseconds> <name>...
+const std::string EXTRACTION_CACHE_HEADER = "svgsc-extraction-cache";
+const std::string EXTRACTION_CACHE_VERSION = "1";
+const std::string ENTRY_RECORD = "entry";
+const char EXTRACTION_CACHE_FIELD_SEPARATOR = '\t';
+
+ExtractionCacheStats::ExtractionCacheStats()
+  : lookups(0), hits(0), saved_parse_us(0), parse_us(0)
+{}
+
+ExtractionCacheEntry::ExtractionCacheEntry()
+  : parse_us(0), last_used_write(0)
+{}
+
+ExtractionCache::ExtractionCache()
+  : writes(1)
+{}
+
+// FNV-1a: https://en.m.wikipedia.org/wiki/Fowler%E2%80%93Noll%E2%80%93Vo_hash_function
+void HashInto(const std::string& bytes, unsigned long long* hash) {
+  for (char c:bytes) {
+    *hash ^= static_cast<unsigned char>(c);
+    *hash *= 1099511628211ULL;
+  }
+}
+
+// the hash of the spec and body, then the body's length, so a collision would also need the same length
+// each part of the spec is ended by a byte no name contains, so ("ab", "c") and ("a", "bc") differ
+std::string ExtractionKey(const std::string& page_data, const std::string& preceding_element_name, const std::string& preceding_element_data_substring, const std::vector<std::string>& containing_element_names) {
+  unsigned long long hash = 14695981039346656037ULL;
+  HashInto(preceding_element_name + EXTRACTION_CACHE_FIELD_SEPARATOR + preceding_element_data_substring + EXTRACTION_CACHE_FIELD_SEPARATOR, &hash);
+  for (const auto& name:containing_element_names) {
+    HashInto(name + EXTRACTION_CACHE_FIELD_SEPARATOR, &hash);
+  }
+  HashInto("\n", &hash);
+  HashInto(page_data, &hash);
+
+  std::stringstream key;
+  key << std::hex << std::setw(16) << std::setfill('0') << hash << "-" << std::dec << page_data.size();
+  return key.str();
+}
+
+std::vector<std::string> SplitCacheFields(const std::string& line) {
+  std::vector<std::string> fields;
+  std::stringstream stream(line);
+  std::string field;
+  while (std::getline(stream, field, EXTRACTION_CACHE_FIELD_SEPARATOR)) {
+    fields.push_back(field);
+  }
+  return fields;
+}
+
+// returns false if the field is not a whole non-negative number
+bool ParseCacheNumber(const std::string& field, unsigned long* value) {
+  char* end = NULL;
+  *value = std::strtoul(field.c_str(), &end, 10);
+  return !field.empty() && field[0] != '-' && end != NULL && *end == '\0';
+}
+
+std::string ExtractionCache::Read(const std::string& path) {
+  this->entries.clear();
+  this->writes = 1;
+
+  std::ifstream file(path.c_str());
+  if (!file) {
+    return "";
+  }
+
+  std::string line;
+  std::vector<std::string> fields;
+  unsigned long written = 0;
+  if (std::getline(file, line)) {
+    fields = SplitCacheFields(line);
+  }
+  if (fields.size() != 3 || fields[0] != EXTRACTION_CACHE_HEADER || fields[1] != EXTRACTION_CACHE_VERSION || !ParseCacheNumber(fields[2], &written)) {
+    return path + " is not a version " + EXTRACTION_CACHE_VERSION + " extraction cache";
+  }
+
+  unsigned long line_number = 1;
+  while (std::getline(file, line)) {
+    ++line_number;
+    fields = SplitCacheFields(line);
+    unsigned long last_used_write = 0;
+    unsigned long parse_us = 0;
+    if (fields.size() < 4 || fields[0] != ENTRY_RECORD || !ParseCacheNumber(fields[2], &last_used_write) || !ParseCacheNumber(fields[3], &parse_us)) {
+      this->entries.clear();
+      std::stringstream error;
+      error << path << " line " << line_number << " is not a valid " << ENTRY_RECORD << " record";
+      return error.str();
+    }
+
+    ExtractionCacheEntry& entry = this->entries[fields[1]];
+    entry.names.assign(fields.begin() + 4, fields.end());
+    entry.parse_us = static_cast<long>(parse_us);
+    entry.last_used_write = last_used_write;
+  }
+
+  this->writes = written + 1;
+  return "";
+}
+
+std::string ExtractionCache::Write(const std::string& path) {
+  const std::string temporary_path = path + ".tmp";
+  std::ofstream file(temporary_path.c_str(), std::ios::trunc);
+  if (!file) {
+    return "could not write " + temporary_path;
+  }
+
+  file << EXTRACTION_CACHE_HEADER << EXTRACTION_CACHE_FIELD_SEPARATOR << EXTRACTION_CACHE_VERSION << EXTRACTION_CACHE_FIELD_SEPARATOR << this->writes << '\n';
+  for (auto entry_it = this->entries.begin(); entry_it != this->entries.end();) {
+    if (this->writes - entry_it->second.last_used_write >= EXTRACTION_CACHE_MAX_IDLE_WRITES) {
+      entry_it = this->entries.erase(entry_it);
+      continue;
+    }
+
+    file << ENTRY_RECORD << EXTRACTION_CACHE_FIELD_SEPARATOR << entry_it->first << EXTRACTION_CACHE_FIELD_SEPARATOR << entry_it->second.last_used_write;
+    file << EXTRACTION_CACHE_FIELD_SEPARATOR << entry_it->second.parse_us;
+    for (const auto& name:entry_it->second.names) {
+      file << EXTRACTION_CACHE_FIELD_SEPARATOR << name;
+    }
+    file << '\n';
+    ++entry_it;
+  }
+  file.close();
+
+  if (!file) {
+    std::remove(temporary_path.c_str());
+    return "could not write " + temporary_path;
+  }
+  if (std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+    std::remove(temporary_path.c_str());
+    return "could not replace " + path;
+  }
+
+  ++this->writes;
+  return "";
+}
+
+XMLParseResult ExtractionCache::Extract(
+  const std::string& page_data,
+  const std::string& preceding_element_name,
+  const std::string& preceding_element_data_substring,
+  const std::vector<std::string>& containing_element_names,
+  XMLParseBackend backend,
+  const XMLItemCallback& on_item)
+{
+  const std::string key = ExtractionKey(page_data, preceding_element_name, preceding_element_data_substring, containing_element_names);
+  ++this->stats.lookups;
+
+  auto found = this->entries.find(key);
+  if (found != this->entries.end() && backend != XMLParseBackend::VERIFY) {
+    ++this->stats.hits;
+    this->stats.saved_parse_us += found->second.parse_us;
+    found->second.last_used_write = this->writes;
+    if (on_item) {
+      for (const auto& name:found->second.names) {
+        on_item(name);
+      }
+    }
+    return XMLParseResult(found->second.names, "");
+  }
+
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  XMLParseResult result = GetPrecededAndNestedData(page_data, preceding_element_name, preceding_element_data_substring, containing_element_names, backend, on_item);
+  const long parse_us = static_cast<long>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+  this->stats.parse_us += parse_us;
+
+  // a name that could not be stored in the file is not cached, and nor is a failed parse, so it is tried again next time
+  bool storable = result.error == "";
+  for (const auto& name:result.data) {
+    storable = storable && !name.empty() && name.find_first_of("\t\r\n") == std::string::npos;
+  }
+  if (storable) {
+    ExtractionCacheEntry& entry = this->entries[key];
+    entry.names = result.data;
+    entry.parse_us = parse_us;
+    entry.last_used_write = this->writes;
+  }
+
+  return result;
+}
+
+const ExtractionCacheStats& ExtractionCache::Stats() const {
+  return this->stats;
+}
+
+size_t ExtractionCache::Size() const {
+  return this->entries.size();
+}
@@ -0,0 +1,82 @@
+/*
+ * Description: interfaces to keep what was extracted from wiki pages, keyed by the page body and what was extracted from it, so an unchanged page is never parsed twice
+ * Documentation: of content addressing: https://en.m.wikipedia.org/wiki/Content-addressable_storage
+ * Author: Laura Galbraith
+*/
+
+#ifndef SVGSC_EXTRACT_CACHE_H
+#define SVGSC_EXTRACT_CACHE_H
+
+#include <string> // string
+#include <vector> // vector
+#include <map> // map
+
+#include "xmlparse.hpp" // XMLParseResult, XMLParseBackend, XMLItemCallback
+
+// an entry not used by this many runs that wrote the cache is dropped
+const unsigned long EXTRACTION_CACHE_MAX_IDLE_WRITES = 8;
+
+// Running totals of an ExtractionCache's use since it was read
+class ExtractionCacheStats {
+  public:
+    // Constructor
+    ExtractionCacheStats();
+
+    // Member variables
+    unsigned long lookups;
+    unsigned long hits;
+    long saved_parse_us; // what the hits took to parse when they were first extracted
+    long parse_us; // spent parsing the misses
+};
+
+// One extraction's names, what it took to parse, and the write of the file it was last used before
+class ExtractionCacheEntry {
+  public:
+    // Constructor
+    ExtractionCacheEntry();
+
+    // Member variables
+    std::vector<std::string> names;
+    long parse_us;
+    unsigned long last_used_write;
+};
+
+// Names extracted from pages by GetPrecededAndNestedData, keyed by a hash of the extraction spec and the page body,
+// so a page whose body has not changed is not parsed again, even when it was downloaded again
+// entries not used for EXTRACTION_CACHE_MAX_IDLE_WRITES writes of the file are dropped, so the old bodies of pages that changed do not pile up
+// not thread-safe
+class ExtractionCache {
+  public:
+    // Constructor; an empty cache
+    ExtractionCache();
+
+    // reads a cache written by Write; a file that does not exist yet reads as an empty cache
+    // returns an error, or empty if successful
+    std::string Read(const std::string& path);
+
+    // replaces the file with the cache, so an interrupted write never leaves a partial file behind
+    // returns an error, or empty if successful
+    std::string Write(const std::string& path);
+
+    // GetPrecededAndNestedData, from the cache when the same page body has been extracted from the same way before
+    // only results without an error are kept; with XMLParseBackend::VERIFY the page is always parsed, so the backends are still compared
+    // on a hit, on_item is passed each cached name in turn before returning
+    // O(length of the page) to hash it on a hit, plus the parse on a miss
+    XMLParseResult Extract(
+      const std::string& page_data,
+      const std::string& preceding_element_name,
+      const std::string& preceding_element_data_substring,
+      const std::vector<std::string>& containing_element_names,
+      XMLParseBackend backend,
+      const XMLItemCallback& on_item = nullptr);
+
+    const ExtractionCacheStats& Stats() const;
+    size_t Size() const;
+
+  private:
+    std::map<std::string, ExtractionCacheEntry> entries; // by key, the hash and length of the spec and page body
+    unsigned long writes; // of the file this cache was read from, including the next one
+    ExtractionCacheStats stats;
+};
+
+#endif // SVGSC_EXTRACT_CACHE_H
@@ -0,0 +1,132 @@
+/*
+ * Description: implementation to greedy set-cover directly over the incidence store's IDs
+ * Author: Laura Galbraith
+*/
+
+#include "greedy.hpp" // self-include header
+
+#include <vector> // vector
+#include <tuple> // pair
+#include <algorithm> // make_heap, push_heap, pop_heap
+
+#include "incidence.hpp" // IncidenceStore
+#include "output.hpp" // GiftSolution
+#include "perfcounters.hpp" // SVGSC_PERF_REGION
+
+// orders the heap by gain, then by lowest gift ID
+class GainOrder {
+  public:
+    bool operator()(const std::pair<unsigned int, unsigned int>& a, const std::pair<unsigned int, unsigned int>& b) const {
+      return a.first < b.first || (a.first == b.first && a.second > b.second);
+    }
+};
+
+GreedyScratch::GreedyScratch()
+{}
+
+void GreedyCover(const IncidenceStore& incidences, const std::vector<unsigned int>* candidate_gift_ids, GiftSolution* solution) {
+  GreedyScratch scratch;
+  scratch.covered.assign(incidences.VillagerCount(), false);
+  GreedyCoverFrom(incidences, candidate_gift_ids, &scratch, solution);
+}
+
+// gives each candidate gift its gain among the villagers not yet covered, and adds those with any to the heap, ordered as the priority_queue GreedyCover used to keep
+void KeyGifts(const IncidenceStore& incidences, const std::vector<unsigned int>* candidate_gift_ids, GreedyScratch* scratch) {
+  SVGSC_PERF_REGION("greedy queue build");
+  const std::vector<bool>& covered = scratch->covered;
+  std::vector<unsigned int>& gains = scratch->gains;
+  std::vector<std::pair<unsigned int, unsigned int>>& heap = scratch->heap;
+  const unsigned int gift_count = static_cast<unsigned int>(incidences.GiftCount());
+  const unsigned int candidate_count = candidate_gift_ids != NULL ? static_cast<unsigned int>(candidate_gift_ids->size()) : gift_count;
+  for (unsigned int candidate_i = 0; candidate_i < candidate_count; ++candidate_i) {
+    const unsigned int gift_id = candidate_gift_ids != NULL ? (*candidate_gift_ids)[candidate_i] : candidate_i;
+    gains[gift_id] = 0;
+    for (const unsigned int* v_it = incidences.GiftVillagersBegin(gift_id); v_it != incidences.GiftVillagersEnd(gift_id); ++v_it) {
+      gains[gift_id] += covered[*v_it] ? 0 : 1;
+    }
+    if (gains[gift_id] > 0) {
+      heap.push_back(std::pair<unsigned int, unsigned int>(gains[gift_id], gift_id));
+    }
+  }
+  std::make_heap(heap.begin(), heap.end(), GainOrder());
+}
+
+// picks from the heap until no gift covers anyone new, which leaves it empty
+void PickFromHeap(const IncidenceStore& incidences, GreedyScratch* scratch, GiftSolution* solution) {
+  std::vector<bool>& covered = scratch->covered;
+  std::vector<unsigned int>& gains = scratch->gains;
+  std::vector<std::pair<unsigned int, unsigned int>>& heap = scratch->heap;
+  while (!heap.empty()) {
+    // each top taken off the heap, whether stale or picked, with its update
+    SVGSC_PERF_REGION("greedy pick");
+    std::pop_heap(heap.begin(), heap.end(), GainOrder());
+    const std::pair<unsigned int, unsigned int> top = heap.back();
+    heap.pop_back();
+
+    // a stale gain goes back in at its current value; every other gift's true gain is at most what it was pushed with, so a current top is the best
+    const unsigned int gift_id = top.second;
+    if (top.first != gains[gift_id]) {
+      if (gains[gift_id] > 0) {
+        heap.push_back(std::pair<unsigned int, unsigned int>(gains[gift_id], gift_id));
+        std::push_heap(heap.begin(), heap.end(), GainOrder());
+      }
+      continue;
+    }
+
+    solution->AddGift(gift_id);
+    SVGSC_PERF_REGION("greedy set update");
+    for (const unsigned int* v_it = incidences.GiftVillagersBegin(gift_id); v_it != incidences.GiftVillagersEnd(gift_id); ++v_it) {
+      if (covered[*v_it]) {
+        continue;
+      }
+      covered[*v_it] = true;
+      solution->villager_ids.push_back(*v_it);
+
+      for (const unsigned int* g_it = incidences.VillagerGiftsBegin(*v_it); g_it != incidences.VillagerGiftsEnd(*v_it); ++g_it) {
+        if (gains[*g_it] > 0) {
+          --gains[*g_it];
+        }
+      }
+    }
+  }
+}
+
+void ListUncovered(const GreedyScratch& scratch, GiftSolution* solution) {
+  for (unsigned int villager_id = 0; villager_id < scratch.covered.size(); ++villager_id) {
+    if (!scratch.covered[villager_id]) {
+      solution->uncovered_villager_ids.push_back(villager_id);
+    }
+  }
+}
+
+void GreedyCoverFrom(const IncidenceStore& incidences, const std::vector<unsigned int>* candidate_gift_ids, GreedyScratch* scratch, GiftSolution* solution) {
+  // in memory kept between solves
+  scratch->gains.assign(incidences.GiftCount(), 0);
+  scratch->heap.resize(0);
+  KeyGifts(incidences, candidate_gift_ids, scratch);
+  PickFromHeap(incidences, scratch, solution);
+  ListUncovered(*scratch, solution);
+}
+
+void GreedyCoverNextTier(const IncidenceStore& tier_incidences, const std::vector<unsigned int>& picked_gift_ids, const std::vector<unsigned int>* candidate_gift_ids, GreedyScratch* scratch, GiftSolution* solution) {
+  // the gifts already picked give what they can first
+  for (auto g:picked_gift_ids) {
+    bool added = false;
+    for (const unsigned int* v_it = tier_incidences.GiftVillagersBegin(g); v_it != tier_incidences.GiftVillagersEnd(g); ++v_it) {
+      if (scratch->covered[*v_it]) {
+        continue;
+      }
+      if (!added) {
+        solution->AddGift(g);
+        added = true;
+      }
+      scratch->covered[*v_it] = true;
+      solution->villager_ids.push_back(*v_it);
+    }
+  }
+
+  // then the tier's sets are keyed into the heap the last tier left empty, each gain counted again among the villagers still uncovered
+  KeyGifts(tier_incidences, candidate_gift_ids, scratch);
+  PickFromHeap(tier_incidences, scratch, solution);
+  ListUncovered(*scratch, solution);
+}
@@ -0,0 +1,48 @@
+/*
+ * Description: interface to greedy set-cover directly over the incidence store's IDs
+ * Documentation: of the technique: https://en.m.wikipedia.org/wiki/Set_cover_problem#Greedy_algorithm
+ * Author: Laura Galbraith
+*/
+
+#ifndef SVGSC_GREEDY_H
+#define SVGSC_GREEDY_H
+
+#include <vector> // vector
+#include <tuple> // pair
+
+#include "incidence.hpp" // IncidenceStore
+#include "output.hpp" // GiftSolution
+
+// Working memory for GreedyCoverFrom, kept between solves so that once it has grown to fit, a solve allocates nothing
+class GreedyScratch {
+  public:
+    // Constructor
+    GreedyScratch();
+
+    // Member variables
+    std::vector<bool> covered; // one per villager: read on entry, and every villager the solve covers is added
+    std::vector<unsigned int> gains; // villagers each candidate gift is loved by that are not covered
+    std::vector<std::pair<unsigned int, unsigned int>> heap; // (gain when pushed, gift ID)
+};
+
+// Greedy set-cover without building a set of names per gift, for instances too large for the bucket queue of GiftForVillagers:
+// the gift loved by the most uncovered villagers goes first, ties going to the lowest gift ID, so with IDs in name order the picks match the bucket queue's
+// gains are kept in a max-heap and only brought up to date when a gift reaches the top, since they only ever fall
+// adds each gift picked to the solution with the villagers it newly covers, in ID order, then every villager left uncovered
+// only the candidate gifts are considered, or every gift if candidate_gift_ids is NULL
+// O(number of incidences * log(number of gifts))
+void GreedyCover(const IncidenceStore& incidences, const std::vector<unsigned int>* candidate_gift_ids, GiftSolution* solution);
+
+// the same, on the scratch's memory, going on from the villagers already covered in it: they are neither given a gift nor listed as uncovered
+// the scratch must have a covered flag for every villager
+void GreedyCoverFrom(const IncidenceStore& incidences, const std::vector<unsigned int>* candidate_gift_ids, GreedyScratch* scratch, GiftSolution* solution);
+
+// carries a cover finished by GreedyCoverFrom on into the next tier of sets, such as liked gifts after loved ones, over the same gift and villager IDs:
+// the scratch's covered villagers carry on rather than starting again, so the villagers the last tier covered are never given a gift in this one; its gains and heap
+// keep their memory, but each candidate's gain is counted again over its tier set, since the last tier's gains were over different sets
+// first the gifts in picked_gift_ids give the tier's villagers they reach, since they add no gift types, then the candidates' tier sets are keyed into the heap
+// at their gains among the villagers still uncovered, and picked greedily; every gift is added to the solution, then every villager left uncovered
+// O(number of tier incidences * log(number of gifts))
+void GreedyCoverNextTier(const IncidenceStore& tier_incidences, const std::vector<unsigned int>& picked_gift_ids, const std::vector<unsigned int>* candidate_gift_ids, GreedyScratch* scratch, GiftSolution* solution);
+
+#endif // SVGSC_GREEDY_H
@@ -0,0 +1,624 @@
+/*
+ * Description: implementations to scan HTML page data without building a document
+ * Documentation/references:
+ *    - libxml2 HTML parser behavior being matched: http://xmlsoft.org/html/libxml-HTMLparser.html
+ *    - SSE2 byte comparison intrinsics: https://www.intel.com/content/www/us/en/docs/intrinsics-guide/
+ * Author: Laura Galbraith
+*/
+
+#include "htmlscan.hpp" // self-include header
+
+#include <cstddef> // size_t
+#include <cstring> // memchr, memcmp, strlen
+#include <cctype> // tolower
+#include <bitset> // bitset
+
+#if defined(__SSE2__)
+#include <emmintrin.h> // __m128i, _mm_set1_epi8, _mm_loadu_si128, _mm_cmpeq_epi8, _mm_or_si128, _mm_movemask_epi8
+#endif
+
+TextSlice::TextSlice()
+  : data(NULL), size(0)
+{}
+
+TextSlice::TextSlice(const char* slice_data, size_t slice_size)
+  : data(slice_data), size(slice_size)
+{}
+
+HTMLScanEvent::HTMLScanEvent()
+  : type(CHARACTERS)
+{}
+
+// returns the first position holding either byte, or end
+// character data runs are usually long, so compare 16 bytes at a time where the CPU allows it
+static const char* FindEitherByte(const char* p, const char* end, char a, char b) {
+#if defined(__SSE2__)
+  const __m128i a_v = _mm_set1_epi8(a);
+  const __m128i b_v = _mm_set1_epi8(b);
+  while (end - p >= 16) {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const int matches = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, a_v), _mm_cmpeq_epi8(chunk, b_v)));
+    if (matches != 0) {
+      return p + __builtin_ctz(static_cast<unsigned int>(matches));
+    }
+    p += 16;
+  }
+#endif
+
+  while (p < end && *p != a && *p != b) {
+    ++p;
+  }
+  return p;
+}
+
+// memchr is vectorized by the C library
+static const char* FindByte(const char* p, const char* end, char c) {
+  const void* found = std::memchr(p, c, static_cast<size_t>(end - p));
+  return found != NULL ? static_cast<const char*>(found) : end;
+}
+
+// case-insensitive comparison of an element name from the page against another
+static bool SameName(const TextSlice& a, const char* b, size_t b_size) {
+  if (a.size != b_size) {
+    return false;
+  }
+
+  for (size_t i = 0; i < b_size; ++i) {
+    if (std::tolower(static_cast<unsigned char>(a.data[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool IsBlank(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static bool IsNameStart(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == ':' || c == '.';
+}
+
+static bool IsNameChar(char c) {
+  return IsNameStart(c) || (c >= '0' && c <= '9') || c == '-';
+}
+
+// elements libxml2 ends as soon as they start
+static const char* const VOID_ELEMENTS[] = {
+  "area", "base", "basefont", "br", "col", "embed", "frame", "hr", "img", "input", "isindex", "link", "meta", "param", NULL
+};
+
+// elements whose contents are not markup
+static const char* const RAW_TEXT_ELEMENTS[] = {"script", "style", NULL};
+
+// libxml2's htmlStartClose table: each new element, then the open elements it implicitly ends while they are innermost
+#define SVGSC_FONTSTYLE "tt", "i", "b", "u", "s", "strike", "big", "small"
+static const char* const START_CLOSES[] = {
+  "form", "form", "p", "hr", "h1", "h2", "h3", "h4", "h5", "h6", "dl", "ul", "ol", "menu", "dir", "address", "pre", "listing", "xmp", "head", NULL,
+  "head", "p", NULL,
+  "title", "p", NULL,
+  "body", "head", "style", "script", "title", NULL,
+  "frameset", "head", "style", "script", "title", NULL,
+  "li", "p", "h1", "h2", "h3", "h4", "h5", "h6", "dl", "address", "pre", "listing", "xmp", "head", "li", NULL,
+  "hr", "p", "head", NULL,
+  "h1", "p", "head", "h2", "h3", "h4", "h5", "h6", NULL,
+  "h2", "p", "head", "h1", "h3", "h4", "h5", "h6", NULL,
+  "h3", "p", "head", "h1", "h2", "h4", "h5", "h6", NULL,
+  "h4", "p", "head", "h1", "h2", "h3", "h5", "h6", NULL,
+  "h5", "p", "head", "h1", "h2", "h3", "h4", "h6", NULL,
+  "h6", "p", "head", "h1", "h2", "h3", "h4", "h5", NULL,
+  "dir", "p", "head", NULL,
+  "address", "p", "head", "ul", NULL,
+  "pre", "p", "head", "ul", NULL,
+  "listing", "p", "head", NULL,
+  "xmp", "p", NULL,
+  "blockquote", "p", "head", NULL,
+  "dl", "p", "dt", "menu", "dir", "address", "pre", "listing", "xmp", "head", NULL,
+  "dt", "p", "menu", "dir", "address", "pre", "listing", "xmp", "head", "dd", NULL,
+  "dd", "p", "menu", "dir", "address", "pre", "listing", "xmp", "head", "dt", NULL,
+  "ul", "p", "head", "ol", "menu", "dir", "address", "pre", "listing", "xmp", NULL,
+  "ol", "p", "head", "ul", NULL,
+  "menu", "p", "head", "ul", NULL,
+  "p", "p", "head", "h1", "h2", "h3", "h4", "h5", "h6", SVGSC_FONTSTYLE, NULL,
+  "div", "p", "head", NULL,
+  "noscript", "script", NULL,
+  "center", "font", "b", "i", "p", "head", NULL,
+  "a", "a", "head", NULL,
+  "caption", "p", NULL,
+  "colgroup", "caption", "colgroup", "col", "p", NULL,
+  "col", "caption", "col", "p", NULL,
+  "table", "p", "head", "h1", "h2", "h3", "h4", "h5", "h6", "pre", "listing", "xmp", "a", NULL,
+  "th", "th", "td", "p", "span", "font", "a", "b", "i", "u", NULL,
+  "td", "th", "td", "p", "span", "font", "a", "b", "i", "u", NULL,
+  "tr", "th", "td", "tr", "caption", "col", "colgroup", "p", NULL,
+  "thead", "caption", "col", "colgroup", NULL,
+  "tfoot", "th", "td", "tr", "caption", "col", "colgroup", "thead", "tbody", "p", NULL,
+  "tbody", "th", "td", "tr", "caption", "col", "colgroup", "thead", "tfoot", "tbody", "p", NULL,
+  "optgroup", "option", NULL,
+  "option", "option", NULL,
+  "fieldset", "legend", "p", "head", "h1", "h2", "h3", "h4", "h5", "h6", "pre", "listing", "xmp", "a", NULL,
+  NULL
+};
+#undef SVGSC_FONTSTYLE
+
+// libxml2's htmlEndPriority: an end tag will not implicitly end open elements of higher priority
+static const int DEFAULT_END_PRIORITY = 100;
+static const char* const END_PRIORITY_NAMES[] = {"div", "td", "th", "tr", "thead", "tbody", "tfoot", "table", "head", "body", "html", NULL};
+static const int END_PRIORITIES[] = {150, 160, 160, 170, 180, 180, 180, 190, 200, 200, 220};
+
+// The elements named in the tables above, so each tag is looked up once by hash rather than compared against every table entry
+class KnownTags {
+  public:
+    KnownTags()
+    : count(0)
+    {
+      for (size_t slot_i = 0; slot_i < KnownTags::HASH_SLOTS; ++slot_i) {
+        this->slots[slot_i] = UNKNOWN_TAG;
+      }
+
+      for (const char* const* v = VOID_ELEMENTS; *v != NULL; ++v) {
+        this->flags[this->Intern(*v)] |= KnownTags::VOID_FLAG;
+      }
+      for (const char* const* r = RAW_TEXT_ELEMENTS; *r != NULL; ++r) {
+        this->flags[this->Intern(*r)] |= KnownTags::RAW_TEXT_FLAG;
+      }
+      for (size_t priority_i = 0; END_PRIORITY_NAMES[priority_i] != NULL; ++priority_i) {
+        this->priorities[this->Intern(END_PRIORITY_NAMES[priority_i])] = END_PRIORITIES[priority_i];
+      }
+
+      const char* const* entry = START_CLOSES;
+      while (*entry != NULL) {
+        const int new_id = this->Intern(*entry);
+        for (++entry; *entry != NULL; ++entry) {
+          this->closes[new_id].set(static_cast<size_t>(this->Intern(*entry)));
+        }
+        ++entry; // past the NULL ending this element's list
+      }
+    }
+
+    // returns UNKNOWN_TAG for elements in none of the tables
+    int Find(const char* name, size_t name_size) const {
+      if (name_size == 0 || name_size > KnownTags::MAX_NAME_SIZE) {
+        return UNKNOWN_TAG;
+      }
+
+      char lowercase[KnownTags::MAX_NAME_SIZE];
+      for (size_t i = 0; i < name_size; ++i) {
+        lowercase[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(name[i])));
+      }
+
+      for (size_t slot_i = KnownTags::Hash(lowercase, name_size); this->slots[slot_i] != UNKNOWN_TAG; slot_i = (slot_i+1) % KnownTags::HASH_SLOTS) {
+        const char* known = this->names[this->slots[slot_i]];
+        if (std::strlen(known) == name_size && std::memcmp(known, lowercase, name_size) == 0) {
+          return this->slots[slot_i];
+        }
+      }
+
+      return UNKNOWN_TAG;
+    }
+
+    bool IsVoid(int id) const {
+      return id != UNKNOWN_TAG && (this->flags[id] & KnownTags::VOID_FLAG) != 0;
+    }
+
+    bool IsRawText(int id) const {
+      return id != UNKNOWN_TAG && (this->flags[id] & KnownTags::RAW_TEXT_FLAG) != 0;
+    }
+
+    int EndPriority(int id) const {
+      return id != UNKNOWN_TAG ? this->priorities[id] : DEFAULT_END_PRIORITY;
+    }
+
+    // returns whether starting new_id implicitly ends the innermost open element old_id
+    bool StartCloses(int new_id, int old_id) const {
+      return new_id != UNKNOWN_TAG && old_id != UNKNOWN_TAG && this->closes[new_id].test(static_cast<size_t>(old_id));
+    }
+
+    static const int UNKNOWN_TAG = -1;
+
+  private:
+    int Intern(const char* lowercase_name) {
+      const size_t name_size = std::strlen(lowercase_name);
+      const int existing = this->Find(lowercase_name, name_size);
+      if (existing != UNKNOWN_TAG) {
+        return existing;
+      }
+
+      const int id = static_cast<int>(this->count);
+      this->names[id] = lowercase_name;
+      this->flags[id] = 0;
+      this->priorities[id] = DEFAULT_END_PRIORITY;
+      ++this->count;
+
+      size_t slot_i = KnownTags::Hash(lowercase_name, name_size);
+      while (this->slots[slot_i] != UNKNOWN_TAG) {
+        slot_i = (slot_i+1) % KnownTags::HASH_SLOTS;
+      }
+      this->slots[slot_i] = id;
+
+      return id;
+    }
+
+    // FNV-1a: https://en.wikipedia.org/wiki/Fowler%E2%80%93Noll%E2%80%93Vo_hash_function
+    static size_t Hash(const char* lowercase_name, size_t name_size) {
+      unsigned int h = 2166136261u;
+      for (size_t i = 0; i < name_size; ++i) {
+        h = (h ^ static_cast<unsigned char>(lowercase_name[i])) * 16777619u;
+      }
+      return h % KnownTags::HASH_SLOTS;
+    }
+
+    static const size_t MAX_TAGS = 128;
+    static const size_t HASH_SLOTS = 256;
+    static const size_t MAX_NAME_SIZE = 16;
+    static const unsigned char VOID_FLAG = 1;
+    static const unsigned char RAW_TEXT_FLAG = 2;
+
+    const char* names[MAX_TAGS];
+    size_t count;
+    unsigned char flags[MAX_TAGS];
+    int priorities[MAX_TAGS];
+    std::bitset<MAX_TAGS> closes[MAX_TAGS];
+    int slots[HASH_SLOTS];
+};
+
+static const KnownTags& Tags() {
+  static const KnownTags tags;
+  return tags;
+}
+
+// named character references, with their UTF-8 encodings
+static const char* const NAMED_REFERENCES[] = {
+  "amp", "&", "lt", "<", "gt", ">", "quot", "\"", "apos", "'",
+  "nbsp", "\xC2\xA0", "copy", "\xC2\xA9", "reg", "\xC2\xAE", "times", "\xC3\x97", "middot", "\xC2\xB7",
+  "eacute", "\xC3\xA9", "ntilde", "\xC3\xB1", "ndash", "\xE2\x80\x93", "mdash", "\xE2\x80\x94",
+  "lsquo", "\xE2\x80\x98", "rsquo", "\xE2\x80\x99", "ldquo", "\xE2\x80\x9C", "rdquo", "\xE2\x80\x9D",
+  "bull", "\xE2\x80\xA2", "hellip", "\xE2\x80\xA6", "rarr", "\xE2\x86\x92", "larr", "\xE2\x86\x90",
+  NULL
+};
+
+HTMLScanner::HTMLScanner(const char* page_data, size_t page_size)
+  : pos(page_data),
+    end(page_data + page_size),
+    open_count(0),
+    overflow_count(0),
+    element_seen(false),
+    pending_next(0),
+    pending_count(0)
+{}
+
+bool HTMLScanner::Next(HTMLScanEvent* event) {
+  while (true) {
+    if (this->PopPending(event)) {
+      return true;
+    }
+
+    if (this->pos >= this->end) {
+      // end every element still open, innermost first; names nested past the capacity are unknown, so those are dropped
+      if (this->overflow_count > 0) {
+        --this->overflow_count;
+        continue;
+      }
+      if (this->open_count > 0) {
+        this->QueueEnd(this->open_elements[this->open_count-1]);
+        continue;
+      }
+      return false;
+    }
+
+    if (*this->pos == '<') {
+      if (this->ScanMarkup(event)) {
+        return true;
+      }
+    }
+    else if (*this->pos == '&') {
+      if (this->ScanReference(event)) {
+        return true;
+      }
+    }
+    else if (this->ScanCharacters(event)) {
+      return true;
+    }
+  }
+}
+
+// returns whether an event was produced; comments and declarations produce none
+bool HTMLScanner::ScanMarkup(HTMLScanEvent* event) {
+  const char* p = this->pos + 1;
+
+  if (p < this->end && *p == '!') {
+    if (this->end - p >= 3 && p[1] == '-' && p[2] == '-') {
+      // comment: skip past the next "-->"
+      const char* c = p + 3;
+      while (true) {
+        c = FindByte(c, this->end, '>');
+        if (c >= this->end || (c - p >= 5 && c[-1] == '-' && c[-2] == '-')) {
+          break;
+        }
+        ++c;
+      }
+      this->pos = c < this->end ? c+1 : this->end;
+      return false;
+    }
+
+    // doctype or other declaration
+    const char* close = FindByte(p, this->end, '>');
+    this->pos = close < this->end ? close+1 : this->end;
+    return false;
+  }
+  else if (p < this->end && *p == '?') {
+    const char* close = FindByte(p, this->end, '>');
+    this->pos = close < this->end ? close+1 : this->end;
+    return false;
+  }
+
+  const bool is_end_tag = p < this->end && *p == '/';
+  if (is_end_tag) {
+    ++p;
+  }
+
+  // a '<' that does not start a tag is just text
+  if (p >= this->end || !IsNameStart(*p)) {
+    event->type = HTMLScanEvent::CHARACTERS;
+    event->text = TextSlice(this->pos, 1);
+    ++this->pos;
+    return true;
+  }
+
+  const char* name = p;
+  while (p < this->end && IsNameChar(*p)) {
+    ++p;
+  }
+  const size_t name_size = static_cast<size_t>(p - name);
+
+  // skip attributes, not stopping at a '>' inside a quoted value
+  bool self_closing = false;
+  while (p < this->end && *p != '>') {
+    if (*p == '"' || *p == '\'') {
+      p = FindByte(p+1, this->end, *p);
+      if (p >= this->end) {
+        break;
+      }
+    }
+    ++p;
+  }
+  if (p < this->end) {
+    self_closing = p[-1] == '/';
+    ++p;
+  }
+  this->pos = p;
+
+  const int tag_id = Tags().Find(name, name_size);
+  if (is_end_tag) {
+    this->ScanEndTag(name, name_size, tag_id);
+  }
+  else {
+    this->ScanStartTag(name, name_size, tag_id);
+    if (self_closing || Tags().IsVoid(tag_id)) {
+      this->QueueEnd(TextSlice(name, name_size));
+    }
+    else if (Tags().IsRawText(tag_id)) {
+      this->QueueRawText();
+    }
+  }
+
+  return this->PopPending(event);
+}
+
+bool HTMLScanner::ScanCharacters(HTMLScanEvent* event) {
+  const char* run_end = FindEitherByte(this->pos, this->end, '<', '&');
+
+  // like libxml2, whitespace before the first element is not reported
+  if (!this->element_seen) {
+    const char* p = this->pos;
+    while (p < run_end && IsBlank(*p)) {
+      ++p;
+    }
+    if (p == run_end) {
+      this->pos = run_end;
+      return false;
+    }
+  }
+
+  event->type = HTMLScanEvent::CHARACTERS;
+  event->text = TextSlice(this->pos, static_cast<size_t>(run_end - this->pos));
+  this->pos = run_end;
+  return true;
+}
+
+// decodes a character reference the way libxml2 reports it: the referenced character on its own,
+// or "&" and the unknown name as two separate runs
+bool HTMLScanner::ScanReference(HTMLScanEvent* event) {
+  const char* p = this->pos + 1;
+  event->type = HTMLScanEvent::CHARACTERS;
+
+  if (p < this->end && *p == '#') {
+    ++p;
+    const bool hex = p < this->end && (*p == 'x' || *p == 'X');
+    if (hex) {
+      ++p;
+    }
+
+    unsigned long code_point = 0;
+    while (p < this->end) {
+      const char c = *p;
+      if (c >= '0' && c <= '9') {
+        code_point = code_point * (hex ? 16 : 10) + static_cast<unsigned long>(c - '0');
+      }
+      else if (hex && c >= 'a' && c <= 'f') {
+        code_point = code_point * 16 + static_cast<unsigned long>(c - 'a' + 10);
+      }
+      else if (hex && c >= 'A' && c <= 'F') {
+        code_point = code_point * 16 + static_cast<unsigned long>(c - 'A' + 10);
+      }
+      else {
+        break;
+      }
+      if (code_point > 0x10FFFF) {
+        code_point = 0;
+        break;
+      }
+      ++p;
+    }
+    if (p < this->end && *p == ';') {
+      ++p;
+    }
+    this->pos = p;
+
+    // invalid references report nothing
+    if (code_point == 0) {
+      return false;
+    }
+
+    size_t size = 0;
+    if (code_point < 0x80) {
+      this->reference_buffer[size++] = static_cast<char>(code_point);
+    }
+    else if (code_point < 0x800) {
+      this->reference_buffer[size++] = static_cast<char>(0xC0 | (code_point >> 6));
+      this->reference_buffer[size++] = static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+    else if (code_point < 0x10000) {
+      this->reference_buffer[size++] = static_cast<char>(0xE0 | (code_point >> 12));
+      this->reference_buffer[size++] = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+      this->reference_buffer[size++] = static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+    else {
+      this->reference_buffer[size++] = static_cast<char>(0xF0 | (code_point >> 18));
+      this->reference_buffer[size++] = static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+      this->reference_buffer[size++] = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+      this->reference_buffer[size++] = static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+    event->text = TextSlice(this->reference_buffer, size);
+    return true;
+  }
+
+  const char* name = p;
+  if (p < this->end && IsNameStart(*p)) {
+    while (p < this->end && IsNameChar(*p)) {
+      ++p;
+    }
+  }
+  const size_t name_size = static_cast<size_t>(p - name);
+
+  if (name_size > 0 && p < this->end && *p == ';') {
+    for (const char* const* r = NAMED_REFERENCES; *r != NULL; r += 2) {
+      if (std::strlen(r[0]) == name_size && std::memcmp(r[0], name, name_size) == 0) {
+        this->pos = p+1;
+        event->text = TextSlice(r[1], std::strlen(r[1]));
+        return true;
+      }
+    }
+  }
+
+  event->text = TextSlice(this->pos, 1); // "&"
+  this->pos = p;
+  if (name_size > 0) {
+    this->pending[this->pending_count].type = HTMLScanEvent::CHARACTERS;
+    this->pending[this->pending_count].text = TextSlice(name, name_size);
+    ++this->pending_count;
+  }
+  return true;
+}
+
+void HTMLScanner::ScanStartTag(const char* name, size_t name_size, int tag_id) {
+  // implicitly end innermost elements this one cannot be nested in
+  while (this->overflow_count == 0 && this->open_count > 0 && Tags().StartCloses(tag_id, this->open_tag_ids[this->open_count-1])) {
+    this->QueueEnd(this->open_elements[this->open_count-1]);
+  }
+
+  this->QueueStart(name, name_size, tag_id);
+}
+
+void HTMLScanner::ScanEndTag(const char* name, size_t name_size, int tag_id) {
+  if (this->overflow_count > 0) {
+    --this->overflow_count;
+    return;
+  }
+
+  // find the element being ended; stray end tags, and ones that would cross a higher-priority element, are ignored
+  const int priority = Tags().EndPriority(tag_id);
+  size_t match = this->open_count;
+  while (match > 0) {
+    const int open_id = this->open_tag_ids[match-1];
+    if (tag_id != KnownTags::UNKNOWN_TAG ? open_id == tag_id : SameName(this->open_elements[match-1], name, name_size)) {
+      break;
+    }
+    if (Tags().EndPriority(open_id) > priority) {
+      return;
+    }
+    --match;
+  }
+  if (match == 0) {
+    return;
+  }
+
+  while (this->open_count >= match) {
+    this->QueueEnd(this->open_elements[this->open_count-1]);
+  }
+}
+
+// script/style contents run until the first "</" followed by a letter
+void HTMLScanner::QueueRawText() {
+  const char* p = this->pos;
+  while (true) {
+    p = FindByte(p, this->end, '<');
+    if (p >= this->end || (this->end - p >= 3 && p[1] == '/' && IsNameStart(p[2]))) {
+      break;
+    }
+    ++p;
+  }
+
+  if (p > this->pos) {
+    this->pending[this->pending_count].type = HTMLScanEvent::CHARACTERS;
+    this->pending[this->pending_count].text = TextSlice(this->pos, static_cast<size_t>(p - this->pos));
+    ++this->pending_count;
+  }
+  this->pos = p;
+}
+
+void HTMLScanner::QueueStart(const char* name, size_t name_size, int tag_id) {
+  this->pending[this->pending_count].type = HTMLScanEvent::START_ELEMENT;
+  this->pending[this->pending_count].text = TextSlice(name, name_size);
+  ++this->pending_count;
+  this->element_seen = true;
+
+  this->PushOpen(name, name_size, tag_id);
+}
+
+// ends the innermost open element, whose name is passed in
+void HTMLScanner::QueueEnd(const TextSlice& name) {
+  this->pending[this->pending_count].type = HTMLScanEvent::END_ELEMENT;
+  this->pending[this->pending_count].text = name;
+  ++this->pending_count;
+
+  if (this->overflow_count > 0) {
+    --this->overflow_count;
+  }
+  else {
+    --this->open_count;
+  }
+}
+
+void HTMLScanner::PushOpen(const char* name, size_t name_size, int tag_id) {
+  if (this->open_count >= HTMLScanner::MAX_OPEN_ELEMENTS) {
+    ++this->overflow_count;
+    return;
+  }
+
+  this->open_elements[this->open_count] = TextSlice(name, name_size);
+  this->open_tag_ids[this->open_count] = tag_id;
+  ++this->open_count;
+}
+
+bool HTMLScanner::PopPending(HTMLScanEvent* event) {
+  if (this->pending_next >= this->pending_count) {
+    this->pending_next = 0;
+    this->pending_count = 0;
+    return false;
+  }
+
+  *event = this->pending[this->pending_next];
+  ++this->pending_next;
+  return true;
+}
@@ -0,0 +1,81 @@
+/*
+ * Description: interfaces to scan HTML page data without building a document
+ * Author: Laura Galbraith
+*/
+
+#ifndef SVGSC_HTMLSCAN_H
+#define SVGSC_HTMLSCAN_H
+
+#include <cstddef> // size_t
+
+// A run of bytes; points into the scanned page buffer, or into the scanner for decoded character references
+class TextSlice {
+  public:
+    // Constructors
+    TextSlice();
+    TextSlice(const char* slice_data, size_t slice_size);
+
+    // Member variables
+    const char* data;
+    size_t size;
+};
+
+class HTMLScanEvent {
+  public:
+    enum Type { START_ELEMENT, END_ELEMENT, CHARACTERS };
+
+    // Constructor
+    HTMLScanEvent();
+
+    // Member variables
+    Type type;
+    TextSlice text; // element name for START/END_ELEMENT, character data for CHARACTERS
+};
+
+// Walks HTML from '<' to '>' and reports the same element/character events libxml2's SAX HTML parser would, for the markup the wiki produces:
+// void and self-closing elements are ended immediately, common implied end tags (p, li, td, ...) are generated,
+// character references are decoded, comments/doctypes are skipped, and script/style contents are reported as-is
+// no memory is allocated; event text is only valid until the next call to Next
+class HTMLScanner {
+  public:
+    // Constructor; the page buffer must outlive the scanner
+    HTMLScanner(const char* page_data, size_t page_size);
+
+    // returns false once the end of the page is reached and every open element has been ended
+    bool Next(HTMLScanEvent* event);
+
+  private:
+    bool ScanMarkup(HTMLScanEvent* event);
+    bool ScanCharacters(HTMLScanEvent* event);
+    bool ScanReference(HTMLScanEvent* event);
+    void ScanStartTag(const char* name, size_t name_size, int tag_id);
+    void ScanEndTag(const char* name, size_t name_size, int tag_id);
+    void QueueRawText();
+
+    void QueueStart(const char* name, size_t name_size, int tag_id);
+    void QueueEnd(const TextSlice& name);
+    void PushOpen(const char* name, size_t name_size, int tag_id);
+    bool PopPending(HTMLScanEvent* event);
+
+    static const size_t MAX_OPEN_ELEMENTS = 256;
+    static const size_t MAX_PENDING_EVENTS = MAX_OPEN_ELEMENTS + 4;
+
+    const char* pos;
+    const char* end;
+
+    // open element names, and their index in the scanner's table of elements with special handling; elements nested deeper than the capacity are only counted
+    TextSlice open_elements[MAX_OPEN_ELEMENTS];
+    int open_tag_ids[MAX_OPEN_ELEMENTS];
+    size_t open_count;
+    size_t overflow_count;
+    bool element_seen;
+
+    // one markup token can produce several events (implied ends, then the start), which are handed out in order
+    HTMLScanEvent pending[MAX_PENDING_EVENTS];
+    size_t pending_next;
+    size_t pending_count;
+
+    char reference_buffer[4]; // UTF-8 of the last numeric character reference
+};
+
+#endif // SVGSC_HTMLSCAN_H
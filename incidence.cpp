@@ -0,0 +1,122 @@
+/*
+ * Description: implementation to store which villagers love which gifts, by interned ID
+ * Author: Laura Galbraith
+*/
+
+#include "incidence.hpp" // self-include header
+
+// lays out rows of the other side from rows of one side, by counting sort: each target row comes out in source ID order
+// O(number of entries + number of rows)
+void Transpose(const std::vector<size_t>& source_offsets, const std::vector<unsigned int>& source_entries, size_t target_count, std::vector<size_t>* target_offsets, std::vector<unsigned int>* target_entries) {
+  target_offsets->assign(target_count+1, 0);
+  for (auto target_id:source_entries) {
+    ++(*target_offsets)[target_id+1];
+  }
+  for (size_t target_i = 0; target_i < target_count; ++target_i) {
+    (*target_offsets)[target_i+1] += (*target_offsets)[target_i];
+  }
+
+  std::vector<size_t> next(target_offsets->begin(), target_offsets->end()-1);
+  target_entries->resize(source_entries.size());
+  for (size_t source_i = 0; source_i+1 < source_offsets.size(); ++source_i) {
+    for (size_t entry_i = source_offsets[source_i]; entry_i < source_offsets[source_i+1]; ++entry_i) {
+      (*target_entries)[next[source_entries[entry_i]]++] = static_cast<unsigned int>(source_i);
+    }
+  }
+}
+
+IncidenceStore::IncidenceStore() {
+  this->Build();
+}
+
+unsigned int IncidenceStore::AddGift(const std::string& gift) {
+  return this->gift_names.Intern(gift);
+}
+
+unsigned int IncidenceStore::AddVillager(const std::string& villager) {
+  return this->villager_names.Intern(villager);
+}
+
+void IncidenceStore::AddIncidence(unsigned int gift_id, unsigned int villager_id) {
+  this->incidences.push_back(std::pair<unsigned int, unsigned int>(gift_id, villager_id));
+}
+
+void IncidenceStore::ReserveIncidences(size_t count) {
+  this->incidences.reserve(count);
+}
+
+void IncidenceStore::Build() {
+  const size_t gift_count = this->gift_names.Size();
+  const size_t villager_count = this->villager_names.Size();
+
+  // group incidences by gift, dropping repeats: within a gift's group, a villager is kept only if not already stamped with that gift
+  std::vector<size_t> grouped_offsets(gift_count+1, 0);
+  for (auto incidence:this->incidences) {
+    ++grouped_offsets[incidence.first+1];
+  }
+  for (size_t gift_i = 0; gift_i < gift_count; ++gift_i) {
+    grouped_offsets[gift_i+1] += grouped_offsets[gift_i];
+  }
+
+  std::vector<size_t> next(grouped_offsets.begin(), grouped_offsets.end()-1);
+  std::vector<unsigned int> grouped_villagers(this->incidences.size());
+  for (auto incidence:this->incidences) {
+    grouped_villagers[next[incidence.first]++] = incidence.second;
+  }
+
+  const unsigned int NOT_STAMPED = static_cast<unsigned int>(-1);
+  std::vector<unsigned int> stamps(villager_count, NOT_STAMPED);
+  std::vector<size_t> unique_offsets(gift_count+1, 0);
+  size_t unique_count = 0;
+  for (size_t gift_i = 0; gift_i < gift_count; ++gift_i) {
+    for (size_t entry_i = grouped_offsets[gift_i]; entry_i < grouped_offsets[gift_i+1]; ++entry_i) {
+      const unsigned int villager_id = grouped_villagers[entry_i];
+      if (stamps[villager_id] != gift_i) {
+        stamps[villager_id] = static_cast<unsigned int>(gift_i);
+        grouped_villagers[unique_count++] = villager_id;
+      }
+    }
+    unique_offsets[gift_i+1] = unique_count;
+  }
+  grouped_villagers.resize(unique_count);
+
+  // transposing twice sorts both sides' rows by ID
+  Transpose(unique_offsets, grouped_villagers, villager_count, &this->villager_offsets, &this->villager_gifts);
+  Transpose(this->villager_offsets, this->villager_gifts, gift_count, &this->gift_offsets, &this->gift_villagers);
+}
+
+const NameTable& IncidenceStore::GetGiftNames() const {
+  return this->gift_names;
+}
+
+const NameTable& IncidenceStore::GetVillagerNames() const {
+  return this->villager_names;
+}
+
+size_t IncidenceStore::GiftCount() const {
+  return this->gift_offsets.size()-1;
+}
+
+size_t IncidenceStore::VillagerCount() const {
+  return this->villager_offsets.size()-1;
+}
+
+size_t IncidenceStore::IncidenceCount() const {
+  return this->gift_villagers.size();
+}
+
+const unsigned int* IncidenceStore::GiftVillagersBegin(unsigned int gift_id) const {
+  return this->gift_villagers.data() + this->gift_offsets[gift_id];
+}
+
+const unsigned int* IncidenceStore::GiftVillagersEnd(unsigned int gift_id) const {
+  return this->gift_villagers.data() + this->gift_offsets[gift_id+1];
+}
+
+const unsigned int* IncidenceStore::VillagerGiftsBegin(unsigned int villager_id) const {
+  return this->villager_gifts.data() + this->villager_offsets[villager_id];
+}
+
+const unsigned int* IncidenceStore::VillagerGiftsEnd(unsigned int villager_id) const {
+  return this->villager_gifts.data() + this->villager_offsets[villager_id+1];
+}
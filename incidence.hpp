@@ -0,0 +1,67 @@
+/*
+ * Description: interface to store which villagers love which gifts, by interned ID
+ * Documentation: compressed sparse row form: https://en.m.wikipedia.org/wiki/Sparse_matrix#Compressed_sparse_row_(CSR,_CRS_or_Yale_format)
+ * Author: Laura Galbraith
+*/
+
+#ifndef SVGSC_INCIDENCE_H
+#define SVGSC_INCIDENCE_H
+
+#include <string> // string
+#include <vector> // vector
+#include <tuple> // pair
+#include <cstddef> // size_t
+
+#include "nametable.hpp" // NameTable
+
+// The gift/villager relation as two adjacency arrays in compressed sparse row form, gift->villagers and villager->gifts,
+// so either side's neighbours are one contiguous, sorted run of IDs
+// names are added and incidences recorded first; Build then lays out both arrays in time linear in the number of incidences
+class IncidenceStore {
+  public:
+    // Constructor
+    IncidenceStore();
+
+    // IDs are given out in the order names are first added
+    // O(1), on average
+    unsigned int AddGift(const std::string& gift);
+    unsigned int AddVillager(const std::string& villager);
+
+    // a repeated incidence is only stored once
+    // O(1), amortized
+    void AddIncidence(unsigned int gift_id, unsigned int villager_id);
+
+    // room for at least this many incidences, so adding them never copies the ones already added
+    void ReserveIncidences(size_t count);
+
+    // lays out the adjacency arrays from every incidence added so far
+    // O(number of incidences + number of gifts + number of villagers)
+    void Build();
+
+    // Data-reading methods, valid after Build
+    const NameTable& GetGiftNames() const;
+    const NameTable& GetVillagerNames() const;
+    size_t GiftCount() const;
+    size_t VillagerCount() const;
+    size_t IncidenceCount() const;
+
+    // the villagers that love a gift, in ID order
+    const unsigned int* GiftVillagersBegin(unsigned int gift_id) const;
+    const unsigned int* GiftVillagersEnd(unsigned int gift_id) const;
+
+    // the gifts a villager loves, in ID order
+    const unsigned int* VillagerGiftsBegin(unsigned int villager_id) const;
+    const unsigned int* VillagerGiftsEnd(unsigned int villager_id) const;
+
+  private:
+    NameTable gift_names;
+    NameTable villager_names;
+    std::vector<std::pair<unsigned int, unsigned int>> incidences; // (gift, villager), as added
+
+    std::vector<size_t> gift_offsets; // gift_villagers[gift_offsets[g] .. gift_offsets[g+1]] are the villagers of gift g
+    std::vector<unsigned int> gift_villagers;
+    std::vector<size_t> villager_offsets; // villager_gifts[villager_offsets[v] .. villager_offsets[v+1]] are the gifts of villager v
+    std::vector<unsigned int> villager_gifts;
+};
+
+#endif // SVGSC_INCIDENCE_H
@@ -0,0 +1,307 @@
+/*
+ * Description: implementations to read generic set-cover instances from files
+ * Author: Laura Galbraith
+*/
+
+#include "instance.hpp" // self-include header
+
+#include <string> // string, to_string
+#include <vector> // vector
+#include <fstream> // ifstream
+#include <cstdio> // FILE, fopen, fread, fclose, ferror, fseek, ftell, rewind, EOF
+#include <climits> // ULONG_MAX
+
+#include "incidence.hpp" // IncidenceStore
+#include "nametable.hpp" // NameTable
+
+const size_t SCAN_BUFFER_SIZE = 1 << 20;
+
+SetCoverInstance::SetCoverInstance()
+  : unit_costs(true)
+{}
+
+SetCoverInstanceSink::~SetCoverInstanceSink() {}
+
+void SetCoverInstanceSink::ReserveIncidences(size_t) {}
+
+// Reads a file a buffer at a time, handing out its bytes and counting lines for error messages
+class InstanceScanner {
+  public:
+    // Constructor; the file must stay open while the scanner is used
+    InstanceScanner(std::FILE* scanned_file, size_t scanned_file_size)
+      : file(scanned_file), file_size(scanned_file_size), consumed(0), buffer(SCAN_BUFFER_SIZE), pos(0), end(0), line(1)
+    {}
+
+    // the next byte, without moving past it, or EOF at the end of the file
+    int Peek() {
+      if (this->pos >= this->end && !this->Refill()) {
+        return EOF;
+      }
+      return static_cast<unsigned char>(this->buffer[this->pos]);
+    }
+
+    void Advance() {
+      if (this->buffer[this->pos++] == '\n') {
+        ++this->line;
+      }
+    }
+
+    // moves past spaces, tabs and carriage returns, and newlines too if asked
+    void SkipBlanks(bool newlines) {
+      for (int c = this->Peek(); c == ' ' || c == '\t' || c == '\r' || (newlines && c == '\n'); c = this->Peek()) {
+        this->Advance();
+      }
+    }
+
+    void SkipLine() {
+      for (int c = this->Peek(); c != EOF && c != '\n'; c = this->Peek()) {
+        this->Advance();
+      }
+    }
+
+    // a whole number after any whitespace; false if there is none, it is too large for an unsigned long, or it runs straight into something else
+    // whitespace and digits are read straight from the buffer, only stopping to refill it, since this reads nearly every byte of an OR-Library file
+    bool ReadUnsigned(unsigned long* value) {
+      const char* p = this->buffer.data() + this->pos;
+      const char* end_p = this->buffer.data() + this->end;
+      while (true) {
+        if (p >= end_p) {
+          if (!this->Refill()) {
+            return false;
+          }
+          p = this->buffer.data();
+          end_p = p + this->end;
+        }
+        if (*p == '\n') {
+          ++this->line;
+        }
+        else if (*p != ' ' && *p != '\t' && *p != '\r') {
+          break;
+        }
+        ++p;
+      }
+
+      *value = 0;
+      bool any_digits = false;
+      bool overflowed = false;
+      while (true) {
+        if (p >= end_p) {
+          if (!this->Refill()) {
+            break;
+          }
+          p = this->buffer.data();
+          end_p = p + this->end;
+        }
+        if (*p < '0' || *p > '9') {
+          break;
+        }
+        const unsigned long digit = static_cast<unsigned long>(*p - '0');
+        overflowed = overflowed || *value > (ULONG_MAX - digit) / 10;
+        *value = *value * 10 + digit;
+        any_digits = true;
+        ++p;
+      }
+      this->pos = static_cast<size_t>(p - this->buffer.data());
+
+      const int next = this->Peek();
+      return any_digits && !overflowed && (next == EOF || next == ' ' || next == '\t' || next == '\r' || next == '\n');
+    }
+
+    // the characters up to the next whitespace, any of the extra separators, or the end of the file
+    void ReadToken(const std::string& separators, std::string* token) {
+      token->resize(0);
+      for (int c = this->Peek(); c != EOF && c != ' ' && c != '\t' && c != '\r' && c != '\n' && separators.find(static_cast<char>(c)) == std::string::npos; c = this->Peek()) {
+        token->push_back(static_cast<char>(c));
+        this->Advance();
+      }
+    }
+
+    // every token takes at least two bytes with the separator after it, so no more than half the bytes left can be tokens
+    size_t MaxTokensLeft() const {
+      const size_t unread = this->file_size > this->consumed ? this->file_size - this->consumed : 0;
+      return (unread + this->end - this->pos) / 2 + 1;
+    }
+
+    unsigned long Line() const {
+      return this->line;
+    }
+
+    bool ReadFailed() const {
+      return std::ferror(this->file) != 0;
+    }
+
+  private:
+    bool Refill() {
+      this->pos = 0;
+      this->end = std::fread(this->buffer.data(), 1, this->buffer.size(), this->file);
+      this->consumed += this->end;
+      return this->end > 0;
+    }
+
+    std::FILE* file;
+    size_t file_size;
+    size_t consumed; // bytes read into the buffer so far
+    std::vector<char> buffer;
+    size_t pos;
+    size_t end;
+    unsigned long line;
+};
+
+// the readers take either an IncidenceStore or a SetCoverInstanceSink, so reading into the store costs no virtual call per incidence
+template <class Sink>
+std::string ReadORLibrary(InstanceScanner* scanner, Sink* incidences, bool* unit_costs) {
+  unsigned long element_count = 0;
+  unsigned long set_count = 0;
+  if (!scanner->ReadUnsigned(&element_count) || !scanner->ReadUnsigned(&set_count)) {
+    return "line " + std::to_string(scanner->Line()) + ": expected the number of elements and the number of sets";
+  }
+
+  // checked before a name is interned, so a header claiming more than the file holds fails instead of filling memory:
+  // the IDs must fit below NameTable::NOT_FOUND, and every set's cost and every element's count of covering sets is a token of its own
+  if (element_count >= NameTable::NOT_FOUND || set_count >= NameTable::NOT_FOUND) {
+    return "line " + std::to_string(scanner->Line()) + ": " + std::to_string(element_count) + " elements and " + std::to_string(set_count) + " sets are more than an ID can number";
+  }
+  if (element_count + set_count > scanner->MaxTokensLeft()) {
+    return "line " + std::to_string(scanner->Line()) + ": " + std::to_string(element_count) + " elements and " + std::to_string(set_count) + " sets cannot fit in the rest of the file";
+  }
+
+  incidences->ReserveIncidences(scanner->MaxTokensLeft());
+  for (unsigned long set_i = 1; set_i <= set_count; ++set_i) {
+    incidences->AddGift(std::to_string(set_i));
+  }
+  for (unsigned long element_i = 1; element_i <= element_count; ++element_i) {
+    incidences->AddVillager(std::to_string(element_i));
+  }
+
+  std::string cost;
+  for (unsigned long set_i = 0; set_i < set_count; ++set_i) {
+    scanner->SkipBlanks(true);
+    scanner->ReadToken("", &cost);
+    if (cost.empty()) {
+      return "line " + std::to_string(scanner->Line()) + ": expected " + std::to_string(set_count) + " set costs";
+    }
+    *unit_costs = *unit_costs && cost == "1";
+  }
+
+  for (unsigned long element_i = 0; element_i < element_count; ++element_i) {
+    unsigned long covering_sets = 0;
+    if (!scanner->ReadUnsigned(&covering_sets)) {
+      return "line " + std::to_string(scanner->Line()) + ": expected how many sets cover element " + std::to_string(element_i+1);
+    }
+
+    for (unsigned long covering_i = 0; covering_i < covering_sets; ++covering_i) {
+      unsigned long set_number = 0;
+      if (!scanner->ReadUnsigned(&set_number) || set_number < 1 || set_number > set_count) {
+        return "line " + std::to_string(scanner->Line()) + ": expected a set from 1 to " + std::to_string(set_count) + " covering element " + std::to_string(element_i+1);
+      }
+      incidences->AddIncidence(static_cast<unsigned int>(set_number-1), static_cast<unsigned int>(element_i));
+    }
+  }
+
+  scanner->SkipBlanks(true);
+  if (scanner->Peek() != EOF) {
+    return "line " + std::to_string(scanner->Line()) + ": more than the " + std::to_string(element_count) + " elements the file starts with";
+  }
+  return "";
+}
+
+template <class Sink>
+std::string ReadSetList(InstanceScanner* scanner, Sink* incidences) {
+  incidences->ReserveIncidences(scanner->MaxTokensLeft());
+  std::string set_name;
+  std::string element;
+  while (true) {
+    scanner->SkipBlanks(true);
+    if (scanner->Peek() == EOF) {
+      return "";
+    }
+    if (scanner->Peek() == '#') {
+      scanner->SkipLine();
+      continue;
+    }
+
+    // the set name runs up to the ':', and may have spaces in it
+    set_name.resize(0);
+    for (int c = scanner->Peek(); c != EOF && c != '\n' && c != ':'; c = scanner->Peek()) {
+      set_name.push_back(static_cast<char>(c));
+      scanner->Advance();
+    }
+    while (!set_name.empty() && (set_name.back() == ' ' || set_name.back() == '\t' || set_name.back() == '\r')) {
+      set_name.pop_back();
+    }
+    if (scanner->Peek() != ':' || set_name.empty()) {
+      return "line " + std::to_string(scanner->Line()) + ": expected '<set name>: <element> <element> ...'";
+    }
+    scanner->Advance();
+
+    const unsigned int set_id = incidences->AddGift(set_name);
+    while (true) {
+      for (int c = scanner->Peek(); c == ' ' || c == '\t' || c == '\r' || c == ','; c = scanner->Peek()) {
+        scanner->Advance();
+      }
+      if (scanner->Peek() == EOF || scanner->Peek() == '\n') {
+        break;
+      }
+
+      scanner->ReadToken(",", &element);
+      incidences->AddIncidence(set_id, incidences->AddVillager(element));
+    }
+  }
+}
+
+// looks at the first line that is not blank or a comment
+SetCoverInstanceFormat DetectFormat(const std::string& path) {
+  std::ifstream file(path.c_str());
+  std::string line;
+  while (std::getline(file, line)) {
+    const size_t first = line.find_first_not_of(" \t\r");
+    if (first == std::string::npos || line[first] == '#') {
+      continue;
+    }
+    return line.find(':') != std::string::npos ? SetCoverInstanceFormat::SET_LIST : SetCoverInstanceFormat::OR_LIBRARY;
+  }
+  return SetCoverInstanceFormat::OR_LIBRARY;
+}
+
+// opens the file and reads it into the sink, the errors naming the file
+template <class Sink>
+std::string ReadInstanceInto(const std::string& path, SetCoverInstanceFormat format, Sink* incidences, bool* unit_costs) {
+  if (format == SetCoverInstanceFormat::DETECT) {
+    format = DetectFormat(path);
+  }
+
+  std::FILE* file = std::fopen(path.c_str(), "rb");
+  if (file == NULL) {
+    return "could not open " + path;
+  }
+
+  std::fseek(file, 0, SEEK_END);
+  const long file_size = std::ftell(file);
+  std::rewind(file);
+
+  *unit_costs = true;
+  InstanceScanner scanner = InstanceScanner(file, file_size > 0 ? static_cast<size_t>(file_size) : 0);
+  std::string error = format == SetCoverInstanceFormat::SET_LIST ? ReadSetList(&scanner, incidences) : ReadORLibrary(&scanner, incidences, unit_costs);
+  if (error == "" && scanner.ReadFailed()) {
+    error = "could not read " + path;
+  }
+  std::fclose(file);
+
+  return error != "" ? path + " " + error : "";
+}
+
+std::string ReadSetCoverInstance(const std::string& path, SetCoverInstanceFormat format, SetCoverInstance* instance) {
+  *instance = SetCoverInstance();
+  const std::string error = ReadInstanceInto(path, format, &instance->incidences, &instance->unit_costs);
+  if (error != "") {
+    *instance = SetCoverInstance();
+    return error;
+  }
+
+  instance->incidences.Build();
+  return "";
+}
+
+std::string StreamSetCoverInstance(const std::string& path, SetCoverInstanceFormat format, SetCoverInstanceSink* sink, bool* unit_costs) {
+  return ReadInstanceInto(path, format, sink, unit_costs);
+}
@@ -0,0 +1,58 @@
+/*
+ * Description: interfaces to read generic set-cover instances from files
+ * Documentation: OR-Library set-cover format: https://people.brunel.ac.uk/~mastjjb/jeb/orlib/scpinfo.html
+ * Author: Laura Galbraith
+*/
+
+#ifndef SVGSC_INSTANCE_H
+#define SVGSC_INSTANCE_H
+
+#include <string> // string
+#include <cstddef> // size_t
+
+#include "incidence.hpp" // IncidenceStore
+
+enum class SetCoverInstanceFormat {
+  DETECT, // SET_LIST if the first line that is not blank or a comment has a ':', otherwise OR_LIBRARY
+  OR_LIBRARY, // "<elements> <sets>", a cost per set, then per element the number of sets covering it and those sets, numbered from 1; all whitespace-separated
+  SET_LIST // one set per line, "<set name>: <element> <element> ...", elements separated by spaces, tabs or commas; lines starting with '#' are comments
+};
+
+// A set-cover instance, with sets standing in for gifts and elements for villagers, so every solver runs on it unchanged
+class SetCoverInstance {
+  public:
+    // Constructor
+    SetCoverInstance();
+
+    // Member variables
+    IncidenceStore incidences; // OR-Library sets and elements are named by their numbers and get IDs in that order; SET_LIST names get IDs in the order first read
+    bool unit_costs; // false if an OR-Library set costs other than 1; costs are otherwise ignored, as every set counts as one
+};
+
+// Takes in an instance as it is read, for keeping it some other way than in an IncidenceStore
+// the reader calls it as it would an IncidenceStore, naming each set and element before its incidences; every read of the same file makes the same calls
+class SetCoverInstanceSink {
+  public:
+    // Destructor
+    virtual ~SetCoverInstanceSink();
+
+    // return the ID of the name, given out in the order names are first added, as IncidenceStore does
+    virtual unsigned int AddGift(const std::string& set_name) = 0;
+    virtual unsigned int AddVillager(const std::string& element_name) = 0;
+
+    // an incidence may be added more than once
+    virtual void AddIncidence(unsigned int set_id, unsigned int element_id) = 0;
+
+    // at most this many incidences follow; does nothing unless overridden
+    virtual void ReserveIncidences(size_t count);
+};
+
+// streams the file through a fixed buffer, parsing as it goes, so a large instance loads about as fast as the disk reads it
+// returns an error, or empty if successful
+std::string ReadSetCoverInstance(const std::string& path, SetCoverInstanceFormat format, SetCoverInstance* instance);
+
+// reads the file the same way, but hands it to the sink instead of keeping it; unit_costs is set as in SetCoverInstance
+// returns an error, or empty if successful
+std::string StreamSetCoverInstance(const std::string& path, SetCoverInstanceFormat format, SetCoverInstanceSink* sink, bool* unit_costs);
+
+#endif // SVGSC_INSTANCE_H
@@ -0,0 +1,352 @@
+/*
+ * Description: implementations to parse JSON data
+ * Documentation/references:
+ *    - JSON grammar: https://www.json.org
+ * Author: Laura Galbraith
+*/
+
+#include "jsonparse.hpp" // self-include header
+
+#include <string> // string
+#include <vector> // vector
+#include <tuple> // pair
+#include <cstdlib> // strtod
+
+JSONValue::JSONValue()
+  : type(JSON_NULL), boolean(false), number(0.0)
+{}
+
+// O(number of members)
+const JSONValue* JSONValue::Find(const std::string& key) const {
+  if (this->type != JSON_OBJECT) {
+    return NULL;
+  }
+
+  for (const auto& m:this->members) {
+    if (m.first == key) {
+      return &m.second;
+    }
+  }
+
+  return NULL;
+}
+
+JSONParseResult::JSONParseResult(const JSONValue& result_data, const std::string& result_error)
+  : data(result_data), error(result_error)
+{}
+
+// Recursive-descent parser over an in-memory document
+// each Parse* method returns false and sets the error when the document is malformed
+class JSONParser {
+  public:
+    // Constructor
+    JSONParser(const std::string& json_data)
+    : text(json_data),
+      pos(0),
+      depth(0)
+    {}
+
+    bool ParseDocument(JSONValue* value) {
+      if (!this->ParseValue(value)) {
+        return false;
+      }
+
+      this->SkipWhitespace();
+      if (this->pos != this->text.size()) {
+        return this->Fail("unexpected data after the document");
+      }
+
+      return true;
+    }
+
+    const std::string Error() const {
+      return this->error;
+    }
+
+  private:
+    bool ParseValue(JSONValue* value) {
+      this->SkipWhitespace();
+      if (this->pos >= this->text.size()) {
+        return this->Fail("unexpected end of document");
+      }
+
+      const char c = this->text[this->pos];
+      if (c == '{') {
+        return this->ParseObject(value);
+      }
+      else if (c == '[') {
+        return this->ParseArray(value);
+      }
+      else if (c == '"') {
+        value->type = JSONValue::JSON_STRING;
+        return this->ParseString(&value->text);
+      }
+      else if (c == 't' || c == 'f' || c == 'n') {
+        return this->ParseLiteral(value);
+      }
+
+      return this->ParseNumber(value);
+    }
+
+    bool ParseObject(JSONValue* value) {
+      if (++this->depth > MAX_DEPTH) {
+        return this->Fail("document is nested too deeply");
+      }
+
+      value->type = JSONValue::JSON_OBJECT;
+      ++this->pos; // past '{'
+
+      this->SkipWhitespace();
+      if (this->Consume('}')) {
+        --this->depth;
+        return true;
+      }
+
+      do {
+        this->SkipWhitespace();
+        std::pair<std::string, JSONValue> member;
+        if (this->pos >= this->text.size() || this->text[this->pos] != '"' || !this->ParseString(&member.first)) {
+          return this->Fail("expected an object key");
+        }
+
+        this->SkipWhitespace();
+        if (!this->Consume(':')) {
+          return this->Fail("expected ':' after an object key");
+        }
+
+        if (!this->ParseValue(&member.second)) {
+          return false;
+        }
+
+        value->members.push_back(member);
+        this->SkipWhitespace();
+      } while (this->Consume(','));
+
+      if (!this->Consume('}')) {
+        return this->Fail("expected ',' or '}' in an object");
+      }
+
+      --this->depth;
+      return true;
+    }
+
+    bool ParseArray(JSONValue* value) {
+      if (++this->depth > MAX_DEPTH) {
+        return this->Fail("document is nested too deeply");
+      }
+
+      value->type = JSONValue::JSON_ARRAY;
+      ++this->pos; // past '['
+
+      this->SkipWhitespace();
+      if (this->Consume(']')) {
+        --this->depth;
+        return true;
+      }
+
+      do {
+        value->elements.push_back(JSONValue());
+        if (!this->ParseValue(&value->elements.back())) {
+          return false;
+        }
+
+        this->SkipWhitespace();
+      } while (this->Consume(','));
+
+      if (!this->Consume(']')) {
+        return this->Fail("expected ',' or ']' in an array");
+      }
+
+      --this->depth;
+      return true;
+    }
+
+    // decodes escapes, including \u surrogate pairs, into UTF-8
+    bool ParseString(std::string* out) {
+      ++this->pos; // past opening quote
+
+      while (this->pos < this->text.size()) {
+        // copy the run of plain characters in one go
+        size_t run_end = this->text.find_first_of("\"\\", this->pos);
+        if (run_end == std::string::npos) {
+          break;
+        }
+
+        out->append(this->text, this->pos, run_end - this->pos);
+        this->pos = run_end;
+
+        if (this->text[this->pos] == '"') {
+          ++this->pos;
+          return true;
+        }
+
+        // escape sequence
+        if (this->pos+1 >= this->text.size()) {
+          break;
+        }
+
+        const char escaped = this->text[this->pos+1];
+        this->pos += 2;
+        switch (escaped) {
+          case '"': out->push_back('"'); break;
+          case '\\': out->push_back('\\'); break;
+          case '/': out->push_back('/'); break;
+          case 'b': out->push_back('\b'); break;
+          case 'f': out->push_back('\f'); break;
+          case 'n': out->push_back('\n'); break;
+          case 'r': out->push_back('\r'); break;
+          case 't': out->push_back('\t'); break;
+          case 'u': {
+            unsigned long code_point = 0;
+            if (!this->ParseHex4(&code_point)) {
+              return this->Fail("invalid \\u escape in a string");
+            }
+
+            // combine a UTF-16 surrogate pair
+            if (code_point >= 0xD800 && code_point <= 0xDBFF && this->text.compare(this->pos, 2, "\\u") == 0) {
+              this->pos += 2;
+              unsigned long low_surrogate = 0;
+              if (!this->ParseHex4(&low_surrogate)) {
+                return this->Fail("invalid \\u escape in a string");
+              }
+
+              code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low_surrogate - 0xDC00);
+            }
+
+            AppendUTF8(code_point, out);
+            break;
+          }
+          default:
+            return this->Fail("invalid escape in a string");
+        }
+      }
+
+      return this->Fail("unterminated string");
+    }
+
+    bool ParseHex4(unsigned long* code_point) {
+      if (this->pos+4 > this->text.size()) {
+        return false;
+      }
+
+      for (int i = 0; i < 4; ++i) {
+        const char c = this->text[this->pos];
+        *code_point <<= 4;
+        if (c >= '0' && c <= '9') {
+          *code_point |= static_cast<unsigned long>(c - '0');
+        }
+        else if (c >= 'a' && c <= 'f') {
+          *code_point |= static_cast<unsigned long>(c - 'a' + 10);
+        }
+        else if (c >= 'A' && c <= 'F') {
+          *code_point |= static_cast<unsigned long>(c - 'A' + 10);
+        }
+        else {
+          return false;
+        }
+
+        ++this->pos;
+      }
+
+      return true;
+    }
+
+    bool ParseLiteral(JSONValue* value) {
+      if (this->text.compare(this->pos, 4, "true") == 0) {
+        value->type = JSONValue::JSON_BOOL;
+        value->boolean = true;
+        this->pos += 4;
+      }
+      else if (this->text.compare(this->pos, 5, "false") == 0) {
+        value->type = JSONValue::JSON_BOOL;
+        value->boolean = false;
+        this->pos += 5;
+      }
+      else if (this->text.compare(this->pos, 4, "null") == 0) {
+        value->type = JSONValue::JSON_NULL;
+        this->pos += 4;
+      }
+      else {
+        return this->Fail("invalid literal");
+      }
+
+      return true;
+    }
+
+    bool ParseNumber(JSONValue* value) {
+      const char* start = this->text.c_str() + this->pos;
+      char* end = NULL;
+      value->number = std::strtod(start, &end);
+      if (end == start) {
+        return this->Fail("invalid value");
+      }
+
+      value->type = JSONValue::JSON_NUMBER;
+      this->pos += static_cast<size_t>(end - start);
+      return true;
+    }
+
+    static void AppendUTF8(unsigned long code_point, std::string* out) {
+      if (code_point < 0x80) {
+        out->push_back(static_cast<char>(code_point));
+      }
+      else if (code_point < 0x800) {
+        out->push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+        out->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+      }
+      else if (code_point < 0x10000) {
+        out->push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+        out->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        out->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+      }
+      else {
+        out->push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+        out->push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+        out->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        out->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+      }
+    }
+
+    void SkipWhitespace() {
+      while (this->pos < this->text.size()) {
+        const char c = this->text[this->pos];
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+          return;
+        }
+        ++this->pos;
+      }
+    }
+
+    bool Consume(char c) {
+      if (this->pos < this->text.size() && this->text[this->pos] == c) {
+        ++this->pos;
+        return true;
+      }
+
+      return false;
+    }
+
+    bool Fail(const std::string& message) {
+      if (this->error == "") {
+        this->error = message + " at offset " + std::to_string(this->pos);
+      }
+      return false;
+    }
+
+    static const unsigned int MAX_DEPTH = 512;
+
+    const std::string& text;
+    size_t pos;
+    unsigned int depth;
+    std::string error;
+};
+
+JSONParseResult ParseJSON(const std::string& json_data) {
+  JSONValue document;
+  JSONParser parser = JSONParser(json_data);
+  if (!parser.ParseDocument(&document)) {
+    return JSONParseResult(JSONValue(), parser.Error());
+  }
+
+  return JSONParseResult(document, "");
+}
@@ -0,0 +1,45 @@
+/*
+ * Description: interfaces to parse JSON data
+ * Author: Laura Galbraith
+*/
+
+#ifndef SVGSC_JSONPARSE_H
+#define SVGSC_JSONPARSE_H
+
+#include <string> // string
+#include <vector> // vector
+#include <tuple> // pair
+
+class JSONValue {
+  public:
+    enum Type { JSON_NULL, JSON_BOOL, JSON_NUMBER, JSON_STRING, JSON_ARRAY, JSON_OBJECT };
+
+    // Constructor
+    JSONValue();
+
+    // returns the member value stored under the given key, or NULL if this is not an object or has no such key
+    const JSONValue* Find(const std::string& key) const;
+
+    // Member variables; only the one(s) matching the type are meaningful
+    Type type;
+    bool boolean;
+    double number;
+    std::string text;
+    std::vector<JSONValue> elements; // array values, in order
+    std::vector<std::pair<std::string, JSONValue>> members; // object members, in order
+};
+
+class JSONParseResult {
+  public:
+    // Constructor
+    JSONParseResult(const JSONValue& result_data, const std::string& result_error);
+
+    // Member variables
+    JSONValue data;
+    std::string error; // will be empty if result is successful
+};
+
+// parses a complete JSON document (https://www.json.org), decoding string escapes into UTF-8
+JSONParseResult ParseJSON(const std::string& json_data);
+
+#endif // SVGSC_JSONPARSE_H
@@ -0,0 +1,320 @@
+/*
+ * Description: implementations to shrink a gift cover after the greedy picks
+ * Author: Laura Galbraith
+*/
+
+#include "localsearch.hpp" // self-include header
+
+#include <vector> // vector
+#include <chrono> // steady_clock, microseconds
+#include <algorithm> // max
+
+#include "incidence.hpp" // IncidenceStore
+
+LocalSearchResult::LocalSearchResult()
+  : redundant_removed(0), one_for_two_swaps(0), two_for_three_swaps(0), local_optimum(false)
+{}
+
+const unsigned int BITS_PER_WORD = 64;
+
+// The cover being improved, with how many picked gifts cover each villager, and the villagers of each gift a swap has looked at as a bitset
+// a gift's bitset is only built when a swap first looks at it, under the time budget, so memory grows with the search and not with gifts * villagers
+class CoverImprover {
+  public:
+    CoverImprover(const IncidenceStore& store, const std::vector<unsigned int>& gift_ids, long time_budget_us, const std::vector<bool>* excluded_gift_flags, const std::vector<bool>* ignored_villager_flags)
+      : incidences(store),
+        words(static_cast<unsigned int>((store.VillagerCount() + BITS_PER_WORD - 1) / BITS_PER_WORD)),
+        picked(gift_ids),
+        picked_flags(store.GiftCount(), false),
+        excluded_flags(excluded_gift_flags != NULL ? *excluded_gift_flags : std::vector<bool>(store.GiftCount(), false)),
+        ignored_flags(ignored_villager_flags),
+        cover_counts(store.VillagerCount(), 0),
+        gift_bits(store.GiftCount()),
+        largest_gift(0),
+        covered_once(words, 0),
+        covered_twice(words, 0),
+        covered_thrice(words, 0),
+        need(words, 0),
+        rest(words, 0),
+        deadline(std::chrono::steady_clock::now() + std::chrono::microseconds(time_budget_us))
+    {
+      for (unsigned int gift_id = 0; gift_id < store.GiftCount(); ++gift_id) {
+        this->largest_gift = std::max(this->largest_gift, static_cast<unsigned int>(store.GiftVillagersEnd(gift_id) - store.GiftVillagersBegin(gift_id)));
+      }
+
+      for (auto g:this->picked) {
+        this->Cover(g, true);
+      }
+    }
+
+    // drops picked gifts whose villagers all have another gift, latest picks first since they tend to be the smallest
+    unsigned int RemoveRedundant() {
+      unsigned int removed = 0;
+      for (size_t picked_i = this->picked.size(); picked_i > 0; --picked_i) {
+        const unsigned int gift_id = this->picked[picked_i-1];
+        bool redundant = true;
+        for (const unsigned int* v_it = this->incidences.GiftVillagersBegin(gift_id); v_it != this->incidences.GiftVillagersEnd(gift_id) && redundant; ++v_it) {
+          redundant = this->cover_counts[*v_it] > 1 || this->Ignored(*v_it);
+        }
+        if (redundant) {
+          this->Unpick(picked_i-1);
+          ++removed;
+        }
+      }
+      return removed;
+    }
+
+    // one unpicked gift in for two picked ones: it must cover every villager only those two cover
+    bool TryOneForTwo() {
+      for (size_t i = 0; i < this->picked.size(); ++i) {
+        for (size_t j = i+1; j < this->picked.size(); ++j) {
+          if (this->OutOfTime()) {
+            return false;
+          }
+
+          const unsigned long long* a = this->Bits(this->picked[i]);
+          const unsigned long long* b = this->Bits(this->picked[j]);
+          for (unsigned int w = 0; w < this->words; ++w) {
+            this->need[w] = (this->covered_once[w] & (a[w] | b[w])) | (this->covered_twice[w] & a[w] & b[w]);
+          }
+          if (this->Count(this->need.data()) > this->largest_gift) {
+            continue;
+          }
+
+          // the gift swapped in must be loved by the needed villager with the fewest loved gifts, so only those are tried
+          const unsigned int pivot = this->RarestVillager(this->need.data());
+          for (const unsigned int* g_it = this->incidences.VillagerGiftsBegin(pivot); g_it != this->incidences.VillagerGiftsEnd(pivot); ++g_it) {
+            if (this->Swappable(*g_it) && this->Covers(this->Bits(*g_it), this->need.data())) {
+              this->Unpick(j);
+              this->Unpick(i);
+              this->Pick(*g_it);
+              return true;
+            }
+          }
+        }
+      }
+      return false;
+    }
+
+    // two unpicked gifts in for three picked ones (or one, if one is enough): together they must cover every villager only those three cover
+    bool TryTwoForThree() {
+      for (size_t i = 0; i < this->picked.size(); ++i) {
+        for (size_t j = i+1; j < this->picked.size(); ++j) {
+          for (size_t k = j+1; k < this->picked.size(); ++k) {
+            if (this->OutOfTime()) {
+              return false;
+            }
+
+            const unsigned long long* a = this->Bits(this->picked[i]);
+            const unsigned long long* b = this->Bits(this->picked[j]);
+            const unsigned long long* c = this->Bits(this->picked[k]);
+            for (unsigned int w = 0; w < this->words; ++w) {
+              const unsigned long long all_three = a[w] & b[w] & c[w];
+              const unsigned long long at_least_two = (a[w] & b[w]) | (a[w] & c[w]) | (b[w] & c[w]);
+              const unsigned long long only_one = (a[w] | b[w] | c[w]) & ~at_least_two;
+              this->need[w] = (this->covered_once[w] & only_one) | (this->covered_twice[w] & at_least_two & ~all_three) | (this->covered_thrice[w] & all_three);
+            }
+            if (this->Count(this->need.data()) > 2 * this->largest_gift) {
+              continue;
+            }
+
+            // one gift swapped in must be loved by the needed villager with the fewest loved gifts, and the other by whoever that leaves with the fewest
+            const unsigned int pivot = this->RarestVillager(this->need.data());
+            for (const unsigned int* first_it = this->incidences.VillagerGiftsBegin(pivot); first_it != this->incidences.VillagerGiftsEnd(pivot); ++first_it) {
+              if (!this->Swappable(*first_it)) {
+                continue;
+              }
+
+              const unsigned long long* first = this->Bits(*first_it);
+              for (unsigned int w = 0; w < this->words; ++w) {
+                this->rest[w] = this->need[w] & ~first[w];
+              }
+
+              const unsigned int rest_count = this->Count(this->rest.data());
+              if (rest_count > this->largest_gift) {
+                continue;
+              }
+              if (rest_count == 0) {
+                this->Unpick(k);
+                this->Unpick(j);
+                this->Unpick(i);
+                this->Pick(*first_it);
+                return true;
+              }
+
+              const unsigned int rest_pivot = this->RarestVillager(this->rest.data());
+              for (const unsigned int* second_it = this->incidences.VillagerGiftsBegin(rest_pivot); second_it != this->incidences.VillagerGiftsEnd(rest_pivot); ++second_it) {
+                if (this->Swappable(*second_it) && this->Covers(this->Bits(*second_it), this->rest.data())) {
+                  this->Unpick(k);
+                  this->Unpick(j);
+                  this->Unpick(i);
+                  this->Pick(*first_it);
+                  this->Pick(*second_it);
+                  return true;
+                }
+              }
+            }
+          }
+        }
+      }
+      return false;
+    }
+
+    bool OutOfTime() const {
+      return std::chrono::steady_clock::now() >= this->deadline;
+    }
+
+    const std::vector<unsigned int>& Picked() const {
+      return this->picked;
+    }
+
+  private:
+    // an ignored villager is in no gift's bitset, so no swap has to keep it covered
+    bool Ignored(unsigned int villager_id) const {
+      return this->ignored_flags != NULL && (*this->ignored_flags)[villager_id];
+    }
+
+    // builds the gift's bitset the first time it is asked for; each gift's bitset is its own allocation, so the pointer stays valid as others are built
+    const unsigned long long* Bits(unsigned int gift_id) {
+      std::vector<unsigned long long>& bits = this->gift_bits[gift_id];
+      if (bits.size() != this->words) {
+        bits.assign(this->words, 0);
+        for (const unsigned int* v_it = this->incidences.GiftVillagersBegin(gift_id); v_it != this->incidences.GiftVillagersEnd(gift_id); ++v_it) {
+          if (!this->Ignored(*v_it)) {
+            bits[*v_it / BITS_PER_WORD] |= 1ULL << (*v_it % BITS_PER_WORD);
+          }
+        }
+      }
+      return bits.data();
+    }
+
+    unsigned int Count(const unsigned long long* bits) const {
+      unsigned int count = 0;
+      for (unsigned int w = 0; w < this->words; ++w) {
+        count += static_cast<unsigned int>(__builtin_popcountll(bits[w]));
+      }
+      return count;
+    }
+
+    // the villager in the (non-empty) bitset who loves the fewest gifts
+    unsigned int RarestVillager(const unsigned long long* bits) const {
+      unsigned int rarest = 0;
+      size_t rarest_degree = this->incidences.GiftCount() + 1;
+      for (unsigned int w = 0; w < this->words; ++w) {
+        for (unsigned long long word = bits[w]; word != 0; word &= word - 1) {
+          const unsigned int villager_id = w * BITS_PER_WORD + static_cast<unsigned int>(__builtin_ctzll(word));
+          const size_t degree = static_cast<size_t>(this->incidences.VillagerGiftsEnd(villager_id) - this->incidences.VillagerGiftsBegin(villager_id));
+          if (degree < rarest_degree) {
+            rarest = villager_id;
+            rarest_degree = degree;
+          }
+        }
+      }
+      return rarest;
+    }
+
+    // not picked already, nor excluded
+    bool Swappable(unsigned int gift_id) const {
+      return !this->picked_flags[gift_id] && !this->excluded_flags[gift_id];
+    }
+
+    // true if every villager in 'needed' is in 'gift'
+    bool Covers(const unsigned long long* gift, const unsigned long long* needed) const {
+      for (unsigned int w = 0; w < this->words; ++w) {
+        if ((needed[w] & ~gift[w]) != 0) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    void Pick(unsigned int gift_id) {
+      this->picked.push_back(gift_id);
+      this->Cover(gift_id, true);
+    }
+
+    void Unpick(size_t picked_i) {
+      this->Cover(this->picked[picked_i], false);
+      this->picked.erase(this->picked.begin() + static_cast<long>(picked_i));
+    }
+
+    // moves each of the gift's villagers between the covered once, twice and three times bitsets as its count changes
+    void Cover(unsigned int gift_id, bool add) {
+      this->picked_flags[gift_id] = add;
+      for (const unsigned int* v_it = this->incidences.GiftVillagersBegin(gift_id); v_it != this->incidences.GiftVillagersEnd(gift_id); ++v_it) {
+        this->Classify(*v_it, false);
+        if (add) {
+          ++this->cover_counts[*v_it];
+        }
+        else {
+          --this->cover_counts[*v_it];
+        }
+        this->Classify(*v_it, true);
+      }
+    }
+
+    // sets or clears the villager's bit in the bitset for its cover count, if it has one
+    void Classify(unsigned int villager_id, bool set) {
+      std::vector<unsigned long long>* counted = NULL;
+      if (this->cover_counts[villager_id] == 1) {
+        counted = &this->covered_once;
+      }
+      else if (this->cover_counts[villager_id] == 2) {
+        counted = &this->covered_twice;
+      }
+      else if (this->cover_counts[villager_id] == 3) {
+        counted = &this->covered_thrice;
+      }
+      if (counted == NULL) {
+        return;
+      }
+
+      const unsigned long long bit = 1ULL << (villager_id % BITS_PER_WORD);
+      if (set) {
+        (*counted)[villager_id / BITS_PER_WORD] |= bit;
+      }
+      else {
+        (*counted)[villager_id / BITS_PER_WORD] &= ~bit;
+      }
+    }
+
+    const IncidenceStore& incidences;
+    unsigned int words; // per villager bitset
+    std::vector<unsigned int> picked;
+    std::vector<bool> picked_flags;
+    std::vector<bool> excluded_flags;
+    const std::vector<bool>* ignored_flags; // may be NULL
+    std::vector<unsigned int> cover_counts;
+    std::vector<std::vector<unsigned long long>> gift_bits; // a villager bitset per gift, empty until it is first needed
+    unsigned int largest_gift; // villagers, so a swap needing more than its gifts can cover is skipped without looking at them
+    std::vector<unsigned long long> covered_once;
+    std::vector<unsigned long long> covered_twice;
+    std::vector<unsigned long long> covered_thrice;
+    std::vector<unsigned long long> need; // scratch: villagers only the gifts being swapped out cover
+    std::vector<unsigned long long> rest; // scratch: what a second gift swapped in must still cover
+    std::chrono::steady_clock::time_point deadline;
+};
+
+LocalSearchResult ImproveCover(const IncidenceStore& incidences, const std::vector<unsigned int>& gift_ids, long time_budget_us, const std::vector<bool>* excluded_gift_flags, const std::vector<bool>* ignored_villager_flags) {
+  LocalSearchResult result;
+  CoverImprover improver = CoverImprover(incidences, gift_ids, time_budget_us, excluded_gift_flags, ignored_villager_flags);
+
+  result.redundant_removed += improver.RemoveRedundant();
+  while (!improver.OutOfTime()) {
+    if (improver.TryOneForTwo()) {
+      ++result.one_for_two_swaps;
+    }
+    else if (improver.TryTwoForThree()) {
+      ++result.two_for_three_swaps;
+    }
+    else {
+      result.local_optimum = !improver.OutOfTime();
+      break;
+    }
+
+    result.redundant_removed += improver.RemoveRedundant();
+  }
+
+  result.gift_ids = improver.Picked();
+  return result;
+}
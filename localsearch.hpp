@@ -0,0 +1,37 @@
+/*
+ * Description: interfaces to shrink a gift cover after the greedy picks
+ * Documentation: of the technique: https://en.m.wikipedia.org/wiki/Local_search_(optimization)
+ * Author: Laura Galbraith
+*/
+
+#ifndef SVGSC_LOCAL_SEARCH_H
+#define SVGSC_LOCAL_SEARCH_H
+
+#include <vector> // vector
+#include <cstddef> // NULL
+
+#include "incidence.hpp" // IncidenceStore
+
+class LocalSearchResult {
+  public:
+    // Constructor
+    LocalSearchResult();
+
+    // Member variables
+    std::vector<unsigned int> gift_ids; // the improved cover: kept gifts in their original order, then any swapped in
+    unsigned int redundant_removed; // gifts dropped because every villager they covered was covered by another
+    unsigned int one_for_two_swaps; // one gift swapped in for two
+    unsigned int two_for_three_swaps; // two gifts swapped in for three
+    bool local_optimum; // false if the time budget ran out first
+};
+
+// Improves a cover without uncovering anyone: first drops redundant gifts, then tries swapping one unpicked gift for two picked ones,
+// then two for three, dropping any gifts each swap makes redundant, until no swap helps or the time budget runs out
+// each candidate is checked with bitset operations on the villagers that only the gifts being swapped out cover, found from per-villager cover counts kept up to date on each swap
+// a gift's bitset is only built when a swap first looks at it, and swaps needing more villagers than the largest gifts could cover are skipped
+// the gifts swapped in are drawn only from those loved by the needed villager who loves the fewest gifts
+// gifts flagged in excluded_gift_flags are never swapped in, and villagers flagged in ignored_villager_flags need not stay covered; either may be NULL for none
+// O(picked^3 * max gifts per villager^2 * number of villagers / 64) per improvement
+LocalSearchResult ImproveCover(const IncidenceStore& incidences, const std::vector<unsigned int>& gift_ids, long time_budget_us, const std::vector<bool>* excluded_gift_flags = NULL, const std::vector<bool>* ignored_villager_flags = NULL);
+
+#endif // SVGSC_LOCAL_SEARCH_H
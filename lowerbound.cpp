@@ -0,0 +1,169 @@
+/*
+ * Description: implementations to bound how few gift types any cover can use
+ * Author: Laura Galbraith
+*/
+
+#include "lowerbound.hpp" // self-include header
+
+#include <vector> // vector
+#include <chrono> // steady_clock, microseconds, duration_cast
+#include <algorithm> // sort, max, min
+#include <cmath> // ceil
+
+#include "incidence.hpp" // IncidenceStore
+
+// subgradient steps are capped, and the step size halves after this many steps in a row find no better value, stopping once it is this small
+const unsigned int MAX_SUBGRADIENT_STEPS = 5000;
+const unsigned int STEPS_BEFORE_HALVING = 20;
+const double INITIAL_STEP_SCALE = 2.0;
+const double MIN_STEP_SCALE = 0.001;
+// relaxation values within this of a whole number are taken to be it, so rounding error cannot cost a gift type
+const double ROUNDING_TOLERANCE = 1e-6;
+
+CoverLowerBound::CoverLowerBound()
+  : bound(0), disjoint_villagers(0), by_size(0), relaxation(0), iterations(0), elapsed_us(0)
+{}
+
+// villagers no two of whom love the same gift each need their own gift type; the pickiest villagers are tried first
+unsigned int CountDisjointVillagers(const IncidenceStore& incidences, const std::vector<bool>& needed) {
+  std::vector<unsigned int> villagers;
+  for (unsigned int villager_id = 0; villager_id < needed.size(); ++villager_id) {
+    if (needed[villager_id]) {
+      villagers.push_back(villager_id);
+    }
+  }
+
+  auto degree = [&incidences](unsigned int villager_id) {
+    return incidences.VillagerGiftsEnd(villager_id) - incidences.VillagerGiftsBegin(villager_id);
+  };
+  std::sort(villagers.begin(), villagers.end(), [&degree](unsigned int a, unsigned int b) {
+    return degree(a) < degree(b) || (degree(a) == degree(b) && a < b);
+  });
+
+  std::vector<bool> gift_taken(incidences.GiftCount(), false);
+  unsigned int disjoint_villagers = 0;
+  for (auto v:villagers) {
+    bool disjoint = true;
+    for (const unsigned int* g_it = incidences.VillagerGiftsBegin(v); g_it != incidences.VillagerGiftsEnd(v) && disjoint; ++g_it) {
+      disjoint = !gift_taken[*g_it];
+    }
+    if (disjoint) {
+      ++disjoint_villagers;
+      for (const unsigned int* g_it = incidences.VillagerGiftsBegin(v); g_it != incidences.VillagerGiftsEnd(v); ++g_it) {
+        gift_taken[*g_it] = true;
+      }
+    }
+  }
+  return disjoint_villagers;
+}
+
+CoverLowerBound BoundCover(const IncidenceStore& incidences, const std::vector<unsigned int>& cover_gift_ids, long time_budget_us) {
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  const std::chrono::steady_clock::time_point deadline = start + std::chrono::microseconds(time_budget_us);
+  CoverLowerBound result;
+
+  // the villagers to cover are those the cover covers; no cover can reach the rest
+  std::vector<bool> needed(incidences.VillagerCount(), false);
+  unsigned int needed_count = 0;
+  for (auto g:cover_gift_ids) {
+    for (const unsigned int* v_it = incidences.GiftVillagersBegin(g); v_it != incidences.GiftVillagersEnd(g); ++v_it) {
+      if (!needed[*v_it]) {
+        needed[*v_it] = true;
+        ++needed_count;
+      }
+    }
+  }
+
+  // each gift only counts for the villagers still to cover
+  std::vector<unsigned int> needed_loved(incidences.GiftCount(), 0);
+  unsigned int largest_gift = 0;
+  for (unsigned int gift_id = 0; gift_id < incidences.GiftCount(); ++gift_id) {
+    for (const unsigned int* v_it = incidences.GiftVillagersBegin(gift_id); v_it != incidences.GiftVillagersEnd(gift_id); ++v_it) {
+      if (needed[*v_it]) {
+        ++needed_loved[gift_id];
+      }
+    }
+    largest_gift = std::max(largest_gift, needed_loved[gift_id]);
+  }
+
+  result.disjoint_villagers = CountDisjointVillagers(incidences, needed);
+  result.by_size = largest_gift > 0 ? (needed_count + largest_gift - 1) / largest_gift : 0;
+  result.bound = std::max(result.disjoint_villagers, result.by_size);
+
+  // Lagrangian relaxation: each villager's covering constraint is priced by a multiplier, so the relaxation's value is the sum of the multipliers,
+  // plus every gift whose villagers' multipliers add up to more than one, which is picked at its (negative) reduced cost
+  // a villager starts priced at one over the most needed villagers any gift they love is loved by
+  const double upper_bound = static_cast<double>(cover_gift_ids.size());
+  std::vector<double> multipliers(incidences.VillagerCount(), 0);
+  for (unsigned int villager_id = 0; villager_id < incidences.VillagerCount(); ++villager_id) {
+    if (!needed[villager_id]) {
+      continue;
+    }
+    unsigned int most_loved = 1;
+    for (const unsigned int* g_it = incidences.VillagerGiftsBegin(villager_id); g_it != incidences.VillagerGiftsEnd(villager_id); ++g_it) {
+      most_loved = std::max(most_loved, needed_loved[*g_it]);
+    }
+    multipliers[villager_id] = 1.0 / most_loved;
+  }
+
+  std::vector<unsigned int> picked_covers(incidences.VillagerCount(), 0);
+  double step_scale = INITIAL_STEP_SCALE;
+  unsigned int steps_without_improvement = 0;
+  while (result.bound < cover_gift_ids.size() && result.iterations < MAX_SUBGRADIENT_STEPS && std::chrono::steady_clock::now() < deadline) {
+    double value = 0;
+    for (unsigned int villager_id = 0; villager_id < incidences.VillagerCount(); ++villager_id) {
+      value += multipliers[villager_id];
+    }
+
+    picked_covers.assign(incidences.VillagerCount(), 0);
+    for (unsigned int gift_id = 0; gift_id < incidences.GiftCount(); ++gift_id) {
+      double reduced_cost = 1;
+      for (const unsigned int* v_it = incidences.GiftVillagersBegin(gift_id); v_it != incidences.GiftVillagersEnd(gift_id); ++v_it) {
+        reduced_cost -= multipliers[*v_it];
+      }
+      if (reduced_cost < 0) {
+        value += reduced_cost;
+        for (const unsigned int* v_it = incidences.GiftVillagersBegin(gift_id); v_it != incidences.GiftVillagersEnd(gift_id); ++v_it) {
+          ++picked_covers[*v_it];
+        }
+      }
+    }
+    ++result.iterations;
+
+    if (value > result.relaxation + ROUNDING_TOLERANCE) {
+      result.relaxation = value;
+      result.bound = std::max(result.bound, static_cast<unsigned int>(std::ceil(value - ROUNDING_TOLERANCE)));
+      steps_without_improvement = 0;
+    }
+    else if (++steps_without_improvement >= STEPS_BEFORE_HALVING) {
+      step_scale /= 2;
+      steps_without_improvement = 0;
+      if (step_scale < MIN_STEP_SCALE) {
+        break;
+      }
+    }
+
+    // the subgradient is how far each villager is from being covered exactly once by the gifts picked
+    double norm = 0;
+    for (unsigned int villager_id = 0; villager_id < incidences.VillagerCount(); ++villager_id) {
+      if (needed[villager_id]) {
+        const double gradient = 1 - static_cast<double>(picked_covers[villager_id]);
+        norm += gradient * gradient;
+      }
+    }
+    if (norm == 0) {
+      // the picked gifts cover everyone exactly once, so no multipliers do better
+      break;
+    }
+
+    const double step = step_scale * (upper_bound - value) / norm;
+    for (unsigned int villager_id = 0; villager_id < incidences.VillagerCount(); ++villager_id) {
+      if (needed[villager_id]) {
+        multipliers[villager_id] = std::max(0.0, multipliers[villager_id] + step * (1 - static_cast<double>(picked_covers[villager_id])));
+      }
+    }
+  }
+
+  result.elapsed_us = static_cast<long>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+  return result;
+}
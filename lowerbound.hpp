@@ -0,0 +1,35 @@
+/*
+ * Description: interfaces to bound how few gift types any cover can use
+ * Documentation: of the technique: https://en.m.wikipedia.org/wiki/Lagrangian_relaxation
+ * Author: Laura Galbraith
+*/
+
+#ifndef SVGSC_LOWER_BOUND_H
+#define SVGSC_LOWER_BOUND_H
+
+#include <vector> // vector
+
+#include "incidence.hpp" // IncidenceStore
+
+class CoverLowerBound {
+  public:
+    // Constructor
+    CoverLowerBound();
+
+    // Member variables
+    unsigned int bound; // no cover of the same villagers has fewer gift types: the largest of the bounds below, the relaxation's rounded up
+    unsigned int disjoint_villagers; // villagers no two of whom love the same gift, so each needs a gift type of their own
+    unsigned int by_size; // gift types it takes the most-loved gift to cover everyone
+    double relaxation; // the best Lagrangian relaxation value found; the linear programming relaxation is at least this
+    unsigned int iterations; // subgradient steps taken
+    long elapsed_us;
+};
+
+// Bounds the size of any cover of the villagers the given cover covers, against the cover's own size:
+// first counting villagers who share no loved gift, and dividing by the most-loved gift's villagers,
+// then maximizing the Lagrangian relaxation of the set cover linear program by subgradient steps, sized by the gap to the cover
+// stops as soon as the bound reaches the cover's size (so the cover is proven optimal), the steps stop improving, or the time budget runs out
+// O(number of loved gift incidences) per step
+CoverLowerBound BoundCover(const IncidenceStore& incidences, const std::vector<unsigned int>& cover_gift_ids, long time_budget_us);
+
+#endif // SVGSC_LOWER_BOUND_H
@@ -4,16 +4,89 @@
 */
 
 #include <iostream> // cout, endl
+#include <fstream> // ofstream
 #include <string> // string
 #include <regex> // regex, regex_search, smatch
 #include <vector> // vector
+#include <cstdlib> // strtoul
+#include <iomanip> // setw
+#include <sstream> // stringstream
+#include <algorithm> // max
+#include <thread> // hardware_concurrency
+#include <memory> // unique_ptr
+#include <stdexcept> // runtime_error
 
-#include "valleyfacts.hpp" // Gift, Villager, GiftsByVillager, GiftForVillagers
-#include "bucketqueue.hpp" // BucketQueue
+#include "valleyfacts.hpp" // Gift, Villager, GiftsByVillager, WikiLoadOptions, WikiSource
+#include "xmlparse.hpp" // XMLParseBackend
+#include "nametable.hpp" // NameTable
+#include "output.hpp" // SolutionWriter, GiftSolution, OutputFormat
+#include "dataset.hpp" // WikiDataset, ReadWikiDataset, WriteWikiDataset
+#include "curl.hpp" // CurlTransferStats, CurlURLOutcome
+#include "incidence.hpp" // IncidenceStore
+#include "sweep.hpp" // RunSweep, SweepResult, SweepVariant
+#include "embedded.hpp" // EmbeddedDataset, GetEmbeddedDataset
+#include "localsearch.hpp" // ImproveCover, LocalSearchResult
+#include "anytime.hpp" // SolveAnytime, AnytimeResult, AnytimeIncumbent, AnytimeMethodName
+#include "instance.hpp" // SetCoverInstance, SetCoverInstanceFormat, ReadSetCoverInstance
+#include "solver.hpp" // SolverContext, SolverQuery, IDSpan
+#include "parallelgreedy.hpp" // ParallelGreedyCover
+#include "lowerbound.hpp" // BoundCover, CoverLowerBound
+#include "maxcoverage.hpp" // SolveMaxCoverage, MaxCoverageResult
+#include "smallcover.hpp" // SolveSmallCover, SmallCoverResult
+#include "setstore.hpp" // BuildSetStore, SetStoreBuildStats, SetStore, StreamingGreedyCover, StreamingGreedyResult
+#include "perfcounters.hpp" // WritePerfReport, PERF_COUNTERS_COMPILED_IN
+#include "extractcache.hpp" // ExtractionCache, ExtractionCacheStats
+#include "engine.hpp" // ProfileInstance, ChooseEngine, EngineChoice, EngineOptions, EngineCalibration, ReadEngineCalibration, GreedyEngine
 
 // Constants for input format
 const std::string SKIP_VILLAGERS_FLAG = "--skip-villagers";
 const std::string SKIP_GIFTS_FLAG = "--missing-gifts";
+const std::string WIKI_SOURCE_FLAG = "--wiki-source";
+const std::string WIKI_SOURCE_HTML = "html";
+const std::string WIKI_SOURCE_WIKITEXT = "wikitext";
+const std::string WIKI_SOURCE_EMBEDDED = "embedded";
+const std::string WIKI_API_URL_FLAG = "--wiki-api-url";
+const std::string DATASET_FLAG = "--dataset";
+const std::string HTML_PARSER_FLAG = "--html-parser";
+const std::string HTML_PARSER_LIBXML2 = "libxml2";
+const std::string HTML_PARSER_SCANNER = "scanner";
+const std::string HTML_PARSER_VERIFY = "verify";
+const std::string EXTRACTION_CACHE_FLAG = "--extraction-cache";
+const std::string FORMAT_FLAG = "--format";
+const std::string FORMAT_TEXT = "text";
+const std::string FORMAT_JSON = "json";
+const std::string FORMAT_CSV = "csv";
+const std::string FORMAT_BINARY = "bin";
+const std::string TRANSFER_STATS_FLAG = "--transfer-stats";
+const std::string CONNECT_TIMEOUT_FLAG = "--connect-timeout-ms";
+const std::string TIMEOUT_FLAG = "--timeout-ms";
+const std::string MAX_ATTEMPTS_FLAG = "--max-attempts";
+const std::string HEDGE_PERCENTILE_FLAG = "--hedge-percentile";
+const std::string FETCH_WINDOW_FLAG = "--fetch-window";
+const unsigned long MAX_FETCH_WINDOW = 32;
+const std::string FETCH_REPORT_FLAG = "--fetch-report";
+const std::string SWEEP_FLAG = "--sweep";
+const std::string SWEEP_PAIRS_FLAG = "--sweep-pairs";
+const std::string THREADS_FLAG = "--threads";
+const std::string EMBEDDED_VERSION_FLAG = "--embedded-version";
+const std::string NO_LOCAL_SEARCH_FLAG = "--no-local-search";
+const std::string LOCAL_SEARCH_BUDGET_FLAG = "--local-search-us";
+const long DEFAULT_LOCAL_SEARCH_BUDGET_US = 10000;
+const std::string TIME_BUDGET_FLAG = "--time-budget-ms";
+const std::string LOWER_BOUND_FLAG = "--lower-bound";
+const long LOWER_BOUND_BUDGET_US = 1000000;
+const std::string MAX_GIFT_TYPES_FLAG = "--max-gift-types";
+const std::string INSTANCE_FLAG = "--instance";
+const std::string INSTANCE_FORMAT_FLAG = "--instance-format";
+const std::string INSTANCE_FORMAT_OR_LIBRARY = "orlib";
+const std::string INSTANCE_FORMAT_SET_LIST = "sets";
+const std::string BULK_GREEDY_FLAG = "--bulk-greedy";
+const std::string SET_STORE_FLAG = "--set-store";
+const std::string STORE_MEMORY_FLAG = "--store-memory-mb";
+const unsigned long DEFAULT_STORE_MEMORY_MB = 256;
+const std::string LIKED_TIER_FLAG = "--liked-tier";
+const std::string PERF_REPORT_FLAG = "--perf-report";
+const std::string ENGINE_CALIBRATION_FLAG = "--engine-calibration";
 const std::string HELP_FLAG = "--help";
 const char INPUT_LIST_SEPARATOR = ',';
 const std::regex NAME_RGX("^[a-zA-Zñ ']+$");
@@ -23,6 +96,35 @@ void PrintUsage() {
   std::cout << "Usage: <program> ";
   std::cout << "[" << SKIP_VILLAGERS_FLAG << " \"Villager1" << INPUT_LIST_SEPARATOR << "Villager2\"] ";
   std::cout << "[" << SKIP_GIFTS_FLAG << " \"GiftA" << INPUT_LIST_SEPARATOR << "GiftB\"] ";
+  std::cout << "[" << WIKI_SOURCE_FLAG << " " << WIKI_SOURCE_HTML << "|" << WIKI_SOURCE_WIKITEXT << "|" << WIKI_SOURCE_EMBEDDED << "] ";
+  std::cout << "[" << WIKI_API_URL_FLAG << " <url>] ";
+  std::cout << "[" << DATASET_FLAG << " <file>] ";
+  std::cout << "[" << HTML_PARSER_FLAG << " " << HTML_PARSER_LIBXML2 << "|" << HTML_PARSER_SCANNER << "|" << HTML_PARSER_VERIFY << "] ";
+  std::cout << "[" << EXTRACTION_CACHE_FLAG << " <file>] ";
+  std::cout << "[" << FORMAT_FLAG << " " << FORMAT_TEXT << "|" << FORMAT_JSON << "|" << FORMAT_CSV << "|" << FORMAT_BINARY << "] ";
+  std::cout << "[" << TRANSFER_STATS_FLAG << "] ";
+  std::cout << "[" << CONNECT_TIMEOUT_FLAG << " <ms>] ";
+  std::cout << "[" << TIMEOUT_FLAG << " <ms>] ";
+  std::cout << "[" << MAX_ATTEMPTS_FLAG << " <n>] ";
+  std::cout << "[" << HEDGE_PERCENTILE_FLAG << " <1-99>] ";
+  std::cout << "[" << FETCH_WINDOW_FLAG << " <1-" << MAX_FETCH_WINDOW << ">] ";
+  std::cout << "[" << FETCH_REPORT_FLAG << "] ";
+  std::cout << "[" << SWEEP_FLAG << "|" << SWEEP_PAIRS_FLAG << "] ";
+  std::cout << "[" << THREADS_FLAG << " <n>] ";
+  std::cout << "[" << EMBEDDED_VERSION_FLAG << "] ";
+  std::cout << "[" << NO_LOCAL_SEARCH_FLAG << "] ";
+  std::cout << "[" << LOCAL_SEARCH_BUDGET_FLAG << " <microseconds>] ";
+  std::cout << "[" << TIME_BUDGET_FLAG << " <ms>] ";
+  std::cout << "[" << LOWER_BOUND_FLAG << "] ";
+  std::cout << "[" << MAX_GIFT_TYPES_FLAG << " <k>] ";
+  std::cout << "[" << INSTANCE_FLAG << " <file>] ";
+  std::cout << "[" << INSTANCE_FORMAT_FLAG << " " << INSTANCE_FORMAT_OR_LIBRARY << "|" << INSTANCE_FORMAT_SET_LIST << "] ";
+  std::cout << "[" << BULK_GREEDY_FLAG << "] ";
+  std::cout << "[" << SET_STORE_FLAG << " <file>] ";
+  std::cout << "[" << STORE_MEMORY_FLAG << " <MB>] ";
+  std::cout << "[" << LIKED_TIER_FLAG << "] ";
+  std::cout << "[" << PERF_REPORT_FLAG << " <file>] ";
+  std::cout << "[" << ENGINE_CALIBRATION_FLAG << " <file>] ";
   std::cout << "[" << HELP_FLAG << "]" << std::endl;
   std::cout << std::endl;
 }
@@ -74,10 +176,200 @@ std::vector<std::string> GetSeparatedNameList(const std::string& s) {
   return ret;
 }
 
+// returns false if the string is not a whole number no greater than the maximum
+bool ParseNumber(const std::string& s, unsigned long max_value, unsigned long* value) {
+  if (s.empty() || s.find_first_not_of("0123456789") != std::string::npos) {
+    return false;
+  }
+
+  *value = std::strtoul(s.c_str(), NULL, 10);
+  return *value <= max_value;
+}
+
+// prints the variants that need more gift types or leave villagers uncovered, most affected first
+// a variant needing fewer gift types only shows the heuristics missing a smaller cover, so it is counted with the unchanged ones
+// ex. "    +2       0  Prismatic Shard (gift)"
+void PrintSweep(const SweepResult& sweep, const IncidenceStore& incidences, bool local_search) {
+  std::cout << "Gift types needed without each gift or villager" << (local_search ? ", after local search," : " by the greedy cover alone,") << " against " << sweep.base.gift_types << " with everything";
+  if (sweep.base.uncovered_villagers > 0) {
+    std::cout << " (" << sweep.base.uncovered_villagers << " villagers uncovered)";
+  }
+  std::cout << ":" << std::endl;
+  std::cout << "    " << std::setw(6) << "change" << "  " << std::setw(9) << "uncovered" << "  without" << std::endl;
+
+  size_t unchanged = 0;
+  for (const auto& variant:sweep.variants) {
+    if (variant.gift_types <= sweep.base.gift_types && variant.uncovered_villagers == sweep.base.uncovered_villagers) {
+      ++unchanged;
+      continue;
+    }
+
+    std::stringstream change;
+    change << "+" << (variant.gift_types > sweep.base.gift_types ? variant.gift_types - sweep.base.gift_types : 0);
+    std::cout << "    " << std::setw(6) << change.str() << "  " << std::setw(9) << variant.uncovered_villagers << "  ";
+
+    std::string separator = "";
+    for (auto g:variant.removed_gifts) {
+      std::cout << separator << incidences.GetGiftNames().Name(g) << " (gift)";
+      separator = ", ";
+    }
+    for (auto v:variant.skipped_villagers) {
+      std::cout << separator << incidences.GetVillagerNames().Name(v) << " (villager)";
+      separator = ", ";
+    }
+    std::cout << std::endl;
+  }
+
+  std::cout << "    (" << unchanged << " other variants need no more gift types)" << std::endl;
+}
+
+// ex. "Cover of 9 gift types at 1.25 ms (exact search), at least 8 needed: Gift A, Gift B"
+void PrintIncumbent(std::ostream& os, const AnytimeIncumbent& incumbent, const NameTable& gift_names) {
+  os << "Cover of " << incumbent.gift_ids.size() << " gift type" << (incumbent.gift_ids.size() == 1 ? "" : "s") << " at ";
+  os << static_cast<double>(incumbent.elapsed_us) / 1000 << " ms (" << AnytimeMethodName(incumbent.method) << "), ";
+  if (incumbent.optimal) {
+    os << "proven optimal";
+  }
+  else {
+    os << "at least " << incumbent.lower_bound << " needed";
+  }
+  os << ":";
+
+  std::string separator = " ";
+  for (auto g:incumbent.gift_ids) {
+    os << separator << gift_names.Name(g);
+    separator = ", ";
+  }
+  os << std::endl;
+}
+
+// one line per URL, in the order GiftsByVillager::GetURLOutcomes gives them
+// ex. "    https://stardewvalleywiki.com/Abigail: failed after 3 attempts in 1500 ms, hedged"
+void PrintFetchReport(std::ostream& os, const std::vector<CurlURLOutcome>& url_outcomes) {
+  os << "Wiki fetches:" << std::endl;
+  for (const auto& outcome:url_outcomes) {
+    os << "    " << outcome.url << ": " << (outcome.error == "" ? "fetched" : "failed") << " after ";
+    os << outcome.attempts << " attempt" << (outcome.attempts == 1 ? "" : "s") << " in " << outcome.elapsed_ms << " ms";
+    if (outcome.hedged) {
+      os << ", hedged" << (outcome.hedge_won ? " (the hedge finished first)" : "");
+    }
+    os << std::endl;
+  }
+  os << std::endl;
+}
+
+// one line per number of gift types, up to what covers everyone who can be
+// ex. "     2      31  (9 uncovered)  optimal"
+void PrintCoverage(std::ostream& os, const MaxCoverageResult& coverage, size_t villager_count, bool exact) {
+  os << "Villagers covered by the best k gift types";
+  if (exact) {
+    os << ", after " << coverage.exact_nodes << " exact search nodes in " << static_cast<double>(coverage.elapsed_us) / 1000 << " ms";
+  }
+  os << ":" << std::endl;
+  os << "    " << std::setw(4) << "k" << "  " << std::setw(7) << "covered" << std::endl;
+  for (size_t k = 1; k <= coverage.covered.size(); ++k) {
+    os << "    " << std::setw(4) << k << "  " << std::setw(7) << coverage.covered[k-1] << "  (" << villager_count - coverage.covered[k-1] << " uncovered)";
+    os << (coverage.optimal[k-1] ? "  optimal" : "") << std::endl;
+  }
+  os << std::endl;
+}
+
+// writes the hardware counters' totals for each region, as JSON, to the file
+// returns 0 if successful, or -1 after printing why not
+int WritePerfReportFile(const std::string& path) {
+  std::ofstream file(path.c_str(), std::ios::trunc);
+  if (!file) {
+    std::cerr << "could not open " << path << " for the performance report" << std::endl;
+    return -1;
+  }
+
+  const std::string report_error = WritePerfReport(file);
+  file.close();
+  if (report_error != "" || file.fail()) {
+    std::cerr << "could not write the performance report: " << (report_error != "" ? report_error : "write failed") << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+// builds the store from the instance file first if there is one, then covers it straight from the file, printing what it took to report_stream
+// the solution names only the gifts picked, so the rest of the gift names are never read
+int SolveSetStore(const std::string& store_path, const std::string& instance_path, SetCoverInstanceFormat instance_format, unsigned long store_memory_mb, OutputFormat output_format) {
+  std::ostream& report_stream = output_format == OutputFormat::TEXT ? std::cout : std::cerr;
+
+  if (instance_path != "") {
+    SetStoreBuildStats built;
+    const std::string build_error = BuildSetStore(instance_path, instance_format, store_path, store_memory_mb << 20, &built);
+    if (build_error != "") {
+      std::cerr << "could not build set store: " << build_error << std::endl;
+      return -1;
+    }
+    if (!built.unit_costs) {
+      std::cerr << "set costs in " << instance_path << " are ignored: every set counts as one" << std::endl;
+    }
+    report_stream << "Built " << store_path << " from " << instance_path << " in " << built.passes << " passes over it: ";
+    report_stream << built.incidences << " incidences in " << built.store_bytes << " bytes" << std::endl;
+  }
+
+  SetStore store;
+  const std::string open_error = store.Open(store_path);
+  if (open_error != "") {
+    std::cerr << "could not read set store: " << open_error << std::endl;
+    return -1;
+  }
+
+  GiftSolution solution;
+  const StreamingGreedyResult streamed = StreamingGreedyCover(store, &solution);
+  if (streamed.error != "") {
+    std::cerr << "could not solve set store: " << streamed.error << std::endl;
+    return -1;
+  }
+
+  NameTable gift_names;
+  for (auto& g:solution.gift_ids) {
+    g = gift_names.Intern(store.GiftName(g));
+  }
+  NameTable villager_names;
+  store.ReadVillagerNames(&villager_names);
+
+  SolutionWriter writer(std::cout, output_format, gift_names, villager_names);
+  writer.Write(solution);
+  writer.Flush();
+
+  report_stream << "Streamed the store " << streamed.passes << " times, lowering the gain each pick needs: " << streamed.bytes_scanned << " of " << store.FileBytes() << " bytes scanned in all, ";
+  report_stream << streamed.resident_bytes << " bytes of gains and covered flags kept in memory" << std::endl;
+  report_stream << std::endl;
+  return 0;
+}
+
 int main(int argc, char *argv[]) {
   // Parse user input
   std::vector<Villager> villagers_to_skip;
   std::vector<Gift> gifts_to_skip;
+  WikiLoadOptions load_options;
+  bool source_specified = false;
+  bool embedded_source = false;
+  std::string dataset_path;
+  OutputFormat output_format = OutputFormat::TEXT;
+  bool print_transfer_stats = false;
+  bool print_fetch_report = false;
+  bool sweep = false;
+  bool sweep_pairs = false;
+  unsigned int thread_count = 0;
+  bool local_search = true;
+  long local_search_budget_us = DEFAULT_LOCAL_SEARCH_BUDGET_US;
+  long time_budget_ms = -1; // no anytime solve
+  bool lower_bound = false;
+  unsigned int max_gift_types = 0; // no limit: cover everyone
+  std::string instance_path;
+  SetCoverInstanceFormat instance_format = SetCoverInstanceFormat::DETECT;
+  bool bulk_greedy = false;
+  bool liked_tier = false;
+  std::string set_store_path;
+  unsigned long store_memory_mb = 0; // unset: DEFAULT_STORE_MEMORY_MB
+  std::string perf_report_path;
+  std::string extraction_cache_path;
+  std::string engine_calibration_path;
 
   int i = 1; // arg 0 is the program name: skip
   while (i < argc) {
@@ -128,61 +420,681 @@ int main(int argc, char *argv[]) {
       // move past 2-part arg
       i += 2;
     }
+    else if (option == WIKI_SOURCE_FLAG) {
+      // check there is a following argument
+      if (i+1 >= argc) {
+        PrintUsage();
+        return -1;
+      }
+
+      std::string source = std::string(argv[i+1]);
+      embedded_source = false;
+      if (source == WIKI_SOURCE_HTML) {
+        load_options.source = WikiSource::RENDERED_HTML;
+      }
+      else if (source == WIKI_SOURCE_WIKITEXT) {
+        load_options.source = WikiSource::WIKITEXT;
+      }
+      else if (source == WIKI_SOURCE_EMBEDDED) {
+        embedded_source = true;
+      }
+      else {
+        PrintUsage();
+        return -1;
+      }
+      source_specified = true;
+
+      // move past 2-part arg
+      i += 2;
+    }
+    else if (option == WIKI_API_URL_FLAG) {
+      // check there is a following argument
+      if (i+1 >= argc) {
+        PrintUsage();
+        return -1;
+      }
+
+      load_options.api_url = std::string(argv[i+1]);
+
+      // move past 2-part arg
+      i += 2;
+    }
+    else if (option == DATASET_FLAG) {
+      // check there is a following argument
+      if (i+1 >= argc) {
+        PrintUsage();
+        return -1;
+      }
+
+      dataset_path = std::string(argv[i+1]);
+
+      // move past 2-part arg
+      i += 2;
+    }
+    else if (option == INSTANCE_FLAG) {
+      // check there is a following argument
+      if (i+1 >= argc) {
+        PrintUsage();
+        return -1;
+      }
+
+      instance_path = std::string(argv[i+1]);
+
+      // move past 2-part arg
+      i += 2;
+    }
+    else if (option == INSTANCE_FORMAT_FLAG) {
+      // check there is a following argument
+      if (i+1 >= argc) {
+        PrintUsage();
+        return -1;
+      }
+
+      const std::string format_name = std::string(argv[i+1]);
+      if (format_name == INSTANCE_FORMAT_OR_LIBRARY) {
+        instance_format = SetCoverInstanceFormat::OR_LIBRARY;
+      }
+      else if (format_name == INSTANCE_FORMAT_SET_LIST) {
+        instance_format = SetCoverInstanceFormat::SET_LIST;
+      }
+      else {
+        PrintUsage();
+        return -1;
+      }
+
+      // move past 2-part arg
+      i += 2;
+    }
+    else if (option == SET_STORE_FLAG) {
+      // check there is a following argument
+      if (i+1 >= argc) {
+        PrintUsage();
+        return -1;
+      }
+
+      set_store_path = std::string(argv[i+1]);
+
+      // move past 2-part arg
+      i += 2;
+    }
+    else if (option == EXTRACTION_CACHE_FLAG) {
+      // check there is a following argument
+      if (i+1 >= argc) {
+        PrintUsage();
+        return -1;
+      }
+
+      extraction_cache_path = std::string(argv[i+1]);
+
+      // move past 2-part arg
+      i += 2;
+    }
+    else if (option == PERF_REPORT_FLAG) {
+      // check there is a following argument
+      if (i+1 >= argc) {
+        PrintUsage();
+        return -1;
+      }
+
+      perf_report_path = std::string(argv[i+1]);
+
+      // move past 2-part arg
+      i += 2;
+    }
+    else if (option == ENGINE_CALIBRATION_FLAG) {
+      // check there is a following argument
+      if (i+1 >= argc) {
+        PrintUsage();
+        return -1;
+      }
+
+      engine_calibration_path = std::string(argv[i+1]);
+
+      // move past 2-part arg
+      i += 2;
+    }
+    else if (option == STORE_MEMORY_FLAG) {
+      // check there is a following argument
+      if (i+1 >= argc) {
+        PrintUsage();
+        return -1;
+      }
+
+      if (!ParseNumber(std::string(argv[i+1]), 1 << 20, &store_memory_mb) || store_memory_mb <= 0) {
+        PrintUsage();
+        return -1;
+      }
+
+      // move past 2-part arg
+      i += 2;
+    }
+    else if (option == BULK_GREEDY_FLAG) {
+      bulk_greedy = true;
+      ++i;
+    }
+    else if (option == LIKED_TIER_FLAG) {
+      liked_tier = true;
+      ++i;
+    }
+    else if (option == HTML_PARSER_FLAG) {
+      // check there is a following argument
+      if (i+1 >= argc) {
+        PrintUsage();
+        return -1;
+      }
+
+      std::string parser = std::string(argv[i+1]);
+      if (parser == HTML_PARSER_LIBXML2) {
+        load_options.html_parser = XMLParseBackend::LIBXML2;
+      }
+      else if (parser == HTML_PARSER_SCANNER) {
+        load_options.html_parser = XMLParseBackend::SCANNER;
+      }
+      else if (parser == HTML_PARSER_VERIFY) {
+        load_options.html_parser = XMLParseBackend::VERIFY;
+      }
+      else {
+        PrintUsage();
+        return -1;
+      }
+
+      // move past 2-part arg
+      i += 2;
+    }
+    else if (option == FORMAT_FLAG) {
+      // check there is a following argument
+      if (i+1 >= argc) {
+        PrintUsage();
+        return -1;
+      }
+
+      std::string format = std::string(argv[i+1]);
+      if (format == FORMAT_TEXT) {
+        output_format = OutputFormat::TEXT;
+      }
+      else if (format == FORMAT_JSON) {
+        output_format = OutputFormat::JSON;
+      }
+      else if (format == FORMAT_CSV) {
+        output_format = OutputFormat::CSV;
+      }
+      else if (format == FORMAT_BINARY) {
+        output_format = OutputFormat::BINARY;
+      }
+      else {
+        PrintUsage();
+        return -1;
+      }
+
+      // move past 2-part arg
+      i += 2;
+    }
+    else if (option == TRANSFER_STATS_FLAG) {
+      print_transfer_stats = true;
+      ++i;
+    }
+    else if (option == CONNECT_TIMEOUT_FLAG || option == TIMEOUT_FLAG || option == MAX_ATTEMPTS_FLAG || option == HEDGE_PERCENTILE_FLAG || option == FETCH_WINDOW_FLAG) {
+      // check there is a following argument
+      if (i+1 >= argc) {
+        PrintUsage();
+        return -1;
+      }
+
+      const unsigned long max_value = option == HEDGE_PERCENTILE_FLAG ? 99 : option == FETCH_WINDOW_FLAG ? MAX_FETCH_WINDOW : 86400000; // a day of milliseconds is more than enough of anything
+      unsigned long value = 0;
+      if (!ParseNumber(std::string(argv[i+1]), max_value, &value) || ((option == MAX_ATTEMPTS_FLAG || option == FETCH_WINDOW_FLAG) && value <= 0)) {
+        PrintUsage();
+        return -1;
+      }
+
+      if (option == CONNECT_TIMEOUT_FLAG) {
+        load_options.request_policy.connect_timeout_ms = static_cast<long>(value);
+      }
+      else if (option == TIMEOUT_FLAG) {
+        load_options.request_policy.total_timeout_ms = static_cast<long>(value);
+      }
+      else if (option == MAX_ATTEMPTS_FLAG) {
+        load_options.request_policy.max_attempts = static_cast<unsigned int>(value);
+      }
+      else if (option == HEDGE_PERCENTILE_FLAG) {
+        load_options.request_policy.hedge_percentile = static_cast<unsigned int>(value);
+      }
+      else {
+        load_options.fetch_window = static_cast<unsigned int>(value);
+      }
+
+      // move past 2-part arg
+      i += 2;
+    }
+    else if (option == FETCH_REPORT_FLAG) {
+      print_fetch_report = true;
+      ++i;
+    }
+    else if (option == SWEEP_FLAG || option == SWEEP_PAIRS_FLAG) {
+      sweep = true;
+      sweep_pairs = sweep_pairs || option == SWEEP_PAIRS_FLAG;
+      ++i;
+    }
+    else if (option == EMBEDDED_VERSION_FLAG) {
+      const EmbeddedDataset* embedded = GetEmbeddedDataset();
+      if (embedded == NULL) {
+        std::cout << "No dataset is embedded in this build" << std::endl;
+        return -1;
+      }
+
+      std::cout << "Embedded dataset: " << embedded->version << "; " << embedded->villager_count << " villagers, " << embedded->gift_count << " gifts" << std::endl;
+      return 0;
+    }
+    else if (option == NO_LOCAL_SEARCH_FLAG) {
+      local_search = false;
+      ++i;
+    }
+    else if (option == LOCAL_SEARCH_BUDGET_FLAG) {
+      // check there is a following argument
+      if (i+1 >= argc) {
+        PrintUsage();
+        return -1;
+      }
+
+      unsigned long value = 0;
+      if (!ParseNumber(std::string(argv[i+1]), 60000000, &value)) {
+        PrintUsage();
+        return -1;
+      }
+      local_search_budget_us = static_cast<long>(value);
+
+      // move past 2-part arg
+      i += 2;
+    }
+    else if (option == TIME_BUDGET_FLAG) {
+      // check there is a following argument
+      if (i+1 >= argc) {
+        PrintUsage();
+        return -1;
+      }
+
+      unsigned long value = 0;
+      if (!ParseNumber(std::string(argv[i+1]), 3600000, &value)) {
+        PrintUsage();
+        return -1;
+      }
+      time_budget_ms = static_cast<long>(value);
+
+      // move past 2-part arg
+      i += 2;
+    }
+    else if (option == LOWER_BOUND_FLAG) {
+      lower_bound = true;
+      ++i;
+    }
+    else if (option == MAX_GIFT_TYPES_FLAG) {
+      // check there is a following argument
+      if (i+1 >= argc) {
+        PrintUsage();
+        return -1;
+      }
+
+      unsigned long value = 0;
+      if (!ParseNumber(std::string(argv[i+1]), 1000000, &value) || value <= 0) {
+        PrintUsage();
+        return -1;
+      }
+      max_gift_types = static_cast<unsigned int>(value);
+
+      // move past 2-part arg
+      i += 2;
+    }
+    else if (option == THREADS_FLAG) {
+      // check there is a following argument
+      if (i+1 >= argc) {
+        PrintUsage();
+        return -1;
+      }
+
+      unsigned long value = 0;
+      if (!ParseNumber(std::string(argv[i+1]), 1024, &value) || value <= 0) {
+        PrintUsage();
+        return -1;
+      }
+      thread_count = static_cast<unsigned int>(value);
+
+      // move past 2-part arg
+      i += 2;
+    }
     else {
       PrintUsage();
       return option == HELP_FLAG ? 0 : -1;
     }
   }
 
-  // Populate gift/villager relationships
-  GiftsByVillager gifts_and_villagers = GiftsByVillager(villagers_to_skip, gifts_to_skip);
+  // the counters are only compiled into 'make profiled' builds
+  if (perf_report_path != "" && !PERF_COUNTERS_COMPILED_IN) {
+    std::cerr << "performance counters are not compiled into this build; see 'make profiled'" << std::endl;
+    return -1;
+  }
 
-  // Set up data for set-covering
-  std::vector<GiftForVillagers> gifts_for_villagers = gifts_and_villagers.GetGiftSets();
+  // the sweep table is only printed as text
+  if (sweep && output_format != OutputFormat::TEXT) {
+    PrintUsage();
+    return -1;
+  }
 
-  BucketQueue<GiftForVillagers> bucket_queue = BucketQueue<GiftForVillagers>(gifts_for_villagers);
+  // the anytime solve is made of local search among other things, so cannot go without it
+  if (time_budget_ms >= 0 && !local_search) {
+    PrintUsage();
+    return -1;
+  }
 
-  // Perform set-covering: https://en.m.wikipedia.org/wiki/Set_cover_problem#Greedy_algorithm
-  std::vector<GiftForVillagers> loved_gifts;
-  unsigned int coverable_villagers = 1;
-  do {
-    GiftForVillagers next_gift = bucket_queue.GetHighestPrioritySet();
-    bucket_queue.DeleteHighestPrioritySet();
+  // with a limit on gift types, some villagers go without, so there is no smaller cover of everyone to search for or bound
+  if (max_gift_types > 0 && lower_bound) {
+    PrintUsage();
+    return -1;
+  }
+  // the best k gift types are read off the first k picks, which bulk rounds do not make in greedy order
+  if (max_gift_types > 0 && bulk_greedy) {
+    PrintUsage();
+    return -1;
+  }
 
-    coverable_villagers = next_gift.Size();
-    if (coverable_villagers > 0) {
-      loved_gifts.push_back(next_gift);
+  // An instance file replaces the wiki entirely, so nothing about reading the wiki applies to it
+  const bool use_instance = instance_path != "";
+  // the wiki's few gifts are solved by the bucket queue, which has no rounds to bulk up
+  if (bulk_greedy && !use_instance) {
+    PrintUsage();
+    return -1;
+  }
+  if (use_instance && (source_specified || dataset_path != "" || !villagers_to_skip.empty() || !gifts_to_skip.empty())) {
+    PrintUsage();
+    return -1;
+  }
+  // instances have no liked sets, and a limit on gift types leaves villagers without on purpose
+  if (liked_tier && (use_instance || max_gift_types > 0)) {
+    PrintUsage();
+    return -1;
+  }
+
+  // A set store is covered in passes over the file, with nothing else held in memory to search or bound with; the memory budget is for building it from an instance
+  const bool use_set_store = set_store_path != "";
+  if (store_memory_mb > 0 && !(use_set_store && use_instance)) {
+    PrintUsage();
+    return -1;
+  }
+  if (use_set_store && (source_specified || dataset_path != "" || !villagers_to_skip.empty() || !gifts_to_skip.empty() || liked_tier || sweep || lower_bound || time_budget_ms >= 0 || max_gift_types > 0 || thread_count > 1 || bulk_greedy || extraction_cache_path != "" || engine_calibration_path != "")) {
+    PrintUsage();
+    return -1;
+  }
+  if (use_set_store) {
+    const int store_result = SolveSetStore(set_store_path, instance_path, instance_format, store_memory_mb > 0 ? store_memory_mb : DEFAULT_STORE_MEMORY_MB, output_format);
+    return store_result == 0 && perf_report_path != "" ? WritePerfReportFile(perf_report_path) : store_result;
+  }
+
+  // A build with an embedded dataset uses it unless told to read the wiki or an instance
+  const EmbeddedDataset* embedded = GetEmbeddedDataset();
+  if (embedded_source && embedded == NULL) {
+    std::cerr << "no dataset is embedded in this build; see 'make embedded'" << std::endl;
+    return -1;
+  }
+  const bool use_embedded = embedded_source || (embedded != NULL && !source_specified && dataset_path == "" && !use_instance);
+  if (use_embedded && liked_tier) {
+    std::cerr << "the embedded dataset has no liked gifts; read the wiki or a dataset instead" << std::endl;
+    return -1;
+  }
+  load_options.liked_gifts = liked_tier;
+
+  // Only the rendered pages are parsed from HTML, so only they have extractions to keep
+  if (extraction_cache_path != "" && (use_instance || use_embedded || dataset_path != "" || load_options.source != WikiSource::RENDERED_HTML)) {
+    PrintUsage();
+    return -1;
+  }
+  ExtractionCache extraction_cache;
+  if (extraction_cache_path != "") {
+    const std::string read_error = extraction_cache.Read(extraction_cache_path);
+    if (read_error != "") {
+      std::cerr << "could not read extraction cache: " << read_error << std::endl;
+      return -1;
     }
-  } while (coverable_villagers > 0);
+    load_options.extraction_cache = &extraction_cache;
+  }
 
-  // Check that set-covering algorithm did complete given constraints from user input
-  const GiftForVillagers covered_villagers = bucket_queue.GetCoveredElements();
-  if (covered_villagers.Size() != gifts_and_villagers.GetVillagers().size()) {
-    // tell the user that the set-covering algorithm could not complete
-    std::cout << "Not all villagers can receive a 'loved' gift with the provided input; these villagers could receive a 'liked' gift instead: ";
+  // without a calibration from this machine, the engine is chosen by how fast the engines ran where the defaults were measured
+  EngineCalibration engine_calibration;
+  if (engine_calibration_path != "") {
+    std::string read_error = ReadEngineCalibration(engine_calibration_path, &engine_calibration);
+    if (read_error != "") {
+      std::cerr << "could not read engine calibration: " << read_error << std::endl;
+      return -1;
+    }
+  }
 
-    // print what villagers remain uncovered
-    GiftForVillagers all_villagers = GiftForVillagers("", gifts_and_villagers.GetVillagers());
-    all_villagers.RemoveElements(covered_villagers);
-    std::vector<Villager> remaining_villagers = all_villagers.GetVillagers();
-    for (std::vector<Villager>::size_type villager_i = 0; villager_i < remaining_villagers.size(); ++villager_i) {
-      std::cout << remaining_villagers[villager_i];
-      if (villager_i != remaining_villagers.size()-1) {
-        std::cout << ", ";
-      }
+  SetCoverInstance instance;
+  if (use_instance) {
+    std::string read_error = ReadSetCoverInstance(instance_path, instance_format, &instance);
+    if (read_error != "") {
+      std::cerr << "could not read instance: " << read_error << std::endl;
+      return -1;
     }
-    std::cout << std::endl;
+    if (!instance.unit_costs) {
+      std::cerr << "set costs in " << instance_path << " are ignored: every set counts as one" << std::endl;
+    }
+  }
+
+  // A stored dataset records page revisions, which only the wiki API provides
+  WikiDataset stored_dataset;
+  if (dataset_path != "") {
+    if (source_specified && (embedded_source || load_options.source != WikiSource::WIKITEXT)) {
+      PrintUsage();
+      return -1;
+    }
+    load_options.source = WikiSource::WIKITEXT;
+
+    WikiDatasetResult read_dataset = ReadWikiDataset(dataset_path);
+    if (read_dataset.error != "") {
+      std::cerr << "could not read dataset: " << read_dataset.error << std::endl;
+      return -1;
+    }
+    stored_dataset = read_dataset.data;
+  }
+
+  // Populate gift/villager relationships; a wiki fetch that still fails after every retry ends the run, but the fetches so far can still be reported
+  std::vector<CurlURLOutcome> failed_url_outcomes;
+  load_options.failed_url_outcomes = &failed_url_outcomes;
+  std::unique_ptr<GiftsByVillager> loaded_gifts_and_villagers;
+  try {
+    loaded_gifts_and_villagers.reset(use_instance ? new GiftsByVillager(&instance) : use_embedded ? new GiftsByVillager(villagers_to_skip, gifts_to_skip, *embedded) : new GiftsByVillager(villagers_to_skip, gifts_to_skip, load_options, stored_dataset));
+  }
+  catch (const std::runtime_error& e) {
+    std::cerr << "could not load the wiki: " << e.what() << std::endl;
+    if (print_fetch_report) {
+      PrintFetchReport(output_format == OutputFormat::TEXT ? std::cout : std::cerr, failed_url_outcomes);
+    }
+    return -1;
+  }
+  GiftsByVillager& gifts_and_villagers = *loaded_gifts_and_villagers;
+
+  if (dataset_path != "") {
+    std::string write_error = WriteWikiDataset(dataset_path, gifts_and_villagers.GetDataset());
+    if (write_error != "") {
+      std::cerr << "could not store dataset: " << write_error << std::endl;
+      return -1;
+    }
+  }
+  if (extraction_cache_path != "") {
+    std::string write_error = extraction_cache.Write(extraction_cache_path);
+    if (write_error != "") {
+      std::cerr << "could not store extraction cache: " << write_error << std::endl;
+      return -1;
+    }
+  }
+
+  // every name already has an ID from the incidence store, so solutions can be written as IDs
+  const NameTable& gift_names = gifts_and_villagers.GetIncidences().GetGiftNames();
+  const NameTable& villager_names = gifts_and_villagers.GetIncidences().GetVillagerNames();
+
+  // The engine is chosen from the shape of the data and the time budget, unless an instance's threads were asked for;
+  // the liked tier is only solved by the solver context, on one thread, and the exact search stands in for the local search, which a limit on gift types has none of
+  EngineOptions engine_options;
+  engine_options.time_budget_us = time_budget_ms >= 0 ? time_budget_ms * 1000 : -1;
+  engine_options.available_threads = std::max(std::thread::hardware_concurrency(), 1u);
+  engine_options.sequential_only = liked_tier;
+  engine_options.exact_allowed = local_search && max_gift_types == 0;
+  engine_options.asked_threads = use_instance ? thread_count : 0;
+  engine_options.asked_bulk = bulk_greedy;
+  engine_options.greedy_order = max_gift_types > 0;
+  const EngineChoice engine = ChooseEngine(ProfileInstance(gifts_and_villagers.GetIncidences()), engine_calibration, engine_options);
+
+  // The skip lists were applied while loading, so the solver is asked for everyone left; the searches for a smaller cover run below, around the lower bound and time budget
+  SolverContext solver;
+  SolverQuery query;
+  query.liked_tier = liked_tier;
+  GiftSolution solution;
+  GiftSolution liked_solution; // only with the liked tier
+  if (engine.greedy != GreedyEngine::SEQUENTIAL) {
+    ParallelGreedyCover(gifts_and_villagers.GetIncidences(), engine.thread_count, engine.greedy == GreedyEngine::BULK_PARALLEL, &solution);
+  }
+  else {
+    const std::string solve_error = solver.Solve(gifts_and_villagers, query);
+    if (solve_error != "") {
+      std::cerr << "could not solve: " << solve_error << std::endl;
+      return -1;
+    }
+    solution = solver.LovedSolution();
+    liked_solution = solver.LikedSolution();
+  }
+
+  // keep machine-readable output parseable
+  std::ostream& report_stream = output_format == OutputFormat::TEXT ? std::cout : std::cerr;
+
+  // Few enough villagers left, as after skipping most of them, are covered exactly, which leaves nothing to search for around the greedy picks
+  SmallCoverResult exact;
+  if (engine.exact) {
+    exact = SolveSmallCover(gifts_and_villagers.GetIncidences(), solution.gift_ids, engine.exact_max_states);
+  }
+
+  // A lower bound that meets the greedy picks proves them optimal, so there is nothing to search for
+  CoverLowerBound bound;
+  if (lower_bound) {
+    bound = BoundCover(gifts_and_villagers.GetIncidences(), solution.gift_ids, LOWER_BOUND_BUDGET_US);
+  }
+  const bool greedy_optimal = (lower_bound && bound.bound >= solution.gift_ids.size()) || (exact.solved && exact.gift_ids.size() >= solution.gift_ids.size());
+  const bool search_smaller = max_gift_types == 0 && !greedy_optimal && !exact.solved;
+
+  // Look for a smaller cover around the greedy picks, or keep looking until the time budget runs out
+  LocalSearchResult improved;
+  AnytimeResult anytime;
+  std::vector<unsigned int> improved_gift_ids = solution.gift_ids;
+  if (exact.solved && !greedy_optimal) {
+    improved_gift_ids = exact.gift_ids;
+  }
+  else if (time_budget_ms >= 0 && search_smaller) {
+    anytime = SolveAnytime(gifts_and_villagers.GetIncidences(), solution.gift_ids, time_budget_ms * 1000, [&report_stream, &gift_names](const AnytimeIncumbent& incumbent) {
+      PrintIncumbent(report_stream, incumbent, gift_names);
+    });
+    improved_gift_ids = anytime.best.gift_ids;
+  }
+  else if (local_search && search_smaller) {
+    improved = ImproveCover(gifts_and_villagers.GetIncidences(), solution.gift_ids, local_search_budget_us);
+    improved_gift_ids = improved.gift_ids;
+  }
+
+  // solve again over only the improved gifts, so they are listed in the usual order with each villager under one gift; they leave the same villagers uncovered
+  // the liked tier is solved again too, since gifts it took for free may no longer be picked
+  const size_t gift_types_saved = solution.gift_ids.size() - improved_gift_ids.size();
+  if (gift_types_saved > 0) {
+    // only the gifts differ from the query already solved, and they come from the data, so this cannot fail
+    query.only_gift_ids = IDSpan(improved_gift_ids);
+    solver.Solve(gifts_and_villagers, query);
+    solution = solver.LovedSolution();
+    liked_solution = solver.LikedSolution();
+  }
+
+  // The first k greedy picks answer every limit k at once, or the time budget goes to an exact search for each k
+  MaxCoverageResult coverage;
+  if (max_gift_types > 0) {
+    coverage = SolveMaxCoverage(gifts_and_villagers.GetIncidences(), solution.gift_ids, max_gift_types, time_budget_ms >= 0, time_budget_ms * 1000);
+    query.only_gift_ids = IDSpan(coverage.gift_ids);
+    solver.Solve(gifts_and_villagers, query);
+    solution = solver.LovedSolution();
   }
 
   // Display the optimal total of gifts
-  std::cout << std::endl << "Gifts needed to give ";
-  std::cout << (covered_villagers.Size() != gifts_and_villagers.GetVillagers().size() ? "all possible" : "all");
-  std::cout << " villagers a 'loved' gift:" << std::endl;
+  SolutionWriter writer(std::cout, output_format, gift_names, villager_names);
+  writer.Write(solution, liked_tier ? &liked_solution : NULL);
+  writer.Flush();
 
-  for (auto g:loved_gifts) {
-    std::cout << "    " << g << std::endl;
+  report_stream << "Engine: " << engine.reason << std::endl;
+  report_stream << std::endl;
+
+  if (max_gift_types > 0) {
+    PrintCoverage(report_stream, coverage, gifts_and_villagers.GetIncidences().VillagerCount(), time_budget_ms >= 0);
+  }
+  else if (time_budget_ms >= 0 && search_smaller) {
+    report_stream << "Anytime solve finished at " << static_cast<double>(anytime.elapsed_us) / 1000 << " ms with " << anytime.best.gift_ids.size() << " gift type" << (anytime.best.gift_ids.size() == 1 ? "" : "s") << ", ";
+    report_stream << (anytime.best.optimal ? "proven optimal" : "at least " + std::to_string(anytime.best.lower_bound) + " needed") << ": ";
+    report_stream << anytime.restarts << " randomized greedy restarts, " << anytime.exact_nodes << " exact search nodes" << std::endl;
+    report_stream << std::endl;
+  }
+  else if (exact.solved && (gift_types_saved > 0 || time_budget_ms >= 0)) {
+    report_stream << "Exact search over the " << exact.villagers << " villagers left proved " << solution.gift_ids.size() << " gift type" << (solution.gift_ids.size() == 1 ? "" : "s") << " the fewest, ";
+    report_stream << (gift_types_saved > 0 ? std::to_string(gift_types_saved) + " fewer than the greedy picks" : "as the greedy picks were") << ": " << exact.candidate_gifts << " candidate gifts, " << exact.states << " covered-sets reached in " << static_cast<double>(exact.elapsed_us) / 1000 << " ms" << std::endl;
+    report_stream << std::endl;
+  }
+  else if (gift_types_saved > 0) {
+    report_stream << "Local search saved " << gift_types_saved << " gift type" << (gift_types_saved == 1 ? "" : "s") << " over the greedy picks: ";
+    report_stream << improved.redundant_removed << " redundant, " << improved.one_for_two_swaps << " one-for-two swaps, " << improved.two_for_three_swaps << " two-for-three swaps" << std::endl;
+    report_stream << std::endl;
+  }
+
+  if (lower_bound) {
+    // the anytime solve may have proven more than the bound did
+    const unsigned int needed = std::max({bound.bound, time_budget_ms >= 0 && search_smaller ? anytime.best.lower_bound : 0u, exact.solved ? static_cast<unsigned int>(exact.gift_ids.size()) : 0u});
+    const size_t gap = solution.gift_ids.size() > needed ? solution.gift_ids.size() - needed : 0;
+    report_stream << "At least " << needed << " gift type" << (needed == 1 ? "" : "s") << " needed";
+    report_stream << " (" << bound.disjoint_villagers << " villagers love no gift in common, " << bound.by_size << " by the most-loved gift";
+    if (bound.iterations > 0) {
+      report_stream << ", " << bound.relaxation << " by the relaxation after " << bound.iterations << " subgradient steps";
+    }
+    report_stream << "; " << static_cast<double>(bound.elapsed_us) / 1000 << " ms): ";
+    if (gap == 0) {
+      report_stream << "the cover of " << solution.gift_ids.size() << " is proven optimal" << std::endl;
+    }
+    else {
+      report_stream << "the cover of " << solution.gift_ids.size() << " is at most " << gap << " more than optimal (a gap of " << 100.0 * static_cast<double>(gap) / static_cast<double>(solution.gift_ids.size()) << "%)" << std::endl;
+    }
+    report_stream << std::endl;
+  }
+
+  if (sweep) {
+    PrintSweep(RunSweep(gifts_and_villagers.GetIncidences(), sweep_pairs, thread_count, local_search ? local_search_budget_us : -1), gifts_and_villagers.GetIncidences(), local_search);
+  }
+
+  if (print_transfer_stats) {
+    // keep machine-readable output parseable
+    std::ostream& stats_stream = output_format == OutputFormat::TEXT ? std::cout : std::cerr;
+    const CurlTransferStats stats = gifts_and_villagers.GetTransferStats();
+    stats_stream << "Fetched " << stats.transfers << " wiki pages: " << stats.wire_bytes << " bytes on the wire, ";
+    stats_stream << stats.decoded_bytes << " bytes after decoding" << std::endl;
+    if (dataset_path != "") {
+      stats_stream << "Read the content of " << gifts_and_villagers.GetReadPages().size() << " wiki pages; the rest were unchanged since the stored dataset" << std::endl;
+    }
+    stats_stream << std::endl;
+  }
+
+  if (extraction_cache_path != "") {
+    const ExtractionCacheStats& stats = extraction_cache.Stats();
+    report_stream << "Extraction cache: " << stats.hits << " of " << stats.lookups << " page extractions were cached (";
+    report_stream << (stats.lookups > 0 ? 100.0 * static_cast<double>(stats.hits) / static_cast<double>(stats.lookups) : 0.0) << "%), saving ";
+    report_stream << static_cast<double>(stats.saved_parse_us) / 1000 << " ms of parsing; " << static_cast<double>(stats.parse_us) / 1000 << " ms parsing the rest; ";
+    report_stream << extraction_cache.Size() << " entries kept" << std::endl;
+    report_stream << std::endl;
+  }
+
+  if (print_fetch_report) {
+    PrintFetchReport(report_stream, gifts_and_villagers.GetURLOutcomes());
+  }
+
+  if (perf_report_path != "") {
+    return WritePerfReportFile(perf_report_path);
   }
-  std::cout << std::endl;
 
   return 0;
 }
@@ -0,0 +1,242 @@
+/*
+ * Description: implementations to pick the few gift types that cover the most villagers
+ * Author: Laura Galbraith
+*/
+
+#include "maxcoverage.hpp" // self-include header
+
+#include <vector> // vector
+#include <chrono> // steady_clock, microseconds, duration_cast
+#include <algorithm> // sort, nth_element, min
+
+#include "incidence.hpp" // IncidenceStore
+
+// the clock is read once every this many branch and bound nodes
+const unsigned int COVERAGE_DEADLINE_CHECK_INTERVAL = 16;
+
+MaxCoverageResult::MaxCoverageResult()
+  : exact_nodes(0), elapsed_us(0)
+{}
+
+// A partial choice of gifts with each gift's gain kept up to date, searched for the k gifts covering the most villagers
+class CoverageSearch {
+  public:
+    CoverageSearch(const IncidenceStore& store, std::chrono::steady_clock::time_point search_deadline)
+      : incidences(store),
+        deadline(search_deadline),
+        deadline_checks(0),
+        expired(false),
+        nodes(0),
+        gains(store.GiftCount(), 0),
+        cover_counts(store.VillagerCount(), 0),
+        covered(0),
+        best_covered(0)
+    {
+      for (unsigned int gift_id = 0; gift_id < store.GiftCount(); ++gift_id) {
+        this->gains[gift_id] = static_cast<unsigned int>(store.GiftVillagersEnd(gift_id) - store.GiftVillagersBegin(gift_id));
+        this->order.push_back(gift_id);
+      }
+
+      // the biggest gifts are tried first, so good choices are found early and prune the rest
+      std::sort(this->order.begin(), this->order.end(), [this](unsigned int a, unsigned int b) {
+        return this->gains[a] > this->gains[b] || (this->gains[a] == this->gains[b] && a < b);
+      });
+    }
+
+    // the k gifts covering the most villagers, if more than the given choice covers; false if out of time first
+    bool Search(unsigned int k, const std::vector<unsigned int>& start_gift_ids, unsigned int start_covered) {
+      this->best_gift_ids = start_gift_ids;
+      this->best_covered = start_covered;
+      this->branch_gains.resize(k + 1);
+      this->Branch(0, k);
+      return !this->expired;
+    }
+
+    // the villagers the gifts cover, and the gift that would add the most to them
+    unsigned int Cover(const std::vector<unsigned int>& gift_ids, unsigned int* best_addition, unsigned int* best_addition_gain) {
+      for (auto g:gift_ids) {
+        this->Pick(g);
+      }
+      const unsigned int gifts_covered = this->covered;
+
+      *best_addition_gain = 0;
+      for (unsigned int gift_id = 0; gift_id < this->gains.size(); ++gift_id) {
+        if (this->gains[gift_id] > *best_addition_gain) {
+          *best_addition = gift_id;
+          *best_addition_gain = this->gains[gift_id];
+        }
+      }
+
+      for (size_t gift_i = 0; gift_i < gift_ids.size(); ++gift_i) {
+        this->Unpick();
+      }
+      return gifts_covered;
+    }
+
+    const std::vector<unsigned int>& BestGiftIDs() const {
+      return this->best_gift_ids;
+    }
+
+    unsigned int BestCovered() const {
+      return this->best_covered;
+    }
+
+    unsigned long Nodes() const {
+      return this->nodes;
+    }
+
+  private:
+    // picks gifts from order_i on, at most picks_left more
+    void Branch(size_t order_i, unsigned int picks_left) {
+      ++this->nodes;
+      if (this->covered > this->best_covered) {
+        this->best_covered = this->covered;
+        this->best_gift_ids = this->picked;
+      }
+      if (picks_left == 0 || order_i >= this->order.size() || this->Expired()) {
+        return;
+      }
+
+      // no choice of the gifts left covers more than the sum of their largest gains
+      std::vector<unsigned int>& later_gains = this->branch_gains[picks_left];
+      later_gains.resize(0);
+      for (size_t later_i = order_i; later_i < this->order.size(); ++later_i) {
+        if (this->gains[this->order[later_i]] > 0) {
+          later_gains.push_back(this->gains[this->order[later_i]]);
+        }
+      }
+      const size_t counted = std::min(later_gains.size(), static_cast<size_t>(picks_left));
+      std::nth_element(later_gains.begin(), later_gains.begin() + static_cast<long>(counted), later_gains.end(), [](unsigned int a, unsigned int b) {
+        return a > b;
+      });
+      unsigned int bound = this->covered;
+      for (size_t gain_i = 0; gain_i < counted; ++gain_i) {
+        bound += later_gains[gain_i];
+      }
+      if (bound <= this->best_covered) {
+        return;
+      }
+
+      for (size_t next_i = order_i; next_i < this->order.size(); ++next_i) {
+        const unsigned int gift_id = this->order[next_i];
+        if (this->gains[gift_id] == 0) {
+          continue;
+        }
+
+        this->Pick(gift_id);
+        this->Branch(next_i + 1, picks_left - 1);
+        this->Unpick();
+        if (this->expired) {
+          return;
+        }
+      }
+    }
+
+    void Pick(unsigned int gift_id) {
+      this->picked.push_back(gift_id);
+      for (const unsigned int* v_it = this->incidences.GiftVillagersBegin(gift_id); v_it != this->incidences.GiftVillagersEnd(gift_id); ++v_it) {
+        if (this->cover_counts[*v_it]++ == 0) {
+          ++this->covered;
+          for (const unsigned int* g_it = this->incidences.VillagerGiftsBegin(*v_it); g_it != this->incidences.VillagerGiftsEnd(*v_it); ++g_it) {
+            --this->gains[*g_it];
+          }
+        }
+      }
+    }
+
+    // undoes the latest pick
+    void Unpick() {
+      const unsigned int gift_id = this->picked.back();
+      this->picked.pop_back();
+      for (const unsigned int* v_it = this->incidences.GiftVillagersBegin(gift_id); v_it != this->incidences.GiftVillagersEnd(gift_id); ++v_it) {
+        if (--this->cover_counts[*v_it] == 0) {
+          --this->covered;
+          for (const unsigned int* g_it = this->incidences.VillagerGiftsBegin(*v_it); g_it != this->incidences.VillagerGiftsEnd(*v_it); ++g_it) {
+            ++this->gains[*g_it];
+          }
+        }
+      }
+    }
+
+    // reads the clock only every few calls; once out of time, stays out of time
+    bool Expired() {
+      if (!this->expired && ++this->deadline_checks % COVERAGE_DEADLINE_CHECK_INTERVAL == 0) {
+        this->expired = std::chrono::steady_clock::now() >= this->deadline;
+      }
+      return this->expired;
+    }
+
+    const IncidenceStore& incidences;
+    std::chrono::steady_clock::time_point deadline;
+    unsigned int deadline_checks;
+    bool expired;
+    unsigned long nodes;
+
+    std::vector<unsigned int> order; // gifts from most to fewest villagers, the order they are branched on
+    std::vector<unsigned int> picked;
+    std::vector<unsigned int> gains; // villagers each gift is loved by that nothing picked covers
+    std::vector<unsigned int> cover_counts; // picked gifts covering each villager
+    unsigned int covered; // villagers something picked covers
+    std::vector<unsigned int> best_gift_ids;
+    unsigned int best_covered;
+    std::vector<std::vector<unsigned int>> branch_gains; // scratch: gains of the gifts left at each number of picks left, kept between nodes
+};
+
+MaxCoverageResult SolveMaxCoverage(const IncidenceStore& incidences, const std::vector<unsigned int>& greedy_gift_ids, unsigned int gift_types, bool exact, long time_budget_us) {
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  MaxCoverageResult result;
+
+  // each greedy pick adds its gain to the one before: the greedy answer for every k in one pass
+  std::vector<bool> covered(incidences.VillagerCount(), false);
+  unsigned int covered_count = 0;
+  for (auto g:greedy_gift_ids) {
+    for (const unsigned int* v_it = incidences.GiftVillagersBegin(g); v_it != incidences.GiftVillagersEnd(g); ++v_it) {
+      covered_count += covered[*v_it] ? 0 : 1;
+      covered[*v_it] = true;
+    }
+    result.covered.push_back(covered_count);
+  }
+
+  // one gift can do no better than the biggest, which greedy picks first, and the full cover leaves out only villagers no gift reaches
+  for (size_t k = 1; k <= result.covered.size(); ++k) {
+    result.optimal.push_back(k == 1 || result.covered[k-1] == covered_count);
+  }
+
+  const size_t chosen_k = std::min(static_cast<size_t>(gift_types), greedy_gift_ids.size());
+  result.gift_ids.assign(greedy_gift_ids.begin(), greedy_gift_ids.begin() + static_cast<long>(chosen_k));
+
+  if (exact) {
+    CoverageSearch search = CoverageSearch(incidences, start + std::chrono::microseconds(time_budget_us));
+    std::vector<unsigned int> previous_best;
+    for (unsigned int k = 1; k <= result.covered.size(); ++k) {
+      std::vector<unsigned int> start_gift_ids(greedy_gift_ids.begin(), greedy_gift_ids.begin() + k);
+      unsigned int start_covered = result.covered[k-1];
+
+      // the best for one fewer, plus whatever adds the most to it, may already beat the greedy answer
+      unsigned int addition = 0;
+      unsigned int addition_gain = 0;
+      const unsigned int previous_covered = search.Cover(previous_best, &addition, &addition_gain);
+      if (addition_gain > 0 && previous_covered + addition_gain > start_covered) {
+        start_gift_ids = previous_best;
+        start_gift_ids.push_back(addition);
+        start_covered = previous_covered + addition_gain;
+      }
+
+      if (!result.optimal[k-1]) {
+        result.optimal[k-1] = search.Search(k, start_gift_ids, start_covered);
+        start_gift_ids = search.BestGiftIDs();
+        start_covered = search.BestCovered();
+      }
+      result.covered[k-1] = start_covered;
+      result.optimal[k-1] = result.optimal[k-1] || start_covered == covered_count;
+      if (k == chosen_k) {
+        result.gift_ids = start_gift_ids;
+      }
+      previous_best = start_gift_ids;
+    }
+    result.exact_nodes = search.Nodes();
+  }
+
+  result.elapsed_us = static_cast<long>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+  return result;
+}
@@ -0,0 +1,35 @@
+/*
+ * Description: interfaces to pick the few gift types that cover the most villagers
+ * Documentation: of the technique: https://en.m.wikipedia.org/wiki/Maximum_coverage_problem
+ * Author: Laura Galbraith
+*/
+
+#ifndef SVGSC_MAX_COVERAGE_H
+#define SVGSC_MAX_COVERAGE_H
+
+#include <vector> // vector
+
+#include "incidence.hpp" // IncidenceStore
+
+class MaxCoverageResult {
+  public:
+    // Constructor
+    MaxCoverageResult();
+
+    // Member variables
+    std::vector<unsigned int> covered; // [k-1]: villagers covered by the k gift types chosen, for every k up to the size of the full cover
+    std::vector<bool> optimal; // [k-1]: no k gift types cover more villagers
+    std::vector<unsigned int> gift_ids; // the gift types chosen for the k asked for
+    unsigned long exact_nodes; // branch and bound nodes visited
+    long elapsed_us;
+};
+
+// Chooses at most gift_types gifts to cover the most villagers, given the greedy cover's picks in the order they were made:
+// the greedy picks stopped after k are the greedy answer for k gift types, so every k is read off the one cover
+// with exact, a branch and bound for each k then looks for more villagers covered than that, until the time budget runs out;
+// it starts from the better of the greedy answer and the best for one fewer plus the best gift to add, and prunes with the gains of the gifts left
+// the first k greedy picks always cover at least 1 - 1/e of what the best k gift types do
+// O(number of incidences) without exact
+MaxCoverageResult SolveMaxCoverage(const IncidenceStore& incidences, const std::vector<unsigned int>& greedy_gift_ids, unsigned int gift_types, bool exact, long time_budget_us);
+
+#endif // SVGSC_MAX_COVERAGE_H
@@ -0,0 +1,39 @@
+/*
+ * Description: implementation to assign small integer IDs to names
+ * Author: Laura Galbraith
+*/
+
+#include "nametable.hpp" // self-include header
+
+const unsigned int NameTable::NOT_FOUND = static_cast<unsigned int>(-1);
+
+NameTable::NameTable() {
+}
+
+unsigned int NameTable::Intern(const std::string& name) {
+  std::unordered_map<std::string, unsigned int>::const_iterator found = this->ids.find(name);
+  if (found != this->ids.end()) {
+    return found->second;
+  }
+
+  const unsigned int id = static_cast<unsigned int>(this->names.size());
+  this->names.push_back(name);
+  this->ids[name] = id;
+  return id;
+}
+
+unsigned int NameTable::Find(const std::string& name) const {
+  std::unordered_map<std::string, unsigned int>::const_iterator found = this->ids.find(name);
+  if (found == this->ids.end()) {
+    return NameTable::NOT_FOUND;
+  }
+  return found->second;
+}
+
+const std::string& NameTable::Name(unsigned int id) const {
+  return this->names[id];
+}
+
+size_t NameTable::Size() const {
+  return this->names.size();
+}
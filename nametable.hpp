@@ -0,0 +1,39 @@
+/*
+ * Description: interface to assign small integer IDs to names
+ * Author: Laura Galbraith
+*/
+
+#ifndef SVGSC_NAME_TABLE_H
+#define SVGSC_NAME_TABLE_H
+
+#include <string> // string
+#include <vector> // vector
+#include <unordered_map> // unordered_map
+#include <cstddef> // size_t
+
+// Interns names: each distinct name gets the next ID, starting at 0, so IDs can index plain arrays
+class NameTable {
+  public:
+    // Constructor
+    NameTable();
+
+    // returns the ID of the name, adding it if it is new
+    // O(1), on average
+    unsigned int Intern(const std::string& name);
+
+    // returns the ID of the name, or NOT_FOUND
+    // O(1), on average
+    unsigned int Find(const std::string& name) const;
+
+    // O(1)
+    const std::string& Name(unsigned int id) const;
+    size_t Size() const;
+
+    static const unsigned int NOT_FOUND;
+
+  private:
+    std::vector<std::string> names;
+    std::unordered_map<std::string, unsigned int> ids;
+};
+
+#endif // SVGSC_NAME_TABLE_H
@@ -0,0 +1,398 @@
+/*
+ * Description: implementation to write set-covering solutions in human- and machine-readable formats
+ * Documentation: JSON strings: https://www.rfc-editor.org/rfc/rfc8259#section-7
+ *                CSV fields: https://www.rfc-editor.org/rfc/rfc4180#section-2
+ * Author: Laura Galbraith
+*/
+
+#include "output.hpp" // self-include header
+
+#include <cstring> // memcpy
+
+GiftSolution::GiftSolution() {
+}
+
+void GiftSolution::Clear() {
+  this->gift_ids.clear();
+  this->villager_starts.clear();
+  this->villager_ids.clear();
+  this->uncovered_villager_ids.clear();
+}
+
+void GiftSolution::AddGift(unsigned int gift_id) {
+  this->gift_ids.push_back(gift_id);
+  this->villager_starts.push_back(this->villager_ids.size());
+}
+
+size_t GiftSolution::GiftCount() const {
+  return this->gift_ids.size();
+}
+
+size_t GiftSolution::VillagersBegin(size_t gift_i) const {
+  return this->villager_starts[gift_i];
+}
+
+size_t GiftSolution::VillagersEnd(size_t gift_i) const {
+  return gift_i+1 < this->villager_starts.size() ? this->villager_starts[gift_i+1] : this->villager_ids.size();
+}
+
+SolutionWriter::SolutionWriter(std::ostream& output_stream, OutputFormat output_format, const NameTable& gift_table, const NameTable& villager_table)
+  : os(output_stream),
+    format(output_format),
+    gift_names(gift_table),
+    villager_names(villager_table),
+    scenarios_written(0),
+    tiered(false),
+    buffered(0)
+{
+}
+
+// O(size of the solution)
+void SolutionWriter::Write(const GiftSolution& solution, const GiftSolution* liked_solution) {
+  if (this->scenarios_written == 0) {
+    this->tiered = liked_solution != NULL;
+    this->WriteHeader();
+  }
+
+  switch (this->format) {
+    case OutputFormat::TEXT:
+      this->WriteText(solution, liked_solution);
+      break;
+    case OutputFormat::JSON:
+      this->WriteJSON(solution, liked_solution);
+      break;
+    case OutputFormat::CSV:
+      this->WriteCSV(solution, liked_solution);
+      break;
+    case OutputFormat::BINARY:
+      this->WriteBinary(solution, liked_solution);
+      break;
+  }
+
+  ++this->scenarios_written;
+}
+
+void SolutionWriter::Flush() {
+  if (this->buffered > 0) {
+    this->os.write(this->buffer, static_cast<std::streamsize>(this->buffered));
+    this->buffered = 0;
+  }
+  this->os.flush();
+}
+
+SolutionWriter::~SolutionWriter() {
+  this->Flush();
+}
+
+void SolutionWriter::WriteHeader() {
+  if (this->format == OutputFormat::CSV) {
+    this->Append(this->tiered ? "scenario,tier,gift,villager\n" : "scenario,gift,villager\n");
+  }
+  else if (this->format == OutputFormat::BINARY) {
+    this->Append("SVGSCBIN", 8);
+    this->AppendUInt32(this->tiered ? SolutionWriter::BINARY_TIERED_VERSION : SolutionWriter::BINARY_VERSION);
+
+    const NameTable* tables[] = {&this->gift_names, &this->villager_names};
+    for (const NameTable* table:tables) {
+      this->AppendUInt32(table->Size());
+      for (unsigned int id = 0; id < table->Size(); ++id) {
+        const std::string& name = table->Name(id);
+        this->AppendUInt32(name.size());
+        this->Append(name);
+      }
+    }
+  }
+}
+
+// ex.
+// Gifts needed to give all villagers a 'loved' gift:
+//     4 Prismatic Shard items for Pierre, Lewis, Penny, Marnie
+// with a liked tier, the villagers left out are given liked gifts in a second list, where gifts also given as loved gifts are marked, ex.
+// Gifts needed to give the remaining villagers a 'liked' gift:
+//     1 Diamond item for Haley (also a loved gift)
+void SolutionWriter::WriteText(const GiftSolution& solution, const GiftSolution* liked_solution) {
+  const bool complete = solution.uncovered_villager_ids.empty();
+  if (!complete) {
+    // tell the user that the set-covering algorithm could not complete, and what villagers remain uncovered
+    this->Append("Not all villagers can receive a 'loved' gift with the provided input; these villagers ");
+    this->Append(liked_solution != NULL ? "will receive a 'liked' gift where possible: " : "could receive a 'liked' gift instead: ");
+    this->AppendTextVillagers(solution.uncovered_villager_ids);
+  }
+
+  this->Append("\nGifts needed to give ");
+  this->Append(complete ? "all" : "all possible");
+  this->Append(" villagers a 'loved' gift:\n");
+  this->AppendTextGifts(solution, NULL);
+  this->Append('\n');
+
+  if (liked_solution == NULL || complete) {
+    return;
+  }
+
+  this->Append("Gifts needed to give the remaining villagers a 'liked' gift:\n");
+  this->AppendTextGifts(*liked_solution, &solution);
+
+  // gift types given in both tiers only count once
+  unsigned long new_gift_types = 0;
+  for (auto liked_gift_id:liked_solution->gift_ids) {
+    bool loved_too = false;
+    for (auto loved_gift_id:solution.gift_ids) {
+      loved_too = loved_too || loved_gift_id == liked_gift_id;
+    }
+    new_gift_types += loved_too ? 0 : 1;
+  }
+  this->Append("    (");
+  this->AppendUnsigned(solution.GiftCount() + new_gift_types);
+  this->Append(" gift types in all: ");
+  this->AppendUnsigned(solution.GiftCount());
+  this->Append(" loved, ");
+  this->AppendUnsigned(new_gift_types);
+  this->Append(" more only liked)\n");
+
+  if (!liked_solution->uncovered_villager_ids.empty()) {
+    this->Append("These villagers cannot receive a 'loved' or 'liked' gift with the provided input: ");
+    this->AppendTextVillagers(liked_solution->uncovered_villager_ids);
+  }
+  this->Append('\n');
+}
+
+// one line per gift; with loved_solution, the gifts it also gives are marked
+void SolutionWriter::AppendTextGifts(const GiftSolution& solution, const GiftSolution* loved_solution) {
+  for (size_t gift_i = 0; gift_i < solution.GiftCount(); ++gift_i) {
+    const size_t begin = solution.VillagersBegin(gift_i);
+    const size_t end = solution.VillagersEnd(gift_i);
+
+    this->Append("    ");
+    this->AppendUnsigned(end - begin);
+    this->Append(' ');
+    this->Append(this->gift_names.Name(solution.gift_ids[gift_i]));
+    this->Append(end - begin > 1 ? " items for " : " item for ");
+    for (size_t villager_i = begin; villager_i < end; ++villager_i) {
+      if (villager_i > begin) {
+        this->Append(", ");
+      }
+      this->Append(this->villager_names.Name(solution.villager_ids[villager_i]));
+    }
+    if (begin == end) {
+      this->Append("no one");
+    }
+
+    bool loved_too = false;
+    for (size_t loved_i = 0; loved_solution != NULL && loved_i < loved_solution->GiftCount(); ++loved_i) {
+      loved_too = loved_too || loved_solution->gift_ids[loved_i] == solution.gift_ids[gift_i];
+    }
+    if (loved_too) {
+      this->Append(" (also a loved gift)");
+    }
+    this->Append('\n');
+  }
+}
+
+// comma-separated, ending the line
+void SolutionWriter::AppendTextVillagers(const std::vector<unsigned int>& villager_ids) {
+  for (size_t villager_i = 0; villager_i < villager_ids.size(); ++villager_i) {
+    if (villager_i > 0) {
+      this->Append(", ");
+    }
+    this->Append(this->villager_names.Name(villager_ids[villager_i]));
+  }
+  this->Append('\n');
+}
+
+void SolutionWriter::WriteJSON(const GiftSolution& solution, const GiftSolution* liked_solution) {
+  const std::vector<unsigned int>& uncovered_villager_ids = liked_solution != NULL ? liked_solution->uncovered_villager_ids : solution.uncovered_villager_ids;
+
+  this->Append("{\"scenario\":");
+  this->AppendUnsigned(this->scenarios_written);
+  this->Append(uncovered_villager_ids.empty() ? ",\"complete\":true" : ",\"complete\":false");
+
+  this->Append(",\"gifts\":");
+  this->AppendJSONGifts(solution);
+  if (liked_solution != NULL) {
+    this->Append(",\"liked\":");
+    this->AppendJSONGifts(*liked_solution);
+  }
+
+  this->Append(",\"uncovered\":[");
+  for (size_t villager_i = 0; villager_i < uncovered_villager_ids.size(); ++villager_i) {
+    if (villager_i > 0) {
+      this->Append(',');
+    }
+    this->AppendJSONString(this->villager_names.Name(uncovered_villager_ids[villager_i]));
+  }
+  this->Append("]}\n");
+}
+
+// [{"gift":"Diamond","villagers":["Abigail",...]},...]
+void SolutionWriter::AppendJSONGifts(const GiftSolution& solution) {
+  this->Append('[');
+  for (size_t gift_i = 0; gift_i < solution.GiftCount(); ++gift_i) {
+    if (gift_i > 0) {
+      this->Append(',');
+    }
+    this->Append("{\"gift\":");
+    this->AppendJSONString(this->gift_names.Name(solution.gift_ids[gift_i]));
+    this->Append(",\"villagers\":[");
+    for (size_t villager_i = solution.VillagersBegin(gift_i); villager_i < solution.VillagersEnd(gift_i); ++villager_i) {
+      if (villager_i > solution.VillagersBegin(gift_i)) {
+        this->Append(',');
+      }
+      this->AppendJSONString(this->villager_names.Name(solution.villager_ids[villager_i]));
+    }
+    this->Append("]}");
+  }
+  this->Append(']');
+}
+
+void SolutionWriter::WriteCSV(const GiftSolution& solution, const GiftSolution* liked_solution) {
+  this->AppendCSVGifts(solution, "loved");
+  if (liked_solution != NULL) {
+    this->AppendCSVGifts(*liked_solution, "liked");
+  }
+
+  const std::vector<unsigned int>& uncovered_villager_ids = liked_solution != NULL ? liked_solution->uncovered_villager_ids : solution.uncovered_villager_ids;
+  for (size_t villager_i = 0; villager_i < uncovered_villager_ids.size(); ++villager_i) {
+    this->AppendUnsigned(this->scenarios_written);
+    this->Append(this->tiered ? ",,," : ",,");
+    this->AppendCSVField(this->villager_names.Name(uncovered_villager_ids[villager_i]));
+    this->Append('\n');
+  }
+}
+
+// the tier column is only written with a liked tier
+void SolutionWriter::AppendCSVGifts(const GiftSolution& solution, const std::string& tier) {
+  for (size_t gift_i = 0; gift_i < solution.GiftCount(); ++gift_i) {
+    for (size_t villager_i = solution.VillagersBegin(gift_i); villager_i < solution.VillagersEnd(gift_i); ++villager_i) {
+      this->AppendUnsigned(this->scenarios_written);
+      this->Append(',');
+      if (this->tiered) {
+        this->Append(tier);
+        this->Append(',');
+      }
+      this->AppendCSVField(this->gift_names.Name(solution.gift_ids[gift_i]));
+      this->Append(',');
+      this->AppendCSVField(this->villager_names.Name(solution.villager_ids[villager_i]));
+      this->Append('\n');
+    }
+  }
+}
+
+void SolutionWriter::WriteBinary(const GiftSolution& solution, const GiftSolution* liked_solution) {
+  this->AppendUInt32(this->scenarios_written);
+  this->AppendBinaryGifts(solution);
+  if (liked_solution != NULL) {
+    this->AppendBinaryGifts(*liked_solution);
+  }
+
+  const std::vector<unsigned int>& uncovered_villager_ids = liked_solution != NULL ? liked_solution->uncovered_villager_ids : solution.uncovered_villager_ids;
+  this->AppendUInt32(uncovered_villager_ids.size());
+  for (auto villager_id:uncovered_villager_ids) {
+    this->AppendUInt32(villager_id);
+  }
+}
+
+// gift count, then per gift its ID, villager count and villager IDs
+void SolutionWriter::AppendBinaryGifts(const GiftSolution& solution) {
+  this->AppendUInt32(solution.GiftCount());
+  for (size_t gift_i = 0; gift_i < solution.GiftCount(); ++gift_i) {
+    this->AppendUInt32(solution.gift_ids[gift_i]);
+    this->AppendUInt32(solution.VillagersEnd(gift_i) - solution.VillagersBegin(gift_i));
+    for (size_t villager_i = solution.VillagersBegin(gift_i); villager_i < solution.VillagersEnd(gift_i); ++villager_i) {
+      this->AppendUInt32(solution.villager_ids[villager_i]);
+    }
+  }
+}
+
+// amortized O(size)
+void SolutionWriter::Append(const char* data, size_t size) {
+  while (size > 0) {
+    if (this->buffered == SolutionWriter::BUFFER_SIZE) {
+      this->os.write(this->buffer, static_cast<std::streamsize>(this->buffered));
+      this->buffered = 0;
+    }
+
+    const size_t space = SolutionWriter::BUFFER_SIZE - this->buffered;
+    const size_t chunk = size < space ? size : space;
+    std::memcpy(this->buffer + this->buffered, data, chunk);
+    this->buffered += chunk;
+    data += chunk;
+    size -= chunk;
+  }
+}
+
+void SolutionWriter::Append(const std::string& s) {
+  this->Append(s.data(), s.size());
+}
+
+void SolutionWriter::Append(char c) {
+  this->Append(&c, 1);
+}
+
+// decimal digits, without going through iostream formatting
+void SolutionWriter::AppendUnsigned(unsigned long value) {
+  char digits[20];
+  size_t digit_count = 0;
+  do {
+    digits[sizeof(digits) - ++digit_count] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value > 0);
+
+  this->Append(digits + sizeof(digits) - digit_count, digit_count);
+}
+
+void SolutionWriter::AppendUInt32(unsigned long value) {
+  const char bytes[4] = {
+    static_cast<char>(value & 0xFF),
+    static_cast<char>((value >> 8) & 0xFF),
+    static_cast<char>((value >> 16) & 0xFF),
+    static_cast<char>((value >> 24) & 0xFF)
+  };
+  this->Append(bytes, 4);
+}
+
+// names are UTF-8, which JSON allows as-is; only quotes, backslashes and control characters are escaped
+void SolutionWriter::AppendJSONString(const std::string& s) {
+  static const char HEX_DIGITS[] = "0123456789abcdef";
+
+  this->Append('"');
+  size_t run_start = 0;
+  for (size_t i = 0; i < s.size(); ++i) {
+    const unsigned char c = static_cast<unsigned char>(s[i]);
+    if (c != '"' && c != '\\' && c >= 0x20) {
+      continue;
+    }
+
+    this->Append(s.data() + run_start, i - run_start);
+    run_start = i+1;
+    if (c == '"' || c == '\\') {
+      const char escaped[2] = {'\\', static_cast<char>(c)};
+      this->Append(escaped, 2);
+    }
+    else {
+      const char escaped[6] = {'\\', 'u', '0', '0', HEX_DIGITS[c >> 4], HEX_DIGITS[c & 0xF]};
+      this->Append(escaped, 6);
+    }
+  }
+  this->Append(s.data() + run_start, s.size() - run_start);
+  this->Append('"');
+}
+
+// fields containing a separator, quote or line break are quoted, with quotes doubled
+void SolutionWriter::AppendCSVField(const std::string& s) {
+  if (s.find_first_of(",\"\r\n") == std::string::npos) {
+    this->Append(s);
+    return;
+  }
+
+  this->Append('"');
+  size_t run_start = 0;
+  size_t quote = s.find('"');
+  while (quote != std::string::npos) {
+    this->Append(s.data() + run_start, quote+1 - run_start);
+    this->Append('"');
+    run_start = quote+1;
+    quote = s.find('"', run_start);
+  }
+  this->Append(s.data() + run_start, s.size() - run_start);
+  this->Append('"');
+}
@@ -0,0 +1,109 @@
+/*
+ * Description: interfaces to write set-covering solutions in human- and machine-readable formats
+ * Author: Laura Galbraith
+*/
+
+#ifndef SVGSC_OUTPUT_H
+#define SVGSC_OUTPUT_H
+
+#include <iostream> // ostream
+#include <string> // string
+#include <vector> // vector
+#include <cstddef> // size_t
+
+#include "nametable.hpp" // NameTable
+
+enum class OutputFormat {
+  TEXT, // the sentences the program has always printed
+  JSON, // one JSON object per solution, one per line: {"scenario":0,"complete":true,"gifts":[{"gift":"Diamond","villagers":["Abigail",...]},...],"uncovered":[]}
+        // with a liked tier, the liked gifts follow the loved ones as "liked":[...] in the same form, and "complete" and "uncovered" take both tiers into account
+  CSV, // header row "scenario,gift,villager", then one row per villager covered by each gift; uncovered villagers have an empty gift
+       // with a liked tier, the header is "scenario,tier,gift,villager" and each row's tier is loved or liked, or empty for uncovered villagers
+  BINARY // see SolutionWriter
+};
+
+// One set cover, as gift and villager IDs of the writer's name tables, kept in flat arrays so it can be reused without reallocating
+class GiftSolution {
+  public:
+    // Constructor
+    GiftSolution();
+
+    // empties the solution, keeping its capacity
+    void Clear();
+
+    // villager IDs appended to villager_ids afterward belong to this gift
+    void AddGift(unsigned int gift_id);
+
+    size_t GiftCount() const;
+    size_t VillagersBegin(size_t gift_i) const;
+    size_t VillagersEnd(size_t gift_i) const;
+
+    // Member variables
+    std::vector<unsigned int> gift_ids; // in the order gifts were picked
+    std::vector<size_t> villager_starts; // index into villager_ids of each gift's first villager
+    std::vector<unsigned int> villager_ids; // villagers each gift is given to
+    std::vector<unsigned int> uncovered_villager_ids; // villagers no gift could be given to; empty if the cover is complete
+};
+
+// Formats solutions into a fixed-size buffer, written to the stream only when full or flushed
+// every gift and villager name must be interned before the first solution is written, since BINARY writes the name tables up front
+//
+// BINARY layout, all integers unsigned 32-bit little-endian:
+//   "SVGSCBIN", version, gift name count, then each gift name as a length and its bytes, then villager names likewise
+//   per solution: scenario, gift count, then per gift its ID, villager count and villager IDs, then uncovered villager count and IDs
+//   with a liked tier the version is 2, and the liked gifts follow the loved ones in the same form before the villagers neither tier covers
+class SolutionWriter {
+  public:
+    // Constructor; the stream and name tables must outlive the writer
+    SolutionWriter(std::ostream& output_stream, OutputFormat output_format, const NameTable& gift_table, const NameTable& villager_table);
+
+    // scenarios are numbered in the order solutions are written, starting at 0
+    // a liked solution gives liked gifts to the villagers the solution's loved gifts could not cover, and its uncovered villagers are those neither tier covers;
+    // every solution written must agree on whether it has one, since the header is written with the first
+    void Write(const GiftSolution& solution, const GiftSolution* liked_solution = NULL);
+    void Flush();
+
+    // Destructor; flushes
+    ~SolutionWriter();
+
+  private:
+    // not copyable, since it holds references and a large buffer
+    SolutionWriter(const SolutionWriter& other);
+    SolutionWriter& operator=(const SolutionWriter& other);
+
+    void WriteHeader();
+    void WriteText(const GiftSolution& solution, const GiftSolution* liked_solution);
+    void WriteJSON(const GiftSolution& solution, const GiftSolution* liked_solution);
+    void WriteCSV(const GiftSolution& solution, const GiftSolution* liked_solution);
+    void WriteBinary(const GiftSolution& solution, const GiftSolution* liked_solution);
+
+    void AppendTextGifts(const GiftSolution& solution, const GiftSolution* loved_solution);
+    void AppendTextVillagers(const std::vector<unsigned int>& villager_ids);
+    void AppendJSONGifts(const GiftSolution& solution);
+    void AppendCSVGifts(const GiftSolution& solution, const std::string& tier);
+    void AppendBinaryGifts(const GiftSolution& solution);
+
+    void Append(const char* data, size_t size);
+    void Append(const std::string& s);
+    void Append(char c);
+    void AppendUnsigned(unsigned long value);
+    void AppendUInt32(unsigned long value);
+    void AppendJSONString(const std::string& s);
+    void AppendCSVField(const std::string& s);
+
+    static const size_t BUFFER_SIZE = 1 << 16;
+    static const unsigned long BINARY_VERSION = 1;
+    static const unsigned long BINARY_TIERED_VERSION = 2;
+
+    std::ostream& os;
+    OutputFormat format;
+    const NameTable& gift_names;
+    const NameTable& villager_names;
+    unsigned long scenarios_written;
+    bool tiered; // whether the solutions written have a liked tier, as the first one did
+
+    size_t buffered;
+    char buffer[BUFFER_SIZE];
+};
+
+#endif // SVGSC_OUTPUT_H
@@ -0,0 +1,288 @@
+/*
+ * Description: implementation to greedy set-cover spread across threads
+ * Author: Laura Galbraith
+*/
+
+#include "parallelgreedy.hpp" // self-include header
+
+#include <vector> // vector
+#include <queue> // priority_queue
+#include <tuple> // pair
+#include <thread> // thread, hardware_concurrency
+#include <mutex> // mutex, unique_lock
+#include <condition_variable> // condition_variable
+#include <algorithm> // lower_bound, upper_bound, sort, max
+
+#include "incidence.hpp" // IncidenceStore
+#include "output.hpp" // GiftSolution
+
+// a bulk round picks gifts covering at least this share of what the best gift covers, from at most this many offers per thread
+const unsigned int BULK_GAIN_PERCENT = 90;
+const size_t BULK_OFFERS_PER_THREAD = 64;
+
+ParallelGreedyStats::ParallelGreedyStats()
+  : thread_count(0), rounds(0)
+{}
+
+// orders offers by gain, then by lowest gift ID
+class OfferOrder {
+  public:
+    bool operator()(const std::pair<unsigned int, unsigned int>& a, const std::pair<unsigned int, unsigned int>& b) const {
+      return a.first < b.first || (a.first == b.first && a.second > b.second);
+    }
+};
+
+// what the threads do when they next meet
+enum class RoundPhase {
+  UPDATE, // take the newly covered villagers from the gains, then offer the best gift
+  OFFER_MANY, // offer every gift up to the bulk threshold
+  STOP
+};
+
+// The threads, the gift ranges they own, and the shared gains; the calling thread works as thread 0
+// gains and heaps are only written by their owning thread during a phase, and only by the calling thread between phases
+class ParallelGreedy {
+  public:
+    ParallelGreedy(const IncidenceStore& store, unsigned int threads, bool bulk)
+      : incidences(store),
+        thread_count(threads),
+        bulk_rounds(bulk),
+        gains(store.GiftCount(), 0),
+        covered(store.VillagerCount(), false),
+        heaps(threads),
+        best_offers(threads),
+        many_offers(threads),
+        bulk_threshold(0),
+        phase(RoundPhase::UPDATE),
+        generation(0),
+        pending(0)
+    {
+      // the gift ranges hold about the same number of incidences, since that is the work of taking villagers from gains
+      const size_t incidence_count = store.IncidenceCount();
+      size_t incidences_so_far = 0;
+      this->range_starts.push_back(0);
+      for (unsigned int gift_id = 0; gift_id < store.GiftCount(); ++gift_id) {
+        const size_t gift_size = static_cast<size_t>(store.GiftVillagersEnd(gift_id) - store.GiftVillagersBegin(gift_id));
+        this->gains[gift_id] = static_cast<unsigned int>(gift_size);
+        incidences_so_far += gift_size;
+        while (this->range_starts.size() < threads && incidences_so_far * threads >= incidence_count * this->range_starts.size()) {
+          this->range_starts.push_back(gift_id + 1);
+        }
+      }
+      while (this->range_starts.size() <= threads) {
+        this->range_starts.push_back(static_cast<unsigned int>(store.GiftCount()));
+      }
+
+      for (unsigned int thread_i = 0; thread_i < threads; ++thread_i) {
+        for (unsigned int gift_id = this->range_starts[thread_i]; gift_id < this->range_starts[thread_i+1]; ++gift_id) {
+          if (this->gains[gift_id] > 0) {
+            this->heaps[thread_i].push(std::pair<unsigned int, unsigned int>(this->gains[gift_id], gift_id));
+          }
+        }
+      }
+
+      for (unsigned int thread_i = 1; thread_i < threads; ++thread_i) {
+        this->workers.push_back(std::thread(&ParallelGreedy::Work, this, thread_i));
+      }
+    }
+
+    ~ParallelGreedy() {
+      this->RunPhase(RoundPhase::STOP);
+      for (auto& t:this->workers) {
+        t.join();
+      }
+    }
+
+    ParallelGreedyStats Run(GiftSolution* solution) {
+      ParallelGreedyStats stats;
+      stats.thread_count = this->thread_count;
+
+      while (true) {
+        this->RunPhase(RoundPhase::UPDATE);
+        ++stats.rounds;
+        this->newly_covered.resize(0);
+
+        std::pair<unsigned int, unsigned int> best = this->best_offers[0];
+        for (const auto& offer:this->best_offers) {
+          if (OfferOrder()(best, offer)) {
+            best = offer;
+          }
+        }
+        if (best.first == 0) {
+          break;
+        }
+
+        if (!this->bulk_rounds) {
+          this->heaps[this->Owner(best.second)].pop();
+          this->Pick(best.second, solution);
+          continue;
+        }
+
+        // the offers are tried best first, each against the villagers picked before it this round
+        this->bulk_threshold = std::max(1u, (best.first * BULK_GAIN_PERCENT + 99) / 100);
+        this->RunPhase(RoundPhase::OFFER_MANY);
+        std::vector<std::pair<unsigned int, unsigned int>> offers;
+        for (const auto& thread_offers:this->many_offers) {
+          offers.insert(offers.end(), thread_offers.begin(), thread_offers.end());
+        }
+        std::sort(offers.begin(), offers.end(), [](const std::pair<unsigned int, unsigned int>& a, const std::pair<unsigned int, unsigned int>& b) {
+          return OfferOrder()(b, a);
+        });
+
+        for (const auto& offer:offers) {
+          unsigned int gain = 0;
+          for (const unsigned int* v_it = this->incidences.GiftVillagersBegin(offer.second); v_it != this->incidences.GiftVillagersEnd(offer.second); ++v_it) {
+            gain += this->covered[*v_it] ? 0 : 1;
+          }
+
+          if (gain >= this->bulk_threshold) {
+            this->Pick(offer.second, solution);
+          }
+          else if (gain > 0) {
+            // back in at its old gain, which the next update brings down
+            this->heaps[this->Owner(offer.second)].push(offer);
+          }
+        }
+      }
+
+      for (unsigned int villager_id = 0; villager_id < this->covered.size(); ++villager_id) {
+        if (!this->covered[villager_id]) {
+          solution->uncovered_villager_ids.push_back(villager_id);
+        }
+      }
+      return stats;
+    }
+
+  private:
+    void Work(unsigned int thread_i) {
+      unsigned long seen_generation = 0;
+      while (true) {
+        RoundPhase current_phase;
+        {
+          std::unique_lock<std::mutex> lock(this->phase_mutex);
+          this->phase_started.wait(lock, [this, seen_generation]() {
+            return this->generation != seen_generation;
+          });
+          seen_generation = this->generation;
+          current_phase = this->phase;
+        }
+
+        if (current_phase == RoundPhase::STOP) {
+          return;
+        }
+        this->DoPhase(thread_i, current_phase);
+
+        std::unique_lock<std::mutex> lock(this->phase_mutex);
+        if (--this->pending == 0) {
+          this->phase_done.notify_one();
+        }
+      }
+    }
+
+    // every thread runs the phase, the calling one included, and this returns once all are done
+    void RunPhase(RoundPhase next_phase) {
+      {
+        std::unique_lock<std::mutex> lock(this->phase_mutex);
+        this->phase = next_phase;
+        this->pending = this->thread_count - 1;
+        ++this->generation;
+      }
+      this->phase_started.notify_all();
+
+      if (next_phase != RoundPhase::STOP) {
+        this->DoPhase(0, next_phase);
+        std::unique_lock<std::mutex> lock(this->phase_mutex);
+        this->phase_done.wait(lock, [this]() {
+          return this->pending == 0;
+        });
+      }
+    }
+
+    void DoPhase(unsigned int thread_i, RoundPhase current_phase) {
+      const unsigned int range_begin = this->range_starts[thread_i];
+      const unsigned int range_end = this->range_starts[thread_i+1];
+      std::priority_queue<std::pair<unsigned int, unsigned int>, std::vector<std::pair<unsigned int, unsigned int>>, OfferOrder>& heap = this->heaps[thread_i];
+
+      if (current_phase == RoundPhase::UPDATE) {
+        // each villager's gifts are sorted by ID, so this thread's share of them is found by binary search
+        for (auto v:this->newly_covered) {
+          const unsigned int* g_it = std::lower_bound(this->incidences.VillagerGiftsBegin(v), this->incidences.VillagerGiftsEnd(v), range_begin);
+          for (; g_it != this->incidences.VillagerGiftsEnd(v) && *g_it < range_end; ++g_it) {
+            --this->gains[*g_it];
+          }
+        }
+
+        this->Settle(&heap);
+        this->best_offers[thread_i] = heap.empty() ? std::pair<unsigned int, unsigned int>(0, 0) : heap.top();
+      }
+      else if (current_phase == RoundPhase::OFFER_MANY) {
+        std::vector<std::pair<unsigned int, unsigned int>>& offers = this->many_offers[thread_i];
+        offers.resize(0);
+        this->Settle(&heap);
+        while (!heap.empty() && heap.top().first >= this->bulk_threshold && offers.size() < BULK_OFFERS_PER_THREAD) {
+          offers.push_back(heap.top());
+          heap.pop();
+          this->Settle(&heap);
+        }
+      }
+    }
+
+    // a stale gain goes back in at its current value, until the top is current; every other gift's true gain is at most what it was pushed with
+    void Settle(std::priority_queue<std::pair<unsigned int, unsigned int>, std::vector<std::pair<unsigned int, unsigned int>>, OfferOrder>* heap) {
+      while (!heap->empty() && heap->top().first != this->gains[heap->top().second]) {
+        const unsigned int gift_id = heap->top().second;
+        heap->pop();
+        if (this->gains[gift_id] > 0) {
+          heap->push(std::pair<unsigned int, unsigned int>(this->gains[gift_id], gift_id));
+        }
+      }
+    }
+
+    // adds the gift with the villagers it newly covers, in ID order, for the next update to take from the gains
+    void Pick(unsigned int gift_id, GiftSolution* solution) {
+      solution->AddGift(gift_id);
+      for (const unsigned int* v_it = this->incidences.GiftVillagersBegin(gift_id); v_it != this->incidences.GiftVillagersEnd(gift_id); ++v_it) {
+        if (!this->covered[*v_it]) {
+          this->covered[*v_it] = true;
+          solution->villager_ids.push_back(*v_it);
+          this->newly_covered.push_back(*v_it);
+        }
+      }
+    }
+
+    unsigned int Owner(unsigned int gift_id) const {
+      return static_cast<unsigned int>(std::upper_bound(this->range_starts.begin(), this->range_starts.end(), gift_id) - this->range_starts.begin() - 1);
+    }
+
+    const IncidenceStore& incidences;
+    unsigned int thread_count;
+    bool bulk_rounds;
+    std::vector<unsigned int> range_starts; // first gift ID each thread owns, then one past the last
+    std::vector<unsigned int> gains; // villagers each gift is loved by that nothing picked covers
+    std::vector<bool> covered;
+    std::vector<unsigned int> newly_covered; // villagers covered by the picks since the last update
+    std::vector<std::priority_queue<std::pair<unsigned int, unsigned int>, std::vector<std::pair<unsigned int, unsigned int>>, OfferOrder>> heaps; // per thread: (gain when pushed, gift ID)
+    std::vector<std::pair<unsigned int, unsigned int>> best_offers; // per thread
+    std::vector<std::vector<std::pair<unsigned int, unsigned int>>> many_offers; // per thread
+    unsigned int bulk_threshold;
+
+    std::vector<std::thread> workers;
+    std::mutex phase_mutex;
+    std::condition_variable phase_started;
+    std::condition_variable phase_done;
+    RoundPhase phase;
+    unsigned long generation;
+    unsigned int pending; // threads yet to finish the phase
+};
+
+ParallelGreedyStats ParallelGreedyCover(const IncidenceStore& incidences, unsigned int thread_count, bool bulk_rounds, GiftSolution* solution) {
+  if (thread_count <= 0) {
+    thread_count = std::thread::hardware_concurrency();
+  }
+  if (thread_count <= 0) {
+    thread_count = 1;
+  }
+
+  ParallelGreedy greedy(incidences, thread_count, bulk_rounds);
+  return greedy.Run(solution);
+}
@@ -0,0 +1,31 @@
+/*
+ * Description: interface to greedy set-cover spread across threads
+ * Documentation: of the technique: https://en.m.wikipedia.org/wiki/Bulk_synchronous_parallel
+ * Author: Laura Galbraith
+*/
+
+#ifndef SVGSC_PARALLEL_GREEDY_H
+#define SVGSC_PARALLEL_GREEDY_H
+
+#include "incidence.hpp" // IncidenceStore
+#include "output.hpp" // GiftSolution
+
+class ParallelGreedyStats {
+  public:
+    // Constructor
+    ParallelGreedyStats();
+
+    // Member variables
+    unsigned int thread_count; // threads used, the calling one included
+    unsigned int rounds; // times the threads met to agree on the next picks
+};
+
+// Greedy set-cover with the gifts split across threads, each owning a range of gift IDs with about the same number of incidences:
+// every round, each thread takes away the villagers the last picks covered from the gains of its own gifts, and offers its best gift from a lazy max-heap,
+// and the best offer is picked, so with bulk_rounds false the picks, their order and the solution are exactly GreedyCover's
+// with bulk_rounds, each round instead picks every offered gift still covering at least 90% as many new villagers as the best gift,
+// checked in order against the villagers picked earlier in the round, so the rounds are far fewer but the picks may differ from GreedyCover's
+// a thread_count of 0 uses every core
+ParallelGreedyStats ParallelGreedyCover(const IncidenceStore& incidences, unsigned int thread_count, bool bulk_rounds, GiftSolution* solution);
+
+#endif // SVGSC_PARALLEL_GREEDY_H
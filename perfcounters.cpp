@@ -0,0 +1,253 @@
+/*
+ * Description: implementations to count cycles, instructions, cache misses and branch misses around named regions of the solver and parsers, on Linux
+ * Author: Laura Galbraith
+*/
+
+#include "perfcounters.hpp" // self-include header
+
+#include <string> // string
+#include <ostream> // ostream
+
+#ifdef SVGSC_PERF_COUNTERS
+#include <vector> // vector
+#include <map> // map
+#include <memory> // unique_ptr
+#include <mutex> // mutex, lock_guard
+#include <chrono> // steady_clock, nanoseconds, duration_cast
+#include <cstring> // memset, strerror
+#include <cerrno> // errno
+
+#include <linux/perf_event.h> // perf_event_attr, PERF_TYPE_HARDWARE, PERF_COUNT_HW_*, PERF_FORMAT_*
+#include <sys/syscall.h> // SYS_perf_event_open
+#include <unistd.h> // syscall, read, close
+
+// in the order of PerfRegion's counts; the first the kernel accepts leads the group, so they are all read at once
+const char* const PERF_COUNTER_NAMES[PERF_COUNTER_COUNT] = {"cycles", "instructions", "cache_misses", "branch_misses"};
+const unsigned long long PERF_COUNTER_CONFIGS[PERF_COUNTER_COUNT] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+// One region's totals on one thread, or summed over threads for the report
+class PerfRegionTotals {
+  public:
+    PerfRegionTotals()
+      : name(NULL), calls(0), wall_ns(0)
+    {
+      for (unsigned int counter_i = 0; counter_i < PERF_COUNTER_COUNT; ++counter_i) {
+        this->counts[counter_i] = 0;
+      }
+    }
+
+    const char* name;
+    unsigned long long calls;
+    unsigned long long wall_ns;
+    unsigned long long counts[PERF_COUNTER_COUNT];
+};
+
+// One thread's group of counters, and the totals of the regions it entered
+// the counters only ever count their own thread, so each thread opens its own; the totals are only added to by their thread, under the lock so the report can read them
+class PerfThreadCounters {
+  public:
+    PerfThreadCounters()
+      : leader_fd(-1), open_count(0)
+    {
+      for (unsigned int counter_i = 0; counter_i < PERF_COUNTER_COUNT; ++counter_i) {
+        this->group_positions[counter_i] = -1;
+
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNTER_CONFIGS[counter_i];
+        // user space only, which perf_event_paranoid allows without privileges
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        const int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, this->leader_fd, 0));
+        if (fd < 0) {
+          if (this->unavailable_reason == "") {
+            this->unavailable_reason = std::string("perf_event_open for ") + PERF_COUNTER_NAMES[counter_i] + ": " + std::strerror(errno);
+          }
+          continue;
+        }
+        if (this->leader_fd < 0) {
+          this->leader_fd = fd;
+        }
+        this->fds.push_back(fd);
+        this->group_positions[counter_i] = static_cast<int>(this->open_count++);
+      }
+    }
+
+    ~PerfThreadCounters() {
+      for (auto fd:this->fds) {
+        close(fd);
+      }
+    }
+
+    // reads every open counter at once; false if none are open or the read fails
+    bool Read(unsigned long long counts[], unsigned long long* enabled_ns, unsigned long long* running_ns) const {
+      if (this->leader_fd < 0) {
+        return false;
+      }
+
+      // number of counters, time enabled, time running, then a value per counter
+      unsigned long long values[3 + PERF_COUNTER_COUNT];
+      const size_t expected_bytes = (3 + this->open_count) * sizeof(unsigned long long);
+      if (read(this->leader_fd, values, expected_bytes) != static_cast<ssize_t>(expected_bytes)) {
+        return false;
+      }
+      *enabled_ns = values[1];
+      *running_ns = values[2];
+      for (unsigned int counter_i = 0; counter_i < PERF_COUNTER_COUNT; ++counter_i) {
+        counts[counter_i] = this->group_positions[counter_i] >= 0 ? values[3 + this->group_positions[counter_i]] : 0;
+      }
+      return true;
+    }
+
+    // O(number of regions this thread entered)
+    void Add(const char* name, unsigned long long wall_ns, const unsigned long long counts[]) {
+      std::lock_guard<std::mutex> guard(this->lock);
+      // names are literals, so one call site always passes the same pointer
+      size_t region_i = 0;
+      while (region_i < this->regions.size() && this->regions[region_i].name != name) {
+        ++region_i;
+      }
+      if (region_i == this->regions.size()) {
+        this->regions.push_back(PerfRegionTotals());
+        this->regions.back().name = name;
+      }
+
+      PerfRegionTotals& totals = this->regions[region_i];
+      ++totals.calls;
+      totals.wall_ns += wall_ns;
+      for (unsigned int counter_i = 0; counter_i < PERF_COUNTER_COUNT; ++counter_i) {
+        totals.counts[counter_i] += counts[counter_i];
+      }
+    }
+
+    int leader_fd;
+    std::vector<int> fds;
+    unsigned int open_count;
+    int group_positions[PERF_COUNTER_COUNT]; // each counter's place in a group read, or -1 if the kernel refused it
+    std::string unavailable_reason; // why the first counter refused was
+    std::mutex lock;
+    std::vector<PerfRegionTotals> regions;
+};
+
+// Every thread's counters, kept until the program exits so the report can include threads that have finished
+class PerfRegistry {
+  public:
+    std::mutex lock;
+    std::vector<std::unique_ptr<PerfThreadCounters>> threads;
+};
+
+static PerfRegistry& Registry() {
+  static PerfRegistry registry;
+  return registry;
+}
+
+static PerfThreadCounters* ThisThreadCounters() {
+  thread_local PerfThreadCounters* counters = NULL;
+  if (counters == NULL) {
+    PerfRegistry& registry = Registry();
+    std::lock_guard<std::mutex> guard(registry.lock);
+    registry.threads.push_back(std::unique_ptr<PerfThreadCounters>(new PerfThreadCounters()));
+    counters = registry.threads.back().get();
+  }
+  return counters;
+}
+
+static long long NowNs() {
+  return static_cast<long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+PerfRegion::PerfRegion(const char* region_name)
+  : name(region_name), counters(ThisThreadCounters()), start_ns(0), counted(false), start_enabled_ns(0), start_running_ns(0)
+{
+  this->counted = this->counters->Read(this->start_counts, &this->start_enabled_ns, &this->start_running_ns);
+  // last, so the clock read is not counted against the region
+  this->start_ns = NowNs();
+}
+
+PerfRegion::~PerfRegion() {
+  const long long end_ns = NowNs();
+  unsigned long long counts[PERF_COUNTER_COUNT] = {0, 0, 0, 0};
+  unsigned long long enabled_ns = 0;
+  unsigned long long running_ns = 0;
+  if (this->counted && this->counters->Read(counts, &enabled_ns, &running_ns)) {
+    // with more counters open than the hardware has, the kernel takes turns between them; scale up to the time they were meant to count
+    const unsigned long long enabled_delta = enabled_ns - this->start_enabled_ns;
+    const unsigned long long running_delta = running_ns - this->start_running_ns;
+    for (unsigned int counter_i = 0; counter_i < PERF_COUNTER_COUNT; ++counter_i) {
+      counts[counter_i] -= this->start_counts[counter_i];
+      if (running_delta > 0 && running_delta < enabled_delta) {
+        counts[counter_i] = static_cast<unsigned long long>(static_cast<long double>(counts[counter_i]) * static_cast<long double>(enabled_delta) / static_cast<long double>(running_delta));
+      }
+    }
+  }
+  else {
+    for (unsigned int counter_i = 0; counter_i < PERF_COUNTER_COUNT; ++counter_i) {
+      counts[counter_i] = 0;
+    }
+  }
+  this->counters->Add(this->name, static_cast<unsigned long long>(end_ns - this->start_ns), counts);
+}
+
+std::string WritePerfReport(std::ostream& os) {
+  std::map<std::string, PerfRegionTotals> regions;
+  bool available[PERF_COUNTER_COUNT] = {false, false, false, false};
+  bool any_available = false;
+  std::string unavailable_reason;
+  {
+    PerfRegistry& registry = Registry();
+    std::lock_guard<std::mutex> guard(registry.lock);
+    for (const auto& thread:registry.threads) {
+      std::lock_guard<std::mutex> thread_guard(thread->lock);
+      for (unsigned int counter_i = 0; counter_i < PERF_COUNTER_COUNT; ++counter_i) {
+        available[counter_i] = available[counter_i] || thread->group_positions[counter_i] >= 0;
+        any_available = any_available || available[counter_i];
+      }
+      if (unavailable_reason == "") {
+        unavailable_reason = thread->unavailable_reason;
+      }
+
+      // the same name from two call sites is one region
+      for (const auto& region:thread->regions) {
+        PerfRegionTotals& totals = regions[region.name];
+        totals.calls += region.calls;
+        totals.wall_ns += region.wall_ns;
+        for (unsigned int counter_i = 0; counter_i < PERF_COUNTER_COUNT; ++counter_i) {
+          totals.counts[counter_i] += region.counts[counter_i];
+        }
+      }
+    }
+  }
+
+  // region names are literals from this code, with nothing to escape
+  os << "{\"counters_available\":" << (any_available ? "true" : "false") << ",\"unavailable_reason\":\"" << unavailable_reason << "\",\"regions\":[";
+  bool first = true;
+  for (const auto& region:regions) {
+    os << (first ? "" : ",") << "{\"region\":\"" << region.first << "\",\"calls\":" << region.second.calls << ",\"wall_ns\":" << region.second.wall_ns;
+    for (unsigned int counter_i = 0; counter_i < PERF_COUNTER_COUNT; ++counter_i) {
+      os << ",\"" << PERF_COUNTER_NAMES[counter_i] << "\":";
+      if (available[counter_i]) {
+        os << region.second.counts[counter_i];
+      }
+      else {
+        os << "null";
+      }
+    }
+    os << "}";
+    first = false;
+  }
+  os << "]}" << std::endl;
+  return "";
+}
+
+#else
+
+std::string WritePerfReport(std::ostream& os) {
+  (void) os;
+  return "performance counters are not compiled into this build; see 'make profiled'";
+}
+
+#endif
@@ -0,0 +1,62 @@
+/*
+ * Description: interfaces to count cycles, instructions, cache misses and branch misses around named regions of the solver and parsers, on Linux
+ * Documentation: of the counters: https://man7.org/linux/man-pages/man2/perf_event_open.2.html
+ * Author: Laura Galbraith
+*/
+
+#ifndef SVGSC_PERF_COUNTERS_H
+#define SVGSC_PERF_COUNTERS_H
+
+#include <string> // string
+#include <ostream> // ostream
+
+// 'make profiled' defines SVGSC_PERF_COUNTERS; without it, SVGSC_PERF_REGION expands to nothing and no counter code is compiled in
+#ifdef SVGSC_PERF_COUNTERS
+const bool PERF_COUNTERS_COMPILED_IN = true;
+// cycles, instructions, cache misses and branch misses
+const unsigned int PERF_COUNTER_COUNT = 4;
+
+class PerfThreadCounters;
+
+// Counts the calling thread's hardware events from its construction to its destruction, adding them to the totals for its region's name
+// the name must outlive the program, as a string literal does; regions may nest, and each counts everything within it
+// a thread's counters are opened the first time it enters a region; if the kernel refuses them, only calls and wall time are counted
+class PerfRegion {
+  public:
+    // Constructor
+    explicit PerfRegion(const char* region_name);
+
+    // Destructor; adds what was counted since construction to the region's totals
+    ~PerfRegion();
+
+  private:
+    // not copyable, since each one is a single measurement
+    PerfRegion(const PerfRegion& other);
+    PerfRegion& operator=(const PerfRegion& other);
+
+    const char* name;
+    PerfThreadCounters* counters; // the calling thread's
+    long long start_ns;
+    bool counted; // false if the thread has no counters open, so only calls and wall time are added
+    unsigned long long start_counts[PERF_COUNTER_COUNT];
+    unsigned long long start_enabled_ns;
+    unsigned long long start_running_ns;
+};
+
+#define SVGSC_PERF_CONCAT_INNER(a, b) a##b
+#define SVGSC_PERF_CONCAT(a, b) SVGSC_PERF_CONCAT_INNER(a, b)
+// ex. SVGSC_PERF_REGION("greedy pick"); counts from here to the end of the enclosing scope
+#define SVGSC_PERF_REGION(region_name) PerfRegion SVGSC_PERF_CONCAT(perf_region_, __LINE__)(region_name)
+#else
+const bool PERF_COUNTERS_COMPILED_IN = false;
+
+#define SVGSC_PERF_REGION(region_name)
+#endif
+
+// writes every region's totals so far, summed over threads and in name order, as one JSON object on one line:
+// {"counters_available":true,"unavailable_reason":"","regions":[{"region":"greedy pick","calls":12,"wall_ns":3400,"cycles":9100,"instructions":12000,"cache_misses":40,"branch_misses":31},...]}
+// a counter the kernel or hardware does not offer is null, with the reason the first one was refused; when counters were multiplexed, counts are scaled up to the time enabled
+// returns an error without writing anything if the counters are not compiled in, or empty if successful
+std::string WritePerfReport(std::ostream& os);
+
+#endif // SVGSC_PERF_COUNTERS_H
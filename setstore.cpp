@@ -0,0 +1,535 @@
+/*
+ * Description: implementations to keep set-cover instances larger than memory on disk, and greedily cover them in passes over the file
+ * Author: Laura Galbraith
+*/
+
+#include "setstore.hpp" // self-include header
+
+#include <string> // string, to_string
+#include <vector> // vector
+#include <algorithm> // sort, unique, max, min, fill, max_element
+#include <cstdio> // FILE, fopen, fwrite, fseek, fclose, ferror, remove
+#include <cstring> // memcmp
+
+#include <sys/mman.h> // mmap, munmap, madvise
+#include <sys/stat.h> // fstat
+#include <fcntl.h> // open
+#include <unistd.h> // close
+
+#include "instance.hpp" // SetCoverInstanceSink, StreamSetCoverInstance
+#include "nametable.hpp" // NameTable
+#include "output.hpp" // GiftSolution
+#include "perfcounters.hpp" // SVGSC_PERF_REGION
+
+const char STORE_MAGIC[] = "SVGSCSTO";
+const size_t STORE_MAGIC_SIZE = 8;
+const unsigned long STORE_VERSION = 1;
+const size_t STORE_HEADER_SIZE = STORE_MAGIC_SIZE + 4 * 4 + 8 + 3 * 8;
+const size_t STORE_INDEX_ENTRY_SIZE = 4 + 4 + 8;
+const size_t STORE_BLOCK_SIZE = 1 << 16; // a block is closed once another set would take it past this, unless it is empty
+const unsigned int THRESHOLD_PERCENT = 90;
+
+SetStoreBuildStats::SetStoreBuildStats()
+  : passes(0), incidences(0), store_bytes(0), unit_costs(true)
+{}
+
+StreamingGreedyResult::StreamingGreedyResult()
+  : passes(0), bytes_scanned(0), resident_bytes(0)
+{}
+
+void AppendVarint(unsigned long value, std::vector<unsigned char>* bytes) {
+  while (value >= 0x80) {
+    bytes->push_back(static_cast<unsigned char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  bytes->push_back(static_cast<unsigned char>(value));
+}
+
+// false if the varint runs past the end, or past 64 bits
+bool ReadVarint(const unsigned char** p, const unsigned char* end, unsigned long* value) {
+  *value = 0;
+  for (unsigned int shift = 0; shift < 64 && *p < end; shift += 7) {
+    const unsigned char byte = *(*p)++;
+    *value |= static_cast<unsigned long>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+unsigned long ReadLittleEndian(const unsigned char* p, size_t size) {
+  unsigned long value = 0;
+  for (size_t byte_i = size; byte_i > 0; --byte_i) {
+    value = (value << 8) | p[byte_i-1];
+  }
+  return value;
+}
+
+// Writes the store front to back through the file's buffer, keeping track of the offset
+class StoreWriter {
+  public:
+    // Constructor; the file must stay open while the writer is used
+    explicit StoreWriter(std::FILE* written_file)
+      : file(written_file), offset(0)
+    {}
+
+    void Write(const unsigned char* data, size_t size) {
+      std::fwrite(data, 1, size, this->file);
+      this->offset += size;
+    }
+
+    void WriteLittleEndian(unsigned long value, size_t size) {
+      unsigned char bytes[8];
+      for (size_t byte_i = 0; byte_i < size; ++byte_i) {
+        bytes[byte_i] = static_cast<unsigned char>(value >> (8 * byte_i));
+      }
+      this->Write(bytes, size);
+    }
+
+    size_t Offset() const {
+      return this->offset;
+    }
+
+  private:
+    std::FILE* file;
+    size_t offset;
+};
+
+// Names every set and element, and counts each set's incidences, on the first pass
+class CountingSink : public SetCoverInstanceSink {
+  public:
+    unsigned int AddGift(const std::string& set_name) override {
+      const unsigned int set_id = this->gift_names.Intern(set_name);
+      if (set_id == this->counts.size()) {
+        this->counts.push_back(0);
+      }
+      return set_id;
+    }
+
+    unsigned int AddVillager(const std::string& element_name) override {
+      return this->villager_names.Intern(element_name);
+    }
+
+    void AddIncidence(unsigned int set_id, unsigned int) override {
+      ++this->counts[set_id];
+    }
+
+    NameTable gift_names;
+    NameTable villager_names;
+    std::vector<size_t> counts; // incidences of each set, repeats included
+};
+
+// Gathers the incidences of one range of sets into slots sized by the first pass's counts, naming through its tables, which the same file gives the same IDs
+class RangeSink : public SetCoverInstanceSink {
+  public:
+    RangeSink(CountingSink* counted, unsigned int first_set, unsigned int end_set)
+      : names(counted), first(first_set), end(end_set), fill(end_set - first_set + 1, 0)
+    {
+      for (unsigned int set_id = first_set; set_id < end_set; ++set_id) {
+        this->fill[set_id - first_set + 1] = this->fill[set_id - first_set] + counted->counts[set_id];
+      }
+      this->elements.resize(this->fill.back());
+      this->starts = this->fill;
+    }
+
+    unsigned int AddGift(const std::string& set_name) override {
+      return this->names->gift_names.Intern(set_name);
+    }
+
+    unsigned int AddVillager(const std::string& element_name) override {
+      return this->names->villager_names.Intern(element_name);
+    }
+
+    void AddIncidence(unsigned int set_id, unsigned int element_id) override {
+      if (set_id >= this->first && set_id < this->end) {
+        this->elements[this->fill[set_id - this->first]++] = element_id;
+      }
+    }
+
+    CountingSink* names;
+    unsigned int first;
+    unsigned int end;
+    std::vector<size_t> fill; // where each set's next incidence goes
+    std::vector<size_t> starts; // elements[starts[s] .. starts[s+1]] are set first+s's, once the pass is done
+    std::vector<unsigned int> elements;
+};
+
+// Packs encoded sets into blocks in ID order, writing each block as it fills, and remembers where each one went
+class BlockPacker {
+  public:
+    explicit BlockPacker(StoreWriter* store_writer)
+      : writer(store_writer), first_gift(0), largest_gift(0), next_gift(0)
+    {}
+
+    // the elements must be sorted, without repeats
+    void Add(const unsigned int* elements, size_t count) {
+      this->payload.resize(0);
+      unsigned int previous = 0;
+      for (size_t element_i = 0; element_i < count; ++element_i) {
+        AppendVarint(elements[element_i] - previous, &this->payload);
+        previous = elements[element_i];
+      }
+
+      this->encoded.resize(0);
+      AppendVarint(count, &this->encoded);
+      AppendVarint(this->payload.size(), &this->encoded);
+      this->encoded.insert(this->encoded.end(), this->payload.begin(), this->payload.end());
+      if (!this->block.empty() && this->block.size() + this->encoded.size() > STORE_BLOCK_SIZE) {
+        this->Flush();
+      }
+
+      if (this->block.empty()) {
+        this->first_gift = this->next_gift;
+        this->largest_gift = 0;
+      }
+      this->block.insert(this->block.end(), this->encoded.begin(), this->encoded.end());
+      this->largest_gift = std::max(this->largest_gift, static_cast<unsigned int>(count));
+      ++this->next_gift;
+    }
+
+    void Flush() {
+      if (this->block.empty()) {
+        return;
+      }
+      this->first_gifts.push_back(this->first_gift);
+      this->largest_gifts.push_back(this->largest_gift);
+      this->offsets.push_back(this->writer->Offset());
+      this->writer->Write(this->block.data(), this->block.size());
+      this->block.resize(0);
+    }
+
+    StoreWriter* writer;
+    std::vector<unsigned char> payload;
+    std::vector<unsigned char> encoded;
+    std::vector<unsigned char> block;
+    unsigned int first_gift;
+    unsigned int largest_gift;
+    unsigned int next_gift;
+    std::vector<unsigned int> first_gifts;
+    std::vector<unsigned int> largest_gifts;
+    std::vector<size_t> offsets;
+};
+
+void WriteNames(const NameTable& names, StoreWriter* writer) {
+  size_t name_offset = 0;
+  for (unsigned int id = 0; id < names.Size(); ++id) {
+    writer->WriteLittleEndian(name_offset, 8);
+    name_offset += names.Name(id).size();
+  }
+  writer->WriteLittleEndian(name_offset, 8);
+  for (unsigned int id = 0; id < names.Size(); ++id) {
+    const std::string& name = names.Name(id);
+    writer->Write(reinterpret_cast<const unsigned char*>(name.data()), name.size());
+  }
+}
+
+// the first pass names and counts; each pass after takes the next sets whose incidences fit the budget, sorts each set's elements and packs them,
+// so the blocks are written in ID order
+std::string BuildSetStore(const std::string& instance_path, SetCoverInstanceFormat format, const std::string& store_path, size_t memory_budget_bytes, SetStoreBuildStats* stats) {
+  *stats = SetStoreBuildStats();
+  CountingSink counted;
+  std::string error = StreamSetCoverInstance(instance_path, format, &counted, &stats->unit_costs);
+  stats->passes = 1;
+  if (error != "") {
+    return error;
+  }
+
+  std::FILE* file = std::fopen(store_path.c_str(), "wb");
+  if (file == NULL) {
+    return "could not write " + store_path;
+  }
+
+  // the header is written again at the end, once the offsets are known
+  StoreWriter writer(file);
+  const std::vector<unsigned char> header(STORE_HEADER_SIZE, 0);
+  writer.Write(header.data(), header.size());
+
+  BlockPacker packer(&writer);
+  const unsigned int gift_count = static_cast<unsigned int>(counted.gift_names.Size());
+  const size_t budget_incidences = std::max(memory_budget_bytes / sizeof(unsigned int), static_cast<size_t>(1));
+  unsigned int first_set = 0;
+  while (first_set < gift_count && error == "") {
+    unsigned int end_set = first_set + 1;
+    size_t range_incidences = counted.counts[first_set];
+    while (end_set < gift_count && range_incidences + counted.counts[end_set] <= budget_incidences) {
+      range_incidences += counted.counts[end_set++];
+    }
+
+    RangeSink range(&counted, first_set, end_set);
+    bool unit_costs = true;
+    error = StreamSetCoverInstance(instance_path, format, &range, &unit_costs);
+    ++stats->passes;
+
+    for (unsigned int set_i = 0; set_i < end_set - first_set && error == ""; ++set_i) {
+      unsigned int* begin = range.elements.data() + range.starts[set_i];
+      unsigned int* end = range.elements.data() + range.starts[set_i+1];
+      std::sort(begin, end);
+      end = std::unique(begin, end);
+      packer.Add(begin, static_cast<size_t>(end - begin));
+      stats->incidences += static_cast<size_t>(end - begin);
+    }
+    first_set = end_set;
+  }
+  packer.Flush();
+
+  const size_t index_offset = writer.Offset();
+  for (size_t block_i = 0; block_i < packer.offsets.size(); ++block_i) {
+    writer.WriteLittleEndian(packer.first_gifts[block_i], 4);
+    writer.WriteLittleEndian(packer.largest_gifts[block_i], 4);
+    writer.WriteLittleEndian(packer.offsets[block_i], 8);
+  }
+  writer.WriteLittleEndian(index_offset, 8);
+  const size_t gift_names_offset = writer.Offset();
+  WriteNames(counted.gift_names, &writer);
+  const size_t villager_names_offset = writer.Offset();
+  WriteNames(counted.villager_names, &writer);
+  stats->store_bytes = writer.Offset();
+
+  std::fseek(file, 0, SEEK_SET);
+  StoreWriter header_writer(file);
+  header_writer.Write(reinterpret_cast<const unsigned char*>(STORE_MAGIC), STORE_MAGIC_SIZE);
+  header_writer.WriteLittleEndian(STORE_VERSION, 4);
+  header_writer.WriteLittleEndian(gift_count, 4);
+  header_writer.WriteLittleEndian(counted.villager_names.Size(), 4);
+  header_writer.WriteLittleEndian(packer.offsets.size(), 4);
+  header_writer.WriteLittleEndian(stats->incidences, 8);
+  header_writer.WriteLittleEndian(index_offset, 8);
+  header_writer.WriteLittleEndian(gift_names_offset, 8);
+  header_writer.WriteLittleEndian(villager_names_offset, 8);
+
+  const bool write_failed = std::ferror(file) != 0;
+  if (std::fclose(file) != 0 || (write_failed && error == "")) {
+    error = "could not write " + store_path;
+  }
+  if (error != "") {
+    std::remove(store_path.c_str());
+  }
+  return error;
+}
+
+SetStore::SetStore()
+  : mapped(NULL), mapped_bytes(0), gift_count(0), villager_count(0), block_count(0), incidence_count(0), index_offset(0), gift_names_offset(0), villager_names_offset(0)
+{}
+
+// the index is checked in full, so the blocks can be scanned without checking where they are; what is in them is checked as it is decoded
+std::string SetStore::Open(const std::string& path) {
+  this->Close();
+
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return "could not open " + path;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size < static_cast<off_t>(STORE_HEADER_SIZE)) {
+    close(fd);
+    return path + " is not a set store";
+  }
+
+  this->mapped_bytes = static_cast<size_t>(file_stat.st_size);
+  void* mapping = mmap(NULL, this->mapped_bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    this->mapped_bytes = 0;
+    return "could not map " + path;
+  }
+  // the blocks are read front to back, so the OS can read ahead and drop pages behind
+  madvise(mapping, this->mapped_bytes, MADV_SEQUENTIAL);
+  this->mapped = static_cast<const unsigned char*>(mapping);
+
+  const unsigned char* p = this->mapped;
+  if (std::memcmp(p, STORE_MAGIC, STORE_MAGIC_SIZE) != 0 || ReadLittleEndian(p + STORE_MAGIC_SIZE, 4) != STORE_VERSION) {
+    this->Close();
+    return path + " is not a set store, or is from another version";
+  }
+  p += STORE_MAGIC_SIZE + 4;
+  this->gift_count = static_cast<unsigned int>(ReadLittleEndian(p, 4));
+  this->villager_count = static_cast<unsigned int>(ReadLittleEndian(p + 4, 4));
+  this->block_count = static_cast<unsigned int>(ReadLittleEndian(p + 8, 4));
+  this->incidence_count = ReadLittleEndian(p + 12, 8);
+  this->index_offset = ReadLittleEndian(p + 20, 8);
+  this->gift_names_offset = ReadLittleEndian(p + 28, 8);
+  this->villager_names_offset = ReadLittleEndian(p + 36, 8);
+
+  bool valid = this->index_offset >= STORE_HEADER_SIZE && this->gift_names_offset <= this->villager_names_offset && this->villager_names_offset <= this->mapped_bytes
+    && this->index_offset + this->block_count * STORE_INDEX_ENTRY_SIZE + 8 == this->gift_names_offset
+    && (this->villager_names_offset - this->gift_names_offset) / 8 > this->gift_count && (this->mapped_bytes - this->villager_names_offset) / 8 > this->villager_count;
+  for (size_t block_i = 0; block_i < this->block_count && valid; ++block_i) {
+    valid = this->BlockFirstGift(block_i) < this->gift_count && this->BlockBegin(block_i) <= this->BlockEnd(block_i) && this->BlockEnd(block_i) <= this->mapped + this->index_offset
+      && (block_i == 0 ? this->BlockBegin(block_i) >= this->mapped + STORE_HEADER_SIZE : this->BlockFirstGift(block_i) > this->BlockFirstGift(block_i-1));
+  }
+  if (!valid) {
+    this->Close();
+    return path + " is not a whole set store";
+  }
+  return "";
+}
+
+size_t SetStore::GiftCount() const {
+  return this->gift_count;
+}
+
+size_t SetStore::VillagerCount() const {
+  return this->villager_count;
+}
+
+size_t SetStore::IncidenceCount() const {
+  return this->incidence_count;
+}
+
+size_t SetStore::BlockCount() const {
+  return this->block_count;
+}
+
+size_t SetStore::FileBytes() const {
+  return this->mapped_bytes;
+}
+
+unsigned int SetStore::BlockFirstGift(size_t block_i) const {
+  return static_cast<unsigned int>(ReadLittleEndian(this->mapped + this->index_offset + block_i * STORE_INDEX_ENTRY_SIZE, 4));
+}
+
+unsigned int SetStore::BlockLargestGift(size_t block_i) const {
+  return static_cast<unsigned int>(ReadLittleEndian(this->mapped + this->index_offset + block_i * STORE_INDEX_ENTRY_SIZE + 4, 4));
+}
+
+const unsigned char* SetStore::BlockBegin(size_t block_i) const {
+  return this->mapped + ReadLittleEndian(this->mapped + this->index_offset + block_i * STORE_INDEX_ENTRY_SIZE + 8, 8);
+}
+
+// the index ends with the offset the last block ends at
+const unsigned char* SetStore::BlockEnd(size_t block_i) const {
+  const size_t next_offset_at = block_i + 1 < this->block_count ? this->index_offset + (block_i + 1) * STORE_INDEX_ENTRY_SIZE + 8 : this->index_offset + this->block_count * STORE_INDEX_ENTRY_SIZE;
+  return this->mapped + ReadLittleEndian(this->mapped + next_offset_at, 8);
+}
+
+std::string SetStore::GiftName(unsigned int gift_id) const {
+  return this->Name(this->gift_names_offset, this->gift_count, gift_id);
+}
+
+void SetStore::ReadVillagerNames(NameTable* villager_names) const {
+  for (unsigned int villager_id = 0; villager_id < this->villager_count; ++villager_id) {
+    villager_names->Intern(this->Name(this->villager_names_offset, this->villager_count, villager_id));
+  }
+}
+
+// empty if the offsets point outside the names
+std::string SetStore::Name(size_t names_offset, size_t name_count, unsigned int id) const {
+  const unsigned char* bytes = this->mapped + names_offset + (name_count + 1) * 8;
+  const unsigned char* names_end = names_offset == this->gift_names_offset ? this->mapped + this->villager_names_offset : this->mapped + this->mapped_bytes;
+  const size_t begin = ReadLittleEndian(this->mapped + names_offset + id * 8, 8);
+  const size_t end = ReadLittleEndian(this->mapped + names_offset + (id + 1) * 8, 8);
+  if (begin > end || end > static_cast<size_t>(names_end - bytes)) {
+    return "";
+  }
+  return std::string(reinterpret_cast<const char*>(bytes + begin), end - begin);
+}
+
+void SetStore::Close() {
+  if (this->mapped != NULL) {
+    munmap(const_cast<unsigned char*>(this->mapped), this->mapped_bytes);
+  }
+  this->mapped = NULL;
+  this->mapped_bytes = 0;
+}
+
+SetStore::~SetStore() {
+  this->Close();
+}
+
+// counts the set's villagers not yet covered, or with cover, covers them and adds them to the solution; false if the set is not whole
+bool ScanSet(const unsigned char* p, const unsigned char* end, unsigned long count, bool cover, std::vector<bool>* covered, GiftSolution* solution, unsigned int* gain) {
+  *gain = 0;
+  unsigned long villager_id = 0;
+  for (unsigned long villager_i = 0; villager_i < count; ++villager_i) {
+    unsigned long gap = 0;
+    if (!ReadVarint(&p, end, &gap)) {
+      return false;
+    }
+    villager_id += gap;
+    if (villager_id >= covered->size()) {
+      return false;
+    }
+    if ((*covered)[villager_id]) {
+      continue;
+    }
+
+    ++*gain;
+    if (cover) {
+      (*covered)[villager_id] = true;
+      solution->villager_ids.push_back(static_cast<unsigned int>(villager_id));
+    }
+  }
+  return true;
+}
+
+StreamingGreedyResult StreamingGreedyCover(const SetStore& store, GiftSolution* solution) {
+  StreamingGreedyResult result;
+  solution->Clear();
+
+  // until a gift is decoded, its gain is at most the largest set in its block
+  std::vector<unsigned int> gains(store.GiftCount(), 0);
+  std::vector<unsigned int> block_bounds(store.BlockCount(), 0);
+  std::vector<bool> covered(store.VillagerCount(), false);
+  unsigned int threshold = 0;
+  for (size_t block_i = 0; block_i < store.BlockCount(); ++block_i) {
+    const unsigned int gifts_end = block_i + 1 < store.BlockCount() ? store.BlockFirstGift(block_i + 1) : static_cast<unsigned int>(store.GiftCount());
+    block_bounds[block_i] = store.BlockLargestGift(block_i);
+    std::fill(gains.begin() + store.BlockFirstGift(block_i), gains.begin() + gifts_end, block_bounds[block_i]);
+    threshold = std::max(threshold, block_bounds[block_i]);
+  }
+  result.resident_bytes = gains.size() * sizeof(unsigned int) + block_bounds.size() * sizeof(unsigned int) + (covered.size() + 7) / 8;
+
+  while (threshold > 0) {
+    SVGSC_PERF_REGION("store greedy pass");
+    ++result.passes;
+    for (size_t block_i = 0; block_i < store.BlockCount(); ++block_i) {
+      if (block_bounds[block_i] < threshold) {
+        continue;
+      }
+
+      const unsigned char* p = store.BlockBegin(block_i);
+      const unsigned char* block_end = store.BlockEnd(block_i);
+      result.bytes_scanned += static_cast<size_t>(block_end - p);
+      unsigned int block_bound = 0;
+      for (unsigned int gift_id = store.BlockFirstGift(block_i); p < block_end; ++gift_id) {
+        unsigned long count = 0;
+        unsigned long length = 0;
+        if (gift_id >= gains.size() || !ReadVarint(&p, block_end, &count) || !ReadVarint(&p, block_end, &length) || length > static_cast<size_t>(block_end - p)) {
+          result.error = "block " + std::to_string(block_i) + " of the store is not whole";
+          return result;
+        }
+
+        const unsigned char* set_end = p + length;
+        if (gains[gift_id] >= threshold) {
+          unsigned int gain = 0;
+          bool whole = ScanSet(p, set_end, count, false, &covered, solution, &gain);
+          if (whole && gain >= threshold) {
+            solution->AddGift(gift_id);
+            whole = ScanSet(p, set_end, count, true, &covered, solution, &gain);
+            gain = 0;
+          }
+          if (!whole) {
+            result.error = "gift " + std::to_string(gift_id) + " in the store is not whole";
+            return result;
+          }
+          gains[gift_id] = gain;
+        }
+        block_bound = std::max(block_bound, gains[gift_id]);
+        p = set_end;
+      }
+      block_bounds[block_i] = block_bound;
+    }
+
+    // every gain left is now below the threshold
+    const unsigned int largest_left = block_bounds.empty() ? 0 : *std::max_element(block_bounds.begin(), block_bounds.end());
+    threshold = std::min(largest_left, static_cast<unsigned int>(static_cast<unsigned long>(threshold) * THRESHOLD_PERCENT / 100));
+  }
+
+  for (unsigned int villager_id = 0; villager_id < covered.size(); ++villager_id) {
+    if (!covered[villager_id]) {
+      solution->uncovered_villager_ids.push_back(villager_id);
+    }
+  }
+  return result;
+}
@@ -0,0 +1,112 @@
+/*
+ * Description: interfaces to keep set-cover instances larger than memory on disk, and greedily cover them in passes over the file
+ * Documentation: of the varint encoding: https://en.m.wikipedia.org/wiki/LEB128
+ * Author: Laura Galbraith
+*/
+
+#ifndef SVGSC_SET_STORE_H
+#define SVGSC_SET_STORE_H
+
+#include <string> // string
+#include <vector> // vector
+#include <cstddef> // size_t
+
+#include "instance.hpp" // SetCoverInstanceFormat
+#include "nametable.hpp" // NameTable
+#include "output.hpp" // GiftSolution
+
+class SetStoreBuildStats {
+  public:
+    // Constructor
+    SetStoreBuildStats();
+
+    // Member variables
+    unsigned int passes; // reads of the instance file: one to name and count, then one per range of sets that fits the memory budget
+    size_t incidences; // after repeats are dropped
+    size_t store_bytes;
+    bool unit_costs; // as in SetCoverInstance; the store has no costs
+};
+
+// writes a store of the instance file for SetStore, reading the instance once per pass and keeping at most about memory_budget_bytes of incidences at a time;
+// the names of every set and element, and a count per set, are kept throughout
+// each set's elements are written sorted and delta-encoded as varints, in blocks of whole sets, sets in ID order
+// returns an error, or empty if successful
+std::string BuildSetStore(const std::string& instance_path, SetCoverInstanceFormat format, const std::string& store_path, size_t memory_budget_bytes, SetStoreBuildStats* stats);
+
+// A store written by BuildSetStore, memory-mapped read-only, so it can be far larger than memory: the OS reads its pages in as they are scanned, and drops them as it needs to
+// sets stand in for gifts and elements for villagers, with the IDs the instance would have given them in an IncidenceStore
+//
+// layout, all integers little-endian:
+//   "SVGSCSTO", version (32-bit), gift count (32-bit), villager count (32-bit), block count (32-bit), incidence count (64-bit),
+//   then the offsets (64-bit) of the block index, the gift names and the villager names
+//   blocks: per set, its villager count and encoded length in bytes, then its villagers, the first as-is and each after as the gap from the one before, all varints
+//   block index: per block, its first gift ID (32-bit), the largest set in it (32-bit) and its offset (64-bit), then the offset its data ends at
+//   names, gifts then villagers: an offset (64-bit) per name and one past the last, then the names' bytes
+class SetStore {
+  public:
+    // Constructor
+    SetStore();
+
+    // maps the file and checks its layout; returns an error, or empty if successful
+    std::string Open(const std::string& path);
+
+    // Data-reading methods, valid after Open
+    size_t GiftCount() const;
+    size_t VillagerCount() const;
+    size_t IncidenceCount() const;
+    size_t BlockCount() const;
+    size_t FileBytes() const;
+
+    unsigned int BlockFirstGift(size_t block_i) const;
+    unsigned int BlockLargestGift(size_t block_i) const; // how many villagers the largest set in the block has
+    const unsigned char* BlockBegin(size_t block_i) const;
+    const unsigned char* BlockEnd(size_t block_i) const;
+
+    // O(length of the name)
+    std::string GiftName(unsigned int gift_id) const;
+    // O(length of every villager name)
+    void ReadVillagerNames(NameTable* villager_names) const;
+
+    // Destructor; unmaps the file
+    ~SetStore();
+
+  private:
+    // not copyable, since it owns the mapping
+    SetStore(const SetStore& other);
+    SetStore& operator=(const SetStore& other);
+
+    std::string Name(size_t names_offset, size_t name_count, unsigned int id) const;
+    void Close();
+
+    const unsigned char* mapped;
+    size_t mapped_bytes;
+    unsigned int gift_count;
+    unsigned int villager_count;
+    unsigned int block_count;
+    size_t incidence_count;
+    size_t index_offset;
+    size_t gift_names_offset;
+    size_t villager_names_offset;
+};
+
+class StreamingGreedyResult {
+  public:
+    // Constructor
+    StreamingGreedyResult();
+
+    // Member variables
+    std::string error; // empty if successful
+    unsigned int passes; // thresholds scanned for
+    size_t bytes_scanned; // of blocks, summed over the passes
+    size_t resident_bytes; // of the gains, covered flags and per-block bounds kept in memory while scanning
+};
+
+// Greedy set-cover over a store, keeping in memory only each gift's gain, a covered flag per villager and the largest gain in each block:
+// each pass scans the blocks in file order for a threshold, picking every gift that still covers at least that many uncovered villagers when it is reached,
+// then the threshold falls to 90% of itself, or to the largest gain left if that is less, so each pick covers at least 90% as many new villagers as the best gift would
+// gains only fall, so a gift or a whole block whose last gain is below the threshold is passed over without decoding it, and a block without reading it
+// the picks may differ from GreedyCover's; adds each gift picked to the solution with the villagers it newly covers, in ID order, then every villager left uncovered
+// O(number of incidences * number of passes) at most, reading the file front to back each pass
+StreamingGreedyResult StreamingGreedyCover(const SetStore& store, GiftSolution* solution);
+
+#endif // SVGSC_SET_STORE_H
@@ -0,0 +1,143 @@
+/*
+ * Description: implementations to solve the fewest gift types exactly when few villagers are left to cover
+ * Author: Laura Galbraith
+*/
+
+#include "smallcover.hpp" // self-include header
+
+#include <vector> // vector
+#include <chrono> // steady_clock, microseconds, duration_cast
+#include <algorithm> // sort, reverse, max
+#include <tuple> // pair
+
+#include "incidence.hpp" // IncidenceStore
+
+// gifts are only checked against each other for being covered by another when there are at most this many distinct masks, since it takes their square
+const size_t DOMINANCE_CHECK_MAX_GIFTS = 4096;
+
+SmallCoverResult::SmallCoverResult()
+  : solved(false), villagers(0), candidate_gifts(0), states(0), elapsed_us(0)
+{}
+
+// One covered-set reached: its mask, the state it was reached from, and the candidate gift added to that one
+class CoverState {
+  public:
+    CoverState(unsigned int state_mask, unsigned int from_state, unsigned int added_candidate)
+      : mask(state_mask), from(from_state), candidate(added_candidate)
+    {}
+
+    unsigned int mask;
+    unsigned int from;
+    unsigned int candidate;
+};
+
+SmallCoverResult SolveSmallCover(const IncidenceStore& incidences, const std::vector<unsigned int>& cover_gift_ids, unsigned long max_states) {
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  SmallCoverResult result;
+
+  // villagers no gift covers stay uncovered whatever is picked, so they get no bit
+  std::vector<unsigned int> villager_bits(incidences.VillagerCount(), 0);
+  for (unsigned int villager_id = 0; villager_id < incidences.VillagerCount(); ++villager_id) {
+    if (incidences.VillagerGiftsBegin(villager_id) == incidences.VillagerGiftsEnd(villager_id)) {
+      continue;
+    }
+    if (result.villagers >= SMALL_COVER_MAX_VILLAGERS) {
+      return result;
+    }
+    villager_bits[villager_id] = 1u << result.villagers++;
+  }
+  const unsigned int all_covered = (1u << result.villagers) - 1;
+
+  // (mask, gift ID), so gifts with the same villagers are next to each other, the lowest ID first
+  std::vector<std::pair<unsigned int, unsigned int>> gift_masks;
+  for (unsigned int gift_id = 0; gift_id < incidences.GiftCount(); ++gift_id) {
+    unsigned int mask = 0;
+    for (const unsigned int* v_it = incidences.GiftVillagersBegin(gift_id); v_it != incidences.GiftVillagersEnd(gift_id); ++v_it) {
+      mask |= villager_bits[*v_it];
+    }
+    if (mask != 0) {
+      gift_masks.push_back(std::pair<unsigned int, unsigned int>(mask, gift_id));
+    }
+  }
+  std::sort(gift_masks.begin(), gift_masks.end());
+
+  std::vector<std::pair<unsigned int, unsigned int>> distinct;
+  for (size_t gift_i = 0; gift_i < gift_masks.size(); ++gift_i) {
+    if (gift_i == 0 || gift_masks[gift_i].first != gift_masks[gift_i-1].first) {
+      distinct.push_back(gift_masks[gift_i]);
+    }
+  }
+  std::vector<unsigned int> candidate_masks;
+  std::vector<unsigned int> candidate_gift_ids;
+  unsigned int largest_gift = 1;
+  for (const auto& gift:distinct) {
+    bool dominated = false;
+    for (size_t other_i = 0; other_i < distinct.size() && distinct.size() <= DOMINANCE_CHECK_MAX_GIFTS && !dominated; ++other_i) {
+      dominated = distinct[other_i].first != gift.first && (gift.first & ~distinct[other_i].first) == 0;
+    }
+    if (!dominated) {
+      candidate_masks.push_back(gift.first);
+      candidate_gift_ids.push_back(gift.second);
+      largest_gift = std::max(largest_gift, static_cast<unsigned int>(__builtin_popcount(gift.first)));
+    }
+  }
+  result.candidate_gifts = static_cast<unsigned int>(candidate_masks.size());
+
+  // the candidates covering each villager's bit, the inner loop's only list
+  std::vector<std::vector<unsigned int>> candidates_by_bit(result.villagers);
+  for (unsigned int candidate_i = 0; candidate_i < candidate_masks.size(); ++candidate_i) {
+    for (unsigned int bit = 0; bit < result.villagers; ++bit) {
+      if ((candidate_masks[candidate_i] >> bit) & 1) {
+        candidates_by_bit[bit].push_back(candidate_i);
+      }
+    }
+  }
+
+  std::vector<bool> reached(static_cast<size_t>(all_covered) + 1, false);
+  std::vector<CoverState> states;
+  states.push_back(CoverState(0, 0, 0));
+  reached[0] = true;
+  size_t level_begin = 0;
+  size_t found = 0; // the state covering every villager, if one is found with fewer gift types than the given cover
+  bool solved = all_covered == 0;
+  const size_t cover_size = cover_gift_ids.size();
+  for (size_t depth = 1; !solved && depth < cover_size && level_begin < states.size() && states.size() <= max_states; ++depth) {
+    const size_t level_end = states.size();
+    for (size_t state_i = level_begin; state_i < level_end && !solved && states.size() <= max_states; ++state_i) {
+      const unsigned int mask = states[state_i].mask;
+      const unsigned int lowest_uncovered = static_cast<unsigned int>(__builtin_ctz(~mask & all_covered));
+      for (auto candidate_i:candidates_by_bit[lowest_uncovered]) {
+        const unsigned int next = mask | candidate_masks[candidate_i];
+        const unsigned int still_uncovered = static_cast<unsigned int>(__builtin_popcount(~next & all_covered));
+        if (reached[next] || depth + (still_uncovered + largest_gift - 1) / largest_gift >= cover_size) {
+          continue;
+        }
+        reached[next] = true;
+        states.push_back(CoverState(next, static_cast<unsigned int>(state_i), candidate_i));
+        if (next == all_covered) {
+          found = states.size() - 1;
+          solved = true;
+          break;
+        }
+      }
+    }
+    level_begin = level_end;
+  }
+  result.states = states.size();
+
+  // with every level below the given cover's size searched, and within the limit, nothing smaller was missed
+  if (solved) {
+    for (size_t state_i = found; state_i != 0; state_i = states[state_i].from) {
+      result.gift_ids.push_back(candidate_gift_ids[states[state_i].candidate]);
+    }
+    std::reverse(result.gift_ids.begin(), result.gift_ids.end());
+    result.solved = true;
+  }
+  else if (states.size() <= max_states) {
+    result.gift_ids = cover_gift_ids;
+    result.solved = true;
+  }
+
+  result.elapsed_us = static_cast<long>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+  return result;
+}
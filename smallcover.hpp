@@ -0,0 +1,41 @@
+/*
+ * Description: interfaces to solve the fewest gift types exactly when few villagers are left to cover
+ * Documentation: of the technique: https://en.m.wikipedia.org/wiki/Breadth-first_search
+ * Author: Laura Galbraith
+*/
+
+#ifndef SVGSC_SMALL_COVER_H
+#define SVGSC_SMALL_COVER_H
+
+#include <vector> // vector
+
+#include "incidence.hpp" // IncidenceStore
+
+// more villagers than this are left to the greedy picks and the searches around them
+const unsigned int SMALL_COVER_MAX_VILLAGERS = 28;
+// covered-sets the search may reach before giving up, at 12 bytes each
+const unsigned long SMALL_COVER_MAX_STATES = 1ul << 21;
+
+class SmallCoverResult {
+  public:
+    // Constructor
+    SmallCoverResult();
+
+    // Member variables
+    bool solved; // false if too many villagers are left, or the search reached its limit of states first
+    std::vector<unsigned int> gift_ids; // if solved, a fewest gift types covering every villager any gift covers: the search's, in the order it added them, or the given cover if none is smaller
+    unsigned int villagers; // villagers some gift covers, each given a bit
+    unsigned int candidate_gifts; // gifts left once those covering the same villagers as another, or only some of them, are dropped
+    unsigned long states; // covered-sets of villagers reached
+    long elapsed_us;
+};
+
+// Finds a fewest gift types covering every villager any gift covers, for universes of up to SMALL_COVER_MAX_VILLAGERS villagers, given a cover of them such as the greedy picks:
+// each villager is a bit, each gift the mask of its villagers, and each covered-set a mask reached breadth-first, one gift type per level,
+// so the first level to reach every villager has the fewest gift types, and if none does before the given cover's size, the given cover is the fewest
+// from each mask, only gifts covering its lowest uncovered villager are added, since every cover has one; a mask is only kept the first time it is reached,
+// a gift whose villagers another gift covers too is never added, and nor is a mask the largest gift could not finish covering in fewer than the given cover's gift types
+// O(2^villagers) time and bits of memory at most, but usually far less
+SmallCoverResult SolveSmallCover(const IncidenceStore& incidences, const std::vector<unsigned int>& cover_gift_ids, unsigned long max_states);
+
+#endif // SVGSC_SMALL_COVER_H
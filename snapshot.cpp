@@ -0,0 +1,162 @@
+/*
+ * Description: implementations to share loaded gift data between solves, and refresh it without making them wait
+ * Author: Laura Galbraith
+*/
+
+#include "snapshot.hpp" // self-include header
+
+#include <string> // string
+#include <vector> // vector
+#include <memory> // shared_ptr, unique_ptr, make_shared
+#include <atomic> // atomic
+#include <mutex> // mutex, lock_guard, unique_lock
+#include <thread> // thread, yield
+#include <chrono> // milliseconds
+#include <utility> // move
+#include <exception> // exception
+
+#include "valleyfacts.hpp" // GiftsByVillager
+
+DatasetSnapshot::DatasetSnapshot(GiftsByVillager* loaded, unsigned long snapshot_version)
+  : data(std::move(*loaded)), version(snapshot_version)
+{}
+
+SnapshotStore::SnapshotStore(GiftsByVillager* first)
+  : epoch(0),
+    versions_published(1)
+{
+  this->acquiring[0] = 0;
+  this->acquiring[1] = 0;
+  this->current = new std::shared_ptr<const DatasetSnapshot>(std::make_shared<const DatasetSnapshot>(first, 1));
+}
+
+// lock-free: counted under its epoch's parity while it copies, so a publish knows not to free what is being copied
+std::shared_ptr<const DatasetSnapshot> SnapshotStore::Acquire() const {
+  const unsigned long parity = this->epoch.load() & 1;
+  ++this->acquiring[parity];
+  std::shared_ptr<const DatasetSnapshot> snapshot = *this->current.load();
+  --this->acquiring[parity];
+  return snapshot;
+}
+
+// once the new snapshot is in place, every thread that copies from then on gets it, so only those already counted can be copying the old one:
+// moving the epoch on twice and waiting for each parity's count to reach zero sees all of them out, while threads starting meanwhile count under the other parity
+// the store's reference to the old snapshot is dropped last; solves holding it keep it alive
+unsigned long SnapshotStore::Publish(GiftsByVillager* next) {
+  std::lock_guard<std::mutex> lock(this->publish_mutex);
+
+  const unsigned long version = ++this->versions_published;
+  const std::shared_ptr<const DatasetSnapshot>* replaced = this->current.exchange(new std::shared_ptr<const DatasetSnapshot>(std::make_shared<const DatasetSnapshot>(next, version)));
+
+  for (unsigned int flip = 0; flip < 2; ++flip) {
+    const unsigned long parity = this->epoch.fetch_add(1) & 1;
+    while (this->acquiring[parity].load() != 0) {
+      std::this_thread::yield();
+    }
+  }
+
+  delete replaced;
+  return version;
+}
+
+SnapshotStore::~SnapshotStore() {
+  delete this->current.load();
+}
+
+BackgroundRefresher::BackgroundRefresher(SnapshotStore* snapshot_store, const Loader& snapshot_loader, long interval_ms)
+  : store(snapshot_store),
+    loader(snapshot_loader),
+    interval(interval_ms),
+    refresh_requested(false),
+    stopping(false),
+    refreshes(0),
+    publishes(0)
+{
+  this->worker = std::thread(&BackgroundRefresher::Run, this);
+}
+
+void BackgroundRefresher::RefreshNow() {
+  {
+    std::lock_guard<std::mutex> lock(this->state_mutex);
+    this->refresh_requested = true;
+  }
+  this->wake.notify_one();
+}
+
+unsigned long BackgroundRefresher::Refreshes() const {
+  std::lock_guard<std::mutex> lock(this->state_mutex);
+  return this->refreshes;
+}
+
+unsigned long BackgroundRefresher::Publishes() const {
+  std::lock_guard<std::mutex> lock(this->state_mutex);
+  return this->publishes;
+}
+
+std::string BackgroundRefresher::LastError() const {
+  std::lock_guard<std::mutex> lock(this->state_mutex);
+  return this->last_error;
+}
+
+BackgroundRefresher::~BackgroundRefresher() {
+  {
+    std::lock_guard<std::mutex> lock(this->state_mutex);
+    this->stopping = true;
+  }
+  this->wake.notify_one();
+  this->worker.join();
+}
+
+// the load runs without the state lock, so asking how the refresher is doing never waits on the wiki
+void BackgroundRefresher::Run() {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(this->state_mutex);
+      auto woken = [this]() {
+        return this->refresh_requested || this->stopping;
+      };
+      if (this->interval > 0) {
+        this->wake.wait_for(lock, std::chrono::milliseconds(this->interval), woken);
+      }
+      else {
+        this->wake.wait(lock, woken);
+      }
+
+      if (this->stopping) {
+        return;
+      }
+      this->refresh_requested = false;
+    }
+
+    const std::shared_ptr<const DatasetSnapshot> current = this->store->Acquire();
+    std::unique_ptr<GiftsByVillager> next;
+    std::string error;
+    try {
+      next = this->loader(current->data);
+    }
+    catch (const std::exception& e) {
+      error = e.what();
+    }
+
+    if (next) {
+      this->store->Publish(next.get());
+    }
+
+    std::lock_guard<std::mutex> lock(this->state_mutex);
+    ++this->refreshes;
+    this->publishes += next ? 1 : 0;
+    if (error != "") {
+      this->last_error = error;
+    }
+  }
+}
+
+BackgroundRefresher::Loader WikiRefreshLoader(const std::vector<Villager>& to_skip_villagers, const std::vector<Gift>& to_skip_gifts, const WikiLoadOptions& options) {
+  return [to_skip_villagers, to_skip_gifts, options](const GiftsByVillager& current) {
+    std::unique_ptr<GiftsByVillager> next(new GiftsByVillager(to_skip_villagers, to_skip_gifts, options, current.GetDataset()));
+    if (options.source == WikiSource::WIKITEXT && next->GetReadPages().empty()) {
+      next.reset();
+    }
+    return next;
+  };
+}
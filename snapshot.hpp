@@ -0,0 +1,104 @@
+/*
+ * Description: interfaces to share loaded gift data between solves, and refresh it without making them wait
+ * Documentation: of the technique: https://en.m.wikipedia.org/wiki/Read-copy-update
+ * Author: Laura Galbraith
+*/
+
+#ifndef SVGSC_SNAPSHOT_H
+#define SVGSC_SNAPSHOT_H
+
+#include <string> // string
+#include <vector> // vector
+#include <memory> // shared_ptr, unique_ptr
+#include <atomic> // atomic
+#include <mutex> // mutex
+#include <condition_variable> // condition_variable
+#include <thread> // thread
+#include <functional> // function
+
+#include "valleyfacts.hpp" // GiftsByVillager, Gift, Villager, WikiLoadOptions
+
+// One load of the gift data, never changed once published; it lives until the last solve holding it lets go
+class DatasetSnapshot {
+  public:
+    // Constructor; the loaded data is moved in
+    DatasetSnapshot(GiftsByVillager* loaded, unsigned long snapshot_version);
+
+    // Member variables
+    const GiftsByVillager data;
+    const unsigned long version; // 1 for the first snapshot a store publishes, counting up from there
+};
+
+// Holds the latest snapshot for any number of threads: taking it is a handful of atomic operations and never waits on a refresh,
+// and publishing a new one waits only for threads part way through taking the old one, never for solves still using it
+class SnapshotStore {
+  public:
+    // Constructor; the first data is moved in and published as version 1
+    explicit SnapshotStore(GiftsByVillager* first);
+
+    // the latest snapshot; solves keep using it, unchanged, however many are published after
+    std::shared_ptr<const DatasetSnapshot> Acquire() const;
+
+    // moves the data into a new snapshot that every later Acquire returns; returns its version
+    unsigned long Publish(GiftsByVillager* next);
+
+    // Destructor; no thread may still be acquiring, though snapshots already taken stay valid
+    ~SnapshotStore();
+
+  private:
+    // not copyable, since threads hold on to the store itself
+    SnapshotStore(const SnapshotStore& other);
+    SnapshotStore& operator=(const SnapshotStore& other);
+
+    std::atomic<const std::shared_ptr<const DatasetSnapshot>*> current; // replaced whole, so a reader copies one shared_ptr that nothing writes to
+    mutable std::atomic<unsigned long> acquiring[2]; // threads copying the current shared_ptr, by the parity of the epoch they started in
+    std::atomic<unsigned long> epoch; // moved on by each publish, so threads starting after it are counted apart from those it waits for
+    std::mutex publish_mutex; // publishers take turns; Acquire never touches it
+    unsigned long versions_published;
+};
+
+// Builds the next snapshot on its own thread, every interval and whenever asked, and publishes it if the data changed
+// the loader is given the current data and returns the next, or nothing if it has not changed; an exception it throws keeps the current snapshot
+class BackgroundRefresher {
+  public:
+    typedef std::function<std::unique_ptr<GiftsByVillager>(const GiftsByVillager& current)> Loader;
+
+    // Constructor; starts the thread, which first refreshes after the interval (or never by itself, if it is 0)
+    BackgroundRefresher(SnapshotStore* snapshot_store, const Loader& snapshot_loader, long interval_ms);
+
+    // wakes the thread to refresh now, without waiting for it
+    void RefreshNow();
+
+    unsigned long Refreshes() const; // loads finished, whether or not they changed anything
+    unsigned long Publishes() const;
+    std::string LastError() const; // from the latest load to fail; empty if none has
+
+    // Destructor; stops the thread, after any load underway
+    ~BackgroundRefresher();
+
+  private:
+    // not copyable, since the thread holds on to the refresher
+    BackgroundRefresher(const BackgroundRefresher& other);
+    BackgroundRefresher& operator=(const BackgroundRefresher& other);
+
+    void Run();
+
+    SnapshotStore* store;
+    Loader loader;
+    long interval;
+
+    mutable std::mutex state_mutex;
+    std::condition_variable wake;
+    bool refresh_requested;
+    bool stopping;
+    unsigned long refreshes;
+    unsigned long publishes;
+    std::string last_error;
+    std::thread worker;
+};
+
+// a loader that reloads with the given options; with WikiSource::WIKITEXT it refreshes the way a stored dataset is, one request for the latest revisions
+// and then only the pages that changed, and gives nothing when no page changed, so only real changes are published; other sources are read again whole, and always published
+BackgroundRefresher::Loader WikiRefreshLoader(const std::vector<Villager>& to_skip_villagers, const std::vector<Gift>& to_skip_gifts, const WikiLoadOptions& options);
+
+#endif // SVGSC_SNAPSHOT_H
@@ -0,0 +1,156 @@
+/*
+ * Description: implementations to answer many gift queries in-process against data loaded once
+ * Author: Laura Galbraith
+*/
+
+#include "solver.hpp" // self-include header
+
+#include <string> // string, to_string
+#include <vector> // vector
+#include <algorithm> // sort
+
+#include "valleyfacts.hpp" // GiftsByVillager
+#include "incidence.hpp" // IncidenceStore
+#include "greedy.hpp" // GreedyCoverFrom, GreedyCoverNextTier, GreedyScratch
+#include "localsearch.hpp" // ImproveCover, LocalSearchResult
+#include "output.hpp" // GiftSolution
+
+IDSpan::IDSpan()
+  : ids(NULL), count(0)
+{}
+
+IDSpan::IDSpan(const unsigned int* first_id, size_t id_count)
+  : ids(first_id), count(id_count)
+{}
+
+IDSpan::IDSpan(const std::vector<unsigned int>& id_list)
+  : ids(id_list.data()), count(id_list.size())
+{}
+
+const unsigned int* IDSpan::begin() const {
+  return this->ids;
+}
+
+const unsigned int* IDSpan::end() const {
+  return this->ids + this->count;
+}
+
+SolverQuery::SolverQuery()
+  : liked_tier(false), local_search_budget_us(-1)
+{}
+
+SolverContext::SolverContext()
+  : greedy_gift_count(0)
+{}
+
+std::string SolverContext::Solve(const GiftsByVillager& data, const SolverQuery& query) {
+  const std::string query_error = this->Prepare(data, query);
+  if (query_error != "") {
+    return query_error;
+  }
+
+  const std::vector<unsigned int>& loved_candidate_gift_ids = query.only_gift_ids.count > 0 ? this->only_candidate_gift_ids : this->candidate_gift_ids;
+  this->SolveTiers(data, query.liked_tier, loved_candidate_gift_ids);
+  this->greedy_gift_count = this->loved_solution.GiftCount();
+
+  // solving again over only the improved gifts lists them in the usual order, each villager under one gift, and leaves the same villagers uncovered
+  this->local_search = LocalSearchResult();
+  if (query.local_search_budget_us >= 0) {
+    this->local_search = ImproveCover(data.GetIncidences(), this->loved_solution.gift_ids, query.local_search_budget_us, &this->loved_excluded_flags, &this->skipped_villager_flags);
+    if (this->local_search.gift_ids.size() < this->greedy_gift_count) {
+      this->SolveTiers(data, query.liked_tier, this->local_search.gift_ids);
+    }
+  }
+
+  return "";
+}
+
+const GiftSolution& SolverContext::LovedSolution() const {
+  return this->loved_solution;
+}
+
+const GiftSolution& SolverContext::LikedSolution() const {
+  return this->liked_solution;
+}
+
+const LocalSearchResult& SolverContext::LocalSearch() const {
+  return this->local_search;
+}
+
+size_t SolverContext::GreedyGiftCount() const {
+  return this->greedy_gift_count;
+}
+
+// checks every ID is in the data, and turns the spans into flags and candidate lists, in memory kept from the last query
+// O(number of gifts + number of villagers + query IDs)
+std::string SolverContext::Prepare(const GiftsByVillager& data, const SolverQuery& query) {
+  const IncidenceStore& incidences = data.GetIncidences();
+  const size_t gift_count = incidences.GiftCount();
+  const size_t villager_count = incidences.VillagerCount();
+
+  if (query.liked_tier && (data.GetLikedIncidences().GiftCount() != gift_count || data.GetLikedIncidences().VillagerCount() != villager_count)) {
+    return "the data was loaded without liked gifts";
+  }
+  for (auto v:query.skip_villager_ids) {
+    if (v >= villager_count) {
+      return "villager ID " + std::to_string(v) + " is not in the data, which has " + std::to_string(villager_count) + " villagers";
+    }
+  }
+  for (const IDSpan* gift_span:{&query.missing_gift_ids, &query.only_gift_ids}) {
+    for (auto g:*gift_span) {
+      if (g >= gift_count) {
+        return "gift ID " + std::to_string(g) + " is not in the data, which has " + std::to_string(gift_count) + " gifts";
+      }
+    }
+  }
+
+  this->skipped_villager_flags.assign(villager_count, false);
+  for (auto v:query.skip_villager_ids) {
+    this->skipped_villager_flags[v] = true;
+  }
+
+  this->missing_gift_flags.assign(gift_count, false);
+  for (auto g:query.missing_gift_ids) {
+    this->missing_gift_flags[g] = true;
+  }
+  this->candidate_gift_ids.resize(0);
+  for (unsigned int gift_id = 0; gift_id < gift_count; ++gift_id) {
+    if (!this->missing_gift_flags[gift_id]) {
+      this->candidate_gift_ids.push_back(gift_id);
+    }
+  }
+
+  // the local search may only swap in gifts the greedy could have picked
+  this->loved_excluded_flags = this->missing_gift_flags;
+  this->only_candidate_gift_ids.resize(0);
+  if (query.only_gift_ids.count > 0) {
+    this->loved_excluded_flags.assign(gift_count, true);
+    for (auto g:query.only_gift_ids) {
+      if (!this->missing_gift_flags[g] && this->loved_excluded_flags[g]) {
+        this->loved_excluded_flags[g] = false;
+        this->only_candidate_gift_ids.push_back(g);
+      }
+    }
+  }
+
+  return "";
+}
+
+// O(number of incidences * log(number of gifts)) for each tier
+void SolverContext::SolveTiers(const GiftsByVillager& data, bool liked_tier, const std::vector<unsigned int>& loved_candidate_gift_ids) {
+  this->loved_solution.Clear();
+  this->liked_solution.Clear();
+  this->scratch.covered = this->skipped_villager_flags;
+  GreedyCoverFrom(data.GetIncidences(), &loved_candidate_gift_ids, &this->scratch, &this->loved_solution);
+  if (!liked_tier) {
+    return;
+  }
+
+  // the same queue carries on into the liked tier, the loved gifts already picked first, since giving them as liked gifts too costs no more gift types
+  GreedyCoverNextTier(data.GetLikedIncidences(), this->loved_solution.gift_ids, &this->candidate_gift_ids, &this->scratch, &this->liked_solution);
+
+  std::vector<unsigned int>& without_loved = this->loved_solution.uncovered_villager_ids;
+  without_loved.assign(this->liked_solution.villager_ids.begin(), this->liked_solution.villager_ids.end());
+  without_loved.insert(without_loved.end(), this->liked_solution.uncovered_villager_ids.begin(), this->liked_solution.uncovered_villager_ids.end());
+  std::sort(without_loved.begin(), without_loved.end());
+}
@@ -0,0 +1,83 @@
+/*
+ * Description: interfaces to answer many gift queries in-process against data loaded once
+ * Author: Laura Galbraith
+*/
+
+#ifndef SVGSC_SOLVER_H
+#define SVGSC_SOLVER_H
+
+#include <string> // string
+#include <vector> // vector
+#include <cstddef> // size_t
+
+#include "valleyfacts.hpp" // GiftsByVillager
+#include "greedy.hpp" // GreedyScratch
+#include "localsearch.hpp" // LocalSearchResult
+#include "output.hpp" // GiftSolution
+
+// A run of gift or villager IDs in memory the caller owns, read in place
+class IDSpan {
+  public:
+    // Constructors
+    IDSpan();
+    IDSpan(const unsigned int* first_id, size_t id_count);
+    explicit IDSpan(const std::vector<unsigned int>& id_list); // the vector must outlive the span, unchanged
+
+    const unsigned int* begin() const;
+    const unsigned int* end() const;
+
+    // Member variables
+    const unsigned int* ids;
+    size_t count;
+};
+
+// What to solve for, in the IDs of the data's incidence store; the spans are only read during SolverContext::Solve
+class SolverQuery {
+  public:
+    // Constructor; every villager and gift, loved gifts only, no local search
+    SolverQuery();
+
+    // Member variables
+    IDSpan skip_villager_ids; // solved as if these villagers were not there: they are neither given a gift nor listed as uncovered
+    IDSpan missing_gift_ids; // never picked, in either tier
+    IDSpan only_gift_ids; // if not empty, loved gifts are picked only from these, such as a smaller cover another search found; the liked tier still draws on every gift not missing
+    bool liked_tier; // give the villagers no loved gift reaches a liked gift; the data must have been loaded with WikiLoadOptions::liked_gifts
+    long local_search_budget_us; // improve the loved gifts with ImproveCover for up to this long, then solve again over the improved gifts; negative for none
+};
+
+// Solves queries one after another, keeping its working memory and results between them, so once it has grown to fit the data a greedy solve allocates nothing
+// the data can differ from one solve to the next; a context is used by one thread at a time, and many contexts can share one loaded dataset
+// the picks are GreedyCover's, which with IDs in name order are the bucket queue's; a liked tier first gives the villagers no loved gift reaches a liked gift
+// from the loved gifts already picked, which costs no more gift types, then picks greedily among the rest
+class SolverContext {
+  public:
+    // Constructor
+    SolverContext();
+
+    // solves the query on the data, replacing the last results; returns an error, or empty if successful
+    std::string Solve(const GiftsByVillager& data, const SolverQuery& query);
+
+    // the last results, in the IDs of the data's incidence store; valid until the next Solve
+    // with a liked tier, the loved solution's uncovered villagers are those given a liked gift and those given neither, and the liked solution's are those given neither
+    const GiftSolution& LovedSolution() const;
+    const GiftSolution& LikedSolution() const;
+    const LocalSearchResult& LocalSearch() const; // how the local search improved the loved gifts, if the query asked for one
+    size_t GreedyGiftCount() const; // loved gift types the greedy picked, before any local search
+
+  private:
+    std::string Prepare(const GiftsByVillager& data, const SolverQuery& query);
+    void SolveTiers(const GiftsByVillager& data, bool liked_tier, const std::vector<unsigned int>& loved_candidate_gift_ids);
+
+    std::vector<bool> skipped_villager_flags;
+    std::vector<bool> missing_gift_flags;
+    std::vector<bool> loved_excluded_flags; // gifts the loved tier may not pick: the missing ones, and with only gifts, every other one
+    std::vector<unsigned int> candidate_gift_ids; // every gift not missing
+    std::vector<unsigned int> only_candidate_gift_ids; // the query's only gifts not missing
+    GreedyScratch scratch;
+    GiftSolution loved_solution;
+    GiftSolution liked_solution;
+    LocalSearchResult local_search;
+    size_t greedy_gift_count;
+};
+
+#endif // SVGSC_SOLVER_H
@@ -0,0 +1,77 @@
+/*
+ * Description: C interface to load the gift data once and answer many gift queries in-process, for programs not written in C++
+ * Author: Laura Galbraith
+*/
+
+#ifndef SVGSC_C_API_H
+#define SVGSC_C_API_H
+
+#include <stddef.h> /* size_t */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* loaded gift data: read-only once loaded, so any number of contexts on any threads can solve against it */
+typedef struct svgsc_dataset svgsc_dataset;
+
+/* one thread's solver, keeping its memory and results between queries */
+typedef struct svgsc_context svgsc_context;
+
+/* a run of gift or villager IDs, read in place: the caller's memory in a query, the context's in a result */
+typedef struct svgsc_span {
+  const unsigned int* ids;
+  size_t count;
+} svgsc_span;
+
+/* what to solve for; see SolverQuery in solver.hpp */
+typedef struct svgsc_query {
+  svgsc_span skip_villager_ids; /* solved as if these villagers were not there */
+  svgsc_span missing_gift_ids; /* never picked */
+  int liked_tier; /* nonzero to give the villagers no loved gift reaches a liked gift; the data must be loaded with liked gifts */
+  long local_search_budget_us; /* negative for no local search */
+} svgsc_query;
+
+#define SVGSC_NOT_FOUND 0xFFFFFFFFu
+#define SVGSC_LOVED 0
+#define SVGSC_LIKED 1
+
+/* every villager and gift, loved gifts only, no local search */
+void svgsc_query_init(svgsc_query* query);
+
+/* each loader returns NULL if it fails, and writes why to error, cut to error_size bytes with the terminating NUL; error may be NULL */
+/* a file stored with --dataset, as-is, without checking the wiki for changes */
+svgsc_dataset* svgsc_dataset_load_stored(const char* dataset_path, int liked_gifts, char* error, size_t error_size);
+/* the wiki, through its API; a NULL api_url uses the Stardew Valley wiki's */
+svgsc_dataset* svgsc_dataset_load_wiki(const char* api_url, int liked_gifts, char* error, size_t error_size);
+/* the dataset compiled into the library with 'make embedded'; it has no liked gifts */
+svgsc_dataset* svgsc_dataset_load_embedded(char* error, size_t error_size);
+/* a set-cover instance file, its sets standing in for gifts and its elements for villagers */
+svgsc_dataset* svgsc_dataset_load_instance(const char* instance_path, char* error, size_t error_size);
+void svgsc_dataset_free(svgsc_dataset* dataset);
+
+/* IDs run from 0 to the count less 1, in name order; names stay valid as long as the dataset */
+unsigned int svgsc_gift_count(const svgsc_dataset* dataset);
+unsigned int svgsc_villager_count(const svgsc_dataset* dataset);
+unsigned int svgsc_gift_id(const svgsc_dataset* dataset, const char* gift_name); /* SVGSC_NOT_FOUND if not in the data */
+unsigned int svgsc_villager_id(const svgsc_dataset* dataset, const char* villager_name); /* SVGSC_NOT_FOUND if not in the data */
+const char* svgsc_gift_name(const svgsc_dataset* dataset, unsigned int gift_id); /* NULL if not in the data */
+const char* svgsc_villager_name(const svgsc_dataset* dataset, unsigned int villager_id); /* NULL if not in the data */
+
+svgsc_context* svgsc_context_create(void);
+void svgsc_context_free(svgsc_context* context);
+
+/* returns 0, or -1 with the reason in svgsc_context_error; the results replace the last solve's */
+int svgsc_solve(svgsc_context* context, const svgsc_dataset* dataset, const svgsc_query* query);
+const char* svgsc_context_error(const svgsc_context* context);
+
+/* results of the last successful solve, for SVGSC_LOVED or SVGSC_LIKED; valid until the next solve with the context */
+svgsc_span svgsc_result_gifts(const svgsc_context* context, int tier); /* in the order picked */
+svgsc_span svgsc_result_villagers(const svgsc_context* context, int tier, size_t gift_i); /* given the gift_i'th gift */
+svgsc_span svgsc_result_uncovered(const svgsc_context* context, int tier); /* loved: without a loved gift; liked: without either */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SVGSC_C_API_H */
@@ -0,0 +1,184 @@
+/*
+ * Description: implementations to see how the gift cover changes without each gift or villager
+ * Author: Laura Galbraith
+*/
+
+#include "sweep.hpp" // self-include header
+
+#include <vector> // vector
+#include <thread> // thread, hardware_concurrency
+#include <atomic> // atomic
+#include <algorithm> // stable_sort
+
+#include "incidence.hpp" // IncidenceStore
+#include "localsearch.hpp" // ImproveCover
+
+SweepVariant::SweepVariant()
+  : gift_types(0), uncovered_villagers(0)
+{}
+
+GreedyWorkspace::GreedyWorkspace(const IncidenceStore& store, long budget_us)
+  : incidences(store),
+    solve_stamp(0),
+    gift_stamps(store.GiftCount(), 0),
+    villager_stamps(store.VillagerCount(), 0),
+    gains(store.GiftCount(), 0),
+    local_search_budget_us(budget_us),
+    removed_gift_flags(store.GiftCount(), false),
+    skipped_villager_flags(store.VillagerCount(), false)
+{}
+
+void GreedyWorkspace::Solve(SweepVariant* variant, unsigned int base_gift_types) {
+  ++this->solve_stamp;
+  for (auto g:variant->removed_gifts) {
+    this->gift_stamps[g] = this->solve_stamp;
+  }
+  unsigned int villagers_left = static_cast<unsigned int>(this->incidences.VillagerCount());
+  for (auto v:variant->skipped_villagers) {
+    if (this->villager_stamps[v] != this->solve_stamp) {
+      this->villager_stamps[v] = this->solve_stamp;
+      --villagers_left;
+    }
+  }
+
+  const unsigned int gift_count = static_cast<unsigned int>(this->incidences.GiftCount());
+  for (unsigned int gift_id = 0; gift_id < gift_count; ++gift_id) {
+    this->gains[gift_id] = 0;
+    if (this->gift_stamps[gift_id] == this->solve_stamp) {
+      continue;
+    }
+
+    for (const unsigned int* v_it = this->incidences.GiftVillagersBegin(gift_id); v_it != this->incidences.GiftVillagersEnd(gift_id); ++v_it) {
+      if (this->villager_stamps[*v_it] != this->solve_stamp) {
+        ++this->gains[gift_id];
+      }
+    }
+  }
+
+  variant->gift_types = 0;
+  this->picked.resize(0);
+  while (villagers_left > 0) {
+    // the first gift with the highest gain wins ties, as the bucket queue's ordering does
+    unsigned int best_gift = 0;
+    unsigned int best_gain = 0;
+    for (unsigned int gift_id = 0; gift_id < gift_count; ++gift_id) {
+      if (this->gains[gift_id] > best_gain) {
+        best_gift = gift_id;
+        best_gain = this->gains[gift_id];
+      }
+    }
+
+    if (best_gain <= 0) {
+      break;
+    }
+    ++variant->gift_types;
+    this->picked.push_back(best_gift);
+
+    // cover the gift's villagers, so no other gift counts them again
+    for (const unsigned int* v_it = this->incidences.GiftVillagersBegin(best_gift); v_it != this->incidences.GiftVillagersEnd(best_gift); ++v_it) {
+      if (this->villager_stamps[*v_it] == this->solve_stamp) {
+        continue;
+      }
+      this->villager_stamps[*v_it] = this->solve_stamp;
+      --villagers_left;
+
+      for (const unsigned int* g_it = this->incidences.VillagerGiftsBegin(*v_it); g_it != this->incidences.VillagerGiftsEnd(*v_it); ++g_it) {
+        if (this->gift_stamps[*g_it] != this->solve_stamp) {
+          --this->gains[*g_it];
+        }
+      }
+    }
+  }
+
+  variant->uncovered_villagers = villagers_left;
+  if (this->local_search_budget_us < 0 || variant->gift_types <= base_gift_types) {
+    return;
+  }
+
+  // the local search never uncovers anyone, so only the gift types can change
+  for (auto g:variant->removed_gifts) {
+    this->removed_gift_flags[g] = true;
+  }
+  for (auto v:variant->skipped_villagers) {
+    this->skipped_villager_flags[v] = true;
+  }
+  variant->gift_types = static_cast<unsigned int>(ImproveCover(this->incidences, this->picked, this->local_search_budget_us, &this->removed_gift_flags, &this->skipped_villager_flags).gift_ids.size());
+  for (auto g:variant->removed_gifts) {
+    this->removed_gift_flags[g] = false;
+  }
+  for (auto v:variant->skipped_villagers) {
+    this->skipped_villager_flags[v] = false;
+  }
+}
+
+// each thread takes the next unsolved variant until none are left, so uneven solve times still keep every core busy
+void SolveVariants(const IncidenceStore* incidences, long local_search_budget_us, unsigned int base_gift_types, std::vector<SweepVariant>* variants, std::atomic<size_t>* next_variant) {
+  GreedyWorkspace workspace = GreedyWorkspace(*incidences, local_search_budget_us);
+  for (size_t variant_i = (*next_variant)++; variant_i < variants->size(); variant_i = (*next_variant)++) {
+    workspace.Solve(&(*variants)[variant_i], base_gift_types);
+  }
+}
+
+// how far a variant strays from the base: villagers left without a gift matter most, then the gift types added
+// taking something away never lets a cover shrink, so a variant needing fewer gift types than the base only shows the heuristics missing a smaller cover, and ranks last
+bool MoreAffected(const SweepVariant& a, const SweepVariant& b) {
+  if (a.uncovered_villagers != b.uncovered_villagers) {
+    return a.uncovered_villagers > b.uncovered_villagers;
+  }
+  return a.gift_types > b.gift_types;
+}
+
+SweepResult RunSweep(const IncidenceStore& incidences, bool include_pairs, unsigned int thread_count, long local_search_budget_us) {
+  SweepResult result;
+  GreedyWorkspace base_workspace = GreedyWorkspace(incidences, local_search_budget_us);
+  base_workspace.Solve(&result.base, 0);
+
+  // every gift, then every villager, then (if asked) every pair of them
+  const unsigned int gift_count = static_cast<unsigned int>(incidences.GiftCount());
+  const unsigned int item_count = gift_count + static_cast<unsigned int>(incidences.VillagerCount());
+  for (unsigned int item_i = 0; item_i < item_count; ++item_i) {
+    SweepVariant variant;
+    if (item_i < gift_count) {
+      variant.removed_gifts.push_back(item_i);
+    }
+    else {
+      variant.skipped_villagers.push_back(item_i - gift_count);
+    }
+    result.variants.push_back(variant);
+  }
+
+  if (include_pairs) {
+    const size_t single_count = result.variants.size();
+    for (size_t first_i = 0; first_i < single_count; ++first_i) {
+      for (size_t second_i = first_i+1; second_i < single_count; ++second_i) {
+        SweepVariant variant = result.variants[first_i];
+        const SweepVariant& second = result.variants[second_i];
+        variant.removed_gifts.insert(variant.removed_gifts.end(), second.removed_gifts.begin(), second.removed_gifts.end());
+        variant.skipped_villagers.insert(variant.skipped_villagers.end(), second.skipped_villagers.begin(), second.skipped_villagers.end());
+        result.variants.push_back(variant);
+      }
+    }
+  }
+
+  if (thread_count <= 0) {
+    thread_count = std::thread::hardware_concurrency();
+  }
+  if (thread_count <= 0) {
+    thread_count = 1;
+  }
+
+  // the calling thread works too
+  std::atomic<size_t> next_variant(0);
+  std::vector<std::thread> threads;
+  for (unsigned int thread_i = 1; thread_i < thread_count; ++thread_i) {
+    threads.push_back(std::thread(SolveVariants, &incidences, local_search_budget_us, result.base.gift_types, &result.variants, &next_variant));
+  }
+  SolveVariants(&incidences, local_search_budget_us, result.base.gift_types, &result.variants, &next_variant);
+  for (auto& t:threads) {
+    t.join();
+  }
+
+  std::stable_sort(result.variants.begin(), result.variants.end(), MoreAffected);
+
+  return result;
+}
@@ -0,0 +1,64 @@
+/*
+ * Description: interfaces to see how the gift cover changes without each gift or villager
+ * Author: Laura Galbraith
+*/
+
+#ifndef SVGSC_SWEEP_H
+#define SVGSC_SWEEP_H
+
+#include <vector> // vector
+
+#include "incidence.hpp" // IncidenceStore
+
+// One what-if: the loaded data, less some gifts and villagers
+class SweepVariant {
+  public:
+    // Constructor; the loaded data as-is
+    SweepVariant();
+
+    // Member variables
+    std::vector<unsigned int> removed_gifts; // gift IDs no longer available
+    std::vector<unsigned int> skipped_villagers; // villager IDs no longer needing a gift
+    unsigned int gift_types; // filled in by solving: how many gift types the cover needs, after the same local search as the solution printed where that could matter
+    unsigned int uncovered_villagers; // filled in by solving: villagers no remaining gift is loved by
+};
+
+class SweepResult {
+  public:
+    // Member variables
+    SweepVariant base; // nothing removed
+    std::vector<SweepVariant> variants; // ranked: most villagers left uncovered first, then most gift types added, then gifts before villagers in ID order
+};
+
+// Greedy set-cover over the incidence store, the same as the bucket queue solve: the gift loved by the most uncovered villagers goes first,
+// and ties go to the lowest gift ID, which is the first gift name
+// then, with a local search budget, ImproveCover over the picks, never swapping in a removed gift nor keeping a skipped villager covered, as the solution printed is improved
+// the search only ever lowers a count, so it is skipped when the greedy already needs no more gift types than the base
+// the greedy's scratch arrays are kept between solves, so without local search one workspace solves any number of variants without allocating
+class GreedyWorkspace {
+  public:
+    // Constructor; the store must outlive the workspace; a negative local search budget leaves the greedy picks as they are
+    GreedyWorkspace(const IncidenceStore& store, long local_search_budget_us);
+
+    // fills in the variant's gift_types and uncovered_villagers, searching locally only if the greedy needs more than base_gift_types
+    // O(gift types picked * number of gifts + number of incidences), plus the local search
+    void Solve(SweepVariant* variant, unsigned int base_gift_types);
+
+  private:
+    const IncidenceStore& incidences;
+    unsigned int solve_stamp; // a gift or villager stamped with the current solve's value is out of play
+    std::vector<unsigned int> gift_stamps;
+    std::vector<unsigned int> villager_stamps;
+    std::vector<unsigned int> gains; // uncovered villagers each gift is loved by
+    long local_search_budget_us;
+    std::vector<unsigned int> picked; // the greedy picks of the current solve
+    std::vector<bool> removed_gift_flags; // the current variant's, for the local search
+    std::vector<bool> skipped_villager_flags;
+};
+
+// solves every variant without one gift or one villager (and, if asked, without any two of them), sharing the store read-only between threads
+// the base and every variant get the same local search, each with the budget given, or none if it is negative, so they count gift types the same way
+// a thread_count of 0 uses every core
+SweepResult RunSweep(const IncidenceStore& incidences, bool include_pairs, unsigned int thread_count, long local_search_budget_us);
+
+#endif // SVGSC_SWEEP_H
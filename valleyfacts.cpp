@@ -9,31 +9,51 @@
 #include <string> // string
 #include <vector> // vector
 #include <map> // map
+#include <unordered_map> // unordered_map
+#include <tuple> // pair
+#include <algorithm> // sort, unique
 #include <sstream> // stringstream
 #include <stdexcept> // runtime_error
-
-#include "curl.hpp" // Curl, CurlResult
-#include "xmlparse.hpp" // GetPrecededAndNestedData, XMLParseResult
+#include <utility> // move
+#include <memory> // unique_ptr
+
+#include "curl.hpp" // Curl, CurlResult, CurlPipeline
+#include "xmlparse.hpp" // GetPrecededAndNestedData, XMLParseResult, XMLParseBackend, XMLItemCallback
+#include "extractcache.hpp" // ExtractionCache
+#include "wikitext.hpp" // WikiPage, WikiPagesResult, WikiPagesURL, ParseWikiPagesResponse, GetSectionNames, GetTemplateParameterNames, WIKI_API_MAX_TITLES
+#include "dataset.hpp" // WikiDataset, VillagerPageData
+#include "nametable.hpp" // NameTable
+#include "incidence.hpp" // IncidenceStore
+#include "instance.hpp" // SetCoverInstance
+#include "perfcounters.hpp" // SVGSC_PERF_REGION
 
 GiftForVillagers::GiftForVillagers() {
   this->gift = "";
 }
 
-GiftForVillagers::GiftForVillagers(const Gift& g, const std::vector<Villager>& vs)
-  : gift(g)
+GiftForVillagers::GiftForVillagers(Arena* arena)
+  : gift(""),
+    villagers(ArenaAllocator<std::pair<const Villager, bool>>(arena))
+{
+}
+
+GiftForVillagers::GiftForVillagers(const Gift& g, const std::vector<Villager>& vs, Arena* arena)
+  : gift(g),
+    villagers(ArenaAllocator<std::pair<const Villager, bool>>(arena))
 {
   for (auto v:vs) {
     this->villagers[v] = true; // the 'true' value does not affect the algorithm
   }
 }
 
-GiftForVillagers::GiftForVillagers(const GiftForVillagers& other) {
-  this->copy(other);
+GiftForVillagers::GiftForVillagers(const GiftForVillagers& other)
+  : gift(other.gift),
+    villagers(other.villagers)
+{
 }
 
 GiftForVillagers& GiftForVillagers::operator=(const GiftForVillagers& other) {
   if (&other != this) {
-    this->clear();
     this->copy(other);
   }
   return *this;
@@ -75,7 +95,7 @@ unsigned int GiftForVillagers::Size() const {
 // "elements" for this class are villagers
 // O(number of elements of 'other')
 void GiftForVillagers::AddElements(const GiftForVillagers& other) {
-  for (auto v:other.villagers) {
+  for (const auto& v:other.villagers) {
     this->villagers[v.first] = true; // the 'true' value does not affect the algorithm
   }
 }
@@ -83,10 +103,12 @@ void GiftForVillagers::AddElements(const GiftForVillagers& other) {
 // "elements" for this class are villagers
 // O(number of elements of 'other')
 size_t GiftForVillagers::RemoveElements(const GiftForVillagers& other) {
+  SVGSC_PERF_REGION("gift set remove");
   size_t villagers_removed = 0;
-  for (auto v:other.villagers) {
-    if (this->villagers.find(v.first) != this->villagers.end()) {
-      this->villagers.erase(v.first);
+  for (const auto& v:other.villagers) {
+    VillagerMap::iterator found = this->villagers.find(v.first);
+    if (found != this->villagers.end()) {
+      this->villagers.erase(found);
       ++villagers_removed;
     }
   }
@@ -111,6 +133,17 @@ const std::vector<Villager> GiftForVillagers::GetVillagers() const {
   return ret;
 }
 
+// villagers are in name order, the same as GetVillagers; villagers not in the table are left out
+// O(number of villagers), on average
+void GiftForVillagers::AddVillagerIDs(const NameTable& villager_names, std::vector<unsigned int>* ids) const {
+  for (const auto& v:this->villagers) {
+    const unsigned int id = villager_names.Find(v.first);
+    if (id != NameTable::NOT_FOUND) {
+      ids->push_back(id);
+    }
+  }
+}
+
 GiftForVillagers::~GiftForVillagers() {
   this->clear();
 }
@@ -119,10 +152,8 @@ void GiftForVillagers::copy(const GiftForVillagers& other) {
   // copy gift
   this->gift = other.gift;
 
-  // copy villagers
-  for (auto v:other.villagers) {
-    this->villagers[v.first] = v.second;
-  }
+  // copy villagers, keeping this set's storage and reusing its nodes
+  this->villagers = other.villagers;
 }
 
 void GiftForVillagers::clear() {
@@ -157,232 +188,694 @@ std::ostream& operator<<(std::ostream& os, const GiftForVillagers& x) {
 }
 
 // Constants for wiki usage
-const std::string GiftsByVillager::VILLAGERS_URL = "https://stardewvalleywiki.com/Villagers";
+const std::string WikiLoadOptions::DEFAULT_PAGE_URL = "https://stardewvalleywiki.com/";
 // though there is also a containing div tag, the code cannot currently distinguish between other div tags starting/ending inside of li
 const std::vector<std::string> GiftsByVillager::VILLAGERS_CONTAINING_ELEMENTS = {"ul", "li", "p", "a"};
 
-const std::string GiftsByVillager::VILLAGER_URL_PREFIX = "https://stardewvalleywiki.com/";
 // this is the format of loved gifts on a Villager's page: <td>Best Gifts: OTHER TEXT</td> ... <td> ... <span>...<a>Spaghetti</a>...</span>...<span>...<a>Peach</a>...</span> ... </td>
 const std::vector<std::string> GiftsByVillager::VILLAGER_GIFTS_CONTAINING_ELEMENTS = {"td", "span", "a"};
-
-const std::string GiftsByVillager::FRIENDSHIP_URL = "https://stardewvalleywiki.com/Friendship";
+// liked gifts are only listed further down, in the table after the <h3>Like</h3> heading of the Gifts section: <table> ... <tr> ... <td><a>Apple</a></td> ...
+const std::vector<std::string> GiftsByVillager::VILLAGER_LIKED_GIFTS_CONTAINING_ELEMENTS = {"table", "tr", "td", "a"};
+
+// Constants for wiki API usage
+const std::string WikiLoadOptions::DEFAULT_API_URL = "https://stardewvalleywiki.com/mediawiki/api.php";
+// enough to keep the villager pages downloading while each is parsed, without crowding the wiki
+const unsigned int WikiLoadOptions::DEFAULT_FETCH_WINDOW = 4;
+const std::string GiftsByVillager::VILLAGERS_PAGE_TITLE = "Villagers";
+const std::string GiftsByVillager::FRIENDSHIP_PAGE_TITLE = "Friendship";
+// the "Best Gifts" row of a villager's page comes from this parameter of the infobox: {{Infobox villager |favor = {{name|Amethyst}} • {{name|Banana}} ...}}
+const std::string GiftsByVillager::VILLAGER_INFOBOX_TEMPLATE = "Infobox villager";
+const std::string GiftsByVillager::VILLAGER_GIFTS_PARAMETER = "favor";
+// liked gifts have no infobox parameter, only the ===Like=== section of the villager's page
+const std::string GiftsByVillager::VILLAGER_LIKES_SECTION = "Like";
+
+WikiLoadOptions::WikiLoadOptions()
+  : source(WikiSource::RENDERED_HTML), html_parser(XMLParseBackend::LIBXML2), extraction_cache(NULL), api_url(WikiLoadOptions::DEFAULT_API_URL), page_url(WikiLoadOptions::DEFAULT_PAGE_URL), fetch_window(WikiLoadOptions::DEFAULT_FETCH_WINDOW), liked_gifts(false), failed_url_outcomes(NULL)
+{}
 
 // Populate gift/villager relationships from the Stardew Valley wiki
-GiftsByVillager::GiftsByVillager(const std::vector<Villager>& to_skip_villagers, const std::vector<Gift>& to_skip_gifts) {
-  // Initiate connection to the SV wiki
-  this->curl_interface = new Curl();
-
-  // Initialize internal storage of the parameters
-  // (the bool value in the maps will represent whether they have been seen from the wiki or not)
-  for (auto v:to_skip_villagers) {
-    this->villagers_to_skip[v] = false;
-  }
+GiftsByVillager::GiftsByVillager(const std::vector<Villager>& to_skip_villagers, const std::vector<Gift>& to_skip_gifts, const WikiLoadOptions& options, const WikiDataset& stored_dataset)
+  : load_options(options)
+{
+  // Initiate connection to the SV wiki; owned here, so it is freed however the load ends, even by a failed fetch throwing
+  std::unique_ptr<Curl> curl(new Curl());
+  this->curl_interface = curl.get();
+  this->curl_interface->SetRequestPolicy(this->load_options.request_policy);
+
+  this->SetSkipLists(to_skip_villagers, to_skip_gifts);
+
+  // Combine Villager/Gift data; liked gifts come from the same pages as the loved ones
+  std::unordered_map<Gift, std::vector<Villager>> universally_loved_gifts_exceptions;
+  std::unordered_map<Gift, std::vector<Villager>> universally_liked_gifts_exceptions;
+  std::unordered_map<Gift, std::vector<Villager>>* liked_exceptions = this->load_options.liked_gifts ? &universally_liked_gifts_exceptions : NULL;
+  std::unique_ptr<CurlPipeline> page_fetches; // only for the rendered pages
+  try {
+    if (this->load_options.source == WikiSource::STORED_DATASET) {
+      this->dataset = stored_dataset;
+      universally_loved_gifts_exceptions = this->PopulateFromDataset(liked_exceptions);
+    }
+    else if (this->load_options.source == WikiSource::WIKITEXT) {
+      if (stored_dataset.Empty()) {
+        this->FetchDataset();
+      }
+      else {
+        this->RefreshDataset(stored_dataset);
+      }
 
-  for (auto g:to_skip_gifts) {
-    this->gifts_to_skip[g] = false;
-  }
+      universally_loved_gifts_exceptions = this->PopulateFromDataset(liked_exceptions);
+    }
+    else {
+      // no page depends on another's contents, only on its name: the Friendship page starts downloading now, and each villager's page as the Villagers page's parse reaches their name,
+      // so the villager pages download while the Villagers page is still being fetched and parsed, and while the earlier villagers' pages are parsed
+      page_fetches.reset(new CurlPipeline(this->load_options.fetch_window, this->load_options.request_policy));
+      page_fetches->Request(this->load_options.page_url + GiftsByVillager::FRIENDSHIP_PAGE_TITLE);
 
-  // Combine Villager/Gift data
-  this->PopulateVillagersFromWiki();
+      this->PopulateVillagersFromWiki(page_fetches.get());
 
-  // get gifts that are specifically loved by each villager
-  for (auto v:this->non_skipped_villagers) {
-    std::vector<Gift> loved_gifts = this->PopulateLovedGiftsOfVillagerFromWiki(v);
-    for (auto g:loved_gifts) {
-      // a mapping of all loved Gifts to the Villagers that love them
-      if (this->loved_gifts_of_villagers.find(g) == this->loved_gifts_of_villagers.end()) {
-        this->loved_gifts_of_villagers[g] = std::vector<Villager>();
+      // get gifts that are specifically loved (and liked) by each villager
+      for (auto v:this->non_skipped_villagers) {
+        this->PopulateGiftsOfVillagerFromWiki(v, page_fetches.get());
       }
 
-      this->loved_gifts_of_villagers[g].push_back(v);
+      // get gifts that are (almost) universally-loved (and liked) by villagers
+      universally_loved_gifts_exceptions = this->GetUniversalLovedGiftExceptions(liked_exceptions, page_fetches.get());
+
+      this->transfer_stats = page_fetches->GetTransferStats();
+      this->url_outcomes = page_fetches->GetURLOutcomes();
+    }
+
+    this->BuildIncidences(universally_loved_gifts_exceptions, universally_liked_gifts_exceptions);
+  }
+  catch (const std::exception&) {
+    // this object is never finished, so the outcomes so far go where the caller asked, in the same order GetURLOutcomes gives them; fetches still in flight are dropped
+    if (this->load_options.failed_url_outcomes != NULL) {
+      *this->load_options.failed_url_outcomes = this->curl_interface->GetURLOutcomes();
+      if (page_fetches) {
+        const std::vector<CurlURLOutcome> pipeline_outcomes = page_fetches->GetURLOutcomes();
+        this->load_options.failed_url_outcomes->insert(this->load_options.failed_url_outcomes->end(), pipeline_outcomes.begin(), pipeline_outcomes.end());
+      }
     }
+    throw;
+  }
+
+  // close down curl memory; the pipeline's fetches are counted along with this object's own
+  this->transfer_stats.Add(this->curl_interface->GetTransferStats());
+  const std::vector<CurlURLOutcome> direct_outcomes = this->curl_interface->GetURLOutcomes();
+  this->url_outcomes.insert(this->url_outcomes.begin(), direct_outcomes.begin(), direct_outcomes.end());
+  this->curl_interface = NULL;
+}
+
+// O(number of incidences + number of gifts)
+// The embedded tables already hold the combined loves, so this only drops skipped names: O(number of gifts * number of villagers / 64 + number of incidences)
+GiftsByVillager::GiftsByVillager(const std::vector<Villager>& to_skip_villagers, const std::vector<Gift>& to_skip_gifts, const EmbeddedDataset& embedded)
+  : curl_interface(NULL)
+{
+  this->SetSkipLists(to_skip_villagers, to_skip_gifts);
+
+  std::vector<Villager> listed_villagers;
+  for (unsigned int order_i = 0; order_i < embedded.villager_count; ++order_i) {
+    listed_villagers.push_back(embedded.villager_names[embedded.villager_order[order_i]]);
   }
+  this->AddNonSkippedVillagers(listed_villagers);
 
-  // get gifts that are (almost) universally-loved by villagers
-  std::map<Gift, std::vector<Villager>> universally_loved_gifts_exceptions = this->GetUniversalLovedGiftExceptions();
-  for (auto g_v:universally_loved_gifts_exceptions) {
-    if (g_v.second.size() <= 0) {
-      this->loved_gifts_of_villagers[g_v.first] = this->non_skipped_villagers;
+  // both name tables are sorted, so interning the names that are kept, in order, keeps the IDs in name order
+  std::vector<unsigned int> villager_ids(embedded.villager_count, NameTable::NOT_FOUND);
+  for (unsigned int villager_id = 0; villager_id < embedded.villager_count; ++villager_id) {
+    if (this->villagers_to_skip.find(embedded.villager_names[villager_id]) == this->villagers_to_skip.end()) {
+      villager_ids[villager_id] = this->incidences.AddVillager(embedded.villager_names[villager_id]);
     }
-    else {
-      std::vector<Villager> loving_villagers;
+  }
 
-      for (auto v:this->non_skipped_villagers) {
-        bool villager_loves_this = true;
-        for (auto excepting_v:g_v.second) {
-          if (excepting_v == v) {
-            villager_loves_this = false;
-            break;
-          }
-        }
+  for (unsigned int gift_id = 0; gift_id < embedded.gift_count; ++gift_id) {
+    const std::vector<Gift> kept_gift = this->RemoveSkippedGifts({embedded.gift_names[gift_id]});
+    if (kept_gift.size() <= 0) {
+      continue;
+    }
 
-        if (villager_loves_this) {
-          loving_villagers.push_back(v);
+    const unsigned int stored_gift_id = this->incidences.AddGift(kept_gift[0]);
+    const unsigned long long* gift_words = embedded.incidences + static_cast<size_t>(gift_id) * embedded.WordsPerGift();
+    for (unsigned int word_i = 0; word_i < embedded.WordsPerGift(); ++word_i) {
+      for (unsigned long long word = gift_words[word_i]; word != 0; word &= word - 1) {
+        const unsigned int villager_id = word_i * EmbeddedDataset::BITS_PER_WORD + static_cast<unsigned int>(__builtin_ctzll(word));
+        if (villager_ids[villager_id] != NameTable::NOT_FOUND) {
+          this->incidences.AddIncidence(stored_gift_id, villager_ids[villager_id]);
         }
       }
-
-      this->loved_gifts_of_villagers[g_v.first] = loving_villagers;
     }
   }
 
-  // close down curl memory
-  delete this->curl_interface;
-  this->curl_interface = NULL;
+  this->incidences.Build();
 }
 
-std::vector<GiftForVillagers> GiftsByVillager::GetGiftSets() const {
+GiftsByVillager::GiftsByVillager(SetCoverInstance* instance)
+  : curl_interface(NULL),
+    incidences(std::move(instance->incidences))
+{
+  const NameTable& element_names = this->incidences.GetVillagerNames();
+  this->non_skipped_villagers.reserve(element_names.Size());
+  for (unsigned int element_id = 0; element_id < element_names.Size(); ++element_id) {
+    this->non_skipped_villagers.push_back(element_names.Name(element_id));
+  }
+}
+
+// every gift of the store, with the villagers it reaches, in gift ID order
+std::vector<GiftForVillagers> GiftSetsOf(const IncidenceStore& incidences) {
+  const NameTable& gift_names = incidences.GetGiftNames();
+  const NameTable& villager_names = incidences.GetVillagerNames();
+
   std::vector<GiftForVillagers> ret;
-  ret.resize(this->loved_gifts_of_villagers.size());
+  ret.resize(incidences.GiftCount());
 
-  int i = 0;
-  for (auto g_v:this->loved_gifts_of_villagers) {
-    ret[i] = GiftForVillagers(g_v.first, g_v.second);
-    ++i;
+  std::vector<Villager> loving_villagers;
+  for (unsigned int gift_id = 0; gift_id < ret.size(); ++gift_id) {
+    loving_villagers.resize(0);
+    for (const unsigned int* v_it = incidences.GiftVillagersBegin(gift_id); v_it != incidences.GiftVillagersEnd(gift_id); ++v_it) {
+      loving_villagers.push_back(villager_names.Name(*v_it));
+    }
+
+    ret[gift_id] = GiftForVillagers(gift_names.Name(gift_id), loving_villagers);
   }
 
   return ret;
 }
 
+std::vector<GiftForVillagers> GiftsByVillager::GetGiftSets() const {
+  return GiftSetsOf(this->incidences);
+}
+
+const IncidenceStore& GiftsByVillager::GetIncidences() const {
+  return this->incidences;
+}
+
+const IncidenceStore& GiftsByVillager::GetLikedIncidences() const {
+  return this->liked_incidences;
+}
+
+std::vector<GiftForVillagers> GiftsByVillager::GetLikedGiftSets() const {
+  return GiftSetsOf(this->liked_incidences);
+}
+
 // Get list of villagers stored
-const std::vector<Villager> GiftsByVillager::GetVillagers() {
+const std::vector<Villager> GiftsByVillager::GetVillagers() const {
   return this->non_skipped_villagers;
 }
 
+const CurlTransferStats GiftsByVillager::GetTransferStats() const {
+  return this->transfer_stats;
+}
+
+const std::vector<CurlURLOutcome> GiftsByVillager::GetURLOutcomes() const {
+  return this->url_outcomes;
+}
+
+const WikiDataset& GiftsByVillager::GetDataset() const {
+  return this->dataset;
+}
+
+const std::vector<std::string> GiftsByVillager::GetReadPages() const {
+  return this->read_pages;
+}
+
+// Initialize internal storage of the parameters
+// (the bool value in the maps will represent whether they have been seen from the wiki or not)
+void GiftsByVillager::SetSkipLists(const std::vector<Villager>& to_skip_villagers, const std::vector<Gift>& to_skip_gifts) {
+  for (auto v:to_skip_villagers) {
+    this->villagers_to_skip[v] = false;
+  }
+
+  for (auto g:to_skip_gifts) {
+    this->gifts_to_skip[g] = false;
+  }
+}
+
 // Get list of villagers from wiki, minus any we want to skip
-void GiftsByVillager::PopulateVillagersFromWiki() {
+// each villager not being skipped has their page requested from the pipeline as soon as the parse finds their name
+void GiftsByVillager::PopulateVillagersFromWiki(CurlPipeline* page_fetches) {
   this->non_skipped_villagers.resize(0);
 
   // Make call to wiki
-  CurlResult villagers_page = this->curl_interface->CallURL(GiftsByVillager::VILLAGERS_URL.c_str());
+  const std::string villagers_url = this->load_options.page_url + GiftsByVillager::VILLAGERS_PAGE_TITLE;
+  CurlResult villagers_page = this->curl_interface->CallURL(villagers_url.c_str());
   if (villagers_page.error != "" || villagers_page.data == "") {
     throw std::runtime_error("failed to perform URL get of villagers: " + villagers_page.error);
   }
 
+  // a section that then fails to parse throws, and the pipeline drops the pages requested from it
+  const XMLItemCallback request_villager_page = [this, page_fetches](const std::string& villager) {
+    if (this->villagers_to_skip.find(villager) == this->villagers_to_skip.end()) {
+      page_fetches->Request(this->load_options.page_url + villager);
+    }
+  };
+
   // parse male marriage candidates
-  XMLParseResult bachelor_xml = GetPrecededAndNestedData(villagers_page.data, "h3", "Bachelors", GiftsByVillager::VILLAGERS_CONTAINING_ELEMENTS);
+  XMLParseResult bachelor_xml = this->ExtractFromPage(villagers_page.data, "h3", "Bachelors", GiftsByVillager::VILLAGERS_CONTAINING_ELEMENTS, request_villager_page);
   if (bachelor_xml.error != "" || bachelor_xml.data.size() <= 0) {
     throw std::runtime_error("failed to parse bachelors from villagers page: " + bachelor_xml.error);
   }
 
-  for (auto v:bachelor_xml.data) {
-    // add the villager to the total list if they aren't being skipped
-    if (this->villagers_to_skip.find(v) != this->villagers_to_skip.end()) {
-      this->villagers_to_skip[v] = true; // mark seen while parsing wiki
-      continue;
-    }
-
-    this->non_skipped_villagers.push_back(v);
-  }
+  this->AddNonSkippedVillagers(bachelor_xml.data);
 
   // parse female marriage candidates
-  XMLParseResult bachelorette_xml = GetPrecededAndNestedData(villagers_page.data, "h3", "Bachelorettes", GiftsByVillager::VILLAGERS_CONTAINING_ELEMENTS);
+  XMLParseResult bachelorette_xml = this->ExtractFromPage(villagers_page.data, "h3", "Bachelorettes", GiftsByVillager::VILLAGERS_CONTAINING_ELEMENTS, request_villager_page);
   if (bachelorette_xml.error != "" || bachelorette_xml.data.size() <= 0) {
     throw std::runtime_error("failed to parse bachelorettes from villagers page: " + bachelorette_xml.error);
   }
 
-  for (auto v:bachelorette_xml.data) {
-    // add the villager to the total list if they aren't being skipped
-    if (this->villagers_to_skip.find(v) != this->villagers_to_skip.end()) {
-      this->villagers_to_skip[v] = true; // mark seen while parsing wiki
-      continue;
-    }
-
-    this->non_skipped_villagers.push_back(v);
-  }
+  this->AddNonSkippedVillagers(bachelorette_xml.data);
 
   // parse non-marriage-candidate (but giftable) villagers
-  XMLParseResult nonmarriage_xml = GetPrecededAndNestedData(villagers_page.data, "h2", "Non-marriage candidates", GiftsByVillager::VILLAGERS_CONTAINING_ELEMENTS);
+  XMLParseResult nonmarriage_xml = this->ExtractFromPage(villagers_page.data, "h2", "Non-marriage candidates", GiftsByVillager::VILLAGERS_CONTAINING_ELEMENTS, request_villager_page);
   if (nonmarriage_xml.error != "" || nonmarriage_xml.data.size() <= 0) {
     throw std::runtime_error("failed to parse non-marriage candidates from villagers page: " + nonmarriage_xml.error);
   }
 
-  for (auto v:nonmarriage_xml.data) {
-    // add the villager to the total list if they aren't being skipped
-    if (this->villagers_to_skip.find(v) != this->villagers_to_skip.end()) {
-      this->villagers_to_skip[v] = true; // mark seen while parsing wiki
-      continue;
-    }
-
-    this->non_skipped_villagers.push_back(v);
-  }
+  this->AddNonSkippedVillagers(nonmarriage_xml.data);
 }
 
-// returns a mapping of all loved Gifts of the specified Villager
-const std::vector<Gift> GiftsByVillager::PopulateLovedGiftsOfVillagerFromWiki(const Villager& villager) {
+// adds the loved Gifts of the specified Villager, and their liked Gifts if asked for, parsed from the one page fetch
+void GiftsByVillager::PopulateGiftsOfVillagerFromWiki(const Villager& villager, CurlPipeline* page_fetches) {
   std::stringstream villager_url;
-  villager_url << GiftsByVillager::VILLAGER_URL_PREFIX << villager;
+  villager_url << this->load_options.page_url << villager;
 
-  // Make call to wiki
-  CurlResult villager_page = this->curl_interface->CallURL(villager_url.str().c_str());
+  // Wait for the call to wiki, most likely made while the pages before it were parsed
+  CurlResult villager_page = page_fetches->Take(villager_url.str());
   if (villager_page.error != "" || villager_page.data == "") {
     throw std::runtime_error("failed to perform URL get of villager " + villager + ": " + villager_page.error);
   }
 
-  XMLParseResult loved_gifts_xml = GetPrecededAndNestedData(villager_page.data, "td", "Best Gifts", GiftsByVillager::VILLAGER_GIFTS_CONTAINING_ELEMENTS);
+  XMLParseResult loved_gifts_xml = this->ExtractFromPage(villager_page.data, "td", "Best Gifts", GiftsByVillager::VILLAGER_GIFTS_CONTAINING_ELEMENTS);
   if (loved_gifts_xml.error != "" || loved_gifts_xml.data.size() <= 0) {
     throw std::runtime_error("failed to parse gifts from " + villager + "'s page: " + loved_gifts_xml.error);
   }
 
-  std::vector<Gift> acceptable_gifts;
-  for (auto g:loved_gifts_xml.data) {
-    // add the gift to the total list if it isn't being skipped
-    if (this->gifts_to_skip.find(g) != this->gifts_to_skip.end()) {
-      this->gifts_to_skip[g] = true; // mark seen while parsing wiki
-      continue;
+  this->AddLovedGifts(villager, this->RemoveSkippedGifts(loved_gifts_xml.data));
+
+  // a villager may like nothing in particular, so a missing table only means no liked gifts
+  if (this->load_options.liked_gifts) {
+    XMLParseResult liked_gifts_xml = this->ExtractFromPage(villager_page.data, "h3", GiftsByVillager::VILLAGER_LIKES_SECTION, GiftsByVillager::VILLAGER_LIKED_GIFTS_CONTAINING_ELEMENTS);
+    if (liked_gifts_xml.error != "") {
+      throw std::runtime_error("failed to parse liked gifts from " + villager + "'s page: " + liked_gifts_xml.error);
     }
 
-    acceptable_gifts.push_back(g);
+    this->AddLikedGifts(villager, this->RemoveSkippedGifts(liked_gifts_xml.data));
   }
+}
 
-  return acceptable_gifts;
+// GetPrecededAndNestedData with the chosen parser, through the extraction cache if there is one
+XMLParseResult GiftsByVillager::ExtractFromPage(const std::string& page_data, const std::string& preceding_element_name, const std::string& preceding_element_data_substring, const std::vector<std::string>& containing_element_names, const XMLItemCallback& on_item) {
+  if (this->load_options.extraction_cache != NULL) {
+    return this->load_options.extraction_cache->Extract(page_data, preceding_element_name, preceding_element_data_substring, containing_element_names, this->load_options.html_parser, on_item);
+  }
+  return GetPrecededAndNestedData(page_data, preceding_element_name, preceding_element_data_substring, containing_element_names, this->load_options.html_parser, on_item);
 }
 
 // returns a map of gifts mapped to any villagers that do not love them
-const std::map<Gift, std::vector<Villager>> GiftsByVillager::GetUniversalLovedGiftExceptions() {
-  // Get page data on (almost) universally-loved gifts
-  CurlResult friendship_page = this->curl_interface->CallURL(GiftsByVillager::FRIENDSHIP_URL.c_str());
+// with somewhere to put them, the universally-liked gifts are read from the same page the same way
+const std::unordered_map<Gift, std::vector<Villager>> GiftsByVillager::GetUniversalLovedGiftExceptions(std::unordered_map<Gift, std::vector<Villager>>* universally_liked_gifts_exceptions, CurlPipeline* page_fetches) {
+  // Get page data on (almost) universally-loved gifts, requested before any other page
+  CurlResult friendship_page = page_fetches->Take(this->load_options.page_url + GiftsByVillager::FRIENDSHIP_PAGE_TITLE);
   if (friendship_page.error != "" || friendship_page.data == "") {
     throw std::runtime_error("failed to perform URL get of friendship page: " + friendship_page.error);
   }
 
   // parse the list of (almost) universally-loved gifts
   std::vector<std::string> loves_containing_element_names = {"ul", "li", "span", "a"};
-  XMLParseResult universal_loves_xml = GetPrecededAndNestedData(friendship_page.data, "h3", "Universal Loves", loves_containing_element_names); // h3 rather than span because there's a tag earlier in the page that also contains it, so it's unique this way
+  XMLParseResult universal_loves_xml = this->ExtractFromPage(friendship_page.data, "h3", "Universal Loves", loves_containing_element_names); // h3 rather than span because there's a tag earlier in the page that also contains it, so it's unique this way
   if (universal_loves_xml.error != "" || universal_loves_xml.data.size() <= 0) {
     throw std::runtime_error("failed to parse universal loves from friendship page: " + universal_loves_xml.error);
   }
 
   // parse the exceptions to that list; returned in a list form of Villager/Gift/Villager/Gift, with the Villager specified before the Gift they don't love
   std::vector<std::string> exception_containing_element_names = {"ul", "li", "a"};
-  XMLParseResult exceptions_xml = GetPrecededAndNestedData(friendship_page.data, "h4", "Universal Loves exceptions", exception_containing_element_names); // h4 rather than span because there's a tag earlier in the page that also contains it, so it's unique this way
+  XMLParseResult exceptions_xml = this->ExtractFromPage(friendship_page.data, "h4", "Universal Loves exceptions", exception_containing_element_names); // h4 rather than span because there's a tag earlier in the page that also contains it, so it's unique this way
   if (exceptions_xml.error != "" || exceptions_xml.data.size() <= 0) {
     throw std::runtime_error("failed to parse exceptions to universal loves from friendship page: " + exceptions_xml.error);
   }
 
-  // combine that data to return
-  std::map<Gift, std::vector<Villager>> exceptional_universal_gifts;
-  for (auto g:universal_loves_xml.data) {
+  // universal likes may have no exceptions, so only parse errors fail
+  if (universally_liked_gifts_exceptions != NULL) {
+    XMLParseResult universal_likes_xml = this->ExtractFromPage(friendship_page.data, "h3", "Universal Likes", loves_containing_element_names);
+    XMLParseResult like_exceptions_xml = this->ExtractFromPage(friendship_page.data, "h4", "Universal Likes exceptions", exception_containing_element_names);
+    if (universal_likes_xml.error != "" || like_exceptions_xml.error != "") {
+      throw std::runtime_error("failed to parse universal likes from friendship page: " + universal_likes_xml.error + like_exceptions_xml.error);
+    }
+
+    *universally_liked_gifts_exceptions = this->CombineUniversalLoveExceptions(universal_likes_xml.data, like_exceptions_xml.data);
+  }
+
+  return this->CombineUniversalLoveExceptions(universal_loves_xml.data, exceptions_xml.data);
+}
+
+// Applies the skip lists to the dataset, the same way as the rendered pages
+// returns a map of universally-loved gifts mapped to any villagers that do not love them, like GetUniversalLovedGiftExceptions, and likewise for liked gifts
+const std::unordered_map<Gift, std::vector<Villager>> GiftsByVillager::PopulateFromDataset(std::unordered_map<Gift, std::vector<Villager>>* universally_liked_gifts_exceptions) {
+  this->non_skipped_villagers.resize(0);
+  this->AddNonSkippedVillagers(this->dataset.villagers);
+
+  // get gifts that are specifically loved (and liked) by each villager
+  for (auto v:this->non_skipped_villagers) {
+    this->AddLovedGifts(v, this->RemoveSkippedGifts(this->dataset.villager_pages[v].loved_gifts));
+    if (universally_liked_gifts_exceptions != NULL) {
+      this->AddLikedGifts(v, this->RemoveSkippedGifts(this->dataset.villager_pages[v].liked_gifts));
+    }
+  }
+
+  if (universally_liked_gifts_exceptions != NULL) {
+    *universally_liked_gifts_exceptions = this->CombineUniversalLoveExceptions(this->dataset.universal_likes, this->dataset.universal_like_exceptions);
+  }
+
+  return this->CombineUniversalLoveExceptions(this->dataset.universal_loves, this->dataset.universal_love_exceptions);
+}
+
+// Loads everything from page wikitext rather than rendered pages: one API call for the Villagers and Friendship pages, then one per batch of villagers
+void GiftsByVillager::FetchDataset() {
+  this->dataset = WikiDataset();
+
+  std::vector<WikiPage> overview_pages = this->FetchWikitextPages({GiftsByVillager::VILLAGERS_PAGE_TITLE, GiftsByVillager::FRIENDSHIP_PAGE_TITLE});
+  this->ReadVillagersPage(overview_pages[0]);
+  this->ReadFriendshipPage(overview_pages[1]);
+
+  this->ReadVillagerPages(this->dataset.villagers);
+  this->dataset.likes_read = true;
+}
+
+// Brings a stored dataset up to date: one API call asks for the latest revision of every page it was read from,
+// then only the pages that changed since (and the pages of any newly-listed villagers) are fetched and parsed again
+// a dataset stored before liked gifts were kept has every page other than the Villagers page read again, once
+void GiftsByVillager::RefreshDataset(const WikiDataset& stored_dataset) {
+  this->dataset = stored_dataset;
+
+  std::vector<std::string> titles = {GiftsByVillager::VILLAGERS_PAGE_TITLE, GiftsByVillager::FRIENDSHIP_PAGE_TITLE};
+  for (auto v_page:this->dataset.villager_pages) {
+    titles.push_back(v_page.first);
+  }
+
+  // a page that can no longer be found means the stored dataset is too out of date to patch
+  WikiPagesResult revisions = this->RequestWikiPages(titles, false);
+  if (revisions.error != "") {
+    this->FetchDataset();
+    return;
+  }
+
+  std::vector<std::string> changed_overview_titles;
+  if (revisions.data[0].revision_id != this->dataset.villagers_revision_id) {
+    changed_overview_titles.push_back(GiftsByVillager::VILLAGERS_PAGE_TITLE);
+  }
+  if (revisions.data[1].revision_id != this->dataset.friendship_revision_id || !this->dataset.likes_read) {
+    changed_overview_titles.push_back(GiftsByVillager::FRIENDSHIP_PAGE_TITLE);
+  }
+
+  if (changed_overview_titles.size() > 0) {
+    for (auto page:this->FetchWikitextPages(changed_overview_titles)) {
+      if (page.title == GiftsByVillager::VILLAGERS_PAGE_TITLE) {
+        this->ReadVillagersPage(page);
+      }
+      else {
+        this->ReadFriendshipPage(page);
+      }
+    }
+  }
+
+  // find villager pages that changed, or were never read
+  std::map<std::string, unsigned long> latest_revisions;
+  for (size_t page_i = 2; page_i < revisions.data.size(); ++page_i) {
+    latest_revisions[titles[page_i]] = revisions.data[page_i].revision_id;
+  }
+
+  std::vector<std::string> changed_villagers;
+  for (auto v:this->dataset.villagers) {
+    if (latest_revisions.find(v) == latest_revisions.end() || latest_revisions[v] != this->dataset.villager_pages[v].revision_id || !this->dataset.likes_read) {
+      changed_villagers.push_back(v);
+    }
+  }
+
+  // forget villagers no longer listed
+  std::map<std::string, VillagerPageData> listed_pages;
+  for (auto v:this->dataset.villagers) {
+    listed_pages[v] = this->dataset.villager_pages[v];
+  }
+  this->dataset.villager_pages = listed_pages;
+
+  this->ReadVillagerPages(changed_villagers);
+  this->dataset.likes_read = true;
+}
+
+// parse villagers the same way as the rendered page: ===Bachelors===, ===Bachelorettes===, ==Non-marriage candidates==
+void GiftsByVillager::ReadVillagersPage(const WikiPage& page) {
+  WikiTextResult bachelors = GetSectionNames(page.content, 3, "Bachelors");
+  if (bachelors.error != "" || bachelors.data.size() <= 0) {
+    throw std::runtime_error("failed to parse bachelors from villagers wikitext: " + bachelors.error);
+  }
+
+  WikiTextResult bachelorettes = GetSectionNames(page.content, 3, "Bachelorettes");
+  if (bachelorettes.error != "" || bachelorettes.data.size() <= 0) {
+    throw std::runtime_error("failed to parse bachelorettes from villagers wikitext: " + bachelorettes.error);
+  }
+
+  WikiTextResult nonmarriage = GetSectionNames(page.content, 2, "Non-marriage candidates");
+  if (nonmarriage.error != "" || nonmarriage.data.size() <= 0) {
+    throw std::runtime_error("failed to parse non-marriage candidates from villagers wikitext: " + nonmarriage.error);
+  }
+
+  this->dataset.villagers = bachelors.data;
+  this->dataset.villagers.insert(this->dataset.villagers.end(), bachelorettes.data.begin(), bachelorettes.data.end());
+  this->dataset.villagers.insert(this->dataset.villagers.end(), nonmarriage.data.begin(), nonmarriage.data.end());
+  this->dataset.villagers_revision_id = page.revision_id;
+}
+
+// get gifts that are (almost) universally-loved by villagers; the exceptions sit in their own subsection
+// universally-liked gifts follow the same layout, though either list may be empty
+void GiftsByVillager::ReadFriendshipPage(const WikiPage& page) {
+  WikiTextResult universal_loves = GetSectionNames(page.content, 3, "Universal Loves");
+  if (universal_loves.error != "" || universal_loves.data.size() <= 0) {
+    throw std::runtime_error("failed to parse universal loves from friendship wikitext: " + universal_loves.error);
+  }
+
+  WikiTextResult exceptions = GetSectionNames(page.content, 4, "Universal Loves exceptions");
+  if (exceptions.error != "" || exceptions.data.size() <= 0) {
+    throw std::runtime_error("failed to parse exceptions to universal loves from friendship wikitext: " + exceptions.error);
+  }
+
+  WikiTextResult universal_likes = GetSectionNames(page.content, 3, "Universal Likes");
+  WikiTextResult like_exceptions = GetSectionNames(page.content, 4, "Universal Likes exceptions");
+  if (universal_likes.error != "" || like_exceptions.error != "") {
+    throw std::runtime_error("failed to parse universal likes from friendship wikitext: " + universal_likes.error + like_exceptions.error);
+  }
+
+  this->dataset.universal_loves = universal_loves.data;
+  this->dataset.universal_love_exceptions = exceptions.data;
+  this->dataset.universal_likes = universal_likes.data;
+  this->dataset.universal_like_exceptions = like_exceptions.data;
+  this->dataset.friendship_revision_id = page.revision_id;
+}
+
+// get gifts that are specifically loved, and liked, by each of the given villagers
+void GiftsByVillager::ReadVillagerPages(const std::vector<std::string>& villagers) {
+  for (auto page:this->FetchWikitextPages(villagers)) {
+    WikiTextResult loved_gifts = GetTemplateParameterNames(page.content, GiftsByVillager::VILLAGER_INFOBOX_TEMPLATE, GiftsByVillager::VILLAGER_GIFTS_PARAMETER);
+    if (loved_gifts.error != "" || loved_gifts.data.size() <= 0) {
+      throw std::runtime_error("failed to parse gifts from " + page.title + "'s wikitext: " + loved_gifts.error);
+    }
+
+    // a villager may like nothing in particular
+    WikiTextResult liked_gifts = GetSectionNames(page.content, 3, GiftsByVillager::VILLAGER_LIKES_SECTION);
+    if (liked_gifts.error != "") {
+      throw std::runtime_error("failed to parse liked gifts from " + page.title + "'s wikitext: " + liked_gifts.error);
+    }
+
+    this->dataset.villager_pages[page.title] = VillagerPageData(page.revision_id, loved_gifts.data, liked_gifts.data);
+  }
+}
+
+// returns the wikitext of the given pages, in the same order, fetching as many per API call as the wiki allows
+const std::vector<WikiPage> GiftsByVillager::FetchWikitextPages(const std::vector<std::string>& titles) {
+  WikiPagesResult pages = this->RequestWikiPages(titles, true);
+  if (pages.error != "") {
+    throw std::runtime_error("failed to get wiki pages from the API: " + pages.error);
+  }
+
+  for (auto page:pages.data) {
+    this->read_pages.push_back(page.title);
+  }
+
+  return pages.data;
+}
+
+// returns the latest revision of the given pages, in the same order, asking for as many per API call as the wiki allows
+const WikiPagesResult GiftsByVillager::RequestWikiPages(const std::vector<std::string>& titles, bool include_content) {
+  std::vector<WikiPage> ret;
+
+  for (size_t batch_start = 0; batch_start < titles.size(); batch_start += WIKI_API_MAX_TITLES) {
+    size_t batch_end = batch_start + WIKI_API_MAX_TITLES < titles.size() ? batch_start + WIKI_API_MAX_TITLES : titles.size();
+    std::vector<std::string> batch_titles(titles.begin() + static_cast<long>(batch_start), titles.begin() + static_cast<long>(batch_end));
+
+    std::string url = WikiPagesURL(this->load_options.api_url, batch_titles, include_content);
+    CurlResult response = this->curl_interface->CallURL(url.c_str());
+    if (response.error != "" || response.data == "") {
+      return WikiPagesResult(std::vector<WikiPage>(), "failed to perform API get of wiki pages: " + response.error);
+    }
+
+    WikiPagesResult pages = ParseWikiPagesResponse(response.data, batch_titles);
+    if (pages.error != "") {
+      return WikiPagesResult(std::vector<WikiPage>(), "failed to read wiki pages from API response: " + pages.error);
+    }
+
+    ret.insert(ret.end(), pages.data.begin(), pages.data.end());
+  }
+
+  return WikiPagesResult(ret, "");
+}
+
+// add the villagers to the total list if they aren't being skipped
+void GiftsByVillager::AddNonSkippedVillagers(const std::vector<Villager>& villagers) {
+  for (auto v:villagers) {
+    if (this->villagers_to_skip.find(v) != this->villagers_to_skip.end()) {
+      this->villagers_to_skip[v] = true; // mark seen while parsing wiki
+      continue;
+    }
+
+    this->non_skipped_villagers.push_back(v);
+  }
+}
+
+// the Gifts a Villager specifically loves, kept until the incidences are built
+void GiftsByVillager::AddLovedGifts(const Villager& villager, const std::vector<Gift>& gifts) {
+  this->specifically_loved_gifts.push_back(std::pair<Villager, std::vector<Gift>>(villager, gifts));
+}
+
+// the Gifts a Villager specifically likes, kept until the incidences are built
+void GiftsByVillager::AddLikedGifts(const Villager& villager, const std::vector<Gift>& gifts) {
+  this->specifically_liked_gifts.push_back(std::pair<Villager, std::vector<Gift>>(villager, gifts));
+}
+
+// returns the gifts that aren't being skipped
+const std::vector<Gift> GiftsByVillager::RemoveSkippedGifts(const std::vector<Gift>& gifts) {
+  std::vector<Gift> acceptable_gifts;
+  for (auto g:gifts) {
+    if (this->gifts_to_skip.find(g) != this->gifts_to_skip.end()) {
+      this->gifts_to_skip[g] = true; // mark seen while parsing wiki
+      continue;
+    }
+
+    acceptable_gifts.push_back(g);
+  }
+
+  return acceptable_gifts;
+}
+
+// exceptions are in a list form of Villager/Gift/Villager/Gift, with the Villager specified before the Gift they don't love
+// universal likes and their exceptions are combined the same way
+// returns a map of gifts mapped to any villagers that do not love them
+// O(number of universal loves + number of exceptions), on average
+const std::unordered_map<Gift, std::vector<Villager>> GiftsByVillager::CombineUniversalLoveExceptions(const std::vector<Gift>& universal_loves, const std::vector<std::string>& exceptions) {
+  std::unordered_map<Gift, std::vector<Villager>> exceptional_universal_gifts;
+  for (auto g:universal_loves) {
     // process the gift if it isn't being skipped
     if (this->gifts_to_skip.find(g) != this->gifts_to_skip.end()) {
       this->gifts_to_skip[g] = true; // mark seen while parsing wiki
       continue;
     }
 
-    std::vector<Villager> unloving_villagers;
-    for (size_t exception_i = 1; exception_i < exceptions_xml.data.size(); exception_i += 2) {
-      // process the exceptional villager if they aren't being skipped
-      if (this->villagers_to_skip.find(exceptions_xml.data[exception_i-1]) != this->villagers_to_skip.end()) {
-        this->villagers_to_skip[exceptions_xml.data[exception_i-1]] = true; // make seen while parsing wiki
-        continue;
-      }
+    exceptional_universal_gifts[g];
+  }
 
-      if (exceptions_xml.data[exception_i] == g) {
-        unloving_villagers.push_back(exceptions_xml.data[exception_i-1]);
-      }
+  if (exceptional_universal_gifts.size() <= 0) {
+    return exceptional_universal_gifts;
+  }
+
+  for (size_t exception_i = 1; exception_i < exceptions.size(); exception_i += 2) {
+    // process the exceptional villager if they aren't being skipped
+    if (this->villagers_to_skip.find(exceptions[exception_i-1]) != this->villagers_to_skip.end()) {
+      this->villagers_to_skip[exceptions[exception_i-1]] = true; // make seen while parsing wiki
+      continue;
     }
 
-    exceptional_universal_gifts[g] = unloving_villagers;
+    auto found = exceptional_universal_gifts.find(exceptions[exception_i]);
+    if (found != exceptional_universal_gifts.end()) {
+      found->second.push_back(exceptions[exception_i-1]);
+    }
   }
 
   return exceptional_universal_gifts;
 }
+
+// Lays out which villagers love which gifts, once everything has been read, and which like which if asked for
+// names are given IDs in sorted order, so ID order agrees with name order (and the sets' ordering) everywhere; both stores are given every name, so their IDs agree
+// a universal love replaces any villager's specific love of the same gift, since its exceptions are the final word on it; likewise for likes
+// O(number of incidences + number of names * log(number of names))
+void GiftsByVillager::BuildIncidences(const std::unordered_map<Gift, std::vector<Villager>>& universally_loved_gifts_exceptions, const std::unordered_map<Gift, std::vector<Villager>>& universally_liked_gifts_exceptions) {
+  this->incidences = IncidenceStore();
+  this->liked_incidences = IncidenceStore();
+
+  std::vector<Villager> villager_names = this->non_skipped_villagers;
+  std::sort(villager_names.begin(), villager_names.end());
+  for (const auto& v:villager_names) {
+    this->incidences.AddVillager(v);
+    if (this->load_options.liked_gifts) {
+      this->liked_incidences.AddVillager(v);
+    }
+  }
+
+  std::vector<Gift> gift_names;
+  for (const auto& g_v:universally_loved_gifts_exceptions) {
+    gift_names.push_back(g_v.first);
+  }
+  for (const auto& v_g:this->specifically_loved_gifts) {
+    gift_names.insert(gift_names.end(), v_g.second.begin(), v_g.second.end());
+  }
+  for (const auto& g_v:universally_liked_gifts_exceptions) {
+    gift_names.push_back(g_v.first);
+  }
+  for (const auto& v_g:this->specifically_liked_gifts) {
+    gift_names.insert(gift_names.end(), v_g.second.begin(), v_g.second.end());
+  }
+  std::sort(gift_names.begin(), gift_names.end());
+  gift_names.erase(std::unique(gift_names.begin(), gift_names.end()), gift_names.end());
+  for (const auto& g:gift_names) {
+    this->incidences.AddGift(g);
+    if (this->load_options.liked_gifts) {
+      this->liked_incidences.AddGift(g);
+    }
+  }
+
+  this->AddIncidences(this->specifically_loved_gifts, universally_loved_gifts_exceptions, &this->incidences);
+  this->incidences.Build();
+  if (this->load_options.liked_gifts) {
+    this->AddIncidences(this->specifically_liked_gifts, universally_liked_gifts_exceptions, &this->liked_incidences);
+    this->liked_incidences.Build();
+  }
+}
+
+// adds each villager's own gifts, except those a universal gift list has the final word on, then every villager for each universal gift bar its exceptions
+void GiftsByVillager::AddIncidences(const std::vector<std::pair<Villager, std::vector<Gift>>>& specific_gifts, const std::unordered_map<Gift, std::vector<Villager>>& universal_gifts_exceptions, IncidenceStore* store) {
+  const NameTable& villager_ids = store->GetVillagerNames();
+  const NameTable& gift_ids = store->GetGiftNames();
+
+  for (const auto& v_g:specific_gifts) {
+    const unsigned int villager_id = villager_ids.Find(v_g.first);
+    for (const auto& g:v_g.second) {
+      if (universal_gifts_exceptions.find(g) == universal_gifts_exceptions.end()) {
+        store->AddIncidence(gift_ids.Find(g), villager_id);
+      }
+    }
+  }
+
+  // every villager gets a universal gift, except those stamped with it
+  const unsigned int villager_count = static_cast<unsigned int>(villager_ids.Size());
+  std::vector<unsigned int> exception_stamps(villager_count, NameTable::NOT_FOUND);
+  for (const auto& g_v:universal_gifts_exceptions) {
+    const unsigned int gift_id = gift_ids.Find(g_v.first);
+    for (const auto& v:g_v.second) {
+      const unsigned int villager_id = villager_ids.Find(v);
+      if (villager_id != NameTable::NOT_FOUND) {
+        exception_stamps[villager_id] = gift_id;
+      }
+    }
+
+    for (unsigned int villager_id = 0; villager_id < villager_count; ++villager_id) {
+      if (exception_stamps[villager_id] != gift_id) {
+        store->AddIncidence(gift_id, villager_id);
+      }
+    }
+  }
+}
@@ -10,8 +10,19 @@
 #include <string> // string
 #include <vector> // vector
 #include <map> // map
-
-#include "curl.hpp" // Curl, CurlResult
+#include <unordered_map> // unordered_map
+#include <tuple> // pair
+
+#include "curl.hpp" // Curl, CurlResult, CurlTransferStats, CurlRequestPolicy, CurlURLOutcome, CurlPipeline
+#include "wikitext.hpp" // WikiPage, WikiPagesResult
+#include "dataset.hpp" // WikiDataset
+#include "xmlparse.hpp" // XMLParseResult, XMLParseBackend, XMLItemCallback
+#include "extractcache.hpp" // ExtractionCache
+#include "nametable.hpp" // NameTable
+#include "incidence.hpp" // IncidenceStore
+#include "embedded.hpp" // EmbeddedDataset
+#include "instance.hpp" // SetCoverInstance
+#include "arena.hpp" // Arena, ArenaAllocator
 
 typedef std::string Villager;
 typedef std::string Gift;
@@ -20,7 +31,8 @@ class GiftForVillagers {
   public:
     // Constructors
     GiftForVillagers(); // necessary for GiftForVillagers to be compatible with BucketQueue
-    GiftForVillagers(const Gift& g, const std::vector<Villager>& vs);
+    explicit GiftForVillagers(Arena* arena); // necessary for GiftForVillagers to be compatible with BucketQueue; an empty set whose villagers are stored in the arena
+    GiftForVillagers(const Gift& g, const std::vector<Villager>& vs, Arena* arena = NULL);
     GiftForVillagers(const GiftForVillagers& other); // necessary for GiftForVillagers to be compatible with BucketQueue
 
     // Methods necessary for GiftForVillagers to be compatible with BucketQueue
@@ -33,6 +45,7 @@ class GiftForVillagers {
     // Data-reading methods
     const Gift GetGift() const;
     const std::vector<Villager> GetVillagers() const;
+    void AddVillagerIDs(const NameTable& villager_names, std::vector<unsigned int>* ids) const; // appends the ID of each villager in the table, without copying names
 
     // Destructor
     ~GiftForVillagers();
@@ -41,41 +54,126 @@ class GiftForVillagers {
     void copy(const GiftForVillagers& other);
     void clear();
 
+    typedef std::map<Villager, bool, std::less<Villager>, ArenaAllocator<std::pair<const Villager, bool>>> VillagerMap;
+
     Gift gift;
-    std::map<Villager, bool> villagers;
+    VillagerMap villagers; // copies keep this set's arena; assignment keeps the arena of the set assigned to
 };
 
 // necessary for GiftForVillagers to be compatible with BucketQueue
 std::ostream& operator<<(std::ostream& os, const GiftForVillagers& x);
 
+// where GiftsByVillager reads the wiki from
+enum class WikiSource {
+  RENDERED_HTML, // one full page per villager, parsed with libxml2
+  WIKITEXT, // page source only, fetched in batches from the MediaWiki API and parsed with the wikitext tokenizer
+  STORED_DATASET // the stored dataset as-is, without checking the wiki for changes
+};
+
+// How GiftsByVillager loads data from the wiki
+class WikiLoadOptions {
+  public:
+    // Constructor; defaults to the rendered pages, parsed with libxml2
+    WikiLoadOptions();
+
+    // Member variables
+    WikiSource source;
+    XMLParseBackend html_parser; // only used for WikiSource::RENDERED_HTML
+    ExtractionCache* extraction_cache; // only used for WikiSource::RENDERED_HTML: NULL to parse every page, or a cache that must outlive the load, to skip parsing pages extracted from before
+    std::string api_url; // only used for WikiSource::WIKITEXT
+    std::string page_url; // only used for WikiSource::RENDERED_HTML: each page is fetched from this followed by its title
+    CurlRequestPolicy request_policy; // timeouts, retries and hedging for every wiki call
+    unsigned int fetch_window; // only used for WikiSource::RENDERED_HTML: pages fetched at once ahead of the parse, besides the Villagers page
+    bool liked_gifts; // also lay out liked gifts, read from the same pages as the loved ones; page wikitext is always read for both, so a stored dataset has them either way
+    std::vector<CurlURLOutcome>* failed_url_outcomes; // NULL, or where a load that throws leaves what happened to each URL fetched so far, since GetURLOutcomes is never reachable then
+
+    static const std::string DEFAULT_API_URL;
+    static const std::string DEFAULT_PAGE_URL;
+    static const unsigned int DEFAULT_FETCH_WINDOW;
+};
+
 class GiftsByVillager {
   public:
     // Constructor
     // will only load giftable villagers not specified in given skip list; likewise with gifts
-    GiftsByVillager(const std::vector<Villager>& to_skip_villagers, const std::vector<Gift>& to_skip_gifts);
-
-    // return list of all gifts and the villagers associated with them
+    // with WikiSource::WIKITEXT, a non-empty stored dataset is refreshed: one request checks every page's latest revision, and only changed pages are read again
+    GiftsByVillager(const std::vector<Villager>& to_skip_villagers, const std::vector<Gift>& to_skip_gifts, const WikiLoadOptions& options = WikiLoadOptions(), const WikiDataset& stored_dataset = WikiDataset());
+    // from a dataset compiled into the program: no wiki calls or file reads, only the skip lists are applied
+    GiftsByVillager(const std::vector<Villager>& to_skip_villagers, const std::vector<Gift>& to_skip_gifts, const EmbeddedDataset& embedded);
+    // from a generic set-cover instance, its sets standing in for gifts and its elements for villagers; the instance's store is moved in rather than copied
+    explicit GiftsByVillager(SetCoverInstance* instance);
+
+    // return list of all gifts and the villagers associated with them, in gift name order
     std::vector<GiftForVillagers> GetGiftSets() const;
 
-    const std::vector<Villager> GetVillagers();
+    // which non-skipped villagers love which non-skipped gifts, by ID; IDs follow name order on both sides
+    const IncidenceStore& GetIncidences() const;
 
-  private:
-    void PopulateVillagersFromWiki();
-    const std::vector<Gift> PopulateLovedGiftsOfVillagerFromWiki(const Villager& villager);
-    const std::map<Gift, std::vector<Villager>> GetUniversalLovedGiftExceptions();
+    // which non-skipped villagers like which non-skipped gifts, with the same IDs as GetIncidences, which then also has every liked gift; empty unless WikiLoadOptions::liked_gifts
+    const IncidenceStore& GetLikedIncidences() const;
+    std::vector<GiftForVillagers> GetLikedGiftSets() const;
 
-    Curl* curl_interface;
-    std::map<Villager,bool> villagers_to_skip;
-    std::map<Gift,bool> gifts_to_skip;
+    const std::vector<Villager> GetVillagers() const;
+
+    // bytes transferred while loading from the wiki
+    const CurlTransferStats GetTransferStats() const;
+
+    // how each wiki URL was fetched: attempts, hedging and time taken
+    const std::vector<CurlURLOutcome> GetURLOutcomes() const;
+
+    // the dataset everything was loaded from, for storing and refreshing later; empty for WikiSource::RENDERED_HTML and an embedded dataset
+    const WikiDataset& GetDataset() const;
+
+    // titles of the pages whose content was read, rather than only their revision checked
+    const std::vector<std::string> GetReadPages() const;
+
+  private:
+    void SetSkipLists(const std::vector<Villager>& to_skip_villagers, const std::vector<Gift>& to_skip_gifts);
+    void PopulateVillagersFromWiki(CurlPipeline* page_fetches);
+    void PopulateGiftsOfVillagerFromWiki(const Villager& villager, CurlPipeline* page_fetches);
+    XMLParseResult ExtractFromPage(const std::string& page_data, const std::string& preceding_element_name, const std::string& preceding_element_data_substring, const std::vector<std::string>& containing_element_names, const XMLItemCallback& on_item = nullptr);
+    const std::unordered_map<Gift, std::vector<Villager>> GetUniversalLovedGiftExceptions(std::unordered_map<Gift, std::vector<Villager>>* universally_liked_gifts_exceptions, CurlPipeline* page_fetches);
+    const std::unordered_map<Gift, std::vector<Villager>> PopulateFromDataset(std::unordered_map<Gift, std::vector<Villager>>* universally_liked_gifts_exceptions);
+    void FetchDataset();
+    void RefreshDataset(const WikiDataset& stored_dataset);
+    void ReadVillagersPage(const WikiPage& page);
+    void ReadFriendshipPage(const WikiPage& page);
+    void ReadVillagerPages(const std::vector<std::string>& villagers);
+    const std::vector<WikiPage> FetchWikitextPages(const std::vector<std::string>& titles);
+    const WikiPagesResult RequestWikiPages(const std::vector<std::string>& titles, bool include_content);
+
+    void AddNonSkippedVillagers(const std::vector<Villager>& villagers);
+    void AddLovedGifts(const Villager& villager, const std::vector<Gift>& gifts);
+    void AddLikedGifts(const Villager& villager, const std::vector<Gift>& gifts);
+    const std::vector<Gift> RemoveSkippedGifts(const std::vector<Gift>& gifts);
+    const std::unordered_map<Gift, std::vector<Villager>> CombineUniversalLoveExceptions(const std::vector<Gift>& universal_loves, const std::vector<std::string>& exceptions);
+    void BuildIncidences(const std::unordered_map<Gift, std::vector<Villager>>& universally_loved_gifts_exceptions, const std::unordered_map<Gift, std::vector<Villager>>& universally_liked_gifts_exceptions);
+    void AddIncidences(const std::vector<std::pair<Villager, std::vector<Gift>>>& specific_gifts, const std::unordered_map<Gift, std::vector<Villager>>& universal_gifts_exceptions, IncidenceStore* store);
+
+    WikiLoadOptions load_options;
+    Curl* curl_interface; // only while the wiki constructor runs, which owns it
+    CurlTransferStats transfer_stats;
+    std::vector<CurlURLOutcome> url_outcomes;
+    WikiDataset dataset;
+    std::vector<std::string> read_pages;
+    std::unordered_map<Villager,bool> villagers_to_skip;
+    std::unordered_map<Gift,bool> gifts_to_skip;
 
     std::vector<Villager> non_skipped_villagers;
-    std::map<Gift, std::vector<Villager>> loved_gifts_of_villagers;
+    std::vector<std::pair<Villager, std::vector<Gift>>> specifically_loved_gifts; // each villager's own loves, as read
+    std::vector<std::pair<Villager, std::vector<Gift>>> specifically_liked_gifts; // each villager's own likes, as read; only with WikiLoadOptions::liked_gifts
+    IncidenceStore incidences;
+    IncidenceStore liked_incidences;
 
-    static const std::string VILLAGERS_URL;
     static const std::vector<std::string> VILLAGERS_CONTAINING_ELEMENTS;
-    static const std::string VILLAGER_URL_PREFIX;
     static const std::vector<std::string> VILLAGER_GIFTS_CONTAINING_ELEMENTS;
-    static const std::string FRIENDSHIP_URL;
+    static const std::vector<std::string> VILLAGER_LIKED_GIFTS_CONTAINING_ELEMENTS;
+
+    static const std::string VILLAGERS_PAGE_TITLE;
+    static const std::string FRIENDSHIP_PAGE_TITLE;
+    static const std::string VILLAGER_INFOBOX_TEMPLATE;
+    static const std::string VILLAGER_GIFTS_PARAMETER;
+    static const std::string VILLAGER_LIKES_SECTION;
 };
 
 #endif // SVGSC_VALLEY_FACTS_H
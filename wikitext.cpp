@@ -0,0 +1,550 @@
+/*
+ * Description: implementations to fetch and parse MediaWiki wikitext
+ * Documentation/references:
+ *    - MediaWiki revisions API: https://www.mediawiki.org/wiki/API:Revisions
+ *    - wikitext markup: https://www.mediawiki.org/wiki/Help:Formatting
+ * Author: Laura Galbraith
+*/
+
+#include "wikitext.hpp" // self-include header
+
+#include <string> // string
+#include <vector> // vector
+#include <map> // map
+#include <cctype> // tolower, isspace
+#include <cstring> // memchr, strncmp
+
+#include "jsonparse.hpp" // ParseJSON, JSONParseResult, JSONValue
+
+WikiPage::WikiPage(const std::string& page_title, unsigned long page_revision_id, const std::string& page_content)
+  : title(page_title), revision_id(page_revision_id), content(page_content)
+{}
+
+WikiPagesResult::WikiPagesResult(const std::vector<WikiPage>& result_data, const std::string& result_error)
+  : data(result_data), error(result_error)
+{}
+
+WikiTextResult::WikiTextResult(const std::vector<std::string>& result_data, const std::string& result_error)
+  : data(result_data), error(result_error)
+{}
+
+// percent-encodes everything but RFC 3986 unreserved characters
+std::string EncodeURLComponent(const std::string& s) {
+  static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+  std::string ret;
+  for (auto c:s) {
+    const unsigned char u = static_cast<unsigned char>(c);
+    if ((u >= 'a' && u <= 'z') || (u >= 'A' && u <= 'Z') || (u >= '0' && u <= '9') || u == '-' || u == '_' || u == '.' || u == '~') {
+      ret.push_back(c);
+    }
+    else {
+      ret.push_back('%');
+      ret.push_back(HEX_DIGITS[u >> 4]);
+      ret.push_back(HEX_DIGITS[u & 0xF]);
+    }
+  }
+
+  return ret;
+}
+
+std::string WikiPagesURL(const std::string& api_url, const std::vector<std::string>& titles, bool include_content) {
+  std::string url = api_url + "?action=query&format=json&formatversion=2&redirects=1&prop=revisions&rvslots=main&rvprop=";
+  url += include_content ? EncodeURLComponent("ids|content") : "ids";
+  url += "&titles=";
+
+  for (size_t title_i = 0; title_i < titles.size(); ++title_i) {
+    if (title_i > 0) {
+      url += EncodeURLComponent("|");
+    }
+    url += EncodeURLComponent(titles[title_i]);
+  }
+
+  return url;
+}
+
+// follows the "normalized" and "redirects" lists of a query response, which map requested titles to the titles of the returned pages
+void CollectTitleMappings(const JSONValue* mappings, std::map<std::string, std::string>* title_map) {
+  if (mappings == NULL || mappings->type != JSONValue::JSON_ARRAY) {
+    return;
+  }
+
+  for (const auto& m:mappings->elements) {
+    const JSONValue* from = m.Find("from");
+    const JSONValue* to = m.Find("to");
+    if (from != NULL && to != NULL && from->type == JSONValue::JSON_STRING && to->type == JSONValue::JSON_STRING) {
+      (*title_map)[from->text] = to->text;
+    }
+  }
+}
+
+WikiPagesResult ParseWikiPagesResponse(const std::string& response_data, const std::vector<std::string>& titles) {
+  JSONParseResult json = ParseJSON(response_data);
+  if (json.error != "") {
+    return WikiPagesResult(std::vector<WikiPage>(), "failed to parse API response: " + json.error);
+  }
+
+  const JSONValue* api_error = json.data.Find("error");
+  if (api_error != NULL) {
+    const JSONValue* info = api_error->Find("info");
+    return WikiPagesResult(std::vector<WikiPage>(), "API returned an error: " + (info != NULL ? info->text : std::string("unknown")));
+  }
+
+  const JSONValue* query = json.data.Find("query");
+  const JSONValue* pages = query != NULL ? query->Find("pages") : NULL;
+  if (pages == NULL || pages->type != JSONValue::JSON_ARRAY) {
+    return WikiPagesResult(std::vector<WikiPage>(), "API response has no pages");
+  }
+
+  std::map<std::string, std::string> normalized_titles;
+  std::map<std::string, std::string> redirected_titles;
+  CollectTitleMappings(query->Find("normalized"), &normalized_titles);
+  CollectTitleMappings(query->Find("redirects"), &redirected_titles);
+
+  // index returned pages by their (final) title
+  std::map<std::string, const JSONValue*> pages_by_title;
+  for (const auto& p:pages->elements) {
+    const JSONValue* title = p.Find("title");
+    if (title != NULL && title->type == JSONValue::JSON_STRING) {
+      pages_by_title[title->text] = &p;
+    }
+  }
+
+  std::vector<WikiPage> ret;
+  for (auto t:titles) {
+    std::string final_title = t;
+    if (normalized_titles.find(final_title) != normalized_titles.end()) {
+      final_title = normalized_titles[final_title];
+    }
+    if (redirected_titles.find(final_title) != redirected_titles.end()) {
+      final_title = redirected_titles[final_title];
+    }
+
+    if (pages_by_title.find(final_title) == pages_by_title.end() || pages_by_title[final_title]->Find("missing") != NULL) {
+      return WikiPagesResult(std::vector<WikiPage>(), "page " + t + " is missing from the API response");
+    }
+
+    // pages[].revisions[0].revid and .slots.main.content
+    const JSONValue* revisions = pages_by_title[final_title]->Find("revisions");
+    if (revisions == NULL || revisions->type != JSONValue::JSON_ARRAY || revisions->elements.size() <= 0) {
+      return WikiPagesResult(std::vector<WikiPage>(), "page " + t + " has no revisions in the API response");
+    }
+
+    const JSONValue& revision = revisions->elements[0];
+    const JSONValue* revision_id = revision.Find("revid");
+    if (revision_id == NULL || revision_id->type != JSONValue::JSON_NUMBER) {
+      return WikiPagesResult(std::vector<WikiPage>(), "page " + t + " has no revision ID in the API response");
+    }
+
+    std::string content;
+    const JSONValue* slots = revision.Find("slots");
+    const JSONValue* main_slot = slots != NULL ? slots->Find("main") : NULL;
+    const JSONValue* main_content = main_slot != NULL ? main_slot->Find("content") : NULL;
+    if (main_content != NULL) {
+      content = main_content->text;
+    }
+
+    ret.push_back(WikiPage(t, static_cast<unsigned long>(revision_id->number), content));
+  }
+
+  return WikiPagesResult(ret, "");
+}
+
+WikiToken::WikiToken()
+  : type(TEXT), text(NULL), length(0), heading_level(0)
+{}
+
+WikiTextTokenizer::WikiTextTokenizer(const std::string& text)
+  : begin(text.c_str()), pos(text.c_str()), end(text.c_str() + text.size())
+{}
+
+bool WikiTextTokenizer::Next(WikiToken* token) {
+  while (this->pos < this->end) {
+    token->text = this->pos;
+    token->length = 0;
+    token->heading_level = 0;
+
+    const char c = *this->pos;
+    const bool has_next = this->pos+1 < this->end;
+
+    if (c == '=' && this->AtLineStart() && this->ReadHeading(token)) {
+      return true;
+    }
+    else if (c == '{' && has_next && this->pos[1] == '{') {
+      token->type = WikiToken::TEMPLATE_START;
+      this->pos += 2;
+    }
+    else if (c == '}' && has_next && this->pos[1] == '}') {
+      token->type = WikiToken::TEMPLATE_END;
+      this->pos += 2;
+    }
+    else if (c == '[' && has_next && this->pos[1] == '[') {
+      token->type = WikiToken::LINK_START;
+      this->pos += 2;
+    }
+    else if (c == ']' && has_next && this->pos[1] == ']') {
+      token->type = WikiToken::LINK_END;
+      this->pos += 2;
+    }
+    else if (c == '|') {
+      token->type = WikiToken::PIPE;
+      ++this->pos;
+    }
+    else if (c == '=') {
+      token->type = WikiToken::EQUALS;
+      ++this->pos;
+    }
+    else if (c == '\n') {
+      token->type = WikiToken::NEWLINE;
+      ++this->pos;
+    }
+    else if (c == '<') {
+      // comments are dropped entirely
+      if (this->end - this->pos >= 4 && std::strncmp(this->pos, "<!--", 4) == 0) {
+        const char* comment_end = this->pos + 4;
+        while (comment_end+2 < this->end && !(comment_end[0] == '-' && comment_end[1] == '-' && comment_end[2] == '>')) {
+          ++comment_end;
+        }
+        this->pos = comment_end+3 < this->end ? comment_end+3 : this->end;
+        continue;
+      }
+
+      const void* tag_end = std::memchr(this->pos, '>', static_cast<size_t>(this->end - this->pos));
+      token->type = WikiToken::TAG;
+      this->pos = tag_end != NULL ? static_cast<const char*>(tag_end)+1 : this->end;
+    }
+    else {
+      // plain text runs until the next character that could start markup
+      token->type = WikiToken::TEXT;
+      while (this->pos < this->end) {
+        const char t = *this->pos;
+        if (t == '{' || t == '}' || t == '[' || t == ']' || t == '|' || t == '=' || t == '\n' || t == '<') {
+          break;
+        }
+        ++this->pos;
+      }
+
+      // a lone bracket or brace is text as well
+      if (this->pos == token->text) {
+        ++this->pos;
+      }
+    }
+
+    token->length = static_cast<size_t>(this->pos - token->text);
+    return true;
+  }
+
+  return false;
+}
+
+bool WikiTextTokenizer::AtLineStart() const {
+  return this->pos == this->begin || this->pos[-1] == '\n';
+}
+
+// a heading is a whole line of the form "== Title ==", possibly followed by whitespace
+bool WikiTextTokenizer::ReadHeading(WikiToken* token) {
+  const void* newline = std::memchr(this->pos, '\n', static_cast<size_t>(this->end - this->pos));
+  const char* line_end = newline != NULL ? static_cast<const char*>(newline) : this->end;
+
+  const char* title_start = this->pos;
+  while (title_start < line_end && *title_start == '=') {
+    ++title_start;
+  }
+
+  const char* title_end = line_end;
+  while (title_end > title_start && std::isspace(static_cast<unsigned char>(title_end[-1]))) {
+    --title_end;
+  }
+  const char* closing_start = title_end;
+  while (closing_start > title_start && closing_start[-1] == '=') {
+    --closing_start;
+  }
+
+  const size_t opening = static_cast<size_t>(title_start - this->pos);
+  const size_t closing = static_cast<size_t>(title_end - closing_start);
+  if (closing == 0 || closing_start <= title_start) {
+    return false;
+  }
+
+  // unbalanced markers leave the extra '=' as part of the title
+  const size_t level = opening < closing ? opening : closing;
+  title_start = this->pos + level;
+  title_end = title_end - level;
+  while (title_start < title_end && std::isspace(static_cast<unsigned char>(*title_start))) {
+    ++title_start;
+  }
+  while (title_end > title_start && std::isspace(static_cast<unsigned char>(title_end[-1]))) {
+    --title_end;
+  }
+
+  token->type = WikiToken::HEADING;
+  token->text = title_start;
+  token->length = static_cast<size_t>(title_end - title_start);
+  token->heading_level = static_cast<unsigned int>(level);
+  this->pos = line_end;
+  return true;
+}
+
+// returns the string with surrounding whitespace removed
+std::string TrimWhitespace(const std::string& s) {
+  size_t start = 0;
+  while (start < s.size() && std::isspace(static_cast<unsigned char>(s[start]))) {
+    ++start;
+  }
+
+  size_t end = s.size();
+  while (end > start && std::isspace(static_cast<unsigned char>(s[end-1]))) {
+    --end;
+  }
+
+  return s.substr(start, end-start);
+}
+
+// template and page names ignore case and treat underscores as spaces
+bool SameWikiName(const std::string& a, const std::string& b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+
+  for (size_t i = 0; i < a.size(); ++i) {
+    const char a_c = a[i] == '_' ? ' ' : a[i];
+    const char b_c = b[i] == '_' ? ' ' : b[i];
+    if (std::tolower(a_c) != std::tolower(b_c)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// templates whose first parameter is displayed as a linked villager or item name
+const std::vector<std::string> NAME_TEMPLATES = {"name", "NPC"};
+
+// links to these namespaces display a file or categorize the page, rather than naming anything
+const std::vector<std::string> NON_NAME_LINK_PREFIXES = {"file:", "image:", "category:", "media:"};
+
+// Template or link currently open while walking the tokens
+class WikiFrame {
+  public:
+    // Constructor
+    WikiFrame(bool frame_is_template)
+    : is_template(frame_is_template),
+      in_parameter_value(false)
+    {
+      this->arguments.resize(1);
+    }
+
+    // the template name or link target
+    const std::string Name() const {
+      return TrimWhitespace(this->arguments[0]);
+    }
+
+    // the key of the argument currently being read; empty for positional arguments
+    const std::string CurrentKey() const {
+      return this->in_parameter_value ? TrimWhitespace(this->current_key) : "";
+    }
+
+    bool is_template;
+    std::vector<std::string> arguments; // plain text of each '|'-separated argument
+    bool in_parameter_value; // whether a '=' was seen in the current (template) argument
+    std::string current_key;
+};
+
+// Walks wikitext and reports each displayed name along with the section and open templates it appears in
+class WikiNameWalker {
+  public:
+    virtual ~WikiNameWalker() {}
+
+    void Walk(const std::string& wikitext) {
+      WikiTextTokenizer tokenizer = WikiTextTokenizer(wikitext);
+      WikiToken token;
+      while (!this->Done() && tokenizer.Next(&token)) {
+        switch (token.type) {
+          case WikiToken::HEADING:
+            this->frames.clear(); // a heading cannot be inside a template or link
+            this->EnterSection(token.heading_level, std::string(token.text, token.length));
+            break;
+          case WikiToken::TEMPLATE_START:
+            this->frames.push_back(WikiFrame(true));
+            break;
+          case WikiToken::LINK_START:
+            this->frames.push_back(WikiFrame(false));
+            break;
+          case WikiToken::TEMPLATE_END:
+          case WikiToken::LINK_END:
+            this->CloseFrame(token.type == WikiToken::TEMPLATE_END);
+            break;
+          case WikiToken::PIPE:
+            if (!this->frames.empty()) {
+              this->frames.back().arguments.push_back("");
+              this->frames.back().in_parameter_value = false;
+              this->frames.back().current_key = "";
+            }
+            break;
+          case WikiToken::EQUALS:
+            if (!this->frames.empty()) {
+              WikiFrame& f = this->frames.back();
+              if (f.is_template && !f.in_parameter_value && f.arguments.size() > 1) {
+                // named template parameter: what came before is the key
+                f.in_parameter_value = true;
+                f.current_key = f.arguments.back();
+                f.arguments.back() = "";
+              }
+              else {
+                f.arguments.back().push_back('=');
+              }
+            }
+            break;
+          case WikiToken::TEXT:
+            if (!this->frames.empty()) {
+              this->frames.back().arguments.back().append(token.text, token.length);
+            }
+            break;
+          case WikiToken::NEWLINE:
+            if (!this->frames.empty()) {
+              this->frames.back().arguments.back().push_back(' ');
+            }
+            break;
+          case WikiToken::TAG:
+            break;
+        }
+      }
+    }
+
+  protected:
+    virtual void EnterSection(unsigned int heading_level, const std::string& heading) = 0;
+    virtual void FoundName(const std::string& name, const std::vector<WikiFrame>& enclosing_frames) = 0;
+    virtual bool Done() const = 0;
+
+  private:
+    void CloseFrame(bool closes_template) {
+      // ignore closers that do not match the innermost open frame
+      if (this->frames.empty() || this->frames.back().is_template != closes_template) {
+        return;
+      }
+
+      WikiFrame f = this->frames.back();
+      this->frames.pop_back();
+
+      std::string name;
+      if (f.is_template) {
+        // {{name|Diamond}} displays its first argument
+        if (f.arguments.size() > 1) {
+          for (auto t:NAME_TEMPLATES) {
+            if (SameWikiName(f.Name(), t)) {
+              name = TrimWhitespace(f.arguments[1]);
+              break;
+            }
+          }
+        }
+      }
+      else {
+        // [[Target]] displays the target, [[Target|Label]] the label
+        std::string lowercase_target = f.Name();
+        for (auto& c:lowercase_target) {
+          c = static_cast<char>(std::tolower(c));
+        }
+        for (auto prefix:NON_NAME_LINK_PREFIXES) {
+          if (lowercase_target.compare(0, prefix.size(), prefix) == 0) {
+            return;
+          }
+        }
+
+        name = TrimWhitespace(f.arguments.back());
+      }
+
+      if (name != "") {
+        this->FoundName(name, this->frames);
+      }
+    }
+
+    std::vector<WikiFrame> frames;
+};
+
+class SectionNameWalker : public WikiNameWalker {
+  public:
+    SectionNameWalker(unsigned int level, const std::string& substring)
+    : heading_level(level),
+      heading_substring(substring),
+      in_section(false),
+      section_done(false)
+    {}
+
+    std::vector<std::string> names;
+
+  protected:
+    void EnterSection(unsigned int level, const std::string& heading) {
+      if (this->in_section) {
+        this->in_section = false;
+        this->section_done = true;
+      }
+      else if (level == this->heading_level && heading.find(this->heading_substring) != std::string::npos) {
+        this->in_section = true;
+      }
+    }
+
+    void FoundName(const std::string& name, const std::vector<WikiFrame>& enclosing_frames) {
+      (void) enclosing_frames;
+      if (this->in_section) {
+        this->names.push_back(name);
+      }
+    }
+
+    bool Done() const {
+      return this->section_done;
+    }
+
+  private:
+    unsigned int heading_level;
+    std::string heading_substring;
+    bool in_section;
+    bool section_done;
+};
+
+class TemplateParameterNameWalker : public WikiNameWalker {
+  public:
+    TemplateParameterNameWalker(const std::string& t_name, const std::string& p_name)
+    : template_name(t_name),
+      parameter_name(p_name)
+    {}
+
+    std::vector<std::string> names;
+
+  protected:
+    void EnterSection(unsigned int level, const std::string& heading) {
+      (void) level;
+      (void) heading;
+    }
+
+    void FoundName(const std::string& name, const std::vector<WikiFrame>& enclosing_frames) {
+      // the nearest enclosing template with the right name decides whether we are in the parameter
+      for (auto f_it = enclosing_frames.crbegin(); f_it != enclosing_frames.crend(); ++f_it) {
+        if (f_it->is_template && SameWikiName(f_it->Name(), this->template_name)) {
+          if (f_it->arguments.size() > 1 && SameWikiName(f_it->CurrentKey(), this->parameter_name)) {
+            this->names.push_back(name);
+          }
+          return;
+        }
+      }
+    }
+
+    bool Done() const {
+      return false;
+    }
+
+  private:
+    std::string template_name;
+    std::string parameter_name;
+};
+
+WikiTextResult GetSectionNames(const std::string& wikitext, unsigned int heading_level, const std::string& heading_substring) {
+  SectionNameWalker walker = SectionNameWalker(heading_level, heading_substring);
+  walker.Walk(wikitext);
+  return WikiTextResult(walker.names, "");
+}
+
+WikiTextResult GetTemplateParameterNames(const std::string& wikitext, const std::string& template_name, const std::string& parameter_name) {
+  TemplateParameterNameWalker walker = TemplateParameterNameWalker(template_name, parameter_name);
+  walker.Walk(wikitext);
+  return WikiTextResult(walker.names, "");
+}
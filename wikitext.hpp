@@ -0,0 +1,97 @@
+/*
+ * Description: interfaces to fetch and parse MediaWiki wikitext
+ * Author: Laura Galbraith
+*/
+
+#ifndef SVGSC_WIKITEXT_H
+#define SVGSC_WIKITEXT_H
+
+#include <string> // string
+#include <vector> // vector
+#include <cstddef> // size_t
+
+// Source of one wiki page, as returned by the MediaWiki API
+class WikiPage {
+  public:
+    // Constructor
+    WikiPage(const std::string& page_title, unsigned long page_revision_id, const std::string& page_content);
+
+    // Member variables
+    std::string title; // title as requested, before any normalization/redirects the wiki applied
+    unsigned long revision_id;
+    std::string content; // wikitext
+};
+
+class WikiPagesResult {
+  public:
+    // Constructor
+    WikiPagesResult(const std::vector<WikiPage>& result_data, const std::string& result_error);
+
+    // Member variables
+    std::vector<WikiPage> data;
+    std::string error; // will be empty if result is successful
+};
+
+class WikiTextResult {
+  public:
+    // Constructor
+    WikiTextResult(const std::vector<std::string>& result_data, const std::string& result_error);
+
+    // Member variables
+    std::vector<std::string> data;
+    std::string error; // will be empty if result is successful
+};
+
+// the MediaWiki API accepts at most this many titles per query for regular users
+const size_t WIKI_API_MAX_TITLES = 50;
+
+// returns the API URL that fetches the latest revision of every given page in one request
+// include_content false asks only for revision IDs
+std::string WikiPagesURL(const std::string& api_url, const std::vector<std::string>& titles, bool include_content);
+
+// parses an API response for the URL above; returned pages are in the same order as the requested titles
+// a requested page that does not exist is an error
+WikiPagesResult ParseWikiPagesResponse(const std::string& response_data, const std::vector<std::string>& titles);
+
+// A piece of wikitext markup; text points into the tokenized buffer
+class WikiToken {
+  public:
+    enum Type { TEXT, TEMPLATE_START, TEMPLATE_END, LINK_START, LINK_END, PIPE, EQUALS, HEADING, NEWLINE, TAG };
+
+    // Constructor
+    WikiToken();
+
+    // Member variables
+    Type type;
+    const char* text; // for TEXT, the characters; for HEADING, the heading title
+    size_t length;
+    unsigned int heading_level; // number of '=' around a HEADING, i.e. the HTML h-level
+};
+
+// Splits wikitext into the markup that matters for finding names: templates, links, headings
+// comments are dropped, and HTML tags are returned whole as TAG tokens
+class WikiTextTokenizer {
+  public:
+    // Constructor; text must outlive the tokenizer
+    WikiTextTokenizer(const std::string& text);
+
+    // returns false once the end of the text is reached
+    bool Next(WikiToken* token);
+
+  private:
+    bool AtLineStart() const;
+    bool ReadHeading(WikiToken* token);
+
+    const char* begin;
+    const char* pos;
+    const char* end;
+};
+
+// returns the displayed names of links and name templates (ex. {{name|Diamond}}) in the first section whose heading has the given level and contains the given substring
+// the section ends at the next heading of any level
+WikiTextResult GetSectionNames(const std::string& wikitext, unsigned int heading_level, const std::string& heading_substring);
+
+// returns the displayed names of links and name templates in the value of the given parameter of every matching template, in page order
+WikiTextResult GetTemplateParameterNames(const std::string& wikitext, const std::string& template_name, const std::string& parameter_name);
+
+#endif // SVGSC_WIKITEXT_H
@@ -10,9 +10,15 @@
 
 #include <string> // string
 #include <vector> // vector
+#include <functional> // function
 #include <cctype> // tolower
+#include <cstring> // strlen
+#include <algorithm> // search
 #include <libxml/HTMLparser.h> // htmlSAXHandler, xmlChar, htmlParserCtxtPtr, htmlCreatePushParserCtxt, XML_CHAR_ENCODING_NONE, htmlParseChunk, htmlFreeParserCtxt
 
+#include "htmlscan.hpp" // HTMLScanner, HTMLScanEvent
+#include "perfcounters.hpp" // SVGSC_PERF_REGION
+
 XMLParseResult::XMLParseResult(const std::vector<std::string>& result_data, const std::string& result_error)
   : error(result_error)
 {
@@ -22,14 +28,15 @@ XMLParseResult::XMLParseResult(const std::vector<std::string>& result_data, cons
 }
 
 // returns true if the two strings are equal when lowercase
-bool CompareLowercaseStrings(const std::string& a, const std::string& b) {
-  if (a.size() != b.size()) {
+// a is given as a pointer and size so element names can be compared in place in the parser's buffer
+bool CompareLowercaseStrings(const char* a, size_t a_size, const std::string& b) {
+  if (a_size != b.size()) {
     return false;
   }
 
   // compare character by character
-  for (size_t i = 0; i < a.size(); ++i) {
-    if (std::tolower(a[i]) != std::tolower(b[i])) {
+  for (size_t i = 0; i < a_size; ++i) {
+    if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
       return false;
     }
   }
@@ -46,7 +53,8 @@ class XMLData {
     XMLData(
       const std::string& prec_elem_name,
       const std::string& prec_elem_data_substr,
-      const std::vector<std::string>& cont_elem_names)
+      const std::vector<std::string>& cont_elem_names,
+      const XMLItemCallback& item_callback)
     // all detection flags start off
     : precending_element_name(prec_elem_name),
       preceding_element_in_progress(false),
@@ -54,7 +62,8 @@ class XMLData {
       preceding_element_met(false),
       containing_elements_met(0),
       desired_data_in_progress(false),
-      desired_data_done(false)
+      desired_data_done(false),
+      on_item(item_callback)
     {
       this->containing_element_names.resize(0);
       for (auto n:cont_elem_names) {
@@ -65,15 +74,15 @@ class XMLData {
     }
 
     // As an element is started, see if it requires changes to our data-storing state
-    void StartElement(const std::string& element_name) {
+    void StartElement(const char* element_name, size_t element_name_size) {
       if (!this->preceding_element_met) { // phase 1: before we've seen the preceding element
-        if (CompareLowercaseStrings(element_name, this->precending_element_name)) {
+        if (CompareLowercaseStrings(element_name, element_name_size, this->precending_element_name)) {
           this->preceding_element_in_progress = true;
         }
       }
       else if (!this->desired_data_done) { // phase 3: getting into the containing elements
         if (this->containing_elements_met < this->containing_element_names.size()) {
-          if (CompareLowercaseStrings(element_name, this->containing_element_names[this->containing_elements_met])) {
+          if (CompareLowercaseStrings(element_name, element_name_size, this->containing_element_names[this->containing_elements_met])) {
             ++this->containing_elements_met;
             if (this->containing_elements_met == this->containing_element_names.size()) {
               this->desired_data_in_progress = true;
@@ -86,24 +95,27 @@ class XMLData {
       }
     }
 
-    void CharacterReceiver(const xmlChar* c, int c_count) {
+    void CharacterReceiver(const char* c, size_t c_count) {
       if (this->preceding_element_in_progress) { // phase 2: while in the preceding element
-        std::string chars = std::string(reinterpret_cast<const char*>(c), c_count);
-        if (chars.find(this->precending_element_data_substring) != std::string::npos) {
+        const char* found = std::search(c, c + c_count, this->precending_element_data_substring.begin(), this->precending_element_data_substring.end());
+        if (found != c + c_count || this->precending_element_data_substring.size() == 0) {
           this->preceding_element_met = true;
         }
       }
       else if (this->desired_data_in_progress && this->containing_elements_met == this->containing_element_names.size()) { // phase 4: inside the innermost containing elements (the desired data)
-        this->desired_data.push_back(std::string(reinterpret_cast<const char*>(c), c_count));
+        this->desired_data.push_back(std::string(c, c_count));
+        if (this->on_item) {
+          this->on_item(this->desired_data.back());
+        }
       }
     }
 
-    void EndElement(const std::string& element_name) {
-      if (this->preceding_element_in_progress && CompareLowercaseStrings(element_name, this->precending_element_name)) {
+    void EndElement(const char* element_name, size_t element_name_size) {
+      if (this->preceding_element_in_progress && CompareLowercaseStrings(element_name, element_name_size, this->precending_element_name)) {
         this->preceding_element_in_progress = false;
       }
       else if (!this->desired_data_done) { // phase 5: getting out of the containing elements
-        if (this->containing_elements_met > 0 && CompareLowercaseStrings(element_name, this->containing_element_names[this->containing_elements_met-1])) {
+        if (this->containing_elements_met > 0 && CompareLowercaseStrings(element_name, element_name_size, this->containing_element_names[this->containing_elements_met-1])) {
           --this->containing_elements_met;
           if (this->desired_data_in_progress && this->containing_elements_met == 0) {
             this->desired_data_in_progress = false;
@@ -129,13 +141,15 @@ class XMLData {
     std::vector<std::string> desired_data;
     bool desired_data_in_progress;
     bool desired_data_done;
+    XMLItemCallback on_item; // may be empty
 };
 
 // http://xmlsoft.org/html/libxml-parser.html#startElementSAXFunc
 void StartXMLElement(void* user_data, const xmlChar* element_name, const xmlChar** name_val_attribute_array) {
   // Cast to our user data type
   XMLData* user_xml_data = static_cast<XMLData*>(user_data);
-  user_xml_data->StartElement(std::string(reinterpret_cast<const char*>(element_name)));
+  const char* name = reinterpret_cast<const char*>(element_name);
+  user_xml_data->StartElement(name, std::strlen(name));
 
   // tell the compiler that we intend to not use the attribute array: https://stackoverflow.com/questions/1043034/what-does-void-mean-in-c-c-and-c
   (void) name_val_attribute_array;
@@ -145,14 +159,15 @@ void StartXMLElement(void* user_data, const xmlChar* element_name, const xmlChar
 void CharacterReceiver(void* user_data, const xmlChar* c, int c_count) {
   // Cast to our user data type
   XMLData* user_xml_data = static_cast<XMLData*>(user_data);
-  user_xml_data->CharacterReceiver(c, c_count);
+  user_xml_data->CharacterReceiver(reinterpret_cast<const char*>(c), static_cast<size_t>(c_count));
 }
 
 // http://xmlsoft.org/html/libxml-parser.html#endElementSAXFunc
 void EndXMLElement(void* user_data, const xmlChar* element_name) {
   // Cast to our user data type
   XMLData* user_xml_data = static_cast<XMLData*>(user_data);
-  user_xml_data->EndElement(std::string(reinterpret_cast<const char*>(element_name)));
+  const char* name = reinterpret_cast<const char*>(element_name);
+  user_xml_data->EndElement(name, std::strlen(name));
 }
 
 // http://xmlsoft.org/html/libxml-tree.html#xmlSAXHandler
@@ -191,19 +206,14 @@ htmlSAXHandler sax_handler = htmlSAXHandler{
   NULL,               // serror
 };
 
-XMLParseResult GetPrecededAndNestedData(
-  const std::string& page_data,
-  const std::string& preceding_element_name,
-  const std::string& preceding_element_data_substring,
-  const std::vector<std::string>& containing_element_names)
-{
+XMLParseResult ParseWithLibXML2(const std::string& page_data, XMLData* xml_data) {
+  SVGSC_PERF_REGION("html parse libxml2");
   htmlParserCtxtPtr parser_context;
-  XMLData xml_data = XMLData(preceding_element_name, preceding_element_data_substring, containing_element_names);
 
   // http://xmlsoft.org/html/libxml-HTMLparser.html#htmlCreatePushParserCtxt
   parser_context = htmlCreatePushParserCtxt(
     &sax_handler,
-    &xml_data, // void* type to receive data as we are user
+    xml_data, // void* type to receive data as we are user
     "", // empty chunk when initializing the parser context
     0, // size of chunk (empty)
     "", // file name, which is irrelevant as we are handling in-memory data
@@ -220,5 +230,62 @@ XMLParseResult GetPrecededAndNestedData(
   // http://xmlsoft.org/html/libxml-HTMLparser.html#htmlFreeParserCtxt ; does memory management of the parser for us
   htmlFreeParserCtxt(parser_context);
 
-  return XMLParseResult(xml_data.DesiredData(), "");
+  return XMLParseResult(xml_data->DesiredData(), "");
+}
+
+XMLParseResult ParseWithScanner(const std::string& page_data, XMLData* xml_data) {
+  SVGSC_PERF_REGION("html parse scanner");
+  HTMLScanner scanner = HTMLScanner(page_data.c_str(), page_data.size());
+  HTMLScanEvent event;
+  while (scanner.Next(&event)) {
+    switch (event.type) {
+      case HTMLScanEvent::START_ELEMENT:
+        xml_data->StartElement(event.text.data, event.text.size);
+        break;
+      case HTMLScanEvent::END_ELEMENT:
+        xml_data->EndElement(event.text.data, event.text.size);
+        break;
+      case HTMLScanEvent::CHARACTERS:
+        xml_data->CharacterReceiver(event.text.data, event.text.size);
+        break;
+    }
+  }
+
+  return XMLParseResult(xml_data->DesiredData(), "");
+}
+
+XMLParseResult GetPrecededAndNestedData(
+  const std::string& page_data,
+  const std::string& preceding_element_name,
+  const std::string& preceding_element_data_substring,
+  const std::vector<std::string>& containing_element_names,
+  XMLParseBackend backend,
+  const XMLItemCallback& on_item)
+{
+  XMLData xml_data = XMLData(preceding_element_name, preceding_element_data_substring, containing_element_names, on_item);
+
+  if (backend == XMLParseBackend::SCANNER) {
+    return ParseWithScanner(page_data, &xml_data);
+  }
+
+  XMLParseResult libxml2_result = ParseWithLibXML2(page_data, &xml_data);
+  if (backend == XMLParseBackend::LIBXML2 || libxml2_result.error != "") {
+    return libxml2_result;
+  }
+
+  // verify the scanner finds exactly what libxml2 does
+  XMLData scanner_xml_data = XMLData(preceding_element_name, preceding_element_data_substring, containing_element_names, nullptr);
+  XMLParseResult scanner_result = ParseWithScanner(page_data, &scanner_xml_data);
+  if (scanner_result.data != libxml2_result.data) {
+    std::string error = "HTML scanner found " + std::to_string(scanner_result.data.size()) + " items but libxml2 found " + std::to_string(libxml2_result.data.size());
+    for (size_t i = 0; i < scanner_result.data.size() && i < libxml2_result.data.size(); ++i) {
+      if (scanner_result.data[i] != libxml2_result.data[i]) {
+        error += "; first difference at item " + std::to_string(i) + ": '" + scanner_result.data[i] + "' vs '" + libxml2_result.data[i] + "'";
+        break;
+      }
+    }
+    return XMLParseResult(libxml2_result.data, error);
+  }
+
+  return libxml2_result;
 }
@@ -8,6 +8,7 @@
 
 #include <string> // string
 #include <vector> // vector
+#include <functional> // function
 
 class XMLParseResult {
   public:
@@ -19,11 +20,24 @@ class XMLParseResult {
     std::string error; // will be empty if result is successful
 };
 
+// which parser GetPrecededAndNestedData walks the page with
+enum class XMLParseBackend {
+  LIBXML2, // libxml2's general-purpose HTML push parser
+  SCANNER, // the specialized HTMLScanner, which does not allocate while walking the page
+  VERIFY // both, returning an error if they disagree
+};
+
+// called with each piece of desired data as soon as the parse reaches it, before the rest of the page is parsed
+typedef std::function<void(const std::string& item)> XMLItemCallback;
+
 // returns all desired html page data, preceded by the specified element containing the specified substring, and nested within the specified elements
+// with an on_item callback, each piece is also passed to it as it is found; with XMLParseBackend::VERIFY, only libxml2's pieces are
 XMLParseResult GetPrecededAndNestedData(
   const std::string& page_data,
   const std::string& preceding_element_name,
   const std::string& preceding_element_data_substring,
-  const std::vector<std::string>& containing_element_names);
+  const std::vector<std::string>& containing_element_names,
+  XMLParseBackend backend = XMLParseBackend::LIBXML2,
+  const XMLItemCallback& on_item = nullptr);
 
 #endif // SVGSC_XMLPARSE_H